@@ -0,0 +1,1056 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_Bench.c
+ *
+ * Description :
+ *  Micro benchmarks of the EduBfM data structures.
+ *  Build with "make bench" using the -O2 CFLAGS of the Makefile.
+ *  Usage: EduBfM_Bench <benchmark>
+ *   hash   - compare the chained hash table with the open addressing hash
+ *            table for pools of 10K to 1M buffers
+ *   policy - compare the hit ratios of the replacement policies on the
+ *            same reference strings; a volume "bench.vol" is created and
+ *            the page buffer pool is enlarged to BENCH_POLICY_NBUFS buffers
+ *   alloc  - compare the latency of EduBfM_GetTrain() hits on a page buffer
+ *            pool of BENCH_ALLOC_NBUFS buffers allocated with each flag of
+ *            EduBfM_SetPoolAllocation(); no volume is used
+ *   layout - compare the latency of edubfm_AllocTrain() on a pool of
+ *            BENCH_ALLOC_NBUFS buffers, a part of which is fixed, under
+ *            each layout of EduBfM_SetTableLayout(); no volume is used
+ *   mmap   - compare the throughput of scans and random lookups of the
+ *            trains of a volume "bench.vol" read into the page buffer pool
+ *            with the throughput when the volume is mapped by
+ *            EduBfM_MapVolume()
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "EduBfM_common.h"
+#include "EduBfM.h"
+#include "EduBfM_Internal.h"
+#include "EduBfM_TestModule.h"
+
+
+/*@
+ * macro definitions
+ */
+#define BENCH_NLOOKUPS      (1 << 22)       /* # of probes of a lookup benchmark */
+#define BENCH_POLICY_NBUFS  256             /* # of page buffers of the policy benchmark */
+#define BENCH_POLICY_NPAGES 1024            /* # of pages referenced by the policy benchmark */
+#define BENCH_POLICY_NREFS  100000          /* # of references of a reference string */
+#define BENCH_ALLOC_NBUFS   32000           /* # of page buffers of the allocation benchmark */
+#define BENCH_ALLOC_NHITS   (1 << 22)       /* # of hits of the allocation benchmark */
+#define BENCH_LAYOUT_NALLOCS (1 << 18)      /* # of allocations of the layout benchmark */
+#define BENCH_MMAP_NPAGES   4096            /* # of pages of the volume of the mmap benchmark */
+#define BENCH_MMAP_NREFS    (1 << 21)       /* # of trains fixed by each run of the mmap benchmark */
+
+/* Macro: BENCH_NSEC(t0, t1)
+ * Description: return the nanoseconds elapsed from t0 to t1
+ */
+#define BENCH_NSEC(t0, t1) \
+    ((double)((t1).tv_sec - (t0).tv_sec) * 1e9 + (double)((t1).tv_nsec - (t0).tv_nsec))
+
+/* Macro: BENCH_NEXT(k, probe, r)
+ * Description: set `k' to the key to look up next. The key depends on the
+ *  result `r' of the previous lookup, so that lookups are not overlapped
+ *  by the CPU and the latency of a lookup is measured, as in the buffer
+ *  manager where the caller waits for the buffer. After a miss (r < 0),
+ *  bit 0 of the pageNo of `probe' is flipped.
+ */
+#define BENCH_NEXT(k, probe, r) \
+    ((k).volNo = (probe).volNo, (k).pageNo = (probe).pageNo ^ (Four)((UFour)(r) >> 31))
+
+/*@
+ * type definitions
+ */
+/* Replica of BufferTable with a four byte chain link.
+ * BufferTable.nextHashEntry is Two, which cannot index 1M buffers, so the
+ * chained table of edubfm_Hash.c is reproduced here with the same layout
+ * and the same hash function.
+ */
+typedef struct {
+    BfMHashKey  key;
+    Two         fixed;
+    One         bits;
+    Four        nextHashEntry;
+} BenchBufferTable;
+
+typedef struct {
+    Four                size;           /* size of the hash table */
+    Four                *hashTable;     /* head of the chains */
+    BenchBufferTable    *bufTable;      /* buffer table linking the chains */
+} BenchChainedTable;
+
+
+/*@
+ * function prototypes
+ */
+Four bench_Hash(void);
+Four bench_Policy(void);
+Four bench_Alloc(void);
+Four bench_Layout(void);
+Four bench_Map(void);
+Four RDsM_CreateSegment(Four, Four *);
+
+
+/*@================================
+ * main()
+ *================================*/
+Four main(
+    Four        argc,
+    char        **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "hash") == 0) return(bench_Hash());
+    if (argc >= 2 && strcmp(argv[1], "policy") == 0) return(bench_Policy());
+    if (argc >= 2 && strcmp(argv[1], "alloc") == 0) return(bench_Alloc());
+    if (argc >= 2 && strcmp(argv[1], "layout") == 0) return(bench_Layout());
+    if (argc >= 2 && strcmp(argv[1], "mmap") == 0) return(bench_Map());
+
+    printf("Usage: %s <benchmark>\n", argv[0]);
+    printf("  hash   chained vs. open addressing hash table\n");
+    printf("  policy hit ratios of the replacement policies\n");
+    printf("  alloc  hit latency with huge page and NUMA allocation of the pool\n");
+    printf("  layout victim selection with the buffer table as an array of structs or of arrays\n");
+    printf("  mmap   scans and lookups through the buffer pool vs. a mapped volume\n");
+
+    return(1);
+}
+
+
+/*@================================
+ * bench_Random()
+ *================================*/
+/*
+ * Function: UFour bench_Random(UFour *)
+ *
+ * Description:
+ *  Return a pseudo random number (xorshift).
+ */
+static UFour bench_Random(
+    UFour       *state)         /* INOUT random state */
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return(*state);
+}
+
+
+/*@================================
+ * bench_ChainedLookUp(), bench_ChainedInsert(), bench_ChainedDelete()
+ *================================*/
+/*
+ * Same algorithms as edubfm_LookUp(), edubfm_Insert() and edubfm_Delete().
+ */
+static Four bench_ChainedLookUp(
+    BenchChainedTable   *t,
+    BfMHashKey          *key)
+{
+    Four                i;
+
+    for (i = t->hashTable[(key->volNo + key->pageNo) % t->size]; i != NOTFOUND_IN_HTABLE;
+         i = t->bufTable[i].nextHashEntry)
+        if (EQUALKEY(key, &t->bufTable[i].key)) return(i);
+
+    return(NOTFOUND_IN_HTABLE);
+}
+
+static void bench_ChainedInsert(
+    BenchChainedTable   *t,
+    BfMHashKey          *key,
+    Four                index)
+{
+    Four                h = (key->volNo + key->pageNo) % t->size;
+
+    t->bufTable[index].key = *key;
+    t->bufTable[index].nextHashEntry = t->hashTable[h];
+    t->hashTable[h] = index;
+}
+
+static void bench_ChainedDelete(
+    BenchChainedTable   *t,
+    BfMHashKey          *key)
+{
+    Four                *link;
+
+    for (link = &t->hashTable[(key->volNo + key->pageNo) % t->size]; *link != NOTFOUND_IN_HTABLE;
+         link = &t->bufTable[*link].nextHashEntry) {
+        if (EQUALKEY(key, &t->bufTable[*link].key)) {
+            *link = t->bufTable[*link].nextHashEntry;
+            return;
+        }
+    }
+}
+
+
+/*@================================
+ * bench_HashOne()
+ *================================*/
+/*
+ * Function: Four bench_HashOne(Four, Four)
+ *
+ * Description:
+ *  Fill both tables with `nBufs' keys and measure the latency of hits and
+ *  misses and the cost of replacements (delete of a resident key followed
+ *  by insert of a new one).
+ *  If `sequential' is TRUE, the resident keys are consecutive pages of one
+ *  volume, otherwise they are random pages of a volume 4 times larger.
+ *
+ * Returns:
+ *  error code
+ */
+static Four bench_HashOne(
+    Four                nBufs,          /* IN # of buffers */
+    Four                sequential)     /* IN resident keys are consecutive pages? */
+{
+    Four                e;
+    Four                i, j;
+    UFour               seed = 12345;
+    BfMHashKey          *keys;          /* resident keys followed by absent keys */
+    Four                *probes;        /* probe order */
+    BfMHashKey          *probeKeys;     /* keys in probe order */
+    BfMHashKey          k;              /* key to look up */
+    Four                *slots;         /* buffer index of each resident key */
+    BenchChainedTable   chained;
+    BfMOpenHashTable    open;
+    struct timespec     t0, t1;
+    double              ns[2][3];       /* [table][hit, miss, replace] */
+    Four                sum = 0;
+    Four                r;              /* result of the previous lookup */
+
+
+    keys = (BfMHashKey*)malloc(sizeof(BfMHashKey) * 2 * nBufs);
+    probes = (Four*)malloc(sizeof(Four) * BENCH_NLOOKUPS);
+    probeKeys = (BfMHashKey*)malloc(sizeof(BfMHashKey) * BENCH_NLOOKUPS);
+    slots = (Four*)malloc(sizeof(Four) * 2 * nBufs);
+    chained.size = HASHTABLESIZE_TO_NBUFS(nBufs);
+    chained.hashTable = (Four*)malloc(sizeof(Four) * chained.size);
+    chained.bufTable = (BenchBufferTable*)malloc(sizeof(BenchBufferTable) * nBufs);
+    if (!keys || !probes || !probeKeys || !slots || !chained.hashTable || !chained.bufTable) ERR(eMEMORYALLOCERR);
+
+    /* keys[0..nBufs) are resident, keys[nBufs..2*nBufs) are not */
+    for (i = 0; i < 2 * nBufs; i++) {
+        keys[i].volNo = 1000;
+        keys[i].pageNo = sequential ? i : i * 4 + (Four)(bench_Random(&seed) % 4);
+    }
+    for (i = 2 * nBufs - 1; i > 0; i--) {
+        j = bench_Random(&seed) % (i + 1);
+        if (!sequential) { BfMHashKey k = keys[i]; keys[i] = keys[j]; keys[j] = k; }
+    }
+
+    for (i = 0; i < chained.size; i++) chained.hashTable[i] = NOTFOUND_IN_HTABLE;
+    e = edubfm_OpenHashCreate(&open, nBufs);
+    if (e < eNOERROR) ERR(e);
+
+    for (i = 0; i < nBufs; i++) {
+        bench_ChainedInsert(&chained, &keys[i], i);
+        e = edubfm_OpenHashInsert(&open, &keys[i], i);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    /* hits */
+    for (i = 0; i < BENCH_NLOOKUPS; i++) probeKeys[i] = keys[bench_Random(&seed) % nBufs];
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0, r = 0; i < BENCH_NLOOKUPS; i++) {
+        BENCH_NEXT(k, probeKeys[i], r);
+        sum += r = bench_ChainedLookUp(&chained, &k);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns[0][0] = BENCH_NSEC(t0, t1) / BENCH_NLOOKUPS;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0, r = 0; i < BENCH_NLOOKUPS; i++) {
+        BENCH_NEXT(k, probeKeys[i], r);
+        sum += r = edubfm_OpenHashLookUp(&open, &k);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns[1][0] = BENCH_NSEC(t0, t1) / BENCH_NLOOKUPS;
+
+    /* misses */
+    for (i = 0; i < BENCH_NLOOKUPS; i++) {
+        probeKeys[i] = keys[nBufs + bench_Random(&seed) % nBufs];
+        probeKeys[i].pageNo ^= 1;       /* undone by BENCH_NEXT() after the previous miss */
+    }
+    probeKeys[0].pageNo ^= 1;           /* there is no previous miss */
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0, r = 0; i < BENCH_NLOOKUPS; i++) {
+        BENCH_NEXT(k, probeKeys[i], r);
+        sum += r = bench_ChainedLookUp(&chained, &k);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns[0][1] = BENCH_NSEC(t0, t1) / BENCH_NLOOKUPS;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0, r = 0; i < BENCH_NLOOKUPS; i++) {
+        BENCH_NEXT(k, probeKeys[i], r);
+        sum += r = edubfm_OpenHashLookUp(&open, &k);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns[1][1] = BENCH_NSEC(t0, t1) / BENCH_NLOOKUPS;
+
+    /* replacements: swap a resident key with an absent one, as an eviction does */
+    for (i = 0; i < 2 * nBufs; i++) slots[i] = (i < nBufs) ? i : NOTFOUND_IN_HTABLE;
+    for (i = 0; i < BENCH_NLOOKUPS; i++) probes[i] = bench_Random(&seed) % nBufs;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < BENCH_NLOOKUPS; i++) {
+        j = probes[i];
+        bench_ChainedDelete(&chained, &keys[j]);
+        bench_ChainedInsert(&chained, &keys[j + nBufs], slots[j]);
+        bench_ChainedDelete(&chained, &keys[j + nBufs]);
+        bench_ChainedInsert(&chained, &keys[j], slots[j]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns[0][2] = BENCH_NSEC(t0, t1) / BENCH_NLOOKUPS / 2;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < BENCH_NLOOKUPS; i++) {
+        j = probes[i];
+        edubfm_OpenHashDelete(&open, &keys[j]);
+        edubfm_OpenHashInsert(&open, &keys[j + nBufs], slots[j]);
+        edubfm_OpenHashDelete(&open, &keys[j + nBufs]);
+        edubfm_OpenHashInsert(&open, &keys[j], slots[j]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns[1][2] = BENCH_NSEC(t0, t1) / BENCH_NLOOKUPS / 2;
+
+    printf("%8d  %-10s  chained %7.1f %7.1f %7.1f   open %7.1f %7.1f %7.1f   (%d)\n",
+           nBufs, sequential ? "sequential" : "random",
+           ns[0][0], ns[0][1], ns[0][2], ns[1][0], ns[1][1], ns[1][2], sum & 1);
+
+    edubfm_OpenHashDestroy(&open);
+    free(chained.bufTable);
+    free(chained.hashTable);
+    free(slots);
+    free(probeKeys);
+    free(probes);
+    free(keys);
+
+    return(eNOERROR);
+}
+
+
+/*@================================
+ * bench_Hash()
+ *================================*/
+/*
+ * Function: Four bench_Hash(void)
+ *
+ * Description:
+ *  Compare the chained hash table of edubfm_Hash.c with the open
+ *  addressing hash table of edubfm_OpenHash.c at 10K, 100K and 1M buffers.
+ *  Reported numbers are nanoseconds per operation.
+ *
+ * Returns:
+ *  error code
+ */
+Four bench_Hash(void)
+{
+    Four        e;
+    Four        nBufs;
+
+
+    printf("   nBufs  keys                  hit    miss replace          hit    miss replace\n");
+    for (nBufs = 10000; nBufs <= 1000000; nBufs *= 10) {
+        e = bench_HashOne(nBufs, TRUE);
+        if (e < eNOERROR) ERR(e);
+        e = bench_HashOne(nBufs, FALSE);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    return(eNOERROR);
+}
+
+
+
+/*@================================
+ * bench_PolicyTrace()
+ *================================*/
+/*
+ * Function: void bench_PolicyTrace(Four, Four *)
+ *
+ * Description:
+ *  Fill `trace' with BENCH_POLICY_NREFS page numbers (indexes into the
+ *  allocated pages) of the given workload.
+ *   0 zipf - skewed references, page i is referenced with probability ~ 1/(i+1)
+ *   1 scan - half of the references go to a hot set which fits in the pool
+ *            (e.g. index pages); the other half scan the remaining pages
+ *   2 loop - repeated sequential scans of 5/4 of the pool
+ */
+static void bench_PolicyTrace(
+    Four        workload,       /* IN workload */
+    Four        *trace)         /* OUT reference string */
+{
+    UFour       r = 2463534242U;        /* random state */
+    double      cdf[BENCH_POLICY_NPAGES];
+    double      sum;
+    double      u;
+    Four        lo, hi, mid;
+    Four        i;
+    Four        scan;           /* next page of the scan */
+    Four        nHot;           /* # of hot pages */
+
+
+    switch (workload) {
+      case 0:
+        for (sum = 0, i = 0; i < BENCH_POLICY_NPAGES; i++) cdf[i] = (sum += 1.0 / (i + 1));
+        for (i = 0; i < BENCH_POLICY_NREFS; i++) {
+            u = (double)bench_Random(&r) / 4294967296.0 * sum;
+            for (lo = 0, hi = BENCH_POLICY_NPAGES - 1; lo < hi; ) {
+                mid = (lo + hi) / 2;
+                if (cdf[mid] < u) lo = mid + 1; else hi = mid;
+            }
+            trace[i] = lo;
+        }
+        break;
+
+      case 1:
+        nHot = BENCH_POLICY_NBUFS / 2;
+        for (scan = nHot, i = 0; i < BENCH_POLICY_NREFS; i++) {
+            if (bench_Random(&r) & 1)
+                trace[i] = bench_Random(&r) % nHot;
+            else {
+                trace[i] = scan;
+                if (++scan == BENCH_POLICY_NPAGES) scan = nHot;
+            }
+        }
+        break;
+
+      case 2:
+        for (i = 0; i < BENCH_POLICY_NREFS; i++)
+            trace[i] = i % (BENCH_POLICY_NBUFS * 5 / 4);
+        break;
+    }
+}
+
+
+/*@================================
+ * bench_PolicyRun()
+ *================================*/
+/*
+ * Function: Four bench_PolicyRun(Four, PageID *, Four *, Four *)
+ *
+ * Description:
+ *  Replay a reference string on the page buffer pool under the given
+ *  policy, starting from an empty pool, and count the hits.
+ */
+static Four bench_PolicyRun(
+    Four        policy,         /* IN replacement policy */
+    PageID      *pids,          /* IN allocated pages */
+    Four        *trace,         /* IN reference string */
+    Four        *nHits)         /* OUT # of hits */
+{
+    Four        e;
+    Four        i;
+    char        *buf;
+
+
+    e = EduBfM_SetReplacementPolicy(PAGE_BUF, policy);
+    if (e < eNOERROR) ERR(e);
+
+    *nHits = 0;
+    for (i = 0; i < BENCH_POLICY_NREFS; i++) {
+        if (edubfm_LookUp(&pids[trace[i]], PAGE_BUF) != NOTFOUND_IN_HTABLE) (*nHits)++;
+
+        e = EduBfM_GetTrain(&pids[trace[i]], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        e = EduBfM_FreeTrain(&pids[trace[i]], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    return(eNOERROR);
+}
+
+
+/*@================================
+ * bench_Policy()
+ *================================*/
+/*
+ * Function: Four bench_Policy(void)
+ *
+ * Description:
+ *  Compare the hit ratios of the replacement policies. The buffer table,
+ *  buffers and hash table of the page buffer pool are replaced by larger
+ *  ones while the reference strings are replayed, and restored before the
+ *  volume is dismounted.
+ */
+Four bench_Policy(void)
+{
+    Four        e;
+    Four        handle;
+    char        *devNames[1] = { "bench.vol" };
+    Four        numPages[1] = { BENCH_POLICY_NPAGES * 2 + 500 };
+    Four        volId = 1000;
+    XactID      xactId;
+    Four        firstExtNo;
+    PageID      nearPid;
+    PageID      *pids;
+    Four        *trace;
+    BufferInfo  saved;              /* the page buffer pool of the storage system */
+    Four        workload;
+    Four        policy;
+    Four        nHits;
+    Four        i;
+    static char *workloadNames[] = { "zipf", "scan", "loop" };
+    static char *policyNames[] = { "CLOCK", "LRU-2", "2Q", "ARC", "CLEAN" };
+
+
+    pids = (PageID*)malloc(sizeof(PageID) * BENCH_POLICY_NPAGES);
+    trace = (Four*)malloc(sizeof(Four) * BENCH_POLICY_NREFS);
+    if (pids == NULL || trace == NULL) ERR(eMEMORYALLOCERR);
+
+    e = LRDS_Init();
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_AllocHandle(&handle);
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_FormatDataVolume(1, devNames, "bench", volId, 16, numPages, 16);
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_Mount(1, devNames, &volId);
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_BeginTransaction(&xactId, X_RR_RR);
+    if (e < eNOERROR) ERR(e);
+
+    e = RDsM_CreateSegment(volId, &firstExtNo);
+    if (e < eNOERROR) ERR(e);
+    e = RDsM_ExtNoToPageId(volId, firstExtNo, &nearPid);
+    if (e < eNOERROR) ERR(e);
+    for (i = 0; i < BENCH_POLICY_NPAGES; i++) {
+        e = RDsM_AllocTrains(volId, firstExtNo, &nearPid, 100, 1, PAGESIZE2, &pids[i]);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    /* enlarge the page buffer pool */
+    e = EduBfM_FlushAll();
+    if (e < eNOERROR) ERR(e);
+    e = EduBfM_DiscardAll();
+    if (e < eNOERROR) ERR(e);
+
+    saved = bufInfo[PAGE_BUF];
+    BI_NBUFS(PAGE_BUF) = BENCH_POLICY_NBUFS;
+    bufInfo[PAGE_BUF].bufTable = (BufferTable*)calloc(BENCH_POLICY_NBUFS, sizeof(BufferTable));
+    bufInfo[PAGE_BUF].bufferPool = (char*)malloc(PAGESIZE * BENCH_POLICY_NBUFS);
+    bufInfo[PAGE_BUF].hashTable = (Two*)malloc(sizeof(Two) * HASHTABLESIZE(PAGE_BUF));
+    if (bufInfo[PAGE_BUF].bufTable == NULL || bufInfo[PAGE_BUF].bufferPool == NULL ||
+        BI_HASHTABLE(PAGE_BUF) == NULL) ERR(eMEMORYALLOCERR);
+    for (i = 0; i < BENCH_POLICY_NBUFS; i++) SET_NILBFMHASHKEY(BI_KEY(PAGE_BUF, i));
+
+    e = EduBfM_SetNumPartitions(PAGE_BUF, 0);
+    if (e < eNOERROR) ERR(e);
+
+    printf("%d buffers, %d pages, %d references\n", BENCH_POLICY_NBUFS, BENCH_POLICY_NPAGES,
+           BENCH_POLICY_NREFS);
+    printf("workload");
+    for (policy = 0; policy < BFM_NUM_POLICIES; policy++) printf("  %7s", policyNames[policy]);
+    printf("\n");
+
+    for (workload = 0; workload < 3; workload++) {
+        bench_PolicyTrace(workload, trace);
+
+        printf("%-8s", workloadNames[workload]);
+        for (policy = 0; policy < BFM_NUM_POLICIES; policy++) {
+            e = bench_PolicyRun(policy, pids, trace, &nHits);
+            if (e < eNOERROR) ERR(e);
+            printf("  %6.2f%%", 100.0 * nHits / BENCH_POLICY_NREFS);
+        }
+        printf("\n");
+    }
+
+    /* restore the page buffer pool */
+    e = EduBfM_SetReplacementPolicy(PAGE_BUF, BFM_POLICY_CLOCK);
+    if (e < eNOERROR) ERR(e);
+    free(bufInfo[PAGE_BUF].bufTable);
+    free(bufInfo[PAGE_BUF].bufferPool);
+    free(bufInfo[PAGE_BUF].hashTable);
+    bufInfo[PAGE_BUF] = saved;
+    e = EduBfM_SetNumPartitions(PAGE_BUF, 0);
+    if (e < eNOERROR) ERR(e);
+
+    e = LRDS_CommitTransaction(&xactId);
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_Dismount(volId);
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_FreeHandle(handle);
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_Final();
+    if (e < eNOERROR) ERR(e);
+
+    remove(devNames[0]);
+    free(pids);
+    free(trace);
+
+    return(eNOERROR);
+}
+
+
+/*@================================
+ * bench_AllocRun()
+ *================================*/
+/*
+ * Function: Four bench_AllocRun(Four, Four, double *)
+ *
+ * Description:
+ *  Allocate the page buffer pool with the given flags and partitions, fill
+ *  the buffers with trains without reading them, and measure the latency
+ *  of EduBfM_GetTrain() hits. The resident trains form a random cycle:
+ *  each train holds the page number of the next one at an offset depending
+ *  on the train, so that each hit waits for the previous one and touches a
+ *  line of a different page.
+ */
+static Four bench_AllocRun(
+    Four        flags,          /* IN BFM_ALLOC_xxx */
+    Four        nPartitions,    /* IN # of partitions */
+    double      *nsPerHit)      /* OUT latency of a hit */
+{
+    Four        e;
+    Four        i, j, t;
+    Four        index;
+    Four        nTrains;        /* # of resident trains */
+    Four        *trains;        /* page numbers of the resident trains, then the cycle */
+    UFour       r = 2463534242U;        /* random state */
+    PageID      pid;
+    char        *buf;
+    struct timespec t0, t1;
+
+
+    e = EduBfM_SetNumPartitions(PAGE_BUF, nPartitions);
+    if (e < eNOERROR) ERR(e);
+    e = EduBfM_SetPoolAllocation(PAGE_BUF, flags);
+    if (e < eNOERROR) ERR(e);
+
+    /* put a train in every buffer as edubfm_ReadTrain() would */
+    pid.volNo = 1;
+    for (i = 0; i < BENCH_ALLOC_NBUFS; i++) {
+        pid.pageNo = i;
+        index = edubfm_AllocTrain(PAGE_BUF, BI_PARTITIONOFKEY(PAGE_BUF, &pid), FALSE);
+        if (index < eNOERROR) ERR(index);
+        BI_KEY(PAGE_BUF, index).volNo = pid.volNo;
+        BI_KEY(PAGE_BUF, index).pageNo = pid.pageNo;
+        e = edubfm_Insert(&BI_KEY(PAGE_BUF, index), index, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        memset(BI_BUFFER(PAGE_BUF, index), 0, PAGESIZE);
+    }
+
+    /* a partition which got more trains than buffers has evicted some of them */
+    trains = (Four*)malloc(sizeof(Four) * BENCH_ALLOC_NBUFS);
+    if (trains == NULL) ERR(eMEMORYALLOCERR);
+    for (nTrains = 0, i = 0; i < BENCH_ALLOC_NBUFS; i++) {
+        pid.pageNo = i;
+        if (edubfm_LookUp(&pid, PAGE_BUF) != NOTFOUND_IN_HTABLE) trains[nTrains++] = i;
+    }
+
+    /* Sattolo's algorithm gives a single cycle */
+    for (i = nTrains - 1; i > 0; i--) {
+        j = bench_Random(&r) % i;
+        t = trains[i]; trains[i] = trains[j]; trains[j] = t;
+    }
+    for (i = 0; i < nTrains; i++) {
+        pid.pageNo = trains[i];
+        buf = BI_BUFFER(PAGE_BUF, edubfm_LookUp(&pid, PAGE_BUF));
+        ((Four*)buf)[(pid.pageNo * 67) % (PAGESIZE / sizeof(Four))] = trains[(i + 1) % nTrains];
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (pid.pageNo = trains[0], i = 0; i < BENCH_ALLOC_NHITS; i++) {
+        e = EduBfM_GetTrain(&pid, &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        e = EduBfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        pid.pageNo = ((Four*)buf)[(pid.pageNo * 67) % (PAGESIZE / sizeof(Four))];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    free(trains);
+
+    *nsPerHit = BENCH_NSEC(t0, t1) / BENCH_ALLOC_NHITS;
+
+    return(eNOERROR);
+}
+
+
+/*@================================
+ * bench_Alloc()
+ *================================*/
+/*
+ * Function: Four bench_Alloc(void)
+ *
+ * Description:
+ *  Compare the latency of EduBfM_GetTrain() hits on the page buffer pool
+ *  allocated by malloc() as by the storage system, and allocated by
+ *  EduBfM_SetPoolAllocation(). The buffer pool is replaced by a larger one
+ *  whose buffers are filled without reading a volume; the trains are
+ *  never dirty, so nothing is written.
+ */
+Four bench_Alloc(void)
+{
+    Four        e;
+    Four        i;
+    double      ns;
+    BufferInfo  saved;              /* the page buffer pool of the storage system */
+    static Four flags[] = { 0, BFM_ALLOC_HUGEPAGE, BFM_ALLOC_HUGEPAGE | BFM_ALLOC_INTERLEAVE,
+                            BFM_ALLOC_HUGEPAGE | BFM_ALLOC_BINDPARTITION };
+    static Four nPartitions[] = { 0, 0, 0, 4 };
+    static char *names[] = { "malloc", "hugepage", "hugepage+interleave", "hugepage+bind/4 partitions" };
+    static char *kinds[] = { "base pages", "base pages", "transparent huge pages",
+                             "2 MB huge pages", "1 GB huge pages" };
+
+
+    saved = bufInfo[PAGE_BUF];
+    BI_NBUFS(PAGE_BUF) = BENCH_ALLOC_NBUFS;
+    bufInfo[PAGE_BUF].bufSize = 1;
+    bufInfo[PAGE_BUF].bufTable = (BufferTable*)calloc(BENCH_ALLOC_NBUFS, sizeof(BufferTable));
+    bufInfo[PAGE_BUF].bufferPool = (char*)malloc(PAGESIZE * BENCH_ALLOC_NBUFS);
+    bufInfo[PAGE_BUF].hashTable = (Two*)malloc(sizeof(Two) * HASHTABLESIZE(PAGE_BUF));
+    if (bufInfo[PAGE_BUF].bufTable == NULL || bufInfo[PAGE_BUF].bufferPool == NULL ||
+        BI_HASHTABLE(PAGE_BUF) == NULL) ERR(eMEMORYALLOCERR);
+    for (i = 0; i < BENCH_ALLOC_NBUFS; i++) SET_NILBFMHASHKEY(BI_KEY(PAGE_BUF, i));
+
+    printf("%d buffers (%d MB), %d hits\n", BENCH_ALLOC_NBUFS,
+           (Four)((long)BENCH_ALLOC_NBUFS * PAGESIZE >> 20), BENCH_ALLOC_NHITS);
+    printf("%-28s %-24s %10s\n", "allocation", "backed by", "ns/hit");
+
+    for (i = 0; i < (Four)(sizeof(flags) / sizeof(flags[0])); i++) {
+        e = bench_AllocRun(flags[i], nPartitions[i], &ns);
+        if (e < eNOERROR) ERR(e);
+        printf("%-28s %-24s %10.1f\n", names[i], kinds[bufArena[PAGE_BUF].kind], ns);
+    }
+
+    /* restore the page buffer pool */
+    e = EduBfM_SetPoolAllocation(PAGE_BUF, 0);
+    if (e < eNOERROR) ERR(e);
+    free(bufInfo[PAGE_BUF].bufTable);
+    free(bufInfo[PAGE_BUF].bufferPool);
+    free(bufInfo[PAGE_BUF].hashTable);
+    bufInfo[PAGE_BUF] = saved;
+    e = EduBfM_SetNumPartitions(PAGE_BUF, 0);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+}
+
+
+/*@================================
+ * bench_LayoutRun()
+ *================================*/
+/*
+ * Function: Four bench_LayoutRun(Four, Four, double *, double *)
+ *
+ * Description:
+ *  Lay out the buffer table as given, put a train in every buffer and fix
+ *  `pctFixed' percent of the buffers at random. Then measure the latency of
+ *  edubfm_AllocTrain() when each train allocated is referenced at once, so
+ *  that the clock finds the reference bits of most unfixed buffers set.
+ */
+static Four bench_LayoutRun(
+    Four        layout,         /* IN BFM_LAYOUT_xxx */
+    Four        pctFixed,       /* IN percentage of the fixed buffers */
+    double      *nsPerAlloc,    /* OUT latency of an allocation */
+    double      *scanned)       /* OUT # of buffers examined per allocation */
+{
+    Four        e;
+    Four        i;
+    Four        index;
+    UFour       r = 2463534242U;        /* random state */
+    PageID      pid;
+    BfMStats    stats;
+    struct timespec t0, t1;
+
+
+    e = EduBfM_SetTableLayout(PAGE_BUF, layout);
+    if (e < eNOERROR) ERR(e);
+
+    /* put a train in every buffer as edubfm_ReadTrain() would */
+    pid.volNo = 1;
+    for (pid.pageNo = 0; pid.pageNo < BENCH_ALLOC_NBUFS; pid.pageNo++) {
+        index = edubfm_AllocTrain(PAGE_BUF, 0, FALSE);
+        if (index < eNOERROR) ERR(index);
+        BI_KEY(PAGE_BUF, index).volNo = pid.volNo;
+        BI_KEY(PAGE_BUF, index).pageNo = pid.pageNo;
+        e = edubfm_Insert(&BI_KEY(PAGE_BUF, index), index, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+    for (i = 0; i < BENCH_ALLOC_NBUFS; i++) {
+        BI_FIXED(PAGE_BUF, i) = ((Four)(bench_Random(&r) % 100) < pctFixed) ? 1 : 0;
+        BI_BITS(PAGE_BUF, i) = REFER;
+    }
+
+    e = EduBfM_ResetStats();
+    if (e < eNOERROR) ERR(e);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < BENCH_LAYOUT_NALLOCS; i++) {
+        /* the train evicted is read again, which keeps the page numbers
+           within the range of the hash function */
+        index = edubfm_AllocTrain(PAGE_BUF, 0, FALSE);
+        if (index < eNOERROR) ERR(index);
+        e = edubfm_Insert(&BI_KEY(PAGE_BUF, index), index, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        BI_BITS(PAGE_BUF, index) = REFER;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    e = EduBfM_GetStats(PAGE_BUF, &stats);
+    if (e < eNOERROR) ERR(e);
+
+    /* unfix the buffers so that the pool can be emptied */
+    for (i = 0; i < BENCH_ALLOC_NBUFS; i++) BI_FIXED(PAGE_BUF, i) = 0;
+
+    *nsPerAlloc = BENCH_NSEC(t0, t1) / BENCH_LAYOUT_NALLOCS;
+    *scanned = (double)stats.nScanned / BENCH_LAYOUT_NALLOCS;
+
+    return(eNOERROR);
+}
+
+
+/*@================================
+ * bench_Layout()
+ *================================*/
+/*
+ * Function: Four bench_Layout(void)
+ *
+ * Description:
+ *  Compare the latency of the clock of edubfm_AllocTrain() when the fixed
+ *  counts and bits are fields of the BufferTable entries with the latency
+ *  when they are kept in dense arrays and examined edubfm_sweepWidth
+ *  buffers at a time. The buffer pool is replaced by a larger one and no train is
+ *  read or written.
+ */
+Four bench_Layout(void)
+{
+    Four        e;
+    Four        i, j;
+    double      ns[2];
+    double      scanned;
+    BufferInfo  saved;              /* the page buffer pool of the storage system */
+    static Four pctFixed[] = { 0, 50, 90, 99 };
+
+
+    saved = bufInfo[PAGE_BUF];
+    BI_NBUFS(PAGE_BUF) = BENCH_ALLOC_NBUFS;
+    bufInfo[PAGE_BUF].bufSize = 1;
+    bufInfo[PAGE_BUF].bufTable = (BufferTable*)calloc(BENCH_ALLOC_NBUFS, sizeof(BufferTable));
+    bufInfo[PAGE_BUF].bufferPool = NULL;    /* no train is read or written */
+    bufInfo[PAGE_BUF].hashTable = (Two*)malloc(sizeof(Two) * HASHTABLESIZE(PAGE_BUF));
+    if (bufInfo[PAGE_BUF].bufTable == NULL || BI_HASHTABLE(PAGE_BUF) == NULL) ERR(eMEMORYALLOCERR);
+    for (i = 0; i < BENCH_ALLOC_NBUFS; i++) SET_NILBFMHASHKEY(BI_KEY(PAGE_BUF, i));
+    e = EduBfM_SetNumPartitions(PAGE_BUF, 0);
+    if (e < eNOERROR) ERR(e);
+
+    printf("%d buffers, %d allocations, %d buffers per step\n",
+           BENCH_ALLOC_NBUFS, BENCH_LAYOUT_NALLOCS, edubfm_sweepWidth);
+    printf("%-8s %16s %16s %10s %16s\n", "fixed", "array of structs", "struct of arrays", "speedup", "scanned/alloc");
+
+    for (i = 0; i < (Four)(sizeof(pctFixed) / sizeof(pctFixed[0])); i++) {
+        for (j = BFM_LAYOUT_AOS; j <= BFM_LAYOUT_SOA; j++) {
+            e = bench_LayoutRun(j, pctFixed[i], &ns[j], &scanned);
+            if (e < eNOERROR) ERR(e);
+        }
+        printf("%6ld%% %13.1f ns %13.1f ns %9.2fx %16.1f\n",
+               (long)pctFixed[i], ns[BFM_LAYOUT_AOS], ns[BFM_LAYOUT_SOA], ns[BFM_LAYOUT_AOS] / ns[BFM_LAYOUT_SOA], scanned);
+    }
+
+    /* restore the page buffer pool */
+    e = EduBfM_SetTableLayout(PAGE_BUF, BFM_LAYOUT_AOS);
+    if (e < eNOERROR) ERR(e);
+    free(bufInfo[PAGE_BUF].bufTable);
+    free(bufInfo[PAGE_BUF].hashTable);
+    bufInfo[PAGE_BUF] = saved;
+    e = EduBfM_SetNumPartitions(PAGE_BUF, 0);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+}
+
+
+/*@================================
+ * bench_MapRun()
+ *================================*/
+/*
+ * Function: Four bench_MapRun(PageID *, Boolean, double *)
+ *
+ * Description:
+ *  Fix BENCH_MMAP_NREFS trains of `pids', reading a word of each, and
+ *  unfix them. The trains are taken in order, over and over, for a scan,
+ *  or at random for lookups.
+ */
+static Four bench_MapRun(
+    PageID      *pids,          /* IN pages of the volume */
+    Boolean     random,         /* IN TRUE for random lookups, FALSE for scans */
+    double      *nsPerTrain)    /* OUT time per train */
+{
+    Four        e;
+    Four        i, k;
+    UFour       r = 2463534242U;        /* random state */
+    UFour       sum;            /* keeps the reads from being optimized out */
+    char        *buf;
+    struct timespec t0, t1;
+
+
+    sum = 0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < BENCH_MMAP_NREFS; i++) {
+        k = random ? (Four)(bench_Random(&r) % BENCH_MMAP_NPAGES) : i % BENCH_MMAP_NPAGES;
+        e = EduBfM_GetTrain(&pids[k], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        sum += ((UFour*)buf)[(k * 67) % (PAGESIZE / sizeof(UFour))];
+        e = EduBfM_FreeTrain(&pids[k], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    if (sum == 1) printf(" ");
+
+    *nsPerTrain = BENCH_NSEC(t0, t1) / BENCH_MMAP_NREFS;
+
+    return(eNOERROR);
+}
+
+
+/*@================================
+ * bench_Map()
+ *================================*/
+/*
+ * Function: Four bench_Map(void)
+ *
+ * Description:
+ *  Compare scans and random lookups of the trains of a volume through the
+ *  page buffer pool, holding all the trains or 1/8 of them, with the same
+ *  accesses when the volume is mapped by EduBfM_MapVolume(). The trains
+ *  missing from the small pool are read from the page cache of the OS, as
+ *  the mapping is.
+ */
+Four bench_Map(void)
+{
+    Four        e;
+    Four        handle;
+    char        *devNames[1] = { "bench.vol" };
+    Four        numPages[1] = { BENCH_MMAP_NPAGES * 2 + 500 };
+    Four        volId = 1000;
+    XactID      xactId;
+    Four        firstExtNo;
+    PageID      nearPid;
+    PageID      *pids;
+    Four        nBufs;              /* # of buffers of the page buffer pool of the storage system */
+    Four        i;
+    Four        run;
+    double      ns[2];
+    static char *runNames[] = { "pool holding all trains", "pool holding 1/8 of them", "mapped volume" };
+
+
+    pids = (PageID*)malloc(sizeof(PageID) * BENCH_MMAP_NPAGES);
+    if (pids == NULL) ERR(eMEMORYALLOCERR);
+
+    e = LRDS_Init();
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_AllocHandle(&handle);
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_FormatDataVolume(1, devNames, "bench", volId, 16, numPages, 16);
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_Mount(1, devNames, &volId);
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_BeginTransaction(&xactId, X_RR_RR);
+    if (e < eNOERROR) ERR(e);
+
+    e = RDsM_CreateSegment(volId, &firstExtNo);
+    if (e < eNOERROR) ERR(e);
+    e = RDsM_ExtNoToPageId(volId, firstExtNo, &nearPid);
+    if (e < eNOERROR) ERR(e);
+    for (i = 0; i < BENCH_MMAP_NPAGES; i++) {
+        e = RDsM_AllocTrains(volId, firstExtNo, &nearPid, 100, 1, PAGESIZE2, &pids[i]);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    nBufs = BI_NBUFS(PAGE_BUF);
+
+    printf("%d trains, %d trains fixed per run\n", BENCH_MMAP_NPAGES, BENCH_MMAP_NREFS);
+    printf("%-26s %12s %12s\n", "", "scan", "lookup");
+
+    for (run = 0; run < 3; run++) {
+        if (run < 2) {
+            e = EduBfM_Resize(PAGE_BUF, (run == 0) ? BENCH_MMAP_NPAGES : BENCH_MMAP_NPAGES / 8);
+            if (e < eNOERROR) ERR(e);
+        }
+        else {
+            e = EduBfM_MapVolume(volId, 1, devNames);
+            if (e < eNOERROR) ERR(e);
+        }
+
+        e = bench_MapRun(pids, FALSE, &ns[0]);
+        if (e < eNOERROR) ERR(e);
+        e = bench_MapRun(pids, TRUE, &ns[1]);
+        if (e < eNOERROR) ERR(e);
+
+        printf("%-26s %9.1f ns %9.1f ns\n", runNames[run], ns[0], ns[1]);
+    }
+
+    /* restore the page buffer pool */
+    e = EduBfM_UnmapVolume(volId);
+    if (e < eNOERROR) ERR(e);
+    e = EduBfM_Resize(PAGE_BUF, nBufs);
+    if (e < eNOERROR) ERR(e);
+
+    e = LRDS_CommitTransaction(&xactId);
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_Dismount(volId);
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_FreeHandle(handle);
+    if (e < eNOERROR) ERR(e);
+    e = LRDS_Final();
+    if (e < eNOERROR) ERR(e);
+
+    remove(devNames[0]);
+    free(pids);
+
+    return(eNOERROR);
+}
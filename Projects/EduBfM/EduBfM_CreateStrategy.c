@@ -0,0 +1,137 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_CreateStrategy.c
+ *
+ * Description :
+ *  Create an access strategy for EduBfM_GetTrainStrategy().
+ *
+ * Exports:
+ *  Four EduBfM_CreateStrategy(Four, Four, BfMStrategy **)
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_CreateStrategy()
+ *================================*/
+/*
+ * Function: Four EduBfM_CreateStrategy(Four, Four, BfMStrategy **)
+ *
+ * Description :
+ *  Create an access strategy of the given kind for the buffer pool of the
+ *  given type. A scan over a large file fixes each of its trains once, and
+ *  would push the hot trains out of the pool; with BFM_STRATEGY_SEQSCAN it
+ *  recycles a small ring of buffers instead, and with
+ *  BFM_STRATEGY_BULKWRITE a larger ring whose dirty buffers are written
+ *  back when they are recycled. The ring holds at most a quarter of the
+ *  pool, or of the partition if the pool is partitioned; each partition
+ *  has a ring of its own. BFM_STRATEGY_NORMAL has no ring and behaves as EduBfM_GetTrain().
+ *  The strategy is freed by EduBfM_DestroyStrategy().
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER - bad kind of strategy or `strategy' is NULL
+ *    eMEMORYALLOCERR - memory allocation failed
+ *
+ * Side effects:
+ *  1) parameter strategy
+ *     the strategy created
+ */
+Four EduBfM_CreateStrategy(
+    Four                kind,                   /* IN BFM_STRATEGY_xxx */
+    Four                type,                   /* IN buffer type */
+    BfMStrategy         **strategy)             /* OUT strategy created */
+{
+    BfMStrategy         *s;                     /* strategy created */
+    Four                i;                      /* index */
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (kind < 0 || kind >= BFM_NUM_STRATEGIES || strategy == NULL) ERR(eBADPARAMETER);
+
+    s = (BfMStrategy*)malloc(sizeof(BfMStrategy));
+    if (s == NULL) ERR(eMEMORYALLOCERR);
+
+    s->kind = kind;
+    s->type = type;
+    s->current = NULL;
+    s->bufs = NULL;
+
+    if (kind == BFM_STRATEGY_NORMAL)
+        s->size = 0;
+    else {
+        s->size = (kind == BFM_STRATEGY_SEQSCAN) ? BFM_RING_SEQSCAN : BFM_RING_BULKWRITE;
+        if (s->size > BI_NBUFS(type) / 4) s->size = BI_NBUFS(type) / 4;
+        if (s->size < 1) s->size = 1;
+
+        s->current = (Four*)malloc(sizeof(Four) * MAXNUMOFPARTITIONS);
+        s->bufs = (Four*)malloc(sizeof(Four) * s->size * MAXNUMOFPARTITIONS);
+        if (s->current == NULL || s->bufs == NULL) {
+            if (s->current != NULL) free(s->current);
+            if (s->bufs != NULL) free(s->bufs);
+            free(s);
+            ERR(eMEMORYALLOCERR);
+        }
+        for (i = 0; i < MAXNUMOFPARTITIONS; i++) s->current[i] = 0;
+        for (i = 0; i < s->size * MAXNUMOFPARTITIONS; i++) s->bufs[i] = NIL;
+    }
+
+    *strategy = s;
+
+    return(eNOERROR);
+
+}  /* EduBfM_CreateStrategy() */
@@ -73,6 +73,8 @@
  *  For ODYSSEUS/EduCOSMOS EduBfM, refer to the EduBfM project manual.)
  *
  *  Discard all buffers.
+ *  A train being read or written back without the latch of its partition
+ *  is waited for on BI_PARTIODONE() first.
  *
  * Returns:
  *  error code
@@ -83,21 +85,66 @@ Four EduBfM_DiscardAll(void)
     Four 	e;			/* error */
     Two 	i;			/* index */
     Four 	type;			/* buffer type */
+    Four 	p;			/* partition number */
+    Four 	busy;			/* buffer being read or written back */
+    Four 	busyType;		/* buffer type of `busy' */
+    Four 	busyPart;		/* partition of `busy' */
 
 	/* NEWCODE */
-	type = PAGE_BUF;
-	for(i=0;i<BI_NBUFS(type);i++){
-		//discard all buffer elements.
-		bufInfo[type].bufTable[i].key.pageNo = -1;
-		bufInfo[type].bufTable[i].bits = ALL_0;
-	}
-	type = LOT_LEAF_BUF;
-	for(i=0;i<BI_NBUFS(type);i++){
-		bufInfo[type].bufTable[i].key.pageNo = -1;
-		bufInfo[type].bufTable[i].bits = ALL_0;
+	/* Latch every partition in a fixed order while the hash tables are reset,
+	 * once no train is being read or written back without the latch. */
+	do{
+		for(type = 0; type < NUM_BUF_TYPES; type++)
+			for(p = 0; p < BI_NPARTITIONS(type); p++)
+				BFM_GETLATCH(BI_PARTLATCH(type, p));
+
+		busy = NIL;
+		for(type = 0; type < NUM_BUF_TYPES && busy == NIL; type++)
+			for(i = 0; i < BI_NBUFS(type); i++)
+				if(BI_BITS(type, i) & (READING | CLEANING)){
+					busy = i;
+					busyType = type;
+					break;
+				}
+
+		if(busy != NIL){
+			//wait on its partition alone, since the transfer may latch the others before it completes.
+			busyPart = BI_PARTITIONOFBUF(busyType, busy);
+			for(type = NUM_BUF_TYPES - 1; type >= 0; type--)
+				for(p = BI_NPARTITIONS(type) - 1; p >= 0; p--)
+					if(type != busyType || p != busyPart)
+						BFM_RELEASELATCH(BI_PARTLATCH(type, p));
+
+			while(BI_BITS(busyType, busy) & (READING | CLEANING))
+				pthread_cond_wait(BI_PARTIODONE(busyType, busyPart), BI_PARTLATCH(busyType, busyPart));
+			BFM_RELEASELATCH(BI_PARTLATCH(busyType, busyPart));
+		}
+	}while(busy != NIL);
+
+	for(type = 0; type < NUM_BUF_TYPES; type++){
+		for(i=0;i<BI_NBUFS(type);i++){
+			//discard all buffer elements.
+			SET_NILBFMHASHKEY(BI_KEY(type, i));
+			BI_BITS(type, i) = ALL_0;
+		}
+		edubfm_ClearDirtyMap(type);
+		edubfm_InvalidateFreeList(type);	//every buffer is free now.
+		edubfm_VictimClear(type);	//the copies of the victim cache are discarded as well.
+		edubfm_SecondaryClear(type);	//so are the copies on the local disk.
 	}
 	
-	edubfm_DeleteAll();
+	e = edubfm_DeleteAll();
+
+	//the replacement policies forget the discarded trains.
+	for(type = 0; type < NUM_BUF_TYPES && e >= eNOERROR; type++)
+		for(p = 0; p < BI_NPARTITIONS(type) && e >= eNOERROR; p++)
+			e = edubfm_PolicyReset(type, p);
+
+	for(type = NUM_BUF_TYPES - 1; type >= 0; type--)
+		for(p = BI_NPARTITIONS(type) - 1; p >= 0; p--)
+			BFM_RELEASELATCH(BI_PARTLATCH(type, p));
+
+	if(e < eNOERROR) ERR(e);
 	/* ENDOFNEWCODE */
 
     return(eNOERROR);
@@ -0,0 +1,184 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_DumpStats.c
+ *
+ * Description :
+ *  Print the statistics of the buffer pools.
+ *
+ * Exports:
+ *  Four EduBfM_DumpStats(FILE *)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * internal function prototypes
+ */
+static void edubfm_DumpHistogram(FILE *, char *, UEight *);
+
+
+
+/*@================================
+ * EduBfM_DumpStats()
+ *================================*/
+/*
+ * Function: Four EduBfM_DumpStats(FILE *)
+ *
+ * Description :
+ *  Print a snapshot of the statistics of every buffer pool to `fp' as text.
+ *  Each histogram line shows the range of a non-empty bucket in
+ *  nanoseconds, its count, and the cumulative percentage.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - `fp' is NULL
+ */
+Four EduBfM_DumpStats(
+    FILE                *fp)                    /* IN output stream */
+{
+    Four                type;                   /* buffer type */
+    BfMStats            s;                      /* snapshot of the statistics */
+    UEight              nGets;                  /* # of EduBfM_GetTrain() */
+    static char         *typeNames[NUM_BUF_TYPES] = { "PAGE_BUF", "LOT_LEAF_BUF" };
+    static char         *arenaNames[] = { "storage system", "base pages", "transparent huge pages",
+                                          "2 MB huge pages", "1 GB huge pages" };
+
+
+    if (fp == NULL) ERR(eBADPARAMETER);
+
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        s = bufStats[type];
+        nGets = s.nHits + s.nMisses;
+
+        fprintf(fp, "%s (%d buffers of %d pages)\n", typeNames[type], BI_NBUFS(type), BI_BUFSIZE(type));
+        if (bufArena[type].kind != BFM_ARENA_DEFAULT)
+            fprintf(fp, "  buffers on %s\n", arenaNames[bufArena[type].kind]);
+        fprintf(fp, "  gets %lu hits %lu misses %lu hit ratio %.2f%%\n",
+                nGets, s.nHits, s.nMisses, (nGets == 0) ? 0.0 : 100.0 * s.nHits / nGets);
+        fprintf(fp, "  allocs %lu free %lu scanned %lu (%.2f per alloc) no unfixed buffer %lu\n",
+                s.nAllocs, s.nFreeAllocs, s.nScanned, (s.nAllocs == 0) ? 0.0 : (double)s.nScanned / s.nAllocs,
+                s.nNoUnfixedBuf);
+        fprintf(fp, "  evictions %lu dirty %lu flushes %lu cleaner writes %lu reads %lu writes %lu\n",
+                s.nEvictions, s.nDirtyEvictions, s.nFlushes, s.nCleanerWrites, s.nReads, s.nWrites);
+        fprintf(fp, "  writes saved by coalescing %lu ring reuses %lu\n", s.nWritesSaved, s.nRingReuses);
+        fprintf(fp, "  prefetches %lu used %lu wasted %lu read-ahead %d\n",
+                s.nPrefetches, s.nPrefetchHits, s.nPrefetchWasted, bufReadAhead[type].curK);
+        if (s.nWarmedUp > 0)
+            fprintf(fp, "  warmed up %lu\n", s.nWarmedUp);
+        if (s.nInvalidations > 0 || s.nWritesDropped > 0)
+            fprintf(fp, "  invalidated %lu dirty %lu\n", s.nInvalidations, s.nWritesDropped);
+        if (s.nWritesAvoided > 0)
+            fprintf(fp, "  writes avoided by clean victims %lu\n", s.nWritesAvoided);
+        if (s.nVictimPuts > 0 || s.nVictimLookups > 0)
+            fprintf(fp, "  victim cache hits %lu of %lu (%.2f%%) puts %lu compression %.2f:1\n",
+                    s.nVictimHits, s.nVictimLookups, (s.nVictimLookups == 0) ? 0.0 : 100.0 * s.nVictimHits / s.nVictimLookups,
+                    s.nVictimPuts, (s.victimBytesOut == 0) ? 0.0 : (double)s.victimBytesIn / s.victimBytesOut);
+        if (s.nSecondaryPuts > 0 || s.nSecondaryLookups > 0)
+            fprintf(fp, "  secondary cache hits %lu of %lu (%.2f%%) puts %lu bytes saved %lu\n",
+                    s.nSecondaryHits, s.nSecondaryLookups, (s.nSecondaryLookups == 0) ? 0.0 : 100.0 * s.nSecondaryHits / s.nSecondaryLookups,
+                    s.nSecondaryPuts, s.secondaryBytesSaved);
+        if (s.nMappedGets > 0)
+            fprintf(fp, "  trains used in place from mapped volumes %lu\n", s.nMappedGets);
+        if (s.nDirectIOs > 0)
+            fprintf(fp, "  direct I/Os %lu, %lu through the bounce buffer\n", s.nDirectIOs, s.nDirectBounces);
+        if (s.nUringIOs > 0)
+            fprintf(fp, "  asynchronous requests through io_uring %lu\n", s.nUringIOs);
+        if (bufAdapt.budget > 0)
+            fprintf(fp, "  ghost hits %lu grown %lu times, %d of %d pages shared\n",
+                    s.nGhostHits, s.nSplitMoves, BI_NBUFS(type) * BI_BUFSIZE(type), bufAdapt.budget);
+        edubfm_DumpHistogram(fp, "hit", s.hitLatency);
+        edubfm_DumpHistogram(fp, "miss", s.missLatency);
+    }
+
+    return(eNOERROR);
+
+}  /* EduBfM_DumpStats() */
+
+
+
+/*@================================
+ * edubfm_DumpHistogram()
+ *================================*/
+/*
+ * Function: static void edubfm_DumpHistogram(FILE *, char *, UEight *)
+ *
+ * Description :
+ *  Print the non-empty buckets of a latency histogram.
+ *
+ * Returns:
+ *  None
+ */
+static void edubfm_DumpHistogram(
+    FILE                *fp,                    /* IN output stream */
+    char                *name,                  /* IN name of the histogram */
+    UEight              *hist)                  /* IN buckets of the histogram */
+{
+    Four                i;                      /* bucket */
+    UEight              total;                  /* # of latencies recorded */
+    UEight              sum;                    /* # of latencies up to the bucket */
+
+
+    for (total = 0, i = 0; i < BFM_STATS_NHISTBUCKETS; i++) total += hist[i];
+
+    fprintf(fp, "  %s latency (ns):%s\n", name, (total == 0) ? " none" : "");
+    if (total == 0) return;
+
+    for (sum = 0, i = 0; i < BFM_STATS_NHISTBUCKETS; i++) {
+        if (hist[i] == 0) continue;
+        sum += hist[i];
+        fprintf(fp, "    [%10lu, %10lu) %10lu %6.2f%%\n",
+                (i == 0) ? 0UL : 1UL << i, 1UL << (i + 1), hist[i], 100.0 * sum / total);
+    }
+
+} /* edubfm_DumpHistogram() */
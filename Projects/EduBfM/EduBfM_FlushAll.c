@@ -57,11 +57,23 @@
  */
 
 
+#include <stdlib.h> /* for malloc, free & qsort */
+#include <string.h> /* for memcpy */
 #include "EduBfM_common.h"
 #include "EduBfM_Internal.h"
 
 
 
+/*@
+ * internal function prototypes
+ */
+static Four edubfm_CollectDirty(BfMFlushEntry **, Four *);
+static int edubfm_CompareFlushEntries(const void *, const void *);
+static Four edubfm_SubmitRun(BfMFlushEntry *, Four, BfMIOHandle *);
+static Four edubfm_CompleteRun(BfMFlushEntry *, BfMIOHandle *);
+
+
+
 /*@================================
  * EduBfM_FlushAll()
  *================================*/
@@ -74,36 +86,303 @@
  *
  *  Flush dirty buffers holding trains.
  *  A dirty buffer is one with the dirty bit set.
+ *  The dirty trains are written in the order of (volNo, pageNo), and a run
+ *  of trains contiguous on the disk is written at once; the writes saved
+ *  are counted in the statistics of the pool. If the asynchronous I/O
+ *  engine is running, all writes are queued to the engine before waiting
+ *  for any of them. If a hot set file is set by EduBfM_SetHotSetFile(),
+ *  the trains resident in the pools are then saved to it.
  *
  * Returns:
  *  error code
+ *    eMEMORYALLOCERR - memory allocation failed
+ *    eCREATEFILEFAILED_BFM - the hot set file could not be written
+ *    some errors caused by the writes
  */
 Four EduBfM_FlushAll(void)
 {
 	/* These local variables are used in the solution code. However, you don¡¯t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four        e;                      /* error */
-    Two         i;                      /* index */
-    Four        type;                   /* buffer type */
+    Four        firstError;             /* first error of the writes */
+    Four        i;                      /* index */
+    Four        nEntries;               /* # of dirty buffers */
+    Four        nRuns;                  /* # of runs submitted */
+    Four        nDone;                  /* # of runs completed */
+    Four        *runStart;              /* index of the first entry of each run */
+    BfMFlushEntry *entries;             /* dirty buffers */
+    BfMIOHandle *handles;               /* requests of the runs */
     
 	
 	/* NEWCODE */
-	type = PAGE_BUF;
-	for(i=0;i<BI_NBUFS(type);i++){
-		//iterate through all buffer elements, check if DIRTY = 1.
-		if((BI_BITS(type, i) & DIRTY) == DIRTY){
-			edubfm_FlushTrain(&(BI_KEY(type, i)), type);
+	//1. collect the dirty buffers, fixed and with the dirty bit cleared.
+	e = edubfm_CollectDirty(&entries, &nEntries);
+	if(e < eNOERROR) ERR(e);
+
+	//2. sort them in the disk order.
+	qsort(entries, nEntries, sizeof(BfMFlushEntry), edubfm_CompareFlushEntries);
+
+	handles = (BfMIOHandle*)malloc(sizeof(BfMIOHandle) * (nEntries + 1));
+	runStart = (Four*)malloc(sizeof(Four) * (nEntries + 1));
+
+	//3. write each run of adjacent trains at once.
+	firstError = (handles == NULL || runStart == NULL) ? eMEMORYALLOCERR : eNOERROR;
+	nRuns = nDone = 0;
+	for(i = 0; i < nEntries; ){
+		if(firstError < eNOERROR){	//give the buffer back as it was.
+			BFM_GETLATCH(BI_PARTLATCH(entries[i].type, entries[i].part));
+			BI_FIXED(entries[i].type, entries[i].index)--;
+			BI_BITS(entries[i].type, entries[i].index) |= DIRTY;
+			edubfm_MarkDirty(entries[i].type, entries[i].index);
+			BFM_RELEASELATCH(BI_PARTLATCH(entries[i].type, entries[i].part));
+			i++;
+			continue;
 		}
-	}
-	type = LOT_LEAF_BUF;
-	for(i=0;i<BI_NBUFS(type);i++){
-		//iterate through all buffer elements, check if DIRTY = 1.
-		if((BI_BITS(type, i) & DIRTY) == DIRTY){
-			edubfm_FlushTrain(&(BI_KEY(type, i)), type);
+
+		runStart[nRuns] = i;
+		i += edubfm_SubmitRun(&entries[i], nEntries - i, &handles[nRuns]);
+		nRuns++;
+
+		if(edubfm_ioEngine.nWorkers == 0){	//the run has been written by the caller.
+			e = edubfm_CompleteRun(&entries[runStart[nDone]], &handles[nDone]);
+			if(e < eNOERROR && firstError == eNOERROR) firstError = e;
+			nDone++;
 		}
 	}
+
+	//4. wait for the runs in the queue of the engine.
+	for(; nDone < nRuns; nDone++){
+		e = edubfm_CompleteRun(&entries[runStart[nDone]], &handles[nDone]);
+		if(e < eNOERROR && firstError == eNOERROR) firstError = e;
+	}
+
+	if(handles != NULL) free(handles);
+	if(runStart != NULL) free(runStart);
+	free(entries);
+
+	if(firstError < eNOERROR) ERR(firstError);
+
+	//5. save the trains resident in the pools for the warm-up after the next mount.
+	if(edubfm_hotSetFile != NULL){
+		e = edubfm_SaveHotSet(edubfm_hotSetFile);
+		if(e < eNOERROR) ERR(e);
+	}
 	/* ENDOFNEWCODE */
 	
     return( eNOERROR );
     
 }  /* EduBfM_FlushAll() */
 
+
+
+
+/*@================================
+ * edubfm_CollectDirty()
+ *================================*/
+/*
+ * Function: static Four edubfm_CollectDirty(BfMFlushEntry **, Four *)
+ *
+ * Description :
+ *  Collect the dirty buffers of all pools. Each dirty buffer is fixed and
+ *  its dirty bit is cleared, so that it stays in the pool until it is
+ *  written and is made dirty again if it is updated meanwhile. A train
+ *  being written back from a copy, by a background cleaner or for its
+ *  eviction, is waited for first.
+ *  The buffers are found through the dirty maps, so the cost depends on
+ *  the number of dirty buffers rather than on the size of the pools.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR - memory allocation failed
+ *
+ * Side effects:
+ *  1) parameter entries
+ *     array of the dirty buffers, to be freed by the caller
+ *  2) parameter nEntries
+ *     # of the dirty buffers
+ */
+static Four edubfm_CollectDirty(
+    BfMFlushEntry       **entries,              /* OUT dirty buffers */
+    Four                *nEntries)              /* OUT # of dirty buffers */
+{
+    Four                i;                      /* index */
+    Four                type;                   /* buffer type */
+    Four                p;                      /* partition number */
+    Four                maxEntries;             /* # of buffers of all pools */
+    BfMFlushEntry       *entry;                 /* a dirty buffer */
+    pthread_mutex_t     *latch;                 /* latch of a partition */
+
+
+    for(maxEntries = 0, type = 0; type < NUM_BUF_TYPES; type++) maxEntries += BI_NBUFS(type);
+
+    *entries = (BfMFlushEntry*)malloc(sizeof(BfMFlushEntry) * maxEntries);
+    if(*entries == NULL) ERR(eMEMORYALLOCERR);
+
+    *nEntries = 0;
+    for(type = 0; type < NUM_BUF_TYPES; type++){
+        for(i = edubfm_NextDirty(type, 0); i != NIL; i = edubfm_NextDirty(type, i + 1)){
+            p = BI_PARTITIONOFBUF(type, i);
+            latch = BI_PARTLATCH(type, p);
+            BFM_GETLATCH(latch);
+
+            while(BI_BITS(type, i) & CLEANING)	//it is being written back from a copy; the write may fail.
+                pthread_cond_wait(BI_PARTIODONE(type, p), latch);
+
+            if(BI_BITS(type, i) & DIRTY){
+                entry = &(*entries)[(*nEntries)++];
+                entry->key = BI_KEY(type, i);
+                entry->type = type;
+                entry->index = i;
+                entry->part = p;
+
+                BI_FIXED(type, i)++;
+                BI_BITS(type, i) &= ~DIRTY;
+            }
+            edubfm_MarkClean(type, i);
+
+            BFM_RELEASELATCH(latch);
+        }
+    }
+
+    return(eNOERROR);
+
+}  /* edubfm_CollectDirty() */
+
+
+
+/*@================================
+ * edubfm_CompareFlushEntries()
+ *================================*/
+/*
+ * Function: static int edubfm_CompareFlushEntries(const void *, const void *)
+ *
+ * Description :
+ *  Order the dirty buffers by (volNo, pageNo, type) for qsort().
+ *
+ * Returns:
+ *  negative, zero or positive as the first buffer goes before, with or
+ *  after the second one
+ */
+static int edubfm_CompareFlushEntries(
+    const void          *a,                     /* IN a dirty buffer */
+    const void          *b)                     /* IN another dirty buffer */
+{
+    const BfMFlushEntry *x = (const BfMFlushEntry*)a;
+    const BfMFlushEntry *y = (const BfMFlushEntry*)b;
+
+
+    if(x->key.volNo != y->key.volNo) return((x->key.volNo < y->key.volNo) ? -1 : 1);
+    if(x->key.pageNo != y->key.pageNo) return((x->key.pageNo < y->key.pageNo) ? -1 : 1);
+    return(x->type - y->type);
+
+}  /* edubfm_CompareFlushEntries() */
+
+
+
+/*@================================
+ * edubfm_SubmitRun()
+ *================================*/
+/*
+ * Function: static Four edubfm_SubmitRun(BfMFlushEntry *, Four, BfMIOHandle *)
+ *
+ * Description :
+ *  Submit the write of the run of trains starting at `entries', i.e. the
+ *  following buffers of the same type whose trains are contiguous on the
+ *  disk, up to BFM_FLUSH_MAXRUN trains. A run of more than one train is
+ *  copied into a buffer of its own and written by one request; if the
+ *  copy cannot be allocated, the first train is written alone.
+ *
+ * Returns:
+ *  # of buffers in the run
+ *
+ * Side effects:
+ *  1) parameter handle
+ *     request of the run
+ */
+static Four edubfm_SubmitRun(
+    BfMFlushEntry       *entries,               /* IN sorted dirty buffers */
+    Four                nEntries,               /* IN # of the buffers */
+    BfMIOHandle         *handle)                /* OUT request of the run */
+{
+    Four                e;                      /* error */
+    Four                n;                      /* # of buffers in the run */
+    Four                type = entries[0].type; /* buffer type */
+    Four                trainBytes;             /* size of a train in bytes */
+
+
+    for(n = 1; n < nEntries && n < BFM_FLUSH_MAXRUN; n++)
+        if(entries[n].type != type || entries[n].key.volNo != entries[0].key.volNo ||
+           entries[n].key.pageNo != entries[n - 1].key.pageNo + BI_BUFSIZE(type)) break;
+
+    handle->op = BFM_IO_WRITE;
+    handle->trainId.volNo = entries[0].key.volNo;
+    handle->trainId.pageNo = entries[0].key.pageNo;
+    handle->type = type;
+    handle->index = entries[0].index;
+    handle->part = entries[0].part;
+    handle->buffer = NULL;
+
+    //copy the trains of the run; the buffers are fixed and cannot be replaced.
+    trainBytes = PAGESIZE * BI_BUFSIZE(type);
+    if(n > 1) handle->buffer = edubfm_AllocIOBuffer(BI_BUFSIZE(type) * n);
+    if(handle->buffer != NULL){
+        for(handle->nTrains = 0; handle->nTrains < n; handle->nTrains++)
+            memcpy(handle->buffer + trainBytes * handle->nTrains,
+                   BI_BUFFER(type, entries[handle->nTrains].index), trainBytes);
+    }
+    else{
+        n = 1;
+        handle->nTrains = 1;
+        handle->buffer = BI_BUFFER(type, entries[0].index);
+    }
+
+    e = edubfm_SubmitIO(handle);
+    if(e < eNOERROR) handle->status = e;
+
+    return(n);
+
+}  /* edubfm_SubmitRun() */
+
+
+
+/*@================================
+ * edubfm_CompleteRun()
+ *================================*/
+/*
+ * Function: static Four edubfm_CompleteRun(BfMFlushEntry *, BfMIOHandle *)
+ *
+ * Description :
+ *  Wait for the write of a run and unfix its buffers. If the write fails,
+ *  the buffers are made dirty again.
+ *
+ * Returns:
+ *  the status of the write (error code)
+ */
+static Four edubfm_CompleteRun(
+    BfMFlushEntry       *entries,               /* IN buffers of the run */
+    BfMIOHandle         *handle)                /* IN request of the run */
+{
+    Four                e;                      /* error */
+    Four                i;                      /* index */
+    pthread_mutex_t     *latch;                 /* latch of a partition */
+
+
+    e = edubfm_WaitIO(handle);
+
+    for(i = 0; i < handle->nTrains; i++){
+        latch = BI_PARTLATCH(entries[i].type, entries[i].part);
+        BFM_GETLATCH(latch);
+        BI_FIXED(entries[i].type, entries[i].index)--;
+        if(e < eNOERROR){
+            BI_BITS(entries[i].type, entries[i].index) |= DIRTY;
+            edubfm_MarkDirty(entries[i].type, entries[i].index);
+        }
+        else
+            BFM_STATS_INC(entries[i].type, nFlushes);
+        BFM_RELEASELATCH(latch);
+    }
+
+    if(handle->nTrains > 1) free(handle->buffer);
+
+    return(e);
+
+}  /* edubfm_CompleteRun() */
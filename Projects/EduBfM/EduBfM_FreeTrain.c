@@ -74,6 +74,8 @@
  *
  *  Free(or unfix) a buffer.
  *  This function simply frees a buffer by decrementing the fix count by 1.
+ *  The train of a volume mapped by EduBfM_MapVolume() is not fixed, so
+ *  nothing is done for it.
  *
  * Returns :
  *  error code
@@ -86,24 +88,30 @@ Four EduBfM_FreeTrain(
 {
 	/* These local variables are used in the solution code. However, you don¡¯t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four                index;          /* index on buffer holding the train */
-    Four 		e;		/* error code */
-	BufferTable* btable;
-	btable = bufInfo[type].bufTable;
+    pthread_mutex_t     *latch;         /* latch of the partition holding the train */
 
     /*@ check if the parameter is valid. */
     if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);	
 	
 	/* NEWCODE */
+	if(bufMapped.nMapped > 0 && edubfm_MappedTrain(trainId, type) != NULL)
+		return( eNOERROR );	//the train of a mapped volume is not fixed.
+
+	latch = BI_PARTLATCH(type, BI_PARTITIONOFKEY(type, trainId));
+	BFM_GETLATCH(latch);
+
 	//1.lookup key from hash table.
 	index = edubfm_LookUp(trainId, type);
-	if(index == NOTFOUND_IN_HTABLE) ERR(eNOTFOUND_BFM);
-	btable[index].fixed--;
+	if(index == NOTFOUND_IN_HTABLE) ERRL(eNOTFOUND_BFM, latch);
+	BI_FIXED(type, index)--;
 	//error msg if fixed < 0.
-	if(btable[index].fixed < 0){
+	if(BI_FIXED(type, index) < 0){
 		printf("Warning: Fixed counter is less than 0!!!\n");
 		PRINT_TRAINID("trainId",trainId);
-		btable[index].fixed = 0;
+		BI_FIXED(type, index) = 0;
 	}
+
+	BFM_RELEASELATCH(latch);
 	/* ENDOFNEWCODE */
 
 
@@ -0,0 +1,141 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_FreeTrains.c
+ *
+ * Description :
+ *  Free (or unfix) many buffers by one call.
+ *
+ * Exports:
+ *  Four EduBfM_FreeTrains(TrainID *, Four, Four *, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_FreeTrains()
+ *================================*/
+/*
+ * Function: Four EduBfM_FreeTrains(TrainID *, Four, Four *, Four)
+ *
+ * Description :
+ *  Vectored variant of EduBfM_FreeTrain(): unfix the buffers of the
+ *  `nTrains' trains of `trainIds', e.g. those fixed by
+ *  EduBfM_GetTrains(). The latch of a partition is kept over consecutive
+ *  trains of the partition. The result of each train is reported in
+ *  `results' if it is not NULL; a train which is not in the pool does not
+ *  keep the others from being freed.
+ *
+ * Returns:
+ *  error code, the first error among the trains
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER - bad array or # of trains
+ *    eNOTFOUND_BFM - some train is not in the pool
+ *
+ * Side effects:
+ *  1) parameter results
+ *     results[i] is the error code of trainIds[i]
+ */
+Four EduBfM_FreeTrains(
+    TrainID             *trainIds,              /* IN trains to be freed */
+    Four                nTrains,                /* IN # of the trains */
+    Four                *results,               /* OUT error code of each train; may be NULL */
+    Four                type)                   /* IN buffer type */
+{
+    Four                e;                      /* error of a train */
+    Four                firstError;             /* first error among the trains */
+    Four                i;                      /* index */
+    Four                index;                  /* index on buffer holding a train */
+    pthread_mutex_t     *latch;                 /* latch of the partition holding a train */
+    pthread_mutex_t     *held;                  /* latch held */
+
+
+    /*@ check if the parameters are valid. */
+    if (trainIds == NULL || nTrains < 0) ERR(eBADPARAMETER);
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+
+    firstError = eNOERROR;
+    held = NULL;
+    for (i = 0; i < nTrains; i++) {
+        if (bufMapped.nMapped > 0 && edubfm_MappedTrain(&trainIds[i], type) != NULL) {
+            /* the train of a mapped volume is not fixed */
+            if (results != NULL) results[i] = eNOERROR;
+            continue;
+        }
+
+        latch = BI_PARTLATCH(type, BI_PARTITIONOFKEY(type, &trainIds[i]));
+        if (latch != held) {
+            if (held != NULL) BFM_RELEASELATCH(held);
+            BFM_GETLATCH(latch);
+            held = latch;
+        }
+
+        e = eNOERROR;
+        index = edubfm_LookUp(&trainIds[i], type);
+        if (index == NOTFOUND_IN_HTABLE) e = eNOTFOUND_BFM;
+        else if (--BI_FIXED(type, index) < 0) {
+            printf("Warning: Fixed counter is less than 0!!!\n");
+            PRINT_TRAINID("trainId", &trainIds[i]);
+            BI_FIXED(type, index) = 0;
+        }
+
+        if (results != NULL) results[i] = e;
+        if (e < eNOERROR && firstError == eNOERROR) firstError = e;
+    }
+    if (held != NULL) BFM_RELEASELATCH(held);
+
+    if (firstError < eNOERROR) ERR(firstError);
+
+    return(eNOERROR);
+
+} /* EduBfM_FreeTrains() */
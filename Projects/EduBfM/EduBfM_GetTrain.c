@@ -79,7 +79,10 @@
  *  buffer table entry.   Otherwise, i.e. the train does not exist in the
  *  pool, allocate a buffer (a buffer selected as victim may be forced out
  *  by the buffer replacement algorithm), read a disk train into the 
- *  selected buffer train, and return it.
+ *  selected buffer train, and return it. The partition is not latched
+ *  during the read; the buffer is marked READING meanwhile.
+ *  The train of a volume mapped by EduBfM_MapVolume() is returned straight
+ *  from the mapping.
  *
  * Returns:
  *  error code
@@ -99,7 +102,11 @@ Four EduBfM_GetTrain(
 	/* These local variables are used in the solution code. However, you don¡¯t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four                e;                      /* for error */
     Four                index;                  /* index of the buffer pool */
-	char* pool;
+    Four                part;                   /* partition holding the train */
+    pthread_mutex_t     *latch;                 /* latch of the partition */
+    UEight              start;                  /* time when the call started */
+    Boolean             hit;                    /* TRUE if the train is found in the pool */
+    Boolean             waited;                 /* TRUE if the train was being read */
 
 
     /*@ Check the validity of given parameters */
@@ -111,28 +118,48 @@ Four EduBfM_GetTrain(
 	
 	
 	/* NEWCODE */
-	//1.lookup key from hash table.
-	pool = BI_BUFFERPOOL(type); //get the pool.
-	index = edubfm_LookUp(trainId, type);
-	if(index == NOTFOUND_IN_HTABLE){
-		//2.not in pool
-		index = edubfm_AllocTrain(type);	//allocate a new buffer element.
-		edubfm_ReadTrain(trainId, (pool + PAGESIZE*BI_BUFSIZE(type)*index), type);	//read in train.
-		BfMHashKey* newkey;
-		newkey = trainId;
-		bufInfo[type].bufTable[index].key = *newkey;
-		bufInfo[type].bufTable[index].fixed = 1;
-		bufInfo[type].bufTable[index].bits = bufInfo[type].bufTable[index].bits | REFER;
-		edubfm_Insert(trainId, index, type);
-		*retBuf = (pool + PAGESIZE*BI_BUFSIZE(type)*index);
+	if(bufMapped.nMapped > 0 && (*retBuf = edubfm_MappedTrain(trainId, type)) != NULL){
+		BFM_STATS_INC(type, nMappedGets);	//the train is used in place; nothing to fix.
+		return(eNOERROR);
 	}
-	else{
-		//3. In pool.
-		edubfm_ReadTrain(trainId, (pool + PAGESIZE*BI_BUFSIZE(type)*index), type);	//read in train.
-		bufInfo[type].bufTable[index].fixed++;
-		bufInfo[type].bufTable[index].bits = bufInfo[type].bufTable[index].bits | REFER;
-		*retBuf = (pool + PAGESIZE*BI_BUFSIZE(type)*index);
+
+	start = edubfm_StatsClock();
+	part = BI_PARTITIONOFKEY(type, trainId);
+	latch = BI_PARTLATCH(type, part);
+	BFM_GETLATCH(latch);
+
+	//1.fix the train if it is in the pool, or claim a buffer for it.
+	waited = FALSE;
+	while((e = edubfm_FixTrain(type, part, trainId, &index)) == BFM_FIX_READING || e == BFM_FIX_EVICTING){
+		//wait for the read of the train by another caller, or for the write-back of a victim to claim a buffer.
+		if(e == BFM_FIX_READING) waited = TRUE;
+		pthread_cond_wait(BI_PARTIODONE(type, part), latch);
+	}
+	if(e < eNOERROR) ERRL(e, latch);
+
+	hit = (e == BFM_FIX_HIT);
+	if(!hit){
+		//2.not in pool: the buffer is fixed and marked READING, so that the latch is not held during the read.
+		BFM_RELEASELATCH(latch);
+		e = edubfm_ReadTrain(trainId, BI_BUFFER(type, index), type);	//read in train.
+		BFM_GETLATCH(latch);
+
+		e = edubfm_EndRead(type, part, index, e);
+		if(e < eNOERROR) ERRL(e, latch);
 	}
+	*retBuf = BI_BUFFER(type, index);
+
+	BFM_RELEASELATCH(latch);
+
+	//3. follow a sequential scan with read-ahead.
+	if(bufReadAhead[type].maxK > 0)
+		edubfm_ReadAhead(type, trainId, *retBuf, waited);
+
+	//4. move memory to the pool which saves more misses with it.
+	if(!hit && bufAdapt.budget > 0 && __sync_add_and_fetch(&bufAdapt.nMisses, 1) % BFM_ADAPT_PERIOD == 0)
+		edubfm_Adapt();
+
+	edubfm_StatsLatency(type, hit, edubfm_StatsClock() - start);
 	/* ENDOFNEWCODE */
 
 
@@ -0,0 +1,211 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_GetTrainAsync.c
+ *
+ * Description :
+ *  Fix a train in the buffer pool without waiting for its disk read.
+ *
+ * Exports:
+ *  Four EduBfM_GetTrainAsync(TrainID *, Four, BfMIOHandle *)
+ *  Four edubfm_JoinTrain(BfMIOHandle *, Boolean)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_GetTrainAsync()
+ *================================*/
+/*
+ * Function: Four EduBfM_GetTrainAsync(TrainID *, Four, BfMIOHandle *)
+ *
+ * Description :
+ *  Non-blocking variant of EduBfM_GetTrain(). The train is fixed as by
+ *  EduBfM_GetTrain() (see edubfm_FixTrain()); if it is not in the pool, a
+ *  buffer is claimed and its read is handed to the asynchronous I/O
+ *  engine, and the call returns without waiting for the read.
+ *  The completion is reported through `handle': EduBfM_PollTrain() tells
+ *  whether the train is ready, and EduBfM_WaitTrain() waits for it and
+ *  returns the buffer. The train must not be used or freed before
+ *  EduBfM_WaitTrain() returns. If the read fails, the train is not fixed
+ *  and EduBfM_WaitTrain() returns the error.
+ *  A train being read for another caller, or missing while a victim of its
+ *  partition is written back, is not waited for either: the handle is
+ *  bound to it, and the train is fixed, or claimed and read, by
+ *  EduBfM_PollTrain() or EduBfM_WaitTrain() once it can be.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - Invalid Buffer type
+ *    eBADPARAMETER - `handle' is NULL
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) parameter handle
+ *     handle of the request
+ */
+Four EduBfM_GetTrainAsync(
+    TrainID             *trainId,               /* IN train to be used */
+    Four                type,                   /* IN buffer type */
+    BfMIOHandle         *handle)                /* OUT handle of the request */
+{
+    Four                e;                      /* for error */
+
+
+    /*@ Check the validity of given parameters */
+    if (handle == NULL) ERR(eBADPARAMETER);
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+
+    handle->trainId = *trainId;
+    handle->nTrains = 1;
+    handle->type = type;
+    handle->part = BI_PARTITIONOFKEY(type, trainId);
+    handle->index = NIL;
+
+    if (bufMapped.nMapped > 0 && (handle->buffer = edubfm_MappedTrain(trainId, type)) != NULL) {
+        /* the train of a mapped volume is ready at once */
+        BFM_STATS_INC(type, nMappedGets);
+        handle->op = BFM_IO_READ;
+        handle->status = eNOERROR;
+        return(eNOERROR);
+    }
+
+    handle->op = BFM_IO_JOIN;
+    handle->buffer = NULL;
+    handle->status = BFM_IO_PENDING;
+    handle->start = edubfm_StatsClock();
+
+    e = edubfm_JoinTrain(handle, FALSE);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+}  /* EduBfM_GetTrainAsync() */
+
+
+
+/*@================================
+ * edubfm_JoinTrain()
+ *================================*/
+/*
+ * Function: Four edubfm_JoinTrain(BfMIOHandle *, Boolean)
+ *
+ * Description:
+ *  Bind a request of EduBfM_GetTrainAsync() whose operation is BFM_IO_JOIN
+ *  to its train: the train is fixed if it is ready, or a buffer is claimed
+ *  and the read of the train is submitted to the asynchronous I/O engine,
+ *  and the operation becomes BFM_IO_READ. If the train is being read for
+ *  another caller, or a victim of the partition is being written back,
+ *  the request is left as it is unless `wait' is TRUE, in which case it is
+ *  waited for on BI_PARTIODONE().
+ *  A hit is counted in the latency histogram at once, a miss when its
+ *  read completes (see edubfm_CompleteIO()).
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls; the request is completed
+ *    with the error
+ */
+Four edubfm_JoinTrain(
+    BfMIOHandle         *handle,                /* INOUT request to bind */
+    Boolean             wait)                   /* IN TRUE to wait until the request is bound */
+{
+    Four                e;                      /* for error */
+    Four                type = handle->type;    /* buffer type */
+    Four                part = handle->part;    /* partition holding the train */
+    Four                index;                  /* index of the buffer pool */
+    pthread_mutex_t     *latch;                 /* latch of the partition */
+
+
+    latch = BI_PARTLATCH(type, part);
+    BFM_GETLATCH(latch);
+
+    while ((e = edubfm_FixTrain(type, part, &handle->trainId, &index)) == BFM_FIX_READING || e == BFM_FIX_EVICTING) {
+        if (!wait) {
+            BFM_RELEASELATCH(latch);
+            return(eNOERROR);
+        }
+        pthread_cond_wait(BI_PARTIODONE(type, part), latch);
+    }
+
+    if (e < eNOERROR) {
+        handle->op = BFM_IO_READ;
+        handle->status = e;
+        ERRL(e, latch);
+    }
+
+    handle->op = BFM_IO_READ;
+    handle->index = index;
+    handle->buffer = BI_BUFFER(type, index);
+
+    if (e == BFM_FIX_HIT) {
+        handle->status = eNOERROR;
+        BFM_RELEASELATCH(latch);
+
+        edubfm_StatsLatency(type, TRUE, edubfm_StatsClock() - handle->start);
+        return(eNOERROR);
+    }
+
+    /* the buffer is fixed and marked READING until the read completes */
+    BFM_RELEASELATCH(latch);
+
+    e = edubfm_SubmitIO(handle);
+    if (e < eNOERROR) ERR(e);
+
+    /* move memory to the pool which saves more misses with it */
+    if (bufAdapt.budget > 0 && __sync_add_and_fetch(&bufAdapt.nMisses, 1) % BFM_ADAPT_PERIOD == 0)
+        edubfm_Adapt();
+
+    return(eNOERROR);
+
+} /* edubfm_JoinTrain() */
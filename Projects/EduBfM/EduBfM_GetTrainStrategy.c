@@ -0,0 +1,195 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_GetTrainStrategy.c
+ *
+ * Description :
+ *  Fix a train in the buffer pool following an access strategy.
+ *
+ * Exports:
+ *  Four EduBfM_GetTrainStrategy(TrainID *, char **, Four, BfMStrategy *)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_GetTrainStrategy()
+ *================================*/
+/*
+ * Function: Four EduBfM_GetTrainStrategy(TrainID *, char **, Four, BfMStrategy *)
+ *
+ * Description :
+ *  Variant of EduBfM_GetTrain() taking an access strategy as a hint. If
+ *  `strategy' is NULL or BFM_STRATEGY_NORMAL, it is EduBfM_GetTrain().
+ *  Otherwise a missing train is read into a buffer of the ring of the
+ *  strategy, recycling the buffer used a ring ago if nobody else has
+ *  referenced it since, and the trains fixed through the ring are not
+ *  marked referenced, so the rest of the pool is left to the other users.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFER_BFM - Invalid Buffer
+ *    eBADBUFFERTYPE_BFM - Invalid Buffer type
+ *    eBADPARAMETER - the strategy is for another buffer type
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) parameter retBuf
+ *     pointer to buffer holding the disk train indicated by `trainId'
+ */
+Four EduBfM_GetTrainStrategy(
+    TrainID             *trainId,               /* IN train to be used */
+    char                **retBuf,               /* OUT pointer to the returned buffer */
+    Four                type,                   /* IN buffer type */
+    BfMStrategy         *strategy)              /* INOUT access strategy */
+{
+    Four                e;                      /* for error */
+    Four                index;                  /* index of the buffer pool */
+    Four                part;                   /* partition holding the train */
+    pthread_mutex_t     *latch;                 /* latch of the partition */
+    UEight              start;                  /* time when the call started */
+    Boolean             hit;                    /* TRUE if the train is found in the pool */
+
+
+    if (strategy == NULL || strategy->kind == BFM_STRATEGY_NORMAL)
+        return(EduBfM_GetTrain(trainId, retBuf, type));
+
+    /*@ Check the validity of given parameters */
+    if (retBuf == NULL) ERR(eBADBUFFER_BFM);
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (strategy->type != type) ERR(eBADPARAMETER);
+
+    if (bufMapped.nMapped > 0 && (*retBuf = edubfm_MappedTrain(trainId, type)) != NULL) {
+        BFM_STATS_INC(type, nMappedGets);
+        return(eNOERROR);
+    }
+
+    start = edubfm_StatsClock();
+    part = BI_PARTITIONOFKEY(type, trainId);
+    latch = BI_PARTLATCH(type, part);
+    BFM_GETLATCH(latch);
+
+    index = edubfm_LookUp(trainId, type);
+    while (index != NOTFOUND_IN_HTABLE ? (BI_BITS(type, index) & READING) : BI_PARTEVICTING(type, part)) {
+        pthread_cond_wait(BI_PARTIODONE(type, part), latch);
+        index = edubfm_LookUp(trainId, type);
+    }
+
+    if (index == NOTFOUND_IN_HTABLE) {
+        /* read the train into a buffer of the ring, without marking it referenced */
+        hit = FALSE;
+        BFM_STATS_INC(type, nMisses);
+
+        e = edubfm_PolicyMiss(type, part, trainId);
+        if (e < eNOERROR) ERRL(e, latch);
+
+        index = edubfm_RingVictim(type, part, strategy);
+        if (index < eNOERROR) ERRL(index, latch);
+
+        /* the buffer is fixed and marked READING, so that the latch is not held during the read */
+        BI_KEY(type, index).volNo = trainId->volNo;
+        BI_KEY(type, index).pageNo = trainId->pageNo;
+        BI_FIXED(type, index) = 1;
+        BI_BITS(type, index) |= READING;
+
+        e = edubfm_Insert(&BI_KEY(type, index), index, type);
+        if (e >= eNOERROR) e = edubfm_PolicyLoad(type, part, index);
+        if (e < eNOERROR) {
+            (void)edubfm_Delete(&BI_KEY(type, index), type);
+            SET_NILBFMHASHKEY(BI_KEY(type, index));
+            BI_FIXED(type, index) = 0;
+            BI_BITS(type, index) = ALL_0;
+            (void)edubfm_PolicyDrop(type, part, index);
+            edubfm_FreeFrame(type, part, index);
+            ERRL(e, latch);
+        }
+
+        BFM_RELEASELATCH(latch);
+        e = edubfm_ReadTrain(trainId, BI_BUFFER(type, index), type);
+        BFM_GETLATCH(latch);
+
+        if (e < eNOERROR) {
+            (void)edubfm_Delete(&BI_KEY(type, index), type);
+            SET_NILBFMHASHKEY(BI_KEY(type, index));
+            BI_FIXED(type, index) = 0;
+            BI_BITS(type, index) = ALL_0;
+            (void)edubfm_PolicyDrop(type, part, index);
+            edubfm_FreeFrame(type, part, index);
+            pthread_cond_broadcast(BI_PARTIODONE(type, part));
+            ERRL(e, latch);
+        }
+
+        BI_BITS(type, index) &= ~READING;
+        pthread_cond_broadcast(BI_PARTIODONE(type, part));
+    }
+    else {
+        /* a train of the ring fixed again by the scan stays unreferenced */
+        hit = TRUE;
+        BFM_STATS_INC(type, nHits);
+        BI_FIXED(type, index)++;
+
+        if (!edubfm_InRing(strategy, part, index)) {
+            BI_BITS(type, index) |= REFER;
+            e = edubfm_PolicyHit(type, part, index);
+            if (e < eNOERROR) ERRL(e, latch);
+        }
+    }
+    *retBuf = BI_BUFFER(type, index);
+
+    BFM_RELEASELATCH(latch);
+
+    edubfm_StatsLatency(type, hit, edubfm_StatsClock() - start);
+
+    return(eNOERROR);
+
+}  /* EduBfM_GetTrainStrategy() */
@@ -0,0 +1,241 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_GetTrains.c
+ *
+ * Description :
+ *  Fix many trains in the buffer pool by one call.
+ *
+ * Exports:
+ *  Four EduBfM_GetTrains(TrainID *, Four, char **, Four *, Four)
+ */
+
+
+#include <stdlib.h> /* for malloc, free, qsort & bsearch */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * constant definitions
+ */
+/* result of a train found being read for another caller, until it is waited for */
+#define GETTRAINS_WAIT      1
+
+
+
+/*@
+ * internal function prototypes
+ */
+static int edubfm_CompareMisses(const void *, const void *);
+
+
+
+/*@================================
+ * EduBfM_GetTrains()
+ *================================*/
+/*
+ * Function: Four EduBfM_GetTrains(TrainID *, Four, char **, Four *, Four)
+ *
+ * Description :
+ *  Vectored variant of EduBfM_GetTrain(): fix the `nTrains' trains of
+ *  `trainIds' and return their buffers in `retBufs'. The trains found in
+ *  the pool are fixed first; buffers are then claimed for all the other
+ *  trains, which are read in the order of (volNo, pageNo), trains
+ *  contiguous on the disk by one I/O of up to BFM_FLUSH_MAXRUN trains,
+ *  all the I/Os being in flight at once (see edubfm_ReadTrains()).
+ *  Trains being read for another caller, or missing from a partition
+ *  whose victim is being written back, are waited for last.
+ *  The result of each train is reported in `results'; a train which
+ *  cannot be fixed does not keep the others from being fixed. Each train
+ *  fixed is to be freed by EduBfM_FreeTrain() or EduBfM_FreeTrains(), and
+ *  a train given twice is fixed twice.
+ *
+ * Returns:
+ *  error code, the first error among the trains
+ *    eBADBUFFERTYPE_BFM - Invalid Buffer type
+ *    eBADPARAMETER - bad array or # of trains
+ *    eMEMORYALLOCERR - memory allocation failed
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) parameter retBufs
+ *     retBufs[i] is the buffer holding trainIds[i] if results[i] is eNOERROR
+ *  2) parameter results
+ *     results[i] is the error code of trainIds[i]
+ */
+Four EduBfM_GetTrains(
+    TrainID             *trainIds,              /* IN trains to be used */
+    Four                nTrains,                /* IN # of the trains */
+    char                **retBufs,              /* OUT pointer to the buffer of each train */
+    Four                *results,               /* OUT error code of each train */
+    Four                type)                   /* IN buffer type */
+{
+    Four                e;                      /* for error */
+    Four                firstError;             /* first error among the trains */
+    Four                i;                      /* index */
+    Four                index;                  /* index of the buffer pool */
+    Four                part;                   /* partition holding a train */
+    Four                nMisses;                /* # of trains not in the pool */
+    pthread_mutex_t     *latch;                 /* latch of a partition */
+    BfMFlushEntry       *misses;                /* trains not in the pool, with their buffers */
+    BfMFlushEntry       key;                    /* key searched in `misses' */
+    BfMFlushEntry       *miss;                  /* a train not in the pool */
+
+
+    /*@ Check the validity of given parameters */
+    if (trainIds == NULL || retBufs == NULL || results == NULL || nTrains < 0) ERR(eBADPARAMETER);
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+
+    if (nTrains == 0) return(eNOERROR);
+
+    misses = (BfMFlushEntry*)malloc(sizeof(BfMFlushEntry) * nTrains);
+    if (misses == NULL) ERR(eMEMORYALLOCERR);
+
+    /*@ fix the trains in the pool, and claim buffers for the others */
+    nMisses = 0;
+    for (i = 0; i < nTrains; i++) {
+        retBufs[i] = NULL;
+        results[i] = eNOERROR;
+
+        if (bufMapped.nMapped > 0 && (retBufs[i] = edubfm_MappedTrain(&trainIds[i], type)) != NULL) {
+            BFM_STATS_INC(type, nMappedGets);
+            continue;
+        }
+
+        part = BI_PARTITIONOFKEY(type, &trainIds[i]);
+        latch = BI_PARTLATCH(type, part);
+        BFM_GETLATCH(latch);
+
+        e = edubfm_FixTrain(type, part, &trainIds[i], &index);
+        if (e < eNOERROR)
+            results[i] = e;
+        else if (e == BFM_FIX_READING || e == BFM_FIX_EVICTING)
+            results[i] = GETTRAINS_WAIT;
+        else if (e == BFM_FIX_HIT)
+            retBufs[i] = BI_BUFFER(type, index);
+        else {
+            misses[nMisses].key.volNo = trainIds[i].volNo;
+            misses[nMisses].key.pageNo = trainIds[i].pageNo;
+            misses[nMisses].type = type;
+            misses[nMisses].index = index;
+            misses[nMisses].part = part;
+            nMisses++;
+        }
+
+        BFM_RELEASELATCH(latch);
+    }
+
+    /*@ read the trains not in the pool in the disk order */
+    qsort(misses, nMisses, sizeof(BfMFlushEntry), edubfm_CompareMisses);
+
+    if (nMisses > 0)
+        (void)edubfm_ReadTrains(misses, nMisses, FALSE);
+
+    /*@ give the results of the trains read, and wait for the trains being read */
+    firstError = eNOERROR;
+    for (i = 0; i < nTrains; i++) {
+        if (results[i] == GETTRAINS_WAIT)
+            results[i] = EduBfM_GetTrain(&trainIds[i], &retBufs[i], type);
+        else if (results[i] == eNOERROR && retBufs[i] == NULL) {
+            key.key.volNo = trainIds[i].volNo;
+            key.key.pageNo = trainIds[i].pageNo;
+            miss = (BfMFlushEntry*)bsearch(&key, misses, nMisses, sizeof(BfMFlushEntry), edubfm_CompareMisses);
+            if (miss->index < 0) results[i] = miss->index;
+            else retBufs[i] = BI_BUFFER(type, miss->index);
+        }
+
+        if (results[i] < eNOERROR) {
+            retBufs[i] = NULL;
+            if (firstError == eNOERROR) firstError = results[i];
+        }
+    }
+
+    free(misses);
+
+    /*@ move memory to the pool which saves more misses with it */
+    for (i = 0; i < nMisses; i++)
+        if (bufAdapt.budget > 0 && __sync_add_and_fetch(&bufAdapt.nMisses, 1) % BFM_ADAPT_PERIOD == 0)
+            edubfm_Adapt();
+
+    if (firstError < eNOERROR) ERR(firstError);
+
+    return(eNOERROR);
+
+}  /* EduBfM_GetTrains() */
+
+
+
+/*@================================
+ * edubfm_CompareMisses()
+ *================================*/
+/*
+ * Function: static int edubfm_CompareMisses(const void *, const void *)
+ *
+ * Description :
+ *  Order the trains by (volNo, pageNo) for qsort() and bsearch().
+ *
+ * Returns:
+ *  negative, zero or positive as the first train goes before, with or
+ *  after the second one
+ */
+static int edubfm_CompareMisses(
+    const void          *a,                     /* IN a train */
+    const void          *b)                     /* IN another train */
+{
+    const BfMFlushEntry *x = (const BfMFlushEntry*)a;
+    const BfMFlushEntry *y = (const BfMFlushEntry*)b;
+
+
+    if(x->key.volNo != y->key.volNo) return((x->key.volNo < y->key.volNo) ? -1 : 1);
+    if(x->key.pageNo != y->key.pageNo) return((x->key.pageNo < y->key.pageNo) ? -1 : 1);
+    return(0);
+
+}  /* edubfm_CompareMisses() */
@@ -0,0 +1,143 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_InvalidateTrains.c
+ *
+ * Description :
+ *  Drop the buffers of deallocated trains without writing them back.
+ *
+ * Exports:
+ *  Four EduBfM_InvalidateTrains(TrainID *, Four, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_InvalidateTrains()
+ *================================*/
+/*
+ * Function: Four EduBfM_InvalidateTrains(TrainID *, Four, Four)
+ *
+ * Description :
+ *  Called when the pages of the `nTrains' trains of `trainIds' are
+ *  deallocated, e.g. when an index or an object is dropped. The contents of
+ *  such a train are never read again, so its DIRTY bit is cleared and the
+ *  train is not written back. An unfixed buffer is removed from the pool
+ *  and given to the free list at once; a fixed one is kept until it is
+ *  replaced as usual. A copy kept by the compressed victim cache or the
+ *  secondary cache is dropped. A train which is not in the pool is skipped. The
+ *  latch of a partition is kept over consecutive trains of the partition.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER - bad array or # of trains
+ *    some errors caused by function calls
+ */
+Four EduBfM_InvalidateTrains(
+    TrainID             *trainIds,              /* IN trains whose pages are deallocated */
+    Four                nTrains,                /* IN # of the trains */
+    Four                type)                   /* IN buffer type */
+{
+    Four                e;                      /* for error */
+    Four                i;                      /* index */
+    Four                index;                  /* index on buffer holding a train */
+    Four                part;                   /* partition holding a train */
+    pthread_mutex_t     *latch;                 /* latch of the partition holding a train */
+    pthread_mutex_t     *held;                  /* latch held */
+
+
+    /*@ check if the parameters are valid. */
+    if (trainIds == NULL || nTrains < 0) ERR(eBADPARAMETER);
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+
+    held = NULL;
+    for (i = 0; i < nTrains; i++) {
+        part = BI_PARTITIONOFKEY(type, &trainIds[i]);
+        latch = BI_PARTLATCH(type, part);
+        if (latch != held) {
+            if (held != NULL) BFM_RELEASELATCH(held);
+            BFM_GETLATCH(latch);
+            held = latch;
+        }
+
+        if (bufVictimCache[type].budget > 0) edubfm_VictimDrop(type, (BfMHashKey*)&trainIds[i]);
+        if (bufSecondaryCache[type].nSlots > 0) edubfm_SecondaryDrop(type, (BfMHashKey*)&trainIds[i]);
+
+        index = edubfm_LookUp(&trainIds[i], type);
+        if (index == NOTFOUND_IN_HTABLE) continue;
+
+        if (BI_BITS(type, index) & DIRTY) BFM_STATS_INC(type, nWritesDropped);
+        BI_BITS(type, index) &= ~DIRTY;
+        edubfm_MarkClean(type, index);
+
+        /* a fixed or a reading buffer is in use; it is replaced later */
+        if (BI_FIXED(type, index) > 0 || (BI_BITS(type, index) & READING)) continue;
+
+        e = edubfm_Delete(&BI_KEY(type, index), type);
+        if (e < eNOERROR) ERRL(e, held);
+
+        SET_NILBFMHASHKEY(BI_KEY(type, index));
+        BI_BITS(type, index) = ALL_0;
+
+        e = edubfm_PolicyDrop(type, part, index);
+        if (e < eNOERROR) ERRL(e, held);
+
+        edubfm_FreeFrame(type, part, index);
+        BFM_STATS_INC(type, nInvalidations);
+    }
+    if (held != NULL) BFM_RELEASELATCH(held);
+
+    return(eNOERROR);
+
+} /* EduBfM_InvalidateTrains() */
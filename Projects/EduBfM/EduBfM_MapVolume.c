@@ -0,0 +1,159 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_MapVolume.c
+ *
+ * Description :
+ *  Map a volume read-only, so that its trains are used without copying
+ *  them into the buffer pools.
+ *
+ * Exports:
+ *  Four EduBfM_MapVolume(Four, Four, char **)
+ */
+
+
+#include <fcntl.h> /* for open */
+#include <unistd.h> /* for close */
+#include <sys/stat.h> /* for fstat */
+#include <sys/mman.h> /* for mmap & munmap */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+#include "EduRDsM.h"
+
+
+
+/*@================================
+ * EduBfM_MapVolume()
+ *================================*/
+/*
+ * Function: Four EduBfM_MapVolume(Four, Four, char **)
+ *
+ * Description :
+ *  Map the `nDevices' devices `devNames' of the mounted volume `volNo'
+ *  read-only, in the order given to its format, e.g. on a replica used for
+ *  reporting only. From now on, EduBfM_GetTrain() and the other functions
+ *  fixing a train of the volume return a pointer into the mapping without
+ *  reading the train or keeping a fix count, EduBfM_FreeTrain() and
+ *  EduBfM_SetDirty() do nothing for it, and such trains must not be
+ *  modified. The pools are flushed first, so the mapping shows the latest
+ *  trains; the trains of the volume left in the pools are not used any
+ *  more and are replaced as usual. No train of the volume may be fixed
+ *  while it is mapped or unmapped (see EduBfM_UnmapVolume()).
+ *  The trains read by the BfM of the storage system still go through its
+ *  pools.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad devices, the volume is already mapped or too
+ *                    many volumes are mapped
+ *    some errors caused by function calls
+ */
+Four EduBfM_MapVolume(
+    Four                volNo,                  /* IN volume to be mapped */
+    Four                nDevices,               /* IN # of devices of the volume */
+    char                **devNames)             /* IN devices of the volume */
+{
+    Four                e;                      /* for error */
+    Four                i;                      /* index */
+    Four                d;                      /* device */
+    Two                 extSize;                /* # of pages of an extent of the volume */
+    int                 fd;                     /* descriptor of a device */
+    struct stat         st;                     /* status of a device */
+    BfMMappedVolume     *v;                     /* entry of the volume */
+
+
+    /*@ check if the parameters are valid. */
+    if (nDevices < 1 || nDevices > MAXNUMOFMAPPEDDEVICES || devNames == NULL) ERR(eBADPARAMETER);
+
+    BFM_GETLATCH(&bufMapped.latch);
+
+    v = NULL;
+    for (i = 0; i < MAXNUMOFMAPPEDVOLUMES; i++) {
+        if (bufMapped.volumes[i].nDevices > 0 && bufMapped.volumes[i].volNo == volNo)
+            ERRL(eBADPARAMETER, &bufMapped.latch);
+        if (bufMapped.volumes[i].nDevices == 0 && v == NULL) v = &bufMapped.volumes[i];
+    }
+    if (v == NULL) ERRL(eBADPARAMETER, &bufMapped.latch);
+
+    e = EduRDsM_GetSizeOfExt(volNo, &extSize);
+    if (e < eNOERROR) ERRL(e, &bufMapped.latch);
+
+    /* the files must hold the trains modified in the pools */
+    e = EduBfM_FlushAll();
+    if (e < eNOERROR) ERRL(e, &bufMapped.latch);
+
+    v->firstPage[0] = 0;
+    for (d = 0; d < nDevices; d++) {
+        fd = (devNames[d] == NULL) ? -1 : open(devNames[d], O_RDONLY);
+        if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size >= PAGESIZE)
+            v->base[d] = (char*)mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        else
+            v->base[d] = (char*)MAP_FAILED;
+        if (fd >= 0) close(fd);
+
+        if (v->base[d] == (char*)MAP_FAILED) {
+            for (i = 0; i < d; i++) munmap(v->base[i], v->size[i]);
+            ERRL(eBADPARAMETER, &bufMapped.latch);
+        }
+        /* a device numbers only its whole extents */
+        v->size[d] = st.st_size;
+        v->firstPage[d + 1] = v->firstPage[d] + (st.st_size / PAGESIZE) / extSize * extSize;
+    }
+    v->volNo = volNo;
+
+    /* the entry is complete before it is found */
+    __sync_synchronize();
+    v->nDevices = nDevices;
+    bufMapped.nMapped++;
+
+    BFM_RELEASELATCH(&bufMapped.latch);
+
+    return(eNOERROR);
+
+}  /* EduBfM_MapVolume() */
@@ -0,0 +1,412 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_Resize.c
+ *
+ * Description :
+ *  Change the number of buffers of a buffer pool while it is in use.
+ *
+ * Exports:
+ *  Four EduBfM_Resize(Four, Four)
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include <string.h> /* for memcpy */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * internal function prototypes
+ */
+static Four edubfm_ResizePool(Four, Four);
+static Four edubfm_Drain(Four, Four);
+static Four edubfm_Relocate(Four, Four, Four);
+
+
+
+/*@================================
+ * EduBfM_Resize()
+ *================================*/
+/*
+ * Function: Four EduBfM_Resize(Four, Four)
+ *
+ * Description :
+ *  Change the number of buffers of the pool of the given type to `nBufs',
+ *  keeping the trains in the pool as far as they fit, so that memory can
+ *  be moved between pools at run time.
+ *  A pool is shrunk by evicting as many trains as the replacement policy
+ *  of each partition chooses until the trains of the partition fit its
+ *  new range; the dirty ones are written back. A pool is grown in place:
+ *  the first time it grows beyond the buffers allocated by the storage
+ *  system, it is moved to an arena having room for BFM_MAXNBUFS buffers,
+ *  whose pages are only used as the pool grows. The memory of the buffers
+ *  given up is returned to the system if the pool uses an arena.
+ *  The partitions keep their latches and the trains their partitions, so
+ *  the partitions are not rebuilt. The trains whose buffers change
+ *  partition or are given up are copied to free buffers of their
+ *  partitions, and the hash tables and states of the replacement policy
+ *  are rebuilt for the new ranges; the policy takes the trains kept as
+ *  just loaded.
+ *  A grown pool whose allocation flags are 0 gets the buffers of the
+ *  storage system back when it is shrunk to their number again, which
+ *  must be done before the storage system is finalized, unless the
+ *  arena is kept for EduBfM_SetAdaptiveSplit().
+ *
+ *  Other threads may use the pool; they wait for the call on the latches
+ *  of the partitions, which it holds together with the latch of a
+ *  background cleaner, once no victim of a partition is being written
+ *  back. A fixed train is never moved, so the call fails if
+ *  one is in a buffer which changes partition or is given up, or if the
+ *  pool is to be moved to an arena while any train is fixed.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER - bad number of buffers
+ *    eFLUSHFIXEDBUF_BFM - a fixed train is in the way; the pool is unchanged
+ *    eNOUNFIXEDBUF_BFM - too many trains are fixed to shrink the pool; some
+ *                        trains may have been evicted
+ *    eMEMORYALLOCERR - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four EduBfM_Resize(
+    Four                type,                   /* IN buffer type */
+    Four                nBufs)                  /* IN new # of buffers */
+{
+    Four                e;                      /* error */
+    Four                p;                      /* partition number */
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (nBufs < 1 || nBufs > BFM_MAXNBUFS || nBufs < BI_NPARTITIONS(type)) ERR(eBADPARAMETER);
+
+    /*@ keep the background cleaner and all users away */
+    BFM_GETLATCH(BI_CLEANERLATCH(type));
+    for (p = 0; p < BI_NPARTITIONS(type); p++) {
+        BFM_GETLATCH(BI_PARTLATCH(type, p));
+        while (BI_PARTEVICTING(type, p))
+            pthread_cond_wait(BI_PARTIODONE(type, p), BI_PARTLATCH(type, p));
+    }
+
+    e = edubfm_ResizePool(type, nBufs);
+
+    for (p = BI_NPARTITIONS(type) - 1; p >= 0; p--)
+        BFM_RELEASELATCH(BI_PARTLATCH(type, p));
+    BFM_RELEASELATCH(BI_CLEANERLATCH(type));
+
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+}  /* EduBfM_Resize() */
+
+
+
+/*@================================
+ * edubfm_ResizePool()
+ *================================*/
+/*
+ * Function: static Four edubfm_ResizePool(Four, Four)
+ *
+ * Description:
+ *  Do the work of EduBfM_Resize() holding all latches of the pool.
+ *
+ * Returns:
+ *  error code
+ */
+static Four edubfm_ResizePool(
+    Four                type,                   /* IN buffer type */
+    Four                nBufs)                  /* IN new # of buffers */
+{
+    Four                e;                      /* for error */
+    Four                nOld;                   /* # of buffers before */
+    Four                capacity;               /* # of buffers the memory of the pool has room for */
+    Four                nFixed;                 /* # of fixed trains */
+    Four                first;                  /* first buffer of a partition */
+    Four                n;                      /* # of buffers of a partition */
+    Four                i;                      /* index */
+
+
+    nOld = BI_NBUFS(type);
+    if (nBufs == nOld) return(eNOERROR);
+
+    capacity = edubfm_ArenaCapacity(type);
+
+    /*@ a fixed train must stay in its buffer */
+    nFixed = 0;
+    for (i = 0; i < nOld; i++) {
+        if (BI_FIXED(type, i) == 0) continue;
+        nFixed++;
+
+        edubfm_PartitionRange(nBufs, BI_NPARTITIONS(type), BI_PARTITIONOFKEY(type, &BI_KEY(type, i)), &first, &n);
+        if (nBufs > capacity || i < first || i >= first + n) ERR(eFLUSHFIXEDBUF_BFM);
+    }
+
+    /*@ make room for the buffers added */
+    if (nBufs > capacity) {
+        e = edubfm_ReserveArena(type, FALSE);
+        if (e < eNOERROR) ERR(e);
+    }
+    for (i = nOld; i < nBufs; i++) {
+        SET_NILBFMHASHKEY(BI_KEY(type, i));
+        BI_FIXED(type, i) = 0;
+        BI_BITS(type, i) = ALL_0;
+        BI_NEXTHASHENTRY(type, i) = NIL;
+    }
+
+    /*@ evict the trains which do not fit */
+    if (nBufs < nOld) {
+        e = edubfm_Drain(type, nBufs);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    /*@ move the trains into the new ranges of their partitions */
+    e = edubfm_Relocate(type, nBufs, nOld);
+    if (e < eNOERROR) ERR(e);
+
+    /*@ give the buffers of the storage system back if no arena was asked for */
+    BI_NBUFS(type) = nBufs;
+    if (nBufs <= bufArena[type].origNBufs && bufArena[type].flags == 0 && !bufArena[type].keep && nFixed == 0 &&
+        bufDirect.nVolumes == 0) {
+        e = edubfm_FreeArena(type);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    /*@ rebuild the hash tables and policy states */
+    e = edubfm_ResizePartitions(type, nBufs);
+    if (e < eNOERROR) ERR(e);
+
+    if (nBufs < nOld) edubfm_TrimArena(type);
+
+    return(eNOERROR);
+
+} /* edubfm_ResizePool() */
+
+
+
+/*@================================
+ * edubfm_Drain()
+ *================================*/
+/*
+ * Function: static Four edubfm_Drain(Four, Four)
+ *
+ * Description:
+ *  Evict trains from each partition of the pool of the given type until
+ *  they fit the range of the partition in a pool of `nBufs' buffers. The
+ *  trains are chosen by edubfm_AllocTrain(), i.e. by the replacement policy,
+ *  while the free buffers and those already drained are held fixed so that
+ *  the policy passes over them.
+ *
+ * Returns:
+ *  error code
+ *    eNOUNFIXEDBUF_BFM - too many trains are fixed
+ *    eMEMORYALLOCERR - memory allocation failed
+ *    some errors caused by function calls
+ */
+static Four edubfm_Drain(
+    Four                type,                   /* IN buffer type */
+    Four                nBufs)                  /* IN new # of buffers */
+{
+    Four                victim = eNOERROR;      /* buffer evicted */
+    Four                p;                      /* partition number */
+    Four                i;                      /* index */
+    Four                first;                  /* first buffer of the partition */
+    Four                n;                      /* new # of buffers of the partition */
+    Four                nTrains;                /* # of trains of the partition */
+    Four                *held;                  /* buffers held fixed */
+    Four                nHeld;                  /* # of buffers held fixed */
+
+
+    held = (Four*)malloc(sizeof(Four) * BI_NBUFS(type));
+    if (held == NULL) ERR(eMEMORYALLOCERR);
+
+    for (p = 0; p < BI_NPARTITIONS(type) && victim >= eNOERROR; p++) {
+        edubfm_PartitionRange(nBufs, BI_NPARTITIONS(type), p, &first, &n);
+
+        nTrains = 0;
+        for (i = BI_PARTFIRSTBUF(type, p); i < BI_PARTFIRSTBUF(type, p) + BI_PARTNBUFS(type, p); i++)
+            if (!IS_NILBFMHASHKEY(BI_KEY(type, i))) nTrains++;
+        if (nTrains <= n) continue;
+
+        nHeld = 0;
+        for (i = BI_PARTFIRSTBUF(type, p); i < BI_PARTFIRSTBUF(type, p) + BI_PARTNBUFS(type, p); i++)
+            if (IS_NILBFMHASHKEY(BI_KEY(type, i)) && BI_FIXED(type, i) == 0) {
+                BI_FIXED(type, i)++;
+                held[nHeld++] = i;
+            }
+
+        for ( ; nTrains > n; nTrains--) {
+            victim = edubfm_AllocTrain(type, p, FALSE);
+            if (victim < eNOERROR) break;
+
+            SET_NILBFMHASHKEY(BI_KEY(type, victim));
+            BI_FIXED(type, victim)++;
+            held[nHeld++] = victim;
+        }
+
+        for (i = 0; i < nHeld; i++)
+            BI_FIXED(type, held[i])--;
+    }
+
+    free(held);
+
+    if (victim < eNOERROR) ERR(victim);
+
+    return(eNOERROR);
+
+} /* edubfm_Drain() */
+
+
+
+/*@================================
+ * edubfm_Relocate()
+ *================================*/
+/*
+ * Function: static Four edubfm_Relocate(Four, Four, Four)
+ *
+ * Description:
+ *  Move every train of the pool of the given type which is outside the
+ *  range of its partition in a pool of `nBufs' buffers into a free buffer
+ *  of that range. The trains moved are first copied aside, since their
+ *  buffers may be the only free ones of another partition. The trains of
+ *  each partition must fit its new range, and none moved may be fixed.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR - memory allocation failed; no train is moved
+ */
+static Four edubfm_Relocate(
+    Four                type,                   /* IN buffer type */
+    Four                nBufs,                  /* IN new # of buffers */
+    Four                nOld)                   /* IN # of buffers before */
+{
+    Four                i;                      /* index */
+    Four                j;                      /* index of a free buffer */
+    Four                k;                      /* index of a train moved */
+    Four                p;                      /* partition number */
+    Four                first;                  /* first buffer of the partition */
+    Four                n;                      /* # of buffers of the partition */
+    Four                nMoved;                 /* # of trains moved */
+    BufferTable         *entries;               /* buffer table entries of the trains moved */
+    char                *copy;                  /* copy of the trains moved */
+    Four                next[MAXNUMOFPARTITIONS];       /* next buffer to try in each partition */
+    size_t              trainSize;              /* size of a train in bytes */
+
+
+    trainSize = (size_t)PAGESIZE * BI_BUFSIZE(type);
+
+    nMoved = 0;
+    for (i = 0; i < nOld; i++) {
+        if (IS_NILBFMHASHKEY(BI_KEY(type, i))) continue;
+
+        edubfm_PartitionRange(nBufs, BI_NPARTITIONS(type), BI_PARTITIONOFKEY(type, &BI_KEY(type, i)), &first, &n);
+        if (i < first || i >= first + n) nMoved++;
+    }
+    if (nMoved == 0) return(eNOERROR);
+
+    entries = (BufferTable*)malloc(sizeof(BufferTable) * nMoved);
+    copy = (char*)malloc(trainSize * nMoved);
+    if (entries == NULL || copy == NULL) {
+        free(entries);
+        free(copy);
+        ERR(eMEMORYALLOCERR);
+    }
+
+    /*@ take the trains out */
+    k = 0;
+    for (i = 0; i < nOld; i++) {
+        if (IS_NILBFMHASHKEY(BI_KEY(type, i))) continue;
+
+        edubfm_PartitionRange(nBufs, BI_NPARTITIONS(type), BI_PARTITIONOFKEY(type, &BI_KEY(type, i)), &first, &n);
+        if (i >= first && i < first + n) continue;
+
+        entries[k] = bufInfo[type].bufTable[i];
+        entries[k].fixed = BI_FIXED(type, i);   /* they are not in the entry under BFM_LAYOUT_SOA */
+        entries[k].bits = BI_BITS(type, i);
+        memcpy(copy + trainSize * k, BI_BUFFER(type, i), trainSize);
+        k++;
+
+        if (BI_BITS(type, i) & DIRTY) edubfm_MarkClean(type, i);
+        SET_NILBFMHASHKEY(BI_KEY(type, i));
+        BI_BITS(type, i) = ALL_0;
+        BI_NEXTHASHENTRY(type, i) = NIL;
+    }
+
+    /*@ put them into free buffers of their partitions */
+    for (p = 0; p < BI_NPARTITIONS(type); p++) {
+        edubfm_PartitionRange(nBufs, BI_NPARTITIONS(type), p, &first, &n);
+        next[p] = first;
+    }
+
+    for (k = 0; k < nMoved; k++) {
+        p = BI_PARTITIONOFKEY(type, &entries[k].key);
+        edubfm_PartitionRange(nBufs, BI_NPARTITIONS(type), p, &first, &n);
+
+        for (j = next[p]; j < first + n; j++)
+            if (IS_NILBFMHASHKEY(BI_KEY(type, j)) && BI_FIXED(type, j) == 0) break;
+        next[p] = j + 1;
+
+        bufInfo[type].bufTable[j] = entries[k];
+        BI_FIXED(type, j) = entries[k].fixed;
+        BI_BITS(type, j) = entries[k].bits;
+        BI_NEXTHASHENTRY(type, j) = NIL;
+        memcpy(BI_BUFFER(type, j), copy + trainSize * k, trainSize);
+        if (BI_BITS(type, j) & DIRTY) edubfm_MarkDirty(type, j);
+    }
+
+    free(entries);
+    free(copy);
+
+    return(eNOERROR);
+
+} /* edubfm_Relocate() */
@@ -0,0 +1,155 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetAdaptiveSplit.c
+ *
+ * Description :
+ *  Let the buffer pools share a budget of memory adaptively.
+ *
+ * Exports:
+ *  Four EduBfM_SetAdaptiveSplit(Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_SetAdaptiveSplit()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetAdaptiveSplit(Four)
+ *
+ * Description :
+ *  Let the pools of PAGE_BUF and LOT_LEAF_BUF share `budget' pages, moving
+ *  memory at run time to the pool which saves more misses with it, as told
+ *  by a ghost list of the trains each pool evicted last (see
+ *  edubfm_Adapt()). The budget is first split in proportion to the
+ *  current sizes of the pools, and each pool is moved to an arena in which
+ *  it can grow in place. If `budget' is 0, the adaptive split is stopped
+ *  and the pools keep their sizes.
+ *
+ *  No train may be fixed, and no other thread may use the pools during the
+ *  call; background cleaners are paused.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad budget
+ *    eFLUSHFIXEDBUF_BFM - some train in a pool is fixed
+ *    eMEMORYALLOCERR - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four EduBfM_SetAdaptiveSplit(
+    Four                budget)                 /* IN # of pages shared by the pools; 0 to stop */
+{
+    Four                e;                      /* error */
+    Four                type;                   /* buffer type */
+    Four                unit;                   /* # of pages which both pools can move */
+    Four                pages[NUM_BUF_TYPES];   /* # of pages of each pool */
+    Four                nBufs[NUM_BUF_TYPES];   /* new # of buffers of each pool */
+
+
+    /*@ check if the parameters are valid. */
+    unit = BI_BUFSIZE(PAGE_BUF) * BI_BUFSIZE(LOT_LEAF_BUF);
+    if (budget < 0 || (budget > 0 && budget < BFM_ADAPT_STEPDIV * unit)) ERR(eBADPARAMETER);
+    if (budget > BFM_MAXNBUFS * BI_BUFSIZE(PAGE_BUF) + BFM_MAXNBUFS * BI_BUFSIZE(LOT_LEAF_BUF))
+        ERR(eBADPARAMETER);
+
+    BFM_GETLATCH(&bufAdapt.adaptLatch);
+
+    edubfm_StopAdapt();
+    for (type = 0; type < NUM_BUF_TYPES; type++)
+        bufArena[type].keep = FALSE;
+
+    if (budget == 0) {
+        BFM_RELEASELATCH(&bufAdapt.adaptLatch);
+        return(eNOERROR);
+    }
+
+    /*@ split the budget in proportion to the current sizes */
+    for (type = 0; type < NUM_BUF_TYPES; type++)
+        pages[type] = BI_NBUFS(type) * BI_BUFSIZE(type);
+    nBufs[PAGE_BUF] = (Four)((double)budget * pages[PAGE_BUF] / (pages[PAGE_BUF] + pages[LOT_LEAF_BUF])) / BI_BUFSIZE(PAGE_BUF);
+    if (nBufs[PAGE_BUF] * BI_BUFSIZE(PAGE_BUF) < budget / BFM_ADAPT_MINDIV)
+        nBufs[PAGE_BUF] = budget / BFM_ADAPT_MINDIV / BI_BUFSIZE(PAGE_BUF);
+    if (nBufs[PAGE_BUF] > BFM_MAXNBUFS) nBufs[PAGE_BUF] = BFM_MAXNBUFS;
+    nBufs[LOT_LEAF_BUF] = (budget - nBufs[PAGE_BUF] * BI_BUFSIZE(PAGE_BUF)) / BI_BUFSIZE(LOT_LEAF_BUF);
+    if (nBufs[LOT_LEAF_BUF] * BI_BUFSIZE(LOT_LEAF_BUF) < budget / BFM_ADAPT_MINDIV) {
+        nBufs[LOT_LEAF_BUF] = budget / BFM_ADAPT_MINDIV / BI_BUFSIZE(LOT_LEAF_BUF);
+        nBufs[PAGE_BUF] = (budget - nBufs[LOT_LEAF_BUF] * BI_BUFSIZE(LOT_LEAF_BUF)) / BI_BUFSIZE(PAGE_BUF);
+    }
+    if (nBufs[LOT_LEAF_BUF] > BFM_MAXNBUFS) nBufs[LOT_LEAF_BUF] = BFM_MAXNBUFS;
+
+    /*@ let the pools grow in place */
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        BFM_GETLATCH(BI_CLEANERLATCH(type));
+        e = edubfm_ReserveArena(type, TRUE);
+        BFM_RELEASELATCH(BI_CLEANERLATCH(type));
+        if (e < eNOERROR) ERRL(e, &bufAdapt.adaptLatch);
+    }
+
+    /*@ resize the pools, the one shrinking first */
+    type = (nBufs[PAGE_BUF] < BI_NBUFS(PAGE_BUF)) ? PAGE_BUF : LOT_LEAF_BUF;
+    e = EduBfM_Resize(type, nBufs[type]);
+    if (e >= eNOERROR) {
+        type = (type == PAGE_BUF) ? LOT_LEAF_BUF : PAGE_BUF;
+        e = EduBfM_Resize(type, nBufs[type]);
+    }
+    if (e < eNOERROR) ERRL(e, &bufAdapt.adaptLatch);
+
+    e = edubfm_StartAdapt(budget);
+    if (e < eNOERROR) ERRL(e, &bufAdapt.adaptLatch);
+
+    BFM_RELEASELATCH(&bufAdapt.adaptLatch);
+
+    return(eNOERROR);
+
+}  /* EduBfM_SetAdaptiveSplit() */
@@ -0,0 +1,100 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetAsyncIO.c
+ *
+ * Description :
+ *  Start or stop the asynchronous I/O engine.
+ *
+ * Exports:
+ *  Four EduBfM_SetAsyncIO(Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_SetAsyncIO()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetAsyncIO(Four)
+ *
+ * Description :
+ *  Run the asynchronous I/O engine with `nWorkers' worker threads, which
+ *  execute the reads of EduBfM_GetTrainAsync() and the writes of
+ *  EduBfM_FlushAll(). If `nWorkers' is 0, the engine is stopped after the
+ *  queued requests are completed, and the requests are executed by the
+ *  callers. The engine must be stopped before the volume is dismounted.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad number of worker threads
+ *    some errors caused by function calls
+ */
+Four EduBfM_SetAsyncIO(
+    Four                nWorkers)               /* IN # of worker threads, 0 to stop */
+{
+    Four                e;                      /* error */
+
+
+    /*@ check if the parameters are valid. */
+    if (nWorkers < 0 || nWorkers > MAXNUMOFIOWORKERS) ERR(eBADPARAMETER);
+
+    if (nWorkers == 0)
+        e = edubfm_StopIOEngine();
+    else
+        e = edubfm_StartIOEngine(nWorkers);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+}  /* EduBfM_SetAsyncIO() */
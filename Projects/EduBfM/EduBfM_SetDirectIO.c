@@ -0,0 +1,211 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetDirectIO.c
+ *
+ * Description :
+ *  Read and write the trains of a volume by direct I/O, bypassing the page
+ *  cache of the operating system.
+ *
+ * Exports:
+ *  Four EduBfM_SetDirectIO(Four, Four, char **)
+ */
+
+
+#define _GNU_SOURCE /* for O_DIRECT */
+#include <stdlib.h> /* for free */
+#include <fcntl.h> /* for open */
+#include <unistd.h> /* for close */
+#include <sys/stat.h> /* for fstat */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+#include "EduRDsM.h"
+
+
+
+/*@================================
+ * EduBfM_SetDirectIO()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetDirectIO(Four, Four, char **)
+ *
+ * Description :
+ *  Read and write the trains of the mounted volume `volNo' by direct I/O on
+ *  its `nDevices' devices `devNames', given in the order given to its
+ *  format, so that the trains cached by the pools are not cached again by
+ *  the operating system and a flush is done when the write returns. The
+ *  pools are moved to arenas first if their buffers are not aligned (see
+ *  edubfm_ReserveArena()), and the runs of trains are staged in aligned
+ *  buffers; the other transfers are copied through a bounce buffer.
+ *  If `nDevices' is 0, the trains of the volume are read and written by
+ *  EduRDsM again, and when no volume is left, the pools moved to arenas only
+ *  for direct I/O get the buffers of the storage system back, discarding
+ *  their trains. Call it with 0 before the volume is dismounted.
+ *  The pages read and written by RDsM itself, and the trains of the BfM of
+ *  the storage system, still go through the page cache.
+ *
+ *  No train may be fixed, and no other thread may use the pools during the
+ *  call; background cleaners are paused.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad devices, the file system does not support direct
+ *                    I/O, the volume is already (not) accessed by direct
+ *                    I/O, or too many volumes are
+ *    eFLUSHFIXEDBUF_BFM - some train in a pool is fixed; the pool stays
+ *                         where it is and its transfers are copied
+ *    eMEMORYALLOCERR - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four EduBfM_SetDirectIO(
+    Four                volNo,                  /* IN volume */
+    Four                nDevices,               /* IN # of devices of the volume; 0 to stop */
+    char                **devNames)             /* IN devices of the volume */
+{
+    Four                e;                      /* for error */
+    Four                i;                      /* index */
+    Four                d;                      /* device */
+    Four                type;                   /* buffer type */
+    Four                maxBufSize;             /* # of pages of the largest train */
+    Two                 extSize;                /* # of pages of an extent of the volume */
+    struct stat         st;                     /* status of a device */
+    BfMDirectVolume     *v;                     /* entry of the volume */
+    BfMDirectVolume     *empty;                 /* free entry */
+
+
+    /*@ check if the parameters are valid. */
+    if (nDevices < 0 || nDevices > MAXNUMOFMAPPEDDEVICES || (nDevices > 0 && devNames == NULL))
+        ERR(eBADPARAMETER);
+
+    BFM_GETLATCH(&bufDirect.latch);
+
+    v = empty = NULL;
+    for (i = 0; i < MAXNUMOFMAPPEDVOLUMES; i++) {
+        if (bufDirect.volumes[i].nDevices > 0 && bufDirect.volumes[i].volNo == volNo) v = &bufDirect.volumes[i];
+        if (bufDirect.volumes[i].nDevices == 0 && empty == NULL) empty = &bufDirect.volumes[i];
+    }
+
+    /*@ stop direct I/O on the volume */
+    if (nDevices == 0) {
+        if (v == NULL) ERRL(eBADPARAMETER, &bufDirect.latch);
+
+        for (d = 0; d < v->nDevices; d++) close(v->fd[d]);
+        v->nDevices = 0;
+        if (--bufDirect.nVolumes == 0) {
+            free(bufDirect.bounce);
+            bufDirect.bounce = NULL;
+            bufDirect.bounceSize = 0;
+        }
+
+        BFM_RELEASELATCH(&bufDirect.latch);
+
+        /*@ give the buffers of the storage system back */
+        if (bufDirect.nVolumes == 0) {
+            for (type = 0; type < NUM_BUF_TYPES; type++) {
+                if (bufArena[type].base == NULL || bufArena[type].flags != 0 || bufArena[type].keep ||
+                    BI_NBUFS(type) > bufArena[type].origNBufs) continue;
+                e = EduBfM_SetPoolAllocation(type, 0);
+                if (e < eNOERROR) ERR(e);
+            }
+        }
+
+        return(eNOERROR);
+    }
+
+    if (v != NULL || empty == NULL) ERRL(eBADPARAMETER, &bufDirect.latch);
+    v = empty;
+
+    e = EduRDsM_GetSizeOfExt(volNo, &extSize);
+    if (e < eNOERROR) ERRL(e, &bufDirect.latch);
+
+    /*@ open the devices */
+    v->firstPage[0] = 0;
+    for (d = 0; d < nDevices; d++) {
+        v->fd[d] = (devNames[d] == NULL) ? -1 : open(devNames[d], O_RDWR | O_DIRECT);
+        if (v->fd[d] < 0 || fstat(v->fd[d], &st) != 0 || st.st_size < PAGESIZE) {
+            if (v->fd[d] >= 0) close(v->fd[d]);
+            for (i = 0; i < d; i++) close(v->fd[i]);
+            ERRL(eBADPARAMETER, &bufDirect.latch);
+        }
+        /* a device numbers only its whole extents */
+        v->firstPage[d + 1] = v->firstPage[d] + (st.st_size / PAGESIZE) / extSize * extSize;
+    }
+
+    /*@ allocate the bounce buffer, which holds the longest run */
+    if (bufDirect.bounce == NULL) {
+        maxBufSize = 0;
+        for (type = 0; type < NUM_BUF_TYPES; type++)
+            if (BI_BUFSIZE(type) > maxBufSize) maxBufSize = BI_BUFSIZE(type);
+        bufDirect.bounce = edubfm_AllocIOBuffer(maxBufSize * BFM_FLUSH_MAXRUN);
+        if (bufDirect.bounce == NULL) {
+            for (d = 0; d < nDevices; d++) close(v->fd[d]);
+            ERRL(eMEMORYALLOCERR, &bufDirect.latch);
+        }
+        bufDirect.bounceSize = (size_t)maxBufSize * BFM_FLUSH_MAXRUN * PAGESIZE;
+    }
+
+    v->volNo = volNo;
+    v->nDevices = nDevices;
+    bufDirect.nVolumes++;
+
+    BFM_RELEASELATCH(&bufDirect.latch);
+
+    /*@ align the buffers of the pools */
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        if ((size_t)BI_BUFFERPOOL(type) % BFM_DIRECTIO_ALIGN == 0) continue;
+
+        BFM_GETLATCH(BI_CLEANERLATCH(type));
+        e = edubfm_ReserveArena(type, bufArena[type].keep);
+        BFM_RELEASELATCH(BI_CLEANERLATCH(type));
+        if (e < eNOERROR) ERR(e);
+    }
+
+    return(eNOERROR);
+
+}  /* EduBfM_SetDirectIO() */
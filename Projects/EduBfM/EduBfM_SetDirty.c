@@ -78,6 +78,10 @@
  *  Set the dirty bit of an entry in the buffer table.
  *  Look up the entry in the using given parameters and set the dirty
  *  bit of the entry.
+ *  When the train becomes dirty, the copy kept by the secondary cache of
+ *  the pool, if any, is dropped since it no longer equals the train.
+ *  Nothing is done for the train of a volume mapped by EduBfM_MapVolume(),
+ *  which is read-only.
  * 
  * Returns:
  *  error code
@@ -90,15 +94,28 @@ Four EduBfM_SetDirty(
 {
 	/* These local variables are used in the solution code. However, you don¡¯t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four                index;                  /* an index of the buffer table & pool */
+    pthread_mutex_t     *latch;                 /* latch of the partition holding the train */
 	
 	
     /*@ Is the paramter valid? */
     if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
 
 	/* NEWCODE */
+	if(bufMapped.nMapped > 0 && edubfm_MappedTrain(trainId, type) != NULL)
+		return( eNOERROR );	//a mapped volume is read-only.
+
+	latch = BI_PARTLATCH(type, BI_PARTITIONOFKEY(type, trainId));
+	BFM_GETLATCH(latch);
+
 	index = edubfm_LookUp(trainId, type);
-	if(index == NOTFOUND_IN_HTABLE) ERR(eNOTFOUND_BFM);
-	bufInfo[type].bufTable[index].bits = bufInfo[type].bufTable[index].bits | DIRTY;
+	if(index == NOTFOUND_IN_HTABLE) ERRL(eNOTFOUND_BFM, latch);
+	if((BI_BITS(type, index) & DIRTY) == 0 && bufSecondaryCache[type].nSlots > 0)
+		edubfm_SecondaryDrop(type, trainId);	//the copy on the local disk becomes stale.
+	BI_BITS(type, index) |= DIRTY;
+	BI_BITS(type, index) &= ~CLEANING;	//the copy being written back is stale.
+	edubfm_MarkDirty(type, index);	//for the flush of the dirty buffers only.
+
+	BFM_RELEASELATCH(latch);
 	/* ENDOFNEWCODE */
 
     return( eNOERROR );
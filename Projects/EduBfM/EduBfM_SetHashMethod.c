@@ -0,0 +1,125 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetHashMethod.c
+ *
+ * Description :
+ *  Select the hash table used to look up trains in a buffer pool.
+ *
+ * Exports:
+ *  Four EduBfM_SetHashMethod(Four, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_SetHashMethod()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetHashMethod(Four, Four)
+ *
+ * Description :
+ *  Select the hash table of the buffer pool of the given type.
+ *   BFM_HASH_CHAINED - the hash table holds the head of a chain linked
+ *                      through BufferTable.nextHashEntry (default)
+ *   BFM_HASH_OPEN    - an open addressing table whose cache line sized
+ *                      buckets hold both the keys and the buffer indexes
+ *  If the pool is partitioned, every partition gets a table of its own.
+ *
+ *  The dirty trains in the pool are flushed and all trains are discarded
+ *  before the tables are rebuilt. No train may be fixed, and no other
+ *  thread may use the pool during the call; a background cleaner is paused.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER - bad hash method
+ *    eFLUSHFIXEDBUF_BFM - some train in the pool is fixed
+ *    some errors caused by function calls
+ */
+Four EduBfM_SetHashMethod(
+    Four                type,                   /* IN buffer type */
+    Four                method)                 /* IN hash method */
+{
+    Four                e;                      /* error */
+    Four                nPartitions;            /* # of partitions of the pool */
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (method != BFM_HASH_CHAINED && method != BFM_HASH_OPEN) ERR(eBADPARAMETER);
+
+    /*@ keep the background cleaner away while the pool is rebuilt */
+    BFM_GETLATCH(BI_CLEANERLATCH(type));
+
+    /*@ empty the pool under the current hash tables */
+    e = edubfm_EmptyPool(type);
+    if (e < eNOERROR) ERRL(e, BI_CLEANERLATCH(type));
+
+    /*@ rebuild the hash tables */
+    nPartitions = bufPartInfo[type].nPartitions;
+    BI_HASHMETHOD(type) = method;
+
+    e = edubfm_InitPartitions(type, nPartitions);
+    if (e < eNOERROR) {
+        /* fall back to the chained hash table which needs no extra memory */
+        BI_HASHMETHOD(type) = BFM_HASH_CHAINED;
+        edubfm_InitPartitions(type, 0);
+        ERRL(e, BI_CLEANERLATCH(type));
+    }
+
+    BFM_RELEASELATCH(BI_CLEANERLATCH(type));
+
+    return(eNOERROR);
+
+}  /* EduBfM_SetHashMethod() */
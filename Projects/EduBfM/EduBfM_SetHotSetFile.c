@@ -0,0 +1,103 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetHotSetFile.c
+ *
+ * Description :
+ *  Select the file to which the trains resident in the pools are saved.
+ *
+ * Exports:
+ *  Four EduBfM_SetHotSetFile(char *)
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include <string.h> /* for strlen & strcpy */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_SetHotSetFile()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetHotSetFile(char *)
+ *
+ * Description :
+ *  From now on, let every EduBfM_FlushAll() save the keys of the trains
+ *  resident in the pools, with their hotness, to the file `path' (see
+ *  edubfm_SaveHotSet()). Call EduBfM_FlushAll() before the volumes are
+ *  dismounted, and EduBfM_WarmUp() with the same file after the next
+ *  mount to load the hottest trains again. If `path' is NULL, the hot set
+ *  is not saved any more.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR - memory allocation failed
+ */
+Four EduBfM_SetHotSetFile(
+    char                *path)                  /* IN file of the hot set; NULL to stop saving it */
+{
+    char                *copy;                  /* copy of the path */
+
+
+    copy = NULL;
+    if (path != NULL) {
+        copy = (char*)malloc(strlen(path) + 1);
+        if (copy == NULL) ERR(eMEMORYALLOCERR);
+        strcpy(copy, path);
+    }
+
+    if (edubfm_hotSetFile != NULL) free(edubfm_hotSetFile);
+    edubfm_hotSetFile = copy;
+
+    return(eNOERROR);
+
+}  /* EduBfM_SetHotSetFile() */
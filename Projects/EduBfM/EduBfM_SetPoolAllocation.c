@@ -0,0 +1,138 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetPoolAllocation.c
+ *
+ * Description :
+ *  Select the memory holding the buffers of a buffer pool.
+ *
+ * Exports:
+ *  Four EduBfM_SetPoolAllocation(Four, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_SetPoolAllocation()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetPoolAllocation(Four, Four)
+ *
+ * Description :
+ *  Move the buffers of the pool of the given type to memory allocated
+ *  according to `flags':
+ *   BFM_ALLOC_HUGEPAGE      - huge pages (1 GB or 2 MB hugetlb pages, else
+ *                             transparent huge pages), to save TLB misses
+ *   BFM_ALLOC_INTERLEAVE    - pages interleaved over all NUMA nodes
+ *   BFM_ALLOC_BINDPARTITION - the buffers of partition p bound to NUMA
+ *                             node p % #nodes, also after the partitions
+ *                             are changed
+ *  If `flags' is 0, the buffers allocated by the storage system are used
+ *  again; this must be done before the storage system is finalized, since
+ *  it frees its own buffers. While direct I/O is on (see
+ *  EduBfM_SetDirectIO()), an arena of base pages is used instead, since
+ *  the buffers of the storage system are not aligned. A pool grown by EduBfM_Resize() beyond the
+ *  buffers of the storage system keeps its size in memory of base pages,
+ *  and is to be resized back before the storage system is finalized.
+ *
+ *  The dirty trains in the pool are flushed and all trains are discarded
+ *  before the buffers are moved. No train may be fixed, and no other
+ *  thread may use the pool during the call; a background cleaner is paused.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER - bad flags
+ *    eFLUSHFIXEDBUF_BFM - some train in the pool is fixed
+ *    eMEMORYALLOCERR - the memory cannot be allocated; the buffers of the
+ *                      storage system are used, and a grown pool is cut
+ *                      to them
+ *    some errors caused by function calls
+ */
+Four EduBfM_SetPoolAllocation(
+    Four                type,                   /* IN buffer type */
+    Four                flags)                  /* IN BFM_ALLOC_xxx */
+{
+    Four                e;                      /* error */
+    Four                nBufs;                  /* # of buffers of the pool */
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (flags & ~(BFM_ALLOC_HUGEPAGE | BFM_ALLOC_INTERLEAVE | BFM_ALLOC_BINDPARTITION)) ERR(eBADPARAMETER);
+    if ((flags & BFM_ALLOC_INTERLEAVE) && (flags & BFM_ALLOC_BINDPARTITION)) ERR(eBADPARAMETER);
+
+    /*@ keep the background cleaner away while the pool is rebuilt */
+    BFM_GETLATCH(BI_CLEANERLATCH(type));
+
+    e = edubfm_EmptyPool(type);
+    if (e < eNOERROR) ERRL(e, BI_CLEANERLATCH(type));
+
+    /*@ move the buffers */
+    nBufs = BI_NBUFS(type);
+    e = edubfm_FreeArena(type);
+    if (e >= eNOERROR && (flags != 0 || nBufs > edubfm_ArenaCapacity(type) || bufDirect.nVolumes > 0)) {
+        e = edubfm_AllocArena(type, flags, (nBufs > edubfm_ArenaCapacity(type)) ? BFM_MAXNBUFS : edubfm_ArenaCapacity(type));
+        if (e >= eNOERROR) BI_NBUFS(type) = nBufs;
+    }
+
+    /*@ rebuild the hash tables and bind the partitions */
+    if (e >= eNOERROR) e = edubfm_InitPartitions(type, bufPartInfo[type].nPartitions);
+    else edubfm_InitPartitions(type, bufPartInfo[type].nPartitions);
+    if (e < eNOERROR) ERRL(e, BI_CLEANERLATCH(type));
+
+    BFM_RELEASELATCH(BI_CLEANERLATCH(type));
+
+    return(eNOERROR);
+
+}  /* EduBfM_SetPoolAllocation() */
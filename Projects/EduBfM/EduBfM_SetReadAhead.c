@@ -0,0 +1,118 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetReadAhead.c
+ *
+ * Description :
+ *  Enable or disable the sequential read-ahead of a buffer pool.
+ *
+ * Exports:
+ *  Four EduBfM_SetReadAhead(Four, Four, BfMNextTrainFunc)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_SetReadAhead()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetReadAhead(Four, Four, BfMNextTrainFunc)
+ *
+ * Description :
+ *  Read up to `maxK' trains ahead of the scans along the page chains of
+ *  the buffer pool of the given type. `nextTrain' gives the train
+ *  following a fixed train, e.g. the header.nextPage of a slotted page for
+ *  the scans of EduOM_NextObject(). A scan is detected when EduBfM_GetTrain()
+ *  fixes two trains in a row along a chain; the number of trains read
+ *  ahead of it adapts to its speed between 1 and `maxK'.
+ *  The reads are done by the asynchronous I/O engine, so the read-ahead
+ *  has no effect unless EduBfM_SetAsyncIO() has started its workers.
+ *  If `maxK' is 0, the read-ahead is disabled.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER - bad number of trains or no `nextTrain'
+ */
+Four EduBfM_SetReadAhead(
+    Four                type,                   /* IN buffer type */
+    Four                maxK,                   /* IN max # of trains read ahead, 0 to disable */
+    BfMNextTrainFunc    nextTrain)              /* IN gives the next train of a page chain */
+{
+    BfMReadAhead        *ra;                    /* read-ahead of the pool */
+    Four                i;                      /* index */
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (maxK < 0 || maxK >= BI_NBUFS(type)) ERR(eBADPARAMETER);
+    if (maxK > 0 && nextTrain == NULL) ERR(eBADPARAMETER);
+
+    ra = &bufReadAhead[type];
+
+    BFM_GETLATCH(&ra->latch);
+
+    ra->maxK = maxK;
+    ra->curK = (maxK < BFM_RA_INITIALK) ? maxK : BFM_RA_INITIALK;
+    if (nextTrain != NULL) ra->nextTrain = nextTrain;
+    ra->clock = 0;
+    for (i = 0; i < BFM_RA_NSTREAMS; i++) {
+        ra->streams[i].run = 0;
+        ra->streams[i].lastUsed = 0;
+    }
+
+    BFM_RELEASELATCH(&ra->latch);
+
+    return(eNOERROR);
+
+}  /* EduBfM_SetReadAhead() */
@@ -0,0 +1,130 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetReplacementPolicy.c
+ *
+ * Description :
+ *  Select the buffer replacement policy of a buffer pool.
+ *
+ * Exports:
+ *  Four EduBfM_SetReplacementPolicy(Four, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_SetReplacementPolicy()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetReplacementPolicy(Four, Four)
+ *
+ * Description :
+ *  Select the policy choosing the victim of the buffer pool of the given type.
+ *   BFM_POLICY_CLOCK - second chance algorithm (default)
+ *   BFM_POLICY_LRUK  - LRU-2 with retained history of evicted trains
+ *   BFM_POLICY_2Q    - 2Q with A1in, A1out and Am queues
+ *   BFM_POLICY_ARC   - adaptive replacement cache
+ *   BFM_POLICY_CLEANFIRST - second chance algorithm which passes over up
+ *                      to BFM_CLEANFIRST_LOOKAHEAD dirty candidates to find
+ *                      a clean victim, leaving their write-back to the
+ *                      background cleaner (see edubfm_CleanFirstSweep())
+ *  If the pool is partitioned, every partition runs the policy on its own
+ *  buffers.
+ *
+ *  The dirty trains in the pool are flushed and all trains are discarded
+ *  before the policy is changed. No train may be fixed, and no other
+ *  thread may use the pool during the call; a background cleaner is paused.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER - bad replacement policy
+ *    eFLUSHFIXEDBUF_BFM - some train in the pool is fixed
+ *    some errors caused by function calls
+ */
+Four EduBfM_SetReplacementPolicy(
+    Four                type,                   /* IN buffer type */
+    Four                policy)                 /* IN replacement policy */
+{
+    Four                e;                      /* error */
+    Four                nPartitions;            /* # of partitions of the pool */
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (policy < 0 || policy >= BFM_NUM_POLICIES) ERR(eBADPARAMETER);
+
+    /*@ keep the background cleaner away while the pool is rebuilt */
+    BFM_GETLATCH(BI_CLEANERLATCH(type));
+
+    /*@ empty the pool under the current policy */
+    e = edubfm_EmptyPool(type);
+    if (e < eNOERROR) ERRL(e, BI_CLEANERLATCH(type));
+
+    /*@ rebuild the pool with the states of the new policy */
+    nPartitions = bufPartInfo[type].nPartitions;
+    BI_POLICY(type) = policy;
+
+    e = edubfm_InitPartitions(type, nPartitions);
+    if (e < eNOERROR) {
+        /* fall back to the clock which needs no extra memory */
+        BI_POLICY(type) = BFM_POLICY_CLOCK;
+        edubfm_InitPartitions(type, nPartitions);
+        ERRL(e, BI_CLEANERLATCH(type));
+    }
+
+    BFM_RELEASELATCH(BI_CLEANERLATCH(type));
+
+    return(eNOERROR);
+
+}  /* EduBfM_SetReplacementPolicy() */
@@ -0,0 +1,108 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetSecondaryCache.c
+ *
+ * Description :
+ *  Enable or disable the secondary cache of a buffer pool on a local disk.
+ *
+ * Exports:
+ *  Four EduBfM_SetSecondaryCache(Four, char *, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_SetSecondaryCache()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetSecondaryCache(Four, char *, Four)
+ *
+ * Description :
+ *  Keep a copy of the clean trains evicted from the buffer pool of the
+ *  given type in a file of `nTrains' trains created at `path', which
+ *  should be on a disk faster than the volumes, e.g. a local SSD when the
+ *  volumes are on network storage. A later miss on such a train reads the
+ *  file instead of the volume. An existing file at `path' is overwritten,
+ *  and the file is removed from the directory at once. If `nTrains' is 0,
+ *  the cache is disabled and its file is closed. Any copy kept so far is
+ *  dropped.
+ *  The hit rate and the bytes not read from the volumes are reported by
+ *  EduBfM_GetStats() and EduBfM_DumpStats(). The trains modified through
+ *  the BfM of the storage system do not drop their copies, so the cache
+ *  should be used only while the pool is used through EduBfM.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER - bad path or size, or the file cannot be created
+ *    some errors caused by function calls
+ */
+Four EduBfM_SetSecondaryCache(
+    Four                type,                   /* IN buffer type */
+    char                *path,                  /* IN file of the cache */
+    Four                nTrains)                /* IN # of trains of the file; 0 to disable */
+{
+    Four                e;                      /* error */
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (nTrains < 0 || (nTrains > 0 && path == NULL)) ERR(eBADPARAMETER);
+
+    e = edubfm_InitSecondaryCache(type, path, nTrains);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+}  /* EduBfM_SetSecondaryCache() */
@@ -0,0 +1,130 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetTableLayout.c
+ *
+ * Description :
+ *  Select where the fixed counts and bits of a buffer pool are kept.
+ *
+ * Exports:
+ *  Four EduBfM_SetTableLayout(Four, Four)
+ */
+
+
+#include <string.h> /* for memset */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_SetTableLayout()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetTableLayout(Four, Four)
+ *
+ * Description :
+ *  Select the layout of the buffer table of the given type.
+ *   BFM_LAYOUT_AOS - the fixed count and the bits of a buffer are fields of
+ *                    its BufferTable entry (default)
+ *   BFM_LAYOUT_SOA - they are kept in the dense arrays of
+ *                    bufStateArrays[type], and the clock examines a vector
+ *                    of buffers at a time (see edubfm_ClockSweep())
+ *  The keys and hash chains stay in the BufferTable entries.
+ *
+ *  The dirty trains in the pool are flushed and all trains are discarded
+ *  before the layout is changed. No train may be fixed, and no other
+ *  thread may use the pool during the call; a background cleaner is paused.
+ *  The storage system only knows the BufferTable entries, so the default
+ *  layout must be selected again before the volume is dismounted.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER - bad layout
+ *    eFLUSHFIXEDBUF_BFM - some train in the pool is fixed
+ *    some errors caused by function calls
+ */
+Four EduBfM_SetTableLayout(
+    Four                type,                   /* IN buffer type */
+    Four                layout)                 /* IN layout of the buffer table */
+{
+    Four                e;                      /* error */
+    Four                i;                      /* index */
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (layout != BFM_LAYOUT_AOS && layout != BFM_LAYOUT_SOA) ERR(eBADPARAMETER);
+
+    /*@ keep the background cleaner away while the pool is rebuilt */
+    BFM_GETLATCH(BI_CLEANERLATCH(type));
+
+    /*@ empty the pool under the current layout */
+    e = edubfm_EmptyPool(type);
+    if (e < eNOERROR) ERRL(e, BI_CLEANERLATCH(type));
+
+    /*@ no buffer is fixed or holds a train in either layout */
+    for (i = 0; i < BI_NBUFS(type); i++) {
+        bufInfo[type].bufTable[i].fixed = 0;
+        bufInfo[type].bufTable[i].bits = ALL_0;
+    }
+    memset(bufStateArrays[type].fixed, 0, sizeof(bufStateArrays[type].fixed));
+    memset(bufStateArrays[type].bits, 0, sizeof(bufStateArrays[type].bits));
+    BI_LAYOUT(type) = layout;
+
+    /*@ rebuild the hash tables and the policy states of the empty pool */
+    e = edubfm_InitPartitions(type, bufPartInfo[type].nPartitions);
+    if (e < eNOERROR) ERRL(e, BI_CLEANERLATCH(type));
+
+    BFM_RELEASELATCH(BI_CLEANERLATCH(type));
+
+    return(eNOERROR);
+
+}  /* EduBfM_SetTableLayout() */
@@ -55,11 +55,2293 @@
 
 
 #include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "EduBfM_common.h"
+#include "EduBfM.h"
 #include "EduBfM_Internal.h"
+#include "EduRDsM.h"
 #include "EduBfM_TestModule.h"
 
 
+/*@
+ * macro definitions
+ */
+/* # of pages allocated for the checks of the extensions of EduBfM */
+#define NUM_CHECK_PAGES 60
+
+/* volume of EduRDsM made by the checks which need a file-backed volume */
+#define CHECK_VOLUME "check.vol"
+
+/* hot set file saved by the checks of EduBfM_WarmUp() */
+#define CHECK_HOTSET "check.hot"
+
+/* file of the secondary cache of the checks */
+#define CHECK_SECONDARY "check.l2"
+
+/* # of trains of the batch of the checks of EduBfM_GetTrains() */
+#define NUM_BATCH_TRAINS 10
+
+/* # of pages allocated by the cursor of the checks, and # of pages of its runs */
+#define NUM_CURSOR_PAGES 10
+#define NUM_CURSOR_RUN 8
+
+/* Macro: CHECK(cond, what)
+ * Description: report the check `what' as failed and return from the
+ *              calling function unless `cond' holds
+ */
+#define CHECK(cond, what) do { if (!(cond)) { printf("%s failed!!!\n", what); return(eBADPARAMETER); } } while (0)
+
+
+/*@
+ * global variables
+ */
+/* pages used by the checks; page i has the flags i and the counter 0 */
+static PageID checkPids[NUM_CHECK_PAGES];
+
+
+/*@
+ * internal function prototypes
+ */
+static Four edubfm_CheckExtensions(Four);
+static Four check_AllocPages(Four);
+static Four check_Page(Four, Four);
+static Four check_Reset(void);
+static Four check_Partitions(void);
+static void *check_PartitionsMain(void *);
+static Four check_OpenHash(void);
+static Four check_Policies(void);
+static Four check_Stats(void);
+static Four check_Cleaner(void);
+static Four check_RunCleaner(PageID *, Four);
+static Four check_AsyncIO(void);
+static Four check_ReadAhead(void);
+static void check_NextTrain(TrainID *, char *, TrainID *);
+static Four check_SortedFlush(void);
+static Four check_SetCounters(Four, Four, Four);
+static Four check_DirtyFlush(void);
+static Four check_DirtyMap(Four *);
+static Four check_Strategies(void);
+static Four check_PoolAllocation(void);
+static Four check_Resize(void);
+static Four check_AdaptiveSplit(void);
+static Four check_HotSet(void);
+static Four check_BatchTrains(void);
+static Four check_NumFixed(void);
+static Four check_FreeList(void);
+static Four check_Invalidate(void);
+static Four check_TableLayout(void);
+static Four check_CleanFirst(void);
+static Four check_VictimCache(void);
+static Four check_SecondaryCache(void);
+static Four check_MakeVolume(Four *, PageID *, Four);
+static Four check_DropVolume(Four);
+static Four check_MapVolume(void);
+static Four check_DirectIO(void);
+static Four check_EduRDsM(void);
+static Four check_AllocCursor(void);
+
+
+
+/*@================================
+ * check_AllocPages()
+ *================================*/
+/*
+ * Function: static Four check_AllocPages(Four)
+ *
+ * Description :
+ *  Allocate the pages of the checks and write the flags i and the counter
+ *  0 into page i.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_AllocPages(Four volId)
+{
+	Four	e;									/* for errors */
+	Four	i;									/* loop index */
+	Four	firstExtNo;							/* first extent number */
+	PageID	nearPid;							/* near pageID */
+	Page	*apage;								/* pointer to buffer holding a page */
+
+	e = RDsM_CreateSegment(volId, &firstExtNo);
+	if (e < eNOERROR) ERR(e);
+	e = RDsM_ExtNoToPageId(volId, firstExtNo, &nearPid);
+	if (e < eNOERROR) ERR(e);
+
+	for (i = 0; i < NUM_CHECK_PAGES; i++){
+		e = RDsM_AllocTrains(volId, firstExtNo, &nearPid, 100, 1, PAGESIZE2, &checkPids[i]);
+		if (e < eNOERROR) ERR(e);
+
+		e = EduBfM_GetTrain(&checkPids[i], (char **)&apage, PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		memset(apage, 0, PAGESIZE);
+		apage->header.pid = checkPids[i];
+		apage->header.flags = i;
+		e = EduBfM_SetDirty(&checkPids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_FreeTrain(&checkPids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_Page()
+ *================================*/
+/*
+ * Function: static Four check_Page(Four, Four)
+ *
+ * Description :
+ *  Fix page i of the checks, check that the buffer holds that page with
+ *  the counter `count' (if not negative), and free it.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_Page(Four i, Four count)
+{
+	Four	e;									/* for errors */
+	Page	*apage;								/* pointer to buffer holding a page */
+
+	e = EduBfM_GetTrain(&checkPids[i], (char **)&apage, PAGE_BUF);
+	if (e < eNOERROR) ERR(e);
+	CHECK(apage->header.flags == i && apage->header.pid.pageNo == checkPids[i].pageNo, "Check of the content of a page");
+	CHECK(count < 0 || ((Four *)apage->data)[0] == count, "Check of the counter of a page");
+	e = EduBfM_FreeTrain(&checkPids[i], PAGE_BUF);
+	if (e < eNOERROR) ERR(e);
+
+	return(eNOERROR);
+}
+
+
+
+/*@================================
+ * check_Reset()
+ *================================*/
+/*
+ * Function: static Four check_Reset(void)
+ *
+ * Description :
+ *  Write back the dirty pages, empty the buffer pools and reset the
+ *  statistics, so that the next check starts from an empty pool.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_Reset(void)
+{
+	Four	e;									/* for errors */
+
+	e = EduBfM_FlushAll();
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_DiscardAll();
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_ResetStats();
+	if (e < eNOERROR) ERR(e);
+
+	return(eNOERROR);
+}
+
+
+
+/*@================================
+ * check_PartitionsMain()
+ *================================*/
+/*
+ * Function: static void *check_PartitionsMain(void *)
+ *
+ * Description :
+ *  Body of a thread of check_Partitions(): thread t fixes the first 20
+ *  pages 50 times, incrementing the counters of the pages i with
+ *  i % 2 == t.
+ *
+ * Returns:
+ *  NULL, or the name of the check failed
+ */
+static void *check_PartitionsMain(void *arg)
+{
+	Four	e;									/* for errors */
+	Four	i, k;								/* loop index */
+	Page	*apage;								/* pointer to buffer holding a page */
+
+	for (k = 0; k < 50; k++){
+		for (i = 0; i < 20; i++){
+			e = EduBfM_GetTrain(&checkPids[i], (char **)&apage, PAGE_BUF);
+			if (e < eNOERROR) return((void *)"EduBfM_GetTrain");
+			if (apage->header.flags != i) return((void *)"Check of the content of a page");
+			if (i % 2 == (Four)(long)arg){
+				((Four *)apage->data)[0]++;
+				e = EduBfM_SetDirty(&checkPids[i], PAGE_BUF);
+				if (e < eNOERROR) return((void *)"EduBfM_SetDirty");
+			}
+			e = EduBfM_FreeTrain(&checkPids[i], PAGE_BUF);
+			if (e < eNOERROR) return((void *)"EduBfM_FreeTrain");
+		}
+	}
+
+	return(NULL);
+}
+
+
+
+/*@================================
+ * check_Partitions()
+ *================================*/
+/*
+ * Function: static Four check_Partitions(void)
+ *
+ * Description :
+ *  Check that a partitioned pool keeps each page in the partition of its
+ *  key, and that two threads updating pages through it lose no update.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_Partitions(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Four		index;							/* an index of the buffer table */
+	Page		*apage;							/* pointer to buffer holding a page */
+	pthread_t	threads[2];						/* threads updating the pages */
+	void		*result[2];						/* NULL or the check failed by a thread */
+
+	e = EduBfM_SetNumPartitions(PAGE_BUF, 2);
+	if (e < eNOERROR) ERR(e);
+	CHECK(BI_NPARTITIONS(PAGE_BUF) == 2, "Check of the number of partitions");
+
+	for (i = 0; i < 20; i++){
+		e = EduBfM_GetTrain(&checkPids[i], (char **)&apage, PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		index = edubfm_LookUp(&checkPids[i], PAGE_BUF);
+		CHECK(index != NOTFOUND_IN_HTABLE && BI_BUFFER(PAGE_BUF, index) == (char *)apage, "Check of the hash table of a partition");
+		CHECK(BI_PARTITIONOFBUF(PAGE_BUF, index) == BI_PARTITIONOFKEY(PAGE_BUF, &checkPids[i]), "Check of the partition of a page");
+		e = EduBfM_FreeTrain(&checkPids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	for (i = 0; i < 2; i++)
+		pthread_create(&threads[i], NULL, check_PartitionsMain, (void *)(long)i);
+	for (i = 0; i < 2; i++)
+		pthread_join(threads[i], &result[i]);
+	for (i = 0; i < 2; i++)
+		CHECK(result[i] == NULL, (char *)result[i]);
+
+	e = check_Reset();
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < 20; i++){
+		e = check_Page(i, 50);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	/* restore the counters and the unpartitioned pool */
+	for (i = 0; i < 20; i++){
+		e = EduBfM_GetTrain(&checkPids[i], (char **)&apage, PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		((Four *)apage->data)[0] = 0;
+		e = EduBfM_SetDirty(&checkPids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_FreeTrain(&checkPids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_SetNumPartitions(PAGE_BUF, 0);
+	if (e < eNOERROR) ERR(e);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_OpenHash()
+ *================================*/
+/*
+ * Function: static Four check_OpenHash(void)
+ *
+ * Description :
+ *  Check that the open addressing hash table finds the pages in the pool,
+ *  and only those, while 30 pages go through the 10 buffers, with and
+ *  without partitions. Unpartitioned, the last 10 pages are the ones kept.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_OpenHash(void)
+{
+	Four	e;									/* for errors */
+	Four	i, j;								/* loop index */
+	Four	nParts;								/* # of partitions */
+	Four	nFound;								/* # of pages found in the hash table */
+
+	for (nParts = 0; nParts <= 2; nParts += 2){
+		e = EduBfM_SetNumPartitions(PAGE_BUF, nParts);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_SetHashMethod(PAGE_BUF, BFM_HASH_OPEN);
+		if (e < eNOERROR) ERR(e);
+
+		for (i = 0; i < 30; i++){
+			e = check_Page(i, 0);
+			if (e < eNOERROR) ERR(e);
+		}
+
+		for (nFound = 0, j = 0; j < 30; j++)
+			if (edubfm_LookUp(&checkPids[j], PAGE_BUF) != NOTFOUND_IN_HTABLE) nFound++;
+		CHECK(nFound == NUM_PAGE_BUFS, "Check of the pages found in the open hash table");
+		for (j = 20; j < 30 && nParts == 0; j++)
+			CHECK(edubfm_LookUp(&checkPids[j], PAGE_BUF) != NOTFOUND_IN_HTABLE, "Check of the last pages in the open hash table");
+
+		e = EduBfM_SetHashMethod(PAGE_BUF, BFM_HASH_CHAINED);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	e = EduBfM_SetNumPartitions(PAGE_BUF, 0);
+	if (e < eNOERROR) ERR(e);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_Policies()
+ *================================*/
+/*
+ * Function: static Four check_Policies(void)
+ *
+ * Description :
+ *  Check the victim of each replacement policy when the pool is full of
+ *  pages 0..9 and pages 0..8 are fixed again: LRU-2 and ARC evict page 9,
+ *  referenced once, while the clock and 2Q, whose A1in is a FIFO, evict
+ *  page 0. A page evicted from A1in comes back into Am, where the new
+ *  pages going through A1in leave it.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_Policies(void)
+{
+	Four	e;									/* for errors */
+	Four	i;									/* loop index */
+	Four	p;									/* replacement policy */
+	Four	victim;								/* page expected to be evicted */
+	static Four policies[] = { BFM_POLICY_CLOCK, BFM_POLICY_LRUK, BFM_POLICY_2Q, BFM_POLICY_ARC };
+
+	for (p = 0; p < (Four)(sizeof(policies) / sizeof(policies[0])); p++){
+		e = EduBfM_SetReplacementPolicy(PAGE_BUF, policies[p]);
+		if (e < eNOERROR) ERR(e);
+
+		for (i = 0; i < NUM_PAGE_BUFS; i++){
+			e = check_Page(i, 0);
+			if (e < eNOERROR) ERR(e);
+		}
+		for (i = 0; i < NUM_PAGE_BUFS - 1; i++){
+			e = check_Page(i, 0);
+			if (e < eNOERROR) ERR(e);
+		}
+		e = check_Page(NUM_PAGE_BUFS, 0);
+		if (e < eNOERROR) ERR(e);
+
+		victim = (policies[p] == BFM_POLICY_LRUK || policies[p] == BFM_POLICY_ARC) ? NUM_PAGE_BUFS - 1 : 0;
+		for (i = 0; i < NUM_PAGE_BUFS; i++)
+			CHECK((edubfm_LookUp(&checkPids[i], PAGE_BUF) == NOTFOUND_IN_HTABLE) == (i == victim), "Check of the victim of a replacement policy");
+
+		if (policies[p] == BFM_POLICY_2Q){
+			/* page 0 comes back into Am, and the new pages go through A1in */
+			e = check_Page(0, 0);
+			if (e < eNOERROR) ERR(e);
+			for (i = NUM_PAGE_BUFS + 1; i <= 2 * NUM_PAGE_BUFS; i++){
+				e = check_Page(i, 0);
+				if (e < eNOERROR) ERR(e);
+			}
+			CHECK(edubfm_LookUp(&checkPids[0], PAGE_BUF) != NOTFOUND_IN_HTABLE, "Check of a page coming back from A1out");
+		}
+
+		e = check_Reset();
+		if (e < eNOERROR) ERR(e);
+	}
+
+	e = EduBfM_SetReplacementPolicy(PAGE_BUF, BFM_POLICY_CLOCK);
+	if (e < eNOERROR) ERR(e);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_Stats()
+ *================================*/
+/*
+ * Function: static Four check_Stats(void)
+ *
+ * Description :
+ *  Check the counters of the statistics and the latency histograms after
+ *  a known sequence of hits, misses and one eviction.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_Stats(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	UEight		nHist[2];						/* # of calls in the histograms */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+	FILE		*fp;							/* file the statistics are dumped into */
+
+	for (i = 0; i <= NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = check_Page(NUM_PAGE_BUFS, 0);
+	if (e < eNOERROR) ERR(e);
+
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nHits == 1 && stats.nMisses == NUM_PAGE_BUFS + 1, "Check of the hits and misses");
+	CHECK(stats.nReads == NUM_PAGE_BUFS + 1 && stats.nEvictions == 1, "Check of the reads and evictions");
+
+	for (nHist[0] = nHist[1] = 0, i = 0; i < BFM_STATS_NHISTBUCKETS; i++){
+		nHist[0] += stats.hitLatency[i];
+		nHist[1] += stats.missLatency[i];
+	}
+	CHECK(nHist[0] == stats.nHits && nHist[1] == stats.nMisses, "Check of the latency histograms");
+
+	fp = tmpfile();
+	CHECK(fp != NULL, "tmpfile");
+	e = EduBfM_DumpStats(fp);
+	CHECK(ftell(fp) > 0, "Check of the dump of the statistics");
+	fclose(fp);
+	if (e < eNOERROR) ERR(e);
+
+	e = EduBfM_ResetStats();
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nHits == 0 && stats.nMisses == 0, "Check of the reset of the statistics");
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_RunCleaner()
+ *================================*/
+/*
+ * Function: static Four check_RunCleaner(PageID *, Four)
+ *
+ * Description :
+ *  Clear the reference bits of the page buffer pool, so that every unfixed
+ *  buffer is a candidate victim, and run the cleaner until the `nPages'
+ *  pages are clean or for 2 seconds.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_RunCleaner(PageID *pids, Four nPages)
+{
+	Four	e;									/* for errors */
+	Four	i, k;								/* loop index */
+	Four	nDirty;								/* # of pages still dirty */
+	Four	index;								/* an index of the buffer table */
+
+	for (i = 0; i < BI_NBUFS(PAGE_BUF); i++)
+		BI_BITS(PAGE_BUF, i) &= ~REFER;
+
+	e = EduBfM_SetCleaner(PAGE_BUF, NUM_PAGE_BUFS);
+	if (e < eNOERROR) ERR(e);
+	for (k = 0, nDirty = nPages; k < 200 && nDirty > 0; k++){
+		usleep(10000);
+		for (nDirty = 0, i = 0; i < nPages; i++){
+			index = edubfm_LookUp(&pids[i], PAGE_BUF);
+			if (index != NOTFOUND_IN_HTABLE && (BI_BITS(PAGE_BUF, index) & DIRTY)) nDirty++;
+		}
+	}
+	e = EduBfM_SetCleaner(PAGE_BUF, 0);
+	if (e < eNOERROR) ERR(e);
+
+	return(eNOERROR);
+}
+
+
+
+/*@================================
+ * check_Cleaner()
+ *================================*/
+/*
+ * Function: static Four check_Cleaner(void)
+ *
+ * Description :
+ *  Check that a write of the cleaner which fails keeps the pages dirty,
+ *  and that the cleaner writes them back once the volume is writable
+ *  again, so that they survive EduBfM_DiscardAll(). The writes are made to
+ *  fail by replacing the file of an EduRDsM volume with a read-only one.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_Cleaner(void)
+{
+	Four	e;									/* for errors */
+	Four	i;									/* loop index */
+	Four	volNo;								/* volume of EduRDsM */
+	Four	segment;							/* segment of the pages */
+	Four	index;								/* an index of the buffer table */
+	int		fd, readOnlyFd, savedFd;			/* file of the volume, read-only and saved */
+	PageID	pids[4];							/* pages of the volume */
+	Page	*apage;								/* pointer to buffer holding a page */
+
+	e = EduRDsM_Format(CHECK_VOLUME, 2001, 200, 16);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_Mount(CHECK_VOLUME, &volNo);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_CreateSegment(volNo, &segment);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_AllocTrains(volNo, segment, NULL, 100, 4, PAGESIZE2, pids);
+	if (e < eNOERROR) ERR(e);
+
+	for (i = 0; i < 4; i++){
+		e = EduBfM_GetTrain(&pids[i], (char **)&apage, PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		memset(apage, 0, PAGESIZE);
+		apage->header.flags = 100 + i;
+		e = EduBfM_SetDirty(&pids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	/* the writes of the cleaner fail */
+	fd = edurdsm_Volume(volNo)->fd;
+	readOnlyFd = open(CHECK_VOLUME, O_RDONLY);
+	savedFd = dup(fd);
+	CHECK(readOnlyFd >= 0 && savedFd >= 0 && dup2(readOnlyFd, fd) == fd, "Check of the read-only volume");
+	e = check_RunCleaner(pids, 4);
+	dup2(savedFd, fd);
+	close(savedFd);
+	close(readOnlyFd);
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < 4; i++){
+		index = edubfm_LookUp(&pids[i], PAGE_BUF);
+		CHECK(index != NOTFOUND_IN_HTABLE && (BI_BITS(PAGE_BUF, index) & DIRTY), "Check of a page whose write back failed");
+	}
+
+	/* the writes of the cleaner succeed */
+	e = check_RunCleaner(pids, 4);
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < 4; i++){
+		index = edubfm_LookUp(&pids[i], PAGE_BUF);
+		CHECK(index != NOTFOUND_IN_HTABLE && !(BI_BITS(PAGE_BUF, index) & DIRTY), "Check of a page written back by the cleaner");
+	}
+
+	e = EduBfM_DiscardAll();
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < 4; i++){
+		e = EduBfM_GetTrain(&pids[i], (char **)&apage, PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		CHECK(apage->header.flags == 100 + i, "Check of a page written back by the cleaner after EduBfM_DiscardAll");
+		e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	e = EduBfM_DiscardAll();
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_Dismount(volNo);
+	if (e < eNOERROR) ERR(e);
+	remove(CHECK_VOLUME);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_AsyncIO()
+ *================================*/
+/*
+ * Function: static Four check_AsyncIO(void)
+ *
+ * Description :
+ *  Check that the pages read by EduBfM_GetTrainAsync() and the updates
+ *  written back through the asynchronous I/O engine are intact, and that
+ *  the reads of an EduRDsM volume go through io_uring where the kernel has
+ *  one.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_AsyncIO(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Four		volNo;							/* volume of EduRDsM */
+	Four		segment;						/* segment of the pages */
+	PageID		pids[4];						/* pages of the volume */
+	BfMIOHandle	handles[4];						/* requests of the reads */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+	Page		*apage;							/* pointer to buffer holding a page */
+
+	e = EduBfM_SetAsyncIO(2);
+	if (e < eNOERROR) ERR(e);
+
+	for (i = 0; i < 4; i++){
+		e = EduBfM_GetTrainAsync(&checkPids[i], PAGE_BUF, &handles[i]);
+		if (e < eNOERROR) ERR(e);
+	}
+	for (i = 0; i < 4; i++){
+		e = EduBfM_WaitTrain(&handles[i], (char **)&apage);
+		if (e < eNOERROR) ERR(e);
+		CHECK(EduBfM_PollTrain(&handles[i]), "Check of a completed request");
+		CHECK(apage->header.flags == i, "Check of a page read asynchronously");
+		((Four *)apage->data)[0] = 1;
+		e = EduBfM_SetDirty(&checkPids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_FreeTrain(&checkPids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	/* the writes of EduBfM_FlushAll() go through the engine */
+	e = check_Reset();
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < 4; i++){
+		e = check_Page(i, 1);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	/* the reads of a volume of EduRDsM */
+	e = EduRDsM_Format(CHECK_VOLUME, 2001, 200, 16);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_Mount(CHECK_VOLUME, &volNo);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_CreateSegment(volNo, &segment);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_AllocTrains(volNo, segment, NULL, 100, 4, PAGESIZE2, pids);
+	if (e < eNOERROR) ERR(e);
+
+	e = EduBfM_ResetStats();
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < 4; i++){
+		e = EduBfM_GetTrainAsync(&pids[i], PAGE_BUF, &handles[i]);
+		if (e < eNOERROR) ERR(e);
+	}
+	for (i = 0; i < 4; i++){
+		e = EduBfM_WaitTrain(&handles[i], (char **)&apage);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(edubfm_ioUring.fd < 0 || stats.nUringIOs == 4, "Check of the reads through io_uring");
+
+	e = EduBfM_SetAsyncIO(0);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_DiscardAll();
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_Dismount(volNo);
+	if (e < eNOERROR) ERR(e);
+	remove(CHECK_VOLUME);
+
+	/* restore the counters */
+	for (i = 0; i < 4; i++){
+		e = EduBfM_GetTrain(&checkPids[i], (char **)&apage, PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		((Four *)apage->data)[0] = 0;
+		e = EduBfM_SetDirty(&checkPids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_FreeTrain(&checkPids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_NextTrain()
+ *================================*/
+/*
+ * Function: static void check_NextTrain(TrainID *, char *, TrainID *)
+ *
+ * Description :
+ *  Give the page following page i of the checks, page i + 1, as the next
+ *  page of a page chain.
+ *
+ * Returns:
+ *  None
+ */
+static void check_NextTrain(TrainID *trainId, char *buffer, TrainID *nextTrainId)
+{
+	Four	i = ((Page *)buffer)->header.flags;	/* page of the checks in the buffer */
+
+	if (i >= 0 && i + 1 < NUM_CHECK_PAGES) *nextTrainId = checkPids[i + 1];
+	else SET_NILPAGEID(*nextTrainId);
+}
+
+
+
+/*@================================
+ * check_ReadAhead()
+ *================================*/
+/*
+ * Function: static Four check_ReadAhead(void)
+ *
+ * Description :
+ *  Check that a scan along a page chain has pages read ahead of it, and
+ *  that the pages it fixes are intact.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_ReadAhead(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	e = EduBfM_SetAsyncIO(2);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_SetReadAhead(PAGE_BUF, 4, check_NextTrain);
+	if (e < eNOERROR) ERR(e);
+
+	for (i = 0; i < 30; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nPrefetches > 0 && stats.nPrefetchHits > 0, "Check of the pages read ahead");
+	CHECK(stats.nMisses < 30, "Check of the misses of a scan read ahead");
+
+	e = EduBfM_SetReadAhead(PAGE_BUF, 0, NULL);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_SetAsyncIO(0);
+	if (e < eNOERROR) ERR(e);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_SetCounters()
+ *================================*/
+/*
+ * Function: static Four check_SetCounters(Four, Four, Four)
+ *
+ * Description :
+ *  Set the counters of the pages `first' .. `first + n - 1' of the checks
+ *  to `count', leaving the pages dirty in the pool.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_SetCounters(Four first, Four n, Four count)
+{
+	Four	e;									/* for errors */
+	Four	i;									/* loop index */
+	Page	*apage;								/* pointer to buffer holding a page */
+
+	for (i = first; i < first + n; i++){
+		e = EduBfM_GetTrain(&checkPids[i], (char **)&apage, PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		((Four *)apage->data)[0] = count;
+		e = EduBfM_SetDirty(&checkPids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_FreeTrain(&checkPids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	return(eNOERROR);
+}
+
+
+
+/*@================================
+ * check_SortedFlush()
+ *================================*/
+/*
+ * Function: static Four check_SortedFlush(void)
+ *
+ * Description :
+ *  Check that EduBfM_FlushAll() writes every dirty page once, coalescing
+ *  the writes of the pages adjacent on the disk whatever order they were
+ *  dirtied in, with and without the asynchronous I/O engine.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_SortedFlush(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Four		nWorkers;						/* # of workers of the engine */
+	Four		nAdjacent;						/* # of pages following their predecessor on the disk */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	for (nAdjacent = 0, i = 1; i < NUM_PAGE_BUFS; i++)
+		if (checkPids[i].volNo == checkPids[i - 1].volNo && checkPids[i].pageNo == checkPids[i - 1].pageNo + 1) nAdjacent++;
+
+	for (nWorkers = 0; nWorkers <= 2; nWorkers += 2){
+		e = EduBfM_SetAsyncIO(nWorkers);
+		if (e < eNOERROR) ERR(e);
+
+		/* dirty the pages in the reverse order of the disk */
+		for (i = NUM_PAGE_BUFS - 1; i >= 0; i--){
+			e = check_SetCounters(i, 1, nWorkers + 1);
+			if (e < eNOERROR) ERR(e);
+		}
+		e = EduBfM_FlushAll();
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_GetStats(PAGE_BUF, &stats);
+		if (e < eNOERROR) ERR(e);
+		CHECK(stats.nFlushes == NUM_PAGE_BUFS, "Check of the pages written back by EduBfM_FlushAll");
+		CHECK(stats.nWrites == NUM_PAGE_BUFS && stats.nWritesSaved >= (UEight)nAdjacent, "Check of the coalesced writes");
+
+		e = check_Reset();
+		if (e < eNOERROR) ERR(e);
+		for (i = 0; i < NUM_PAGE_BUFS; i++){
+			e = check_Page(i, nWorkers + 1);
+			if (e < eNOERROR) ERR(e);
+		}
+		e = check_Reset();
+		if (e < eNOERROR) ERR(e);
+	}
+
+	e = EduBfM_SetAsyncIO(0);
+	if (e < eNOERROR) ERR(e);
+	e = check_SetCounters(0, NUM_PAGE_BUFS, 0);
+	if (e < eNOERROR) ERR(e);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_DirtyMap()
+ *================================*/
+/*
+ * Function: static Four check_DirtyMap(Four *)
+ *
+ * Description :
+ *  Count the buffers of the page buffer pool found through its dirty map,
+ *  checking that each of them is dirty.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_DirtyMap(Four *nDirty)
+{
+	Four	i;									/* index of a buffer */
+
+	for (*nDirty = 0, i = edubfm_NextDirty(PAGE_BUF, 0); i != NIL; i = edubfm_NextDirty(PAGE_BUF, i + 1)){
+		CHECK(BI_BITS(PAGE_BUF, i) & DIRTY, "Check of a buffer of the dirty map");
+		(*nDirty)++;
+	}
+
+	return(eNOERROR);
+}
+
+
+
+/*@================================
+ * check_DirtyFlush()
+ *================================*/
+/*
+ * Function: static Four check_DirtyFlush(void)
+ *
+ * Description :
+ *  Check that the dirty map holds the dirty buffers only, so that
+ *  EduBfM_FlushAll() writes back just them, and that it is cleared by the
+ *  write-back of EduBfM_FlushAll(), of a victim and by EduBfM_DiscardAll().
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_DirtyFlush(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Four		nDirty;							/* # of buffers of the dirty map */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	for (i = 0; i < NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = check_DirtyMap(&nDirty);
+	if (e < eNOERROR) return(e);
+	CHECK(nDirty == 0, "Check of the dirty map of a clean pool");
+
+	/* dirty 3 pages of the full pool */
+	e = check_SetCounters(1, 1, 1);
+	if (e < eNOERROR) ERR(e);
+	e = check_SetCounters(4, 1, 1);
+	if (e < eNOERROR) ERR(e);
+	e = check_SetCounters(8, 1, 1);
+	if (e < eNOERROR) ERR(e);
+	e = check_DirtyMap(&nDirty);
+	if (e < eNOERROR) return(e);
+	CHECK(nDirty == 3, "Check of the dirty map of 3 dirty pages");
+
+	e = EduBfM_FlushAll();
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nFlushes == 3, "Check of the pages written back by EduBfM_FlushAll");
+	e = check_DirtyMap(&nDirty);
+	if (e < eNOERROR) return(e);
+	CHECK(nDirty == 0, "Check of the dirty map after EduBfM_FlushAll");
+
+	/* a dirty victim written back by the allocation */
+	e = check_SetCounters(2, 1, 1);
+	if (e < eNOERROR) ERR(e);
+	for (i = NUM_PAGE_BUFS; i < 2 * NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nDirtyEvictions == 1, "Check of the dirty victim");
+	e = check_DirtyMap(&nDirty);
+	if (e < eNOERROR) return(e);
+	CHECK(nDirty == 0, "Check of the dirty map after the eviction");
+
+	e = check_Reset();
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < NUM_PAGE_BUFS; i++){
+		e = check_Page(i, (i == 1 || i == 2 || i == 4 || i == 8) ? 1 : 0);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	/* restore the counters, dropping the last update */
+	e = check_SetCounters(1, 2, 0);
+	if (e < eNOERROR) ERR(e);
+	e = check_SetCounters(4, 1, 0);
+	if (e < eNOERROR) ERR(e);
+	e = check_SetCounters(8, 1, 0);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_FlushAll();
+	if (e < eNOERROR) ERR(e);
+	e = check_SetCounters(3, 1, 1);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_DiscardAll();
+	if (e < eNOERROR) ERR(e);
+	e = check_DirtyMap(&nDirty);
+	if (e < eNOERROR) return(e);
+	CHECK(nDirty == 0, "Check of the dirty map after EduBfM_DiscardAll");
+	e = check_Page(3, 0);
+	if (e < eNOERROR) ERR(e);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_Strategies()
+ *================================*/
+/*
+ * Function: static Four check_Strategies(void)
+ *
+ * Description :
+ *  Check that a sequential scan through a ring recycles its buffers and
+ *  leaves the hot pages in the pool, unpartitioned and under 2
+ *  partitions, and that the pages updated through a bulk write ring are
+ *  written back.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_Strategies(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Four		count;							/* counter written into the pages */
+	Four		nParts;							/* # of partitions */
+	BfMStrategy	*strategy;						/* access strategy */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+	Page		*apage;							/* pointer to buffer holding a page */
+
+	for (nParts = 0; nParts <= 2; nParts += 2){
+		e = EduBfM_SetNumPartitions(PAGE_BUF, nParts);
+		if (e < eNOERROR) ERR(e);
+
+		/* 4 hot pages fit in a partition next to its ring */
+		for (i = 0; i < 4; i++){
+			e = check_Page(i, 0);
+			if (e < eNOERROR) ERR(e);
+		}
+
+		e = EduBfM_CreateStrategy(BFM_STRATEGY_SEQSCAN, PAGE_BUF, &strategy);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_ResetStats();
+		if (e < eNOERROR) ERR(e);
+		for (i = NUM_PAGE_BUFS; i < NUM_CHECK_PAGES; i++){
+			e = EduBfM_GetTrainStrategy(&checkPids[i], (char **)&apage, PAGE_BUF, strategy);
+			if (e < eNOERROR) ERR(e);
+			CHECK(apage->header.flags == i, "Check of a page read through a ring");
+			e = EduBfM_FreeTrain(&checkPids[i], PAGE_BUF);
+			if (e < eNOERROR) ERR(e);
+		}
+		e = EduBfM_DestroyStrategy(strategy);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_GetStats(PAGE_BUF, &stats);
+		if (e < eNOERROR) ERR(e);
+		CHECK(stats.nRingReuses > 0, "Check of the buffers recycled by a ring");
+
+		e = EduBfM_ResetStats();
+		if (e < eNOERROR) ERR(e);
+		for (i = 0; i < 4; i++){
+			e = check_Page(i, 0);
+			if (e < eNOERROR) ERR(e);
+		}
+		e = EduBfM_GetStats(PAGE_BUF, &stats);
+		if (e < eNOERROR) ERR(e);
+		CHECK(stats.nHits == 4, "Check of the hot pages after a scan through a ring");
+
+		e = check_Reset();
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_SetNumPartitions(PAGE_BUF, 0);
+	if (e < eNOERROR) ERR(e);
+
+	/* update the pages through a bulk write ring, then restore their counters */
+	for (count = 1; count >= 0; count--){
+		e = EduBfM_CreateStrategy(BFM_STRATEGY_BULKWRITE, PAGE_BUF, &strategy);
+		if (e < eNOERROR) ERR(e);
+		for (i = NUM_PAGE_BUFS; i < NUM_CHECK_PAGES; i++){
+			e = EduBfM_GetTrainStrategy(&checkPids[i], (char **)&apage, PAGE_BUF, strategy);
+			if (e < eNOERROR) ERR(e);
+			((Four *)apage->data)[0] = count;
+			e = EduBfM_SetDirty(&checkPids[i], PAGE_BUF);
+			if (e < eNOERROR) ERR(e);
+			e = EduBfM_FreeTrain(&checkPids[i], PAGE_BUF);
+			if (e < eNOERROR) ERR(e);
+		}
+		e = EduBfM_DestroyStrategy(strategy);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_GetStats(PAGE_BUF, &stats);
+		if (e < eNOERROR) ERR(e);
+		CHECK(stats.nRingReuses > 0 && stats.nWrites > 0, "Check of the pages written back by a ring");
+
+		e = check_Reset();
+		if (e < eNOERROR) ERR(e);
+		for (i = NUM_PAGE_BUFS; i < NUM_CHECK_PAGES; i++){
+			e = check_Page(i, count);
+			if (e < eNOERROR) ERR(e);
+		}
+		e = check_Reset();
+		if (e < eNOERROR) ERR(e);
+	}
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_PoolAllocation()
+ *================================*/
+/*
+ * Function: static Four check_PoolAllocation(void)
+ *
+ * Description :
+ *  Check that the pages are read, updated and written back through the
+ *  buffers of the page buffer pool moved to each kind of memory of
+ *  EduBfM_SetPoolAllocation(), and that the pool is moved back to the
+ *  buffers of the storage system.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_PoolAllocation(void)
+{
+	Four	e;									/* for errors */
+	Four	i;									/* loop index */
+	Four	k;									/* index of the flags */
+	Four	flags[3] = { BFM_ALLOC_HUGEPAGE, BFM_ALLOC_HUGEPAGE | BFM_ALLOC_INTERLEAVE, BFM_ALLOC_BINDPARTITION };
+
+	for (k = 0; k < 3; k++){
+		e = EduBfM_SetNumPartitions(PAGE_BUF, (flags[k] & BFM_ALLOC_BINDPARTITION) ? 2 : 0);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_SetPoolAllocation(PAGE_BUF, flags[k]);
+		if (e < eNOERROR) ERR(e);
+		CHECK(bufArena[PAGE_BUF].kind != BFM_ARENA_DEFAULT && bufArena[PAGE_BUF].flags == flags[k], "Check of the memory of the buffers");
+
+		e = check_SetCounters(0, 2 * NUM_PAGE_BUFS, k + 1);
+		if (e < eNOERROR) ERR(e);
+		e = check_Reset();
+		if (e < eNOERROR) ERR(e);
+		for (i = 0; i < 2 * NUM_PAGE_BUFS; i++){
+			e = check_Page(i, k + 1);
+			if (e < eNOERROR) ERR(e);
+		}
+	}
+
+	e = EduBfM_SetNumPartitions(PAGE_BUF, 0);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_SetPoolAllocation(PAGE_BUF, 0);
+	if (e < eNOERROR) ERR(e);
+	CHECK(bufArena[PAGE_BUF].kind == BFM_ARENA_DEFAULT && BI_NBUFS(PAGE_BUF) == NUM_PAGE_BUFS, "Check of the pool moved back to the buffers of the storage system");
+	for (i = 0; i < 2 * NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 3);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = check_SetCounters(0, 2 * NUM_PAGE_BUFS, 0);
+	if (e < eNOERROR) ERR(e);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_Resize()
+ *================================*/
+/*
+ * Function: static Four check_Resize(void)
+ *
+ * Description :
+ *  Check that the page buffer pool grown by EduBfM_Resize() holds more
+ *  pages, and that the pool shrunk back writes back the dirty pages it
+ *  gives up and keeps the others, unpartitioned and under 2 partitions.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_Resize(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Four		nParts;							/* # of partitions */
+	Four		nKept;							/* # of pages kept in the pool */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	for (nParts = 0; nParts <= 2; nParts += 2){
+		e = EduBfM_SetNumPartitions(PAGE_BUF, nParts);
+		if (e < eNOERROR) ERR(e);
+
+		/* grow the pool with pages in it */
+		for (i = 0; i < NUM_PAGE_BUFS / 2; i++){
+			e = check_Page(i, -1);
+			if (e < eNOERROR) ERR(e);
+		}
+		e = EduBfM_Resize(PAGE_BUF, 3 * NUM_PAGE_BUFS);
+		if (e < eNOERROR) ERR(e);
+		CHECK(BI_NBUFS(PAGE_BUF) == 3 * NUM_PAGE_BUFS, "Check of the size of a grown pool");
+		e = check_SetCounters(0, 2 * NUM_PAGE_BUFS, nParts + 1);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_GetStats(PAGE_BUF, &stats);
+		if (e < eNOERROR) ERR(e);
+		CHECK(stats.nHits == NUM_PAGE_BUFS / 2 && stats.nEvictions == 0, "Check of the pages kept in a grown pool");
+
+		/* shrink it back with dirty pages in it */
+		e = EduBfM_Resize(PAGE_BUF, NUM_PAGE_BUFS);
+		if (e < eNOERROR) ERR(e);
+		CHECK(BI_NBUFS(PAGE_BUF) == NUM_PAGE_BUFS, "Check of the size of a shrunk pool");
+		for (nKept = 0, i = 0; i < BI_NBUFS(PAGE_BUF); i++)
+			if (BI_KEY(PAGE_BUF, i).pageNo != NIL) nKept++;
+		CHECK(nKept == NUM_PAGE_BUFS, "Check of the pages kept in a shrunk pool");
+		e = check_Reset();
+		if (e < eNOERROR) ERR(e);
+		for (i = 0; i < 2 * NUM_PAGE_BUFS; i++){
+			e = check_Page(i, nParts + 1);
+			if (e < eNOERROR) ERR(e);
+		}
+		e = check_Reset();
+		if (e < eNOERROR) ERR(e);
+	}
+
+	e = EduBfM_SetNumPartitions(PAGE_BUF, 0);
+	if (e < eNOERROR) ERR(e);
+	CHECK(bufArena[PAGE_BUF].kind == BFM_ARENA_DEFAULT, "Check of the buffers of the storage system given back");
+	e = check_SetCounters(0, 2 * NUM_PAGE_BUFS, 0);
+	if (e < eNOERROR) ERR(e);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_AdaptiveSplit()
+ *================================*/
+/*
+ * Function: static Four check_AdaptiveSplit(void)
+ *
+ * Description :
+ *  Check that the adaptive split moves memory to the page buffer pool
+ *  while the pages of a loop slightly larger than the pool are missed,
+ *  and that the pools are given their buffers back afterwards.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_AdaptiveSplit(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Four		k;								/* # of loops */
+	Four		nBufs;							/* # of buffers of the page buffer pool under the split */
+	Four		nLotBufs;						/* # of buffers of the large object buffer pool under the split */
+	Four		nOrigLotBufs;					/* # of buffers of the large object buffer pool before the split */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	nOrigLotBufs = BI_NBUFS(LOT_LEAF_BUF);
+	e = EduBfM_SetAdaptiveSplit(BFM_ADAPT_STEPDIV * BI_BUFSIZE(PAGE_BUF) * BI_BUFSIZE(LOT_LEAF_BUF));
+	if (e < eNOERROR) ERR(e);
+	nBufs = BI_NBUFS(PAGE_BUF);
+	nLotBufs = BI_NBUFS(LOT_LEAF_BUF);
+	CHECK(nBufs < NUM_CHECK_PAGES, "Check of the split of the budget");
+
+	for (k = 0; k < 50 && BI_NBUFS(PAGE_BUF) < NUM_CHECK_PAGES; k++)
+		for (i = 0; i < NUM_CHECK_PAGES; i++){
+			e = check_Page(i, 0);
+			if (e < eNOERROR) ERR(e);
+		}
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nGhostHits > 0 && stats.nSplitMoves > 0, "Check of the decisions of the adaptive split");
+	CHECK(BI_NBUFS(PAGE_BUF) > nBufs && BI_NBUFS(LOT_LEAF_BUF) < nLotBufs, "Check of the memory moved by the adaptive split");
+
+	/* the pools keep their sizes until resized back */
+	e = EduBfM_SetAdaptiveSplit(0);
+	if (e < eNOERROR) ERR(e);
+	nBufs = BI_NBUFS(PAGE_BUF);
+	for (i = 0; i < NUM_CHECK_PAGES; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	CHECK(BI_NBUFS(PAGE_BUF) == nBufs, "Check of the pools after the adaptive split");
+
+	e = check_Reset();
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_Resize(LOT_LEAF_BUF, nOrigLotBufs);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_Resize(PAGE_BUF, NUM_PAGE_BUFS);
+	if (e < eNOERROR) ERR(e);
+	CHECK(bufArena[PAGE_BUF].kind == BFM_ARENA_DEFAULT && bufArena[LOT_LEAF_BUF].kind == BFM_ARENA_DEFAULT, "Check of the buffers of the storage system given back");
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_HotSet()
+ *================================*/
+/*
+ * Function: static Four check_HotSet(void)
+ *
+ * Description :
+ *  Check that EduBfM_WarmUp() loads the pages resident when the hot set
+ *  was saved by EduBfM_FlushAll() into the emptied pool, and that it does
+ *  nothing without a hot set file.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_HotSet(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	for (i = 2 * NUM_PAGE_BUFS; i < 3 * NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_SetHotSetFile(CHECK_HOTSET);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_FlushAll();
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_SetHotSetFile(NULL);
+	if (e < eNOERROR) ERR(e);
+
+	/* warm up the emptied pool */
+	e = check_Reset();
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_WarmUp(CHECK_HOTSET);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nWarmedUp == NUM_PAGE_BUFS, "Check of the pages loaded by EduBfM_WarmUp");
+	for (i = 2 * NUM_PAGE_BUFS; i < 3 * NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nHits == NUM_PAGE_BUFS && stats.nMisses == 0, "Check of the pages of a warmed up pool");
+
+	/* without the file */
+	remove(CHECK_HOTSET);
+	e = check_Reset();
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_WarmUp(CHECK_HOTSET);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nWarmedUp == 0, "Check of EduBfM_WarmUp without a hot set file");
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_NumFixed()
+ *================================*/
+/*
+ * Function: static Four check_NumFixed(void)
+ *
+ * Description :
+ *  Count the fixes of the buffers of the page buffer pool.
+ *
+ * Returns:
+ *  # of fixes
+ */
+static Four check_NumFixed(void)
+{
+	Four	i;									/* index of a buffer */
+	Four	nFixed;								/* # of fixes */
+
+	for (nFixed = 0, i = 0; i < BI_NBUFS(PAGE_BUF); i++)
+		nFixed += BI_FIXED(PAGE_BUF, i);
+
+	return(nFixed);
+}
+
+
+
+/*@================================
+ * check_BatchTrains()
+ *================================*/
+/*
+ * Function: static Four check_BatchTrains(void)
+ *
+ * Description :
+ *  Check that EduBfM_GetTrains() fixes a batch of pages, some resident,
+ *  one given twice, reading each missing page once, and that
+ *  EduBfM_FreeTrains() unfixes them all, reporting a page not in the pool
+ *  without keeping the others from being freed.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_BatchTrains(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Four		pages[NUM_BATCH_TRAINS] = { 7, 0, 6, 1, 5, 2, 4, 3, 2, NUM_CHECK_PAGES - 1 };	/* pages of the batch */
+	TrainID		trainIds[NUM_BATCH_TRAINS];		/* trains of the batch */
+	Four		results[NUM_BATCH_TRAINS];		/* error code of each train */
+	Page		*bufs[NUM_BATCH_TRAINS];		/* buffer of each train */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	for (i = 0; i < NUM_BATCH_TRAINS; i++)
+		trainIds[i] = checkPids[pages[i]];
+
+	for (i = 0; i < 2; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_ResetStats();
+	if (e < eNOERROR) ERR(e);
+
+	/* the last page is left out of the batch to be fixed */
+	e = EduBfM_GetTrains(trainIds, NUM_BATCH_TRAINS - 1, (char **)bufs, results, PAGE_BUF);
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < NUM_BATCH_TRAINS - 1; i++){
+		CHECK(results[i] == eNOERROR, "Check of the result of a train of EduBfM_GetTrains");
+		CHECK(bufs[i]->header.flags == pages[i] && bufs[i]->header.pid.pageNo == trainIds[i].pageNo, "Check of a page of EduBfM_GetTrains");
+	}
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nReads == 6, "Check of the pages read by EduBfM_GetTrains");
+	CHECK(check_NumFixed() == NUM_BATCH_TRAINS - 1, "Check of the pages fixed by EduBfM_GetTrains");
+
+	e = EduBfM_FreeTrains(trainIds, NUM_BATCH_TRAINS, results, PAGE_BUF);
+	CHECK(e == eNOTFOUND_BFM && results[NUM_BATCH_TRAINS - 1] == eNOTFOUND_BFM, "Check of a page of EduBfM_FreeTrains not in the pool");
+	for (i = 0; i < NUM_BATCH_TRAINS - 1; i++)
+		CHECK(results[i] == eNOERROR, "Check of the result of a train of EduBfM_FreeTrains");
+	CHECK(check_NumFixed() == 0, "Check of the pages unfixed by EduBfM_FreeTrains");
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_FreeList()
+ *================================*/
+/*
+ * Function: static Four check_FreeList(void)
+ *
+ * Description :
+ *  Check that the buffers of an emptied pool are allocated from the free
+ *  list without running the clock, and that the clock examines a bounded
+ *  number of buffers when all the trains of a larger pool are referenced.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_FreeList(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Four		nBufs;							/* # of buffers of the enlarged pool */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	for (i = 0; i < NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nFreeAllocs == NUM_PAGE_BUFS && stats.nScanned == 0, "Check of the allocations from the free list");
+
+	/* a miss on a pool of referenced trains */
+	nBufs = NUM_CHECK_PAGES - NUM_PAGE_BUFS;
+	e = EduBfM_Resize(PAGE_BUF, nBufs);
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < nBufs; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_ResetStats();
+	if (e < eNOERROR) ERR(e);
+	e = check_Page(nBufs, 0);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nEvictions == 1 && stats.nScanned <= BFM_CLOCK_BUDGET + 1, "Check of the buffers examined by the clock");
+
+	e = check_Reset();
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_Resize(PAGE_BUF, NUM_PAGE_BUFS);
+	if (e < eNOERROR) ERR(e);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_Invalidate()
+ *================================*/
+/*
+ * Function: static Four check_Invalidate(void)
+ *
+ * Description :
+ *  Check that EduBfM_InvalidateTrains() drops the unfixed pages from the
+ *  pool without writing back their updates, gives their buffers to the
+ *  free list, keeps a fixed page and skips a page not in the pool.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_Invalidate(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Four		nDirty;							/* # of buffers of the dirty map */
+	TrainID		trainIds[5];					/* trains invalidated */
+	Page		*apage;							/* pointer to buffer holding a page */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	for (i = 0; i < NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = check_SetCounters(3, 3, 1);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_GetTrain(&checkPids[6], (char **)&apage, PAGE_BUF);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_ResetStats();
+	if (e < eNOERROR) ERR(e);
+
+	for (i = 0; i < 4; i++)
+		trainIds[i] = checkPids[3 + i];
+	trainIds[4] = checkPids[NUM_CHECK_PAGES - 1];
+	e = EduBfM_InvalidateTrains(trainIds, 5, PAGE_BUF);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nInvalidations == 3 && stats.nWritesDropped == 3, "Check of the pages invalidated");
+	e = check_DirtyMap(&nDirty);
+	if (e < eNOERROR) return(e);
+	CHECK(nDirty == 0, "Check of the dirty map after EduBfM_InvalidateTrains");
+
+	/* the fixed page is kept */
+	CHECK(apage->header.flags == 6, "Check of an invalidated page kept fixed");
+	e = EduBfM_FreeTrain(&checkPids[6], PAGE_BUF);
+	if (e < eNOERROR) ERR(e);
+
+	/* the updates are dropped, and the pages are read into the freed buffers */
+	e = EduBfM_FlushAll();
+	if (e < eNOERROR) ERR(e);
+	for (i = 3; i < 6; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nFlushes == 0 && stats.nWrites == 0, "Check of the updates dropped by EduBfM_InvalidateTrains");
+	CHECK(stats.nFreeAllocs == 3 && stats.nEvictions == 0, "Check of the buffers freed by EduBfM_InvalidateTrains");
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_TableLayout()
+ *================================*/
+/*
+ * Function: static Four check_TableLayout(void)
+ *
+ * Description :
+ *  Check that the clock chooses the same victims, and skips a fixed page,
+ *  with the buffer table laid out as arrays as with the default layout,
+ *  and that the pages updated in either layout are written back.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_TableLayout(void)
+{
+	Four		e;								/* for errors */
+	Four		i, j;							/* loop indices */
+	Four		layout;							/* layout of the buffer table */
+	Four		count;							/* counter written into the pages */
+	Boolean		resident[2][NUM_CHECK_PAGES];	/* TRUE for the pages left in the pool in each layout */
+	Page		*apage;							/* pointer to buffer holding a page */
+
+	for (layout = BFM_LAYOUT_AOS; layout <= BFM_LAYOUT_SOA; layout++){
+		e = EduBfM_SetTableLayout(PAGE_BUF, layout);
+		if (e < eNOERROR) ERR(e);
+		count = (layout == BFM_LAYOUT_AOS) ? 1 : 0;
+
+		for (i = 0; i < NUM_PAGE_BUFS; i++){
+			e = check_Page(i, -1);
+			if (e < eNOERROR) ERR(e);
+		}
+		e = EduBfM_GetTrain(&checkPids[0], (char **)&apage, PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		e = check_SetCounters(NUM_PAGE_BUFS, NUM_PAGE_BUFS / 2, count);
+		if (e < eNOERROR) ERR(e);
+		CHECK(apage->header.flags == 0, "Check of a fixed page");
+		e = EduBfM_FreeTrain(&checkPids[0], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+
+		for (i = 0; i < NUM_CHECK_PAGES; i++){
+			resident[layout][i] = FALSE;
+			for (j = 0; j < BI_NBUFS(PAGE_BUF); j++)
+				if (BI_KEY(PAGE_BUF, j).pageNo == checkPids[i].pageNo && BI_KEY(PAGE_BUF, j).volNo == checkPids[i].volNo)
+					resident[layout][i] = TRUE;
+		}
+		CHECK(resident[layout][0], "Check of a fixed page kept in the pool");
+
+		e = check_Reset();
+		if (e < eNOERROR) ERR(e);
+		for (i = NUM_PAGE_BUFS; i < NUM_PAGE_BUFS + NUM_PAGE_BUFS / 2; i++){
+			e = check_Page(i, count);
+			if (e < eNOERROR) ERR(e);
+		}
+		e = check_Reset();
+		if (e < eNOERROR) ERR(e);
+	}
+
+	CHECK(memcmp(resident[BFM_LAYOUT_AOS], resident[BFM_LAYOUT_SOA], sizeof(resident[0])) == 0, "Check of the victims in both layouts");
+
+	e = EduBfM_SetTableLayout(PAGE_BUF, BFM_LAYOUT_AOS);
+	if (e < eNOERROR) ERR(e);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_CleanFirst()
+ *================================*/
+/*
+ * Function: static Four check_CleanFirst(void)
+ *
+ * Description :
+ *  Check that BFM_POLICY_CLEANFIRST evicts the clean pages of a pool before
+ *  the dirty ones, and a dirty page once no clean one is left.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_CleanFirst(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	e = EduBfM_SetReplacementPolicy(PAGE_BUF, BFM_POLICY_CLEANFIRST);
+	if (e < eNOERROR) ERR(e);
+
+	/* the first half of the pool is dirty */
+	for (i = 0; i < NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = check_SetCounters(0, NUM_PAGE_BUFS / 2, 1);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_ResetStats();
+	if (e < eNOERROR) ERR(e);
+
+	for (i = NUM_PAGE_BUFS; i < NUM_PAGE_BUFS + NUM_PAGE_BUFS / 2; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nWritesAvoided > 0 && stats.nDirtyEvictions == 0, "Check of the clean victims chosen over the dirty ones");
+
+	/* every page of the pool is dirty */
+	e = check_SetCounters(NUM_PAGE_BUFS, NUM_PAGE_BUFS / 2, 0);
+	if (e < eNOERROR) ERR(e);
+	e = check_Page(2 * NUM_PAGE_BUFS, 0);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nDirtyEvictions == 1, "Check of a dirty victim");
+
+	e = check_Reset();
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < NUM_PAGE_BUFS / 2; i++){
+		e = check_Page(i, 1);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = check_SetCounters(0, NUM_PAGE_BUFS / 2, 0);
+	if (e < eNOERROR) ERR(e);
+
+	e = EduBfM_SetReplacementPolicy(PAGE_BUF, BFM_POLICY_CLOCK);
+	if (e < eNOERROR) ERR(e);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_VictimCache()
+ *================================*/
+/*
+ * Function: static Four check_VictimCache(void)
+ *
+ * Description :
+ *  Check that the pages evicted from the page buffer pool are read back
+ *  intact from the compressed victim cache instead of the disk, and that
+ *  a page updated after it was cached is read back with its update.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_VictimCache(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Four		count;							/* counter written into the pages */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	e = EduBfM_SetVictimCache(PAGE_BUF, 2 * NUM_PAGE_BUFS * PAGESIZE);
+	if (e < eNOERROR) ERR(e);
+
+	for (count = 1; count <= 2; count++){
+		/* update the pages, and let them be evicted by others */
+		e = check_SetCounters(0, NUM_PAGE_BUFS, count);
+		if (e < eNOERROR) ERR(e);
+		if (count == 1){
+			e = EduBfM_FlushAll();
+			if (e < eNOERROR) ERR(e);
+		}
+		for (i = NUM_PAGE_BUFS; i < 2 * NUM_PAGE_BUFS; i++){
+			e = check_Page(i, 0);
+			if (e < eNOERROR) ERR(e);
+		}
+		e = EduBfM_GetStats(PAGE_BUF, &stats);
+		if (e < eNOERROR) ERR(e);
+		CHECK(stats.nVictimPuts >= NUM_PAGE_BUFS && stats.victimBytesOut < stats.victimBytesIn, "Check of the pages put into the victim cache");
+
+		e = EduBfM_ResetStats();
+		if (e < eNOERROR) ERR(e);
+		for (i = 0; i < NUM_PAGE_BUFS; i++){
+			e = check_Page(i, count);
+			if (e < eNOERROR) ERR(e);
+		}
+		e = EduBfM_GetStats(PAGE_BUF, &stats);
+		if (e < eNOERROR) ERR(e);
+		CHECK(stats.nVictimHits == NUM_PAGE_BUFS && stats.nReads == 0, "Check of the pages read from the victim cache");
+		e = EduBfM_ResetStats();
+		if (e < eNOERROR) ERR(e);
+	}
+
+	e = EduBfM_SetVictimCache(PAGE_BUF, 0);
+	if (e < eNOERROR) ERR(e);
+	e = check_Reset();
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 2);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = check_SetCounters(0, NUM_PAGE_BUFS, 0);
+	if (e < eNOERROR) ERR(e);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_SecondaryCache()
+ *================================*/
+/*
+ * Function: static Four check_SecondaryCache(void)
+ *
+ * Description :
+ *  Check that the pages evicted from the page buffer pool are read back
+ *  intact from the secondary cache instead of the volume, and that the
+ *  copy of a page is dropped when the page is updated.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_SecondaryCache(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Page		copy;							/* copy of a page read from the cache */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	e = EduBfM_SetSecondaryCache(PAGE_BUF, CHECK_SECONDARY, 2 * NUM_PAGE_BUFS);
+	if (e < eNOERROR) ERR(e);
+
+	for (i = 0; i < 2 * NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nSecondaryPuts == NUM_PAGE_BUFS, "Check of the pages put into the secondary cache");
+	CHECK(edubfm_SecondaryRead(PAGE_BUF, (BfMHashKey *)&checkPids[0], (char *)&copy) && copy.header.flags == 0, "Check of a copy of the secondary cache");
+
+	e = EduBfM_ResetStats();
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nSecondaryHits == NUM_PAGE_BUFS && stats.secondaryBytesSaved == NUM_PAGE_BUFS * PAGESIZE, "Check of the pages read from the secondary cache");
+
+	/* an update drops the copy, which would be stale */
+	e = check_SetCounters(0, 1, 1);
+	if (e < eNOERROR) ERR(e);
+	CHECK(!edubfm_SecondaryRead(PAGE_BUF, (BfMHashKey *)&checkPids[0], (char *)&copy), "Check of the copy of an updated page");
+	for (i = NUM_PAGE_BUFS; i < 2 * NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = check_Page(0, 1);
+	if (e < eNOERROR) ERR(e);
+
+	e = EduBfM_SetSecondaryCache(PAGE_BUF, NULL, 0);
+	if (e < eNOERROR) ERR(e);
+	e = check_SetCounters(0, 1, 0);
+	if (e < eNOERROR) ERR(e);
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_MakeVolume()
+ *================================*/
+/*
+ * Function: static Four check_MakeVolume(Four *, PageID *, Four)
+ *
+ * Description :
+ *  Format and mount a volume of EduRDsM in the file CHECK_VOLUME, allocate
+ *  `nPages' pages in it and write the flags 100 + i into page i.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_MakeVolume(Four *volNo, PageID *pids, Four nPages)
+{
+	Four	e;									/* for errors */
+	Four	i;									/* loop index */
+	Four	segment;							/* segment of the pages */
+	Page	*apage;								/* pointer to buffer holding a page */
+
+	e = EduRDsM_Format(CHECK_VOLUME, 2001, 200, 16);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_Mount(CHECK_VOLUME, volNo);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_CreateSegment(*volNo, &segment);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_AllocTrains(*volNo, segment, NULL, 100, nPages, PAGESIZE2, pids);
+	if (e < eNOERROR) ERR(e);
+
+	for (i = 0; i < nPages; i++){
+		e = EduBfM_GetTrain(&pids[i], (char **)&apage, PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		memset(apage, 0, PAGESIZE);
+		apage->header.pid = pids[i];
+		apage->header.flags = 100 + i;
+		e = EduBfM_SetDirty(&pids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	return(check_Reset());
+}
+
+
+
+/*@================================
+ * check_DropVolume()
+ *================================*/
+/*
+ * Function: static Four check_DropVolume(Four)
+ *
+ * Description :
+ *  Dismount the volume made by check_MakeVolume() and remove its file.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_DropVolume(Four volNo)
+{
+	Four	e;									/* for errors */
+
+	e = check_Reset();
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_Dismount(volNo);
+	if (e < eNOERROR) ERR(e);
+	remove(CHECK_VOLUME);
+
+	return(eNOERROR);
+}
+
+
+
+/*@================================
+ * check_MapVolume()
+ *================================*/
+/*
+ * Function: static Four check_MapVolume(void)
+ *
+ * Description :
+ *  Check that the pages of a mapped volume are returned from the mapping
+ *  without being read, showing the updates left in the pool before the
+ *  mapping, and that they are read again once the volume is unmapped.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_MapVolume(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Four		volNo;							/* volume of EduRDsM */
+	PageID		pids[NUM_PAGE_BUFS];			/* pages of the volume */
+	char		*devNames[1];					/* device of the volume */
+	Page		*apage;							/* pointer to buffer holding a page */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	e = check_MakeVolume(&volNo, pids, NUM_PAGE_BUFS);
+	if (e < eNOERROR) return(e);
+
+	/* an update left in the pool */
+	e = EduBfM_GetTrain(&pids[0], (char **)&apage, PAGE_BUF);
+	if (e < eNOERROR) ERR(e);
+	((Four *)apage->data)[0] = 1;
+	e = EduBfM_SetDirty(&pids[0], PAGE_BUF);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_FreeTrain(&pids[0], PAGE_BUF);
+	if (e < eNOERROR) ERR(e);
+
+	devNames[0] = CHECK_VOLUME;
+	e = EduBfM_MapVolume(volNo, 1, devNames);
+	if (e < eNOERROR) ERR(e);
+	e = EduBfM_ResetStats();
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < NUM_PAGE_BUFS; i++){
+		e = EduBfM_GetTrain(&pids[i], (char **)&apage, PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		CHECK(apage->header.flags == 100 + i && ((Four *)apage->data)[0] == (i == 0), "Check of a page of a mapped volume");
+		e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nMappedGets == NUM_PAGE_BUFS && stats.nReads == 0, "Check of the pages returned from the mapping");
+
+	e = EduBfM_UnmapVolume(volNo);
+	if (e < eNOERROR) ERR(e);
+	e = check_Reset();
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < NUM_PAGE_BUFS; i++){
+		e = EduBfM_GetTrain(&pids[i], (char **)&apage, PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		CHECK(apage->header.flags == 100 + i, "Check of a page of an unmapped volume");
+		e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nMappedGets == 0 && stats.nReads == NUM_PAGE_BUFS, "Check of the pages read after the unmapping");
+
+	return(check_DropVolume(volNo));
+}
+
+
+
+/*@================================
+ * check_DirectIO()
+ *================================*/
+/*
+ * Function: static Four check_DirectIO(void)
+ *
+ * Description :
+ *  Check that the pages of a volume accessed by direct I/O are written and
+ *  read back intact through the aligned buffers of an arena, and that the
+ *  pool gets the buffers of the storage system back when direct I/O is
+ *  stopped. Nothing is checked where the file system has no direct I/O.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_DirectIO(void)
+{
+	Four		e;								/* for errors */
+	Four		i;								/* loop index */
+	Four		volNo;							/* volume of EduRDsM */
+	PageID		pids[2 * NUM_PAGE_BUFS];		/* pages of the volume */
+	char		*devNames[1];					/* device of the volume */
+	Page		*apage;							/* pointer to buffer holding a page */
+	BfMStats	stats;							/* statistics of the page buffer pool */
+
+	e = check_MakeVolume(&volNo, pids, 2 * NUM_PAGE_BUFS);
+	if (e < eNOERROR) return(e);
+
+	devNames[0] = CHECK_VOLUME;
+	e = EduBfM_SetDirectIO(volNo, 1, devNames);
+	if (e == eBADPARAMETER) return(check_DropVolume(volNo));
+	if (e < eNOERROR) ERR(e);
+	CHECK(bufArena[PAGE_BUF].kind != BFM_ARENA_DEFAULT, "Check of the aligned buffers of direct I/O");
+
+	/* update the pages, evicting half of them */
+	for (i = 0; i < 2 * NUM_PAGE_BUFS; i++){
+		e = EduBfM_GetTrain(&pids[i], (char **)&apage, PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		CHECK(apage->header.flags == 100 + i, "Check of a page read by direct I/O");
+		((Four *)apage->data)[0] = i;
+		e = EduBfM_SetDirty(&pids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = check_Reset();
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < 2 * NUM_PAGE_BUFS; i++){
+		e = EduBfM_GetTrain(&pids[i], (char **)&apage, PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+		CHECK(apage->header.flags == 100 + i && ((Four *)apage->data)[0] == i, "Check of a page written by direct I/O");
+		e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduBfM_GetStats(PAGE_BUF, &stats);
+	if (e < eNOERROR) ERR(e);
+	CHECK(stats.nDirectIOs > 0 && stats.nReads == 2 * NUM_PAGE_BUFS, "Check of the reads by direct I/O");
+
+	e = EduBfM_SetDirectIO(volNo, 0, NULL);
+	if (e < eNOERROR) ERR(e);
+	CHECK(bufArena[PAGE_BUF].kind == BFM_ARENA_DEFAULT && BI_NBUFS(PAGE_BUF) == NUM_PAGE_BUFS, "Check of the buffers of the storage system given back");
+	for (i = 0; i < NUM_PAGE_BUFS; i++){
+		e = check_Page(i, 0);
+		if (e < eNOERROR) ERR(e);
+	}
+
+	return(check_DropVolume(volNo));
+}
+
+
+
+/*@================================
+ * check_EduRDsM()
+ *================================*/
+/*
+ * Function: static Four check_EduRDsM(void)
+ *
+ * Description :
+ *  Check that a volume of EduRDsM allocates distinct pages in the extents
+ *  of a segment, hands out distinct unique numbers, and keeps the pages
+ *  written and its allocations over a dismount, and that the pages of the
+ *  other volumes are passed to RDsM.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_EduRDsM(void)
+{
+	Four		e;								/* for errors */
+	Four		i, j;							/* loop indices */
+	Four		volNo;							/* volume of EduRDsM */
+	Four		segment;						/* segment of the pages */
+	Four		extNo;							/* extent of a page */
+	Four		num;							/* # of unique numbers handed out */
+	Two			extSize;						/* # of pages of an extent */
+	Unique		unique;							/* first unique number handed out */
+	Unique		nextUnique;						/* first unique number not handed out yet */
+	PageID		pids[8];						/* pages of the volume */
+	PageID		firstPid;						/* first page of an extent */
+	Page		page;							/* contents of a page */
+
+	e = EduRDsM_Format(CHECK_VOLUME, 2001, 200, 16);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_Mount(CHECK_VOLUME, &volNo);
+	if (e < eNOERROR) ERR(e);
+	CHECK(volNo == 2001, "Check of the number of a mounted volume");
+	e = EduRDsM_GetSizeOfExt(volNo, &extSize);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_CreateSegment(volNo, &segment);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_AllocTrains(volNo, segment, NULL, 100, 4, PAGESIZE2, pids);
+	if (e < eNOERROR) ERR(e);
+
+	for (i = 0; i < 4; i++){
+		e = EduRDsM_PageIdToExtNo(&pids[i], &extNo);
+		if (e < eNOERROR) ERR(e);
+		e = EduRDsM_ExtNoToPageId(volNo, extNo, &firstPid);
+		if (e < eNOERROR) ERR(e);
+		CHECK(pids[i].volNo == volNo && pids[i].pageNo >= firstPid.pageNo && pids[i].pageNo < firstPid.pageNo + extSize, "Check of the extent of a page");
+
+		memset(&page, 0, sizeof(page));
+		page.header.pid = pids[i];
+		page.header.flags = 200 + i;
+		e = EduRDsM_WriteTrain((char *)&page, &pids[i], PAGESIZE2);
+		if (e < eNOERROR) ERR(e);
+	}
+	e = EduRDsM_GetUnique(&pids[0], &unique, &num);
+	if (e < eNOERROR) ERR(e);
+	nextUnique = unique + num;
+	e = EduRDsM_GetUnique(&pids[0], &unique, &num);
+	if (e < eNOERROR) ERR(e);
+	CHECK(num > 0 && unique >= nextUnique, "Check of the unique numbers handed out");
+	nextUnique = unique + num;
+
+	/* the volume is the same after a dismount */
+	e = EduRDsM_Dismount(volNo);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_Mount(CHECK_VOLUME, &volNo);
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < 4; i++){
+		e = EduRDsM_ReadTrain(&pids[i], (char *)&page, PAGESIZE2);
+		if (e < eNOERROR) ERR(e);
+		CHECK(page.header.flags == 200 + i && page.header.pid.pageNo == pids[i].pageNo, "Check of a page of a remounted volume");
+	}
+	e = EduRDsM_GetUnique(&pids[0], &unique, &num);
+	if (e < eNOERROR) ERR(e);
+	CHECK(unique >= nextUnique, "Check of the unique numbers of a remounted volume");
+	e = EduRDsM_AllocTrains(volNo, segment, &pids[3], 100, 4, PAGESIZE2, &pids[4]);
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < 8; i++)
+		for (j = 0; j < i; j++)
+			CHECK(pids[i].pageNo != pids[j].pageNo, "Check of the pages allocated");
+
+	/* a page of the volume of the storage system */
+	e = EduRDsM_ReadTrain(&checkPids[1], (char *)&page, PAGESIZE2);
+	if (e < eNOERROR) ERR(e);
+	CHECK(page.header.flags == 1 && page.header.pid.pageNo == checkPids[1].pageNo, "Check of a page read through RDsM");
+
+	e = EduRDsM_Dismount(volNo);
+	if (e < eNOERROR) ERR(e);
+	remove(CHECK_VOLUME);
+
+	return(eNOERROR);
+}
+
+
+
+/*@================================
+ * check_AllocCursor()
+ *================================*/
+/*
+ * Function: static Four check_AllocCursor(void)
+ *
+ * Description :
+ *  Check that an allocation cursor hands out the pages of a volume of
+ *  EduRDsM in contiguous runs in ascending order, and that the pages it
+ *  has reserved but not handed out are freed on close and allocated again.
+ *
+ * Returns:
+ *  error code
+ */
+static Four check_AllocCursor(void)
+{
+	Four				e;						/* for errors */
+	Four				i;						/* loop index */
+	Four				volNo;					/* volume of EduRDsM */
+	Four				segment;				/* segment of the pages */
+	PageID				pids[NUM_CURSOR_PAGES];	/* pages handed out by the cursor */
+	PageID				freed[NUM_CURSOR_RUN];	/* pages allocated after the cursor is closed */
+	EduRDsMAllocCursor	cursor;					/* allocation cursor */
+
+	e = EduRDsM_Format(CHECK_VOLUME, 2001, 200, 16);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_Mount(CHECK_VOLUME, &volNo);
+	if (e < eNOERROR) ERR(e);
+	e = EduRDsM_CreateSegment(volNo, &segment);
+	if (e < eNOERROR) ERR(e);
+
+	e = EduRDsM_OpenAllocCursor(volNo, segment, NULL, 100, PAGESIZE2, NUM_CURSOR_RUN, &cursor);
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < NUM_CURSOR_PAGES; i++){
+		e = EduRDsM_AllocFromCursor(&cursor, &pids[i]);
+		if (e < eNOERROR) ERR(e);
+		CHECK(i == 0 || pids[i].pageNo > pids[i - 1].pageNo, "Check of the order of the pages of a cursor");
+		CHECK(i % NUM_CURSOR_RUN == 0 || pids[i].pageNo == pids[i - 1].pageNo + PAGESIZE2, "Check of a run of a cursor");
+	}
+	e = EduRDsM_CloseAllocCursor(&cursor);
+	if (e < eNOERROR) ERR(e);
+
+	/* the rest of the last run is allocated again */
+	e = EduRDsM_AllocTrains(volNo, segment, &pids[NUM_CURSOR_PAGES - 1], 100, NUM_CURSOR_RUN - NUM_CURSOR_PAGES % NUM_CURSOR_RUN, PAGESIZE2, freed);
+	if (e < eNOERROR) ERR(e);
+	for (i = 0; i < NUM_CURSOR_RUN - NUM_CURSOR_PAGES % NUM_CURSOR_RUN; i++)
+		CHECK(freed[i].pageNo == pids[NUM_CURSOR_PAGES - 1].pageNo + (i + 1) * PAGESIZE2, "Check of a page freed by the close of a cursor");
+
+	e = EduRDsM_Dismount(volNo);
+	if (e < eNOERROR) ERR(e);
+	remove(CHECK_VOLUME);
+
+	return(eNOERROR);
+}
+
+
+
+/*@================================
+ * edubfm_CheckExtensions()
+ *================================*/
+/*
+ * Function: static Four edubfm_CheckExtensions(Four)
+ *
+ * Description :
+ *  Check the behavior of the extensions of EduBfM on the pages of the
+ *  volume `volId'. A failed check is reported and ends the checks.
+ *
+ * Returns:
+ *  error code
+ */
+static Four edubfm_CheckExtensions(Four volId)
+{
+	Four	e;									/* for errors */
+
+	e = check_AllocPages(volId);
+	if (e < eNOERROR) ERR(e);
+
+	e = check_Partitions();
+	if (e < eNOERROR) return(e);
+
+	e = check_OpenHash();
+	if (e < eNOERROR) return(e);
+
+	e = check_Policies();
+	if (e < eNOERROR) return(e);
+
+	e = check_Stats();
+	if (e < eNOERROR) return(e);
+
+	e = check_Cleaner();
+	if (e < eNOERROR) return(e);
+
+	e = check_AsyncIO();
+	if (e < eNOERROR) return(e);
+
+	e = check_ReadAhead();
+	if (e < eNOERROR) return(e);
+
+	e = check_SortedFlush();
+	if (e < eNOERROR) return(e);
+
+	e = check_DirtyFlush();
+	if (e < eNOERROR) return(e);
+
+	e = check_Strategies();
+	if (e < eNOERROR) return(e);
+
+	e = check_PoolAllocation();
+	if (e < eNOERROR) return(e);
+
+	e = check_Resize();
+	if (e < eNOERROR) return(e);
+
+	e = check_AdaptiveSplit();
+	if (e < eNOERROR) return(e);
+
+	e = check_HotSet();
+	if (e < eNOERROR) return(e);
+
+	e = check_BatchTrains();
+	if (e < eNOERROR) return(e);
+
+	e = check_FreeList();
+	if (e < eNOERROR) return(e);
+
+	e = check_Invalidate();
+	if (e < eNOERROR) return(e);
+
+	e = check_TableLayout();
+	if (e < eNOERROR) return(e);
+
+	e = check_CleanFirst();
+	if (e < eNOERROR) return(e);
+
+	e = check_VictimCache();
+	if (e < eNOERROR) return(e);
+
+	e = check_SecondaryCache();
+	if (e < eNOERROR) return(e);
+
+	e = check_MapVolume();
+	if (e < eNOERROR) return(e);
+
+	e = check_DirectIO();
+	if (e < eNOERROR) return(e);
+
+	e = check_EduRDsM();
+	if (e < eNOERROR) return(e);
+
+	e = check_AllocCursor();
+	if (e < eNOERROR) return(e);
+
+	return(eNOERROR);
+}
+
+
+
 Four main()
 {
 
@@ -144,6 +2426,12 @@ Four main()
 		LRDS_Final();
 	}
 
+	/* Check the extensions of EduBfM */
+	e = edubfm_CheckExtensions(volId);
+	if (e < eNOERROR){
+		printf("edubfm_CheckExtensions failed!!!\n");
+	}
+
 	/* Commit Transaction */
 	e = LRDS_CommitTransaction(&xactId);
 	if (e < eNOERROR){
@@ -0,0 +1,111 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_UnmapVolume.c
+ *
+ * Description :
+ *  Stop using the mapping of a volume mapped by EduBfM_MapVolume().
+ *
+ * Exports:
+ *  Four EduBfM_UnmapVolume(Four)
+ */
+
+
+#include <sys/mman.h> /* for munmap */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_UnmapVolume()
+ *================================*/
+/*
+ * Function: Four EduBfM_UnmapVolume(Four)
+ *
+ * Description :
+ *  Unmap the volume `volNo', whose trains are read into the pools again
+ *  from now on. No train of the volume may be fixed, since the pointers
+ *  returned for them become invalid. Call it before the volume is
+ *  dismounted.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the volume is not mapped
+ */
+Four EduBfM_UnmapVolume(
+    Four                volNo)                  /* IN volume to be unmapped */
+{
+    Four                i;                      /* index */
+    Four                d;                      /* device */
+    Four                nDevices;               /* # of devices of the volume */
+    BfMMappedVolume     *v;                     /* entry of the volume */
+
+
+    BFM_GETLATCH(&bufMapped.latch);
+
+    for (i = 0; i < MAXNUMOFMAPPEDVOLUMES; i++)
+        if (bufMapped.volumes[i].nDevices > 0 && bufMapped.volumes[i].volNo == volNo) break;
+    if (i == MAXNUMOFMAPPEDVOLUMES) ERRL(eBADPARAMETER, &bufMapped.latch);
+    v = &bufMapped.volumes[i];
+
+    /* the entry is not found any more before it is unmapped */
+    nDevices = v->nDevices;
+    v->nDevices = 0;
+    bufMapped.nMapped--;
+    __sync_synchronize();
+
+    for (d = 0; d < nDevices; d++)
+        munmap(v->base[d], v->size[d]);
+
+    BFM_RELEASELATCH(&bufMapped.latch);
+
+    return(eNOERROR);
+
+}  /* EduBfM_UnmapVolume() */
@@ -0,0 +1,110 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_WaitTrain.c
+ *
+ * Description :
+ *  Wait for a train requested by EduBfM_GetTrainAsync().
+ *
+ * Exports:
+ *  Four EduBfM_WaitTrain(BfMIOHandle *, char **)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_WaitTrain()
+ *================================*/
+/*
+ * Function: Four EduBfM_WaitTrain(BfMIOHandle *, char **)
+ *
+ * Description :
+ *  Wait until the train requested through `handle' is in its buffer and
+ *  return the buffer. The train is fixed as if returned by EduBfM_GetTrain().
+ *  A request not bound to the read of its train yet is bound first by
+ *  edubfm_JoinTrain().
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - `handle' is NULL
+ *    eBADBUFFER_BFM - Invalid Buffer
+ *    some errors caused by the read of the train
+ *
+ * Side effects:
+ *  1) parameter retBuf
+ *     pointer to buffer holding the disk train
+ */
+Four EduBfM_WaitTrain(
+    BfMIOHandle         *handle,                /* IN handle of the request */
+    char                **retBuf)               /* OUT pointer to the returned buffer */
+{
+    Four                e;                      /* for error */
+
+
+    /*@ Check the validity of given parameters */
+    if (handle == NULL) ERR(eBADPARAMETER);
+    if (retBuf == NULL) ERR(eBADBUFFER_BFM);
+
+    if (handle->op == BFM_IO_JOIN) {
+        e = edubfm_JoinTrain(handle, TRUE);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    e = edubfm_WaitIO(handle);
+    if (e < eNOERROR) ERR(e);
+
+    *retBuf = handle->buffer;
+
+    return(eNOERROR);
+
+}  /* EduBfM_WaitTrain() */
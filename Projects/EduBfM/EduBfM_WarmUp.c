@@ -0,0 +1,315 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_WarmUp.c
+ *
+ * Description :
+ *  Load the trains saved in a hot set file into the buffer pools.
+ *
+ * Exports:
+ *  Four EduBfM_WarmUp(char *)
+ */
+
+
+#include <errno.h> /* for errno */
+#include <stdio.h> /* for fopen, fread & fclose */
+#include <stdlib.h> /* for malloc, free & qsort */
+#include <string.h> /* for memcmp & strlen */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * internal function prototypes
+ */
+static Four edubfm_ReadHotSet(char *, BfMHotEntry **, Four *);
+static int edubfm_CompareHotEntries(const void *, const void *);
+static Four edubfm_ClaimBuffer(Four, BfMHashKey *, BfMFlushEntry *);
+
+
+
+/*@================================
+ * EduBfM_WarmUp()
+ *================================*/
+/*
+ * Function: Four EduBfM_WarmUp(char *)
+ *
+ * Description :
+ *  Load the trains saved in the hot set file `path' (see
+ *  EduBfM_SetHotSetFile()) into the pools, to be called after the volumes
+ *  are mounted. The trains of each pool are taken from the hottest, as
+ *  many as the buffers of each partition can hold, and are loaded
+ *  BFM_WARMUP_BATCH at a time: the trains of a batch are read in the
+ *  order of (volNo, pageNo), and trains contiguous on the disk are read
+ *  by one I/O of up to BFM_FLUSH_MAXRUN trains.
+ *  A train already in the pool is left as it is. The loaded trains are
+ *  unfixed and not referenced yet, so that they are evicted first if
+ *  they are not used again. Nothing is done if the file does not exist.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - `path' is NULL or is not a hot set file
+ *    eMEMORYALLOCERR - memory allocation failed
+ *    some errors caused by the reads
+ */
+Four EduBfM_WarmUp(
+    char                *path)                  /* IN hot set file */
+{
+    Four                e;                      /* error */
+    Four                firstError;             /* first error of the reads */
+    Four                type;                   /* buffer type */
+    Four                i, j;                   /* indices */
+    Four                p;                      /* partition of a train */
+    Four                n;                      /* # of trains in the batch */
+    Four                nClaimed;               /* # of trains of the batch to be read */
+    Four                nEntries;               /* # of trains in the file */
+    BfMHotEntry         *entries;               /* trains in the file */
+    BfMHotEntry         batch[BFM_WARMUP_BATCH];        /* trains loaded together */
+    BfMFlushEntry       claimed[BFM_WARMUP_BATCH];      /* trains of the batch not in the pool yet */
+    Four                nTaken[MAXNUMOFPARTITIONS];     /* # of trains taken for each partition */
+
+
+    /*@ check if the parameters are valid. */
+    if (path == NULL) ERR(eBADPARAMETER);
+
+    e = edubfm_ReadHotSet(path, &entries, &nEntries);
+    if (e < eNOERROR) ERR(e);
+    if (entries == NULL) return(eNOERROR);
+
+    firstError = eNOERROR;
+    for (type = 0; type < NUM_BUF_TYPES && firstError == eNOERROR; type++) {
+        /* the cleaner latch keeps the partitions from being rebuilt meanwhile */
+        BFM_GETLATCH(BI_CLEANERLATCH(type));
+
+        for (p = 0; p < BI_NPARTITIONS(type); p++) nTaken[p] = 0;
+
+        for (i = 0; i < nEntries && firstError == eNOERROR; ) {
+            /*@ take the next hottest trains which fit in their partitions */
+            for (n = 0; i < nEntries && n < BFM_WARMUP_BATCH; i++) {
+                if (entries[i].type != type) continue;
+                p = BI_PARTITIONOFKEY(type, &entries[i].key);
+                if (nTaken[p] >= BI_PARTNBUFS(type, p)) continue;
+                nTaken[p]++;
+                batch[n++] = entries[i];
+            }
+            if (n == 0) break;
+
+            /*@ claim the buffers, and read the trains in the disk order */
+            qsort(batch, n, sizeof(BfMHotEntry), edubfm_CompareHotEntries);
+
+            for (nClaimed = 0, j = 0; j < n; j++)
+                nClaimed += edubfm_ClaimBuffer(type, &batch[j].key, &claimed[nClaimed]);
+
+            if (nClaimed == 0) continue;
+
+            e = edubfm_ReadTrains(claimed, nClaimed, TRUE);
+            if (e < eNOERROR && firstError == eNOERROR) firstError = e;
+            for (j = 0; j < nClaimed; j++)
+                if (claimed[j].index >= 0) BFM_STATS_INC(type, nWarmedUp);
+        }
+
+        BFM_RELEASELATCH(BI_CLEANERLATCH(type));
+    }
+
+    free(entries);
+
+    if (firstError < eNOERROR) ERR(firstError);
+
+    return(eNOERROR);
+
+}  /* EduBfM_WarmUp() */
+
+
+
+/*@================================
+ * edubfm_ReadHotSet()
+ *================================*/
+/*
+ * Function: static Four edubfm_ReadHotSet(char *, BfMHotEntry **, Four *)
+ *
+ * Description :
+ *  Read the entries of a hot set file.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the file is not a hot set file
+ *    eMEMORYALLOCERR - memory allocation failed
+ *
+ * Side effects:
+ *  1) parameter entries
+ *     array of the entries to be freed by the caller; NULL if the file
+ *     does not exist or is empty
+ *  2) parameter nEntries
+ *     # of the entries
+ */
+static Four edubfm_ReadHotSet(
+    char                *path,                  /* IN hot set file */
+    BfMHotEntry         **entries,              /* OUT entries of the file */
+    Four                *nEntries)              /* OUT # of the entries */
+{
+    Four                e;                      /* error */
+    FILE                *fp;                    /* the file */
+    char                magic[sizeof(BFM_HOTSET_MAGIC)];        /* first bytes of the file */
+
+
+    *entries = NULL;
+    *nEntries = 0;
+
+    fp = fopen(path, "rb");
+    if (fp == NULL) {
+        if (errno == ENOENT) return(eNOERROR);
+        ERR(eBADPARAMETER);
+    }
+
+    e = eNOERROR;
+    if (fread(magic, 1, strlen(BFM_HOTSET_MAGIC), fp) != strlen(BFM_HOTSET_MAGIC) ||
+        memcmp(magic, BFM_HOTSET_MAGIC, strlen(BFM_HOTSET_MAGIC)) != 0 ||
+        fread(nEntries, sizeof(Four), 1, fp) != 1 ||
+        *nEntries < 0 || *nEntries > NUM_BUF_TYPES * BFM_MAXNBUFS)
+        e = eBADPARAMETER;
+
+    if (e == eNOERROR && *nEntries > 0) {
+        *entries = (BfMHotEntry*)malloc(sizeof(BfMHotEntry) * *nEntries);
+        if (*entries == NULL) e = eMEMORYALLOCERR;
+        else if (fread(*entries, sizeof(BfMHotEntry), *nEntries, fp) != (size_t)*nEntries) e = eBADPARAMETER;
+    }
+
+    fclose(fp);
+
+    if (e < eNOERROR) {
+        if (*entries != NULL) free(*entries);
+        *entries = NULL;
+        ERR(e);
+    }
+
+    return(eNOERROR);
+
+}  /* edubfm_ReadHotSet() */
+
+
+
+/*@================================
+ * edubfm_CompareHotEntries()
+ *================================*/
+/*
+ * Function: static int edubfm_CompareHotEntries(const void *, const void *)
+ *
+ * Description :
+ *  Order the trains by (volNo, pageNo) for qsort().
+ *
+ * Returns:
+ *  negative, zero or positive as the first train goes before, with or
+ *  after the second one
+ */
+static int edubfm_CompareHotEntries(
+    const void          *a,                     /* IN a train */
+    const void          *b)                     /* IN another train */
+{
+    const BfMHotEntry   *x = (const BfMHotEntry*)a;
+    const BfMHotEntry   *y = (const BfMHotEntry*)b;
+
+
+    if(x->key.volNo != y->key.volNo) return((x->key.volNo < y->key.volNo) ? -1 : 1);
+    if(x->key.pageNo != y->key.pageNo) return((x->key.pageNo < y->key.pageNo) ? -1 : 1);
+    return(0);
+
+}  /* edubfm_CompareHotEntries() */
+
+
+
+/*@================================
+ * edubfm_ClaimBuffer()
+ *================================*/
+/*
+ * Function: static Four edubfm_ClaimBuffer(Four, BfMHashKey *, BfMFlushEntry *)
+ *
+ * Description :
+ *  Claim a buffer for a train to be loaded by edubfm_ClaimTrain(). Nothing
+ *  is done if the train is already in the pool, a victim of its partition
+ *  is being written back or no buffer can be allocated; the warm-up is
+ *  only a hint.
+ *
+ * Returns:
+ *  1 if a buffer has been claimed, 0 otherwise
+ *
+ * Side effects:
+ *  1) parameter entry
+ *     the train and its buffer if 1 is returned
+ */
+static Four edubfm_ClaimBuffer(
+    Four                type,                   /* IN buffer type */
+    BfMHashKey          *key,                   /* IN train to load */
+    BfMFlushEntry       *entry)                 /* OUT the train and its buffer */
+{
+    Four                index;                  /* index of the buffer */
+    Four                part;                   /* partition holding the train */
+    pthread_mutex_t     *latch;                 /* latch of the partition */
+
+
+    part = BI_PARTITIONOFKEY(type, key);
+    latch = BI_PARTLATCH(type, part);
+    BFM_GETLATCH(latch);
+
+    index = NOTFOUND_IN_HTABLE;
+    if (!BI_PARTEVICTING(type, part) && edubfm_LookUp(key, type) == NOTFOUND_IN_HTABLE)
+        index = edubfm_ClaimTrain(type, part, key, ALL_0);
+
+    BFM_RELEASELATCH(latch);
+
+    if (index < 0) return(0);
+
+    entry->key = *key;
+    entry->type = type;
+    entry->index = index;
+    entry->part = part;
+
+    return(1);
+
+}  /* edubfm_ClaimBuffer() */
@@ -0,0 +1,708 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduRDsM_Alloc.c
+ *
+ * Description :
+ *  Allocation of the extents and pages of the volumes mounted by
+ *  EduRDsM_Mount(), and the numbering of their extents and unique numbers;
+ *  the calls for the other volumes are passed to RDsM. A segment is a
+ *  chain of extents identified by its first extent, and a train is
+ *  allocated at a multiple of its size in an extent of its segment.
+ *
+ * Exports:
+ *  Four EduRDsM_CreateSegment(Four, Four *)
+ *  Four EduRDsM_AllocTrains(Four, Four, PageID *, Two, Four, Two, PageID *)
+ *  Four EduRDsM_AllocContigTrains(Four, Four, PageID *, Two, Four, Two, PageID *, Four *)
+ *  Four EduRDsM_PageIdToExtNo(PageID *, Four *)
+ *  Four EduRDsM_ExtNoToPageId(Four, Four, PageID *)
+ *  Four EduRDsM_GetSizeOfExt(Four, Two *)
+ *  Four EduRDsM_GetUnique(PageID *, Unique *, Four *)
+ *  Four edurdsm_FreeRun(EduRDsMVolume *, PageID *, Four, Two)
+ */
+
+
+#include "EduBfM_common.h"
+#include "RDsM.h"
+#include "EduBfM_Internal.h"
+#include "EduRDsM.h"
+
+
+
+/*@
+ * macro definitions
+ */
+/* Macro: EDURDSM_METAPAGE(ext)
+ * Description: return the page of the extent table holding the entry of the extent
+ */
+#define EDURDSM_METAPAGE(ext)   (1 + (ext) / EDURDSM_EXTSPERPAGE)
+
+/* Macro: EDURDSM_TOUCH(first, last, ext)
+ * Description: widen the range of changed pages [first, last] of the extent table to the entry of the extent
+ */
+#define EDURDSM_TOUCH(first, last, ext) \
+    do { \
+        if (EDURDSM_METAPAGE(ext) < (first)) (first) = EDURDSM_METAPAGE(ext); \
+        if (EDURDSM_METAPAGE(ext) > (last)) (last) = EDURDSM_METAPAGE(ext); \
+    } while (0)
+
+
+
+/*@
+ * internal function prototypes
+ */
+static Four edurdsm_NewExtent(EduRDsMVolume *, Four);
+static Four edurdsm_NearExtent(EduRDsMVolume *, Four, PageID *);
+static Four edurdsm_AllocRun(EduRDsMVolume *, Four, Four, Two, Two, Four, PageID *, Four *, Four *, Four *);
+static Four edurdsm_AllocInExtent(EduRDsMVolume *, Four, Two, Four, Four, Four *);
+
+
+
+/*@================================
+ * EduRDsM_CreateSegment()
+ *================================*/
+/*
+ * Function: Four EduRDsM_CreateSegment(Four, Four *)
+ *
+ * Description :
+ *  Create a segment of one free extent in the volume `volNo'.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad parameters
+ *    eVOLUMEFULL_EDUBFM - no extent is free
+ *    eIOFAILED_EDUBFM - the extent table cannot be written
+ *    some errors caused by RDsM_CreateSegment()
+ *
+ * Side effects:
+ *  1) parameter firstExtNo
+ *     firstExtNo is the first extent of the segment, which identifies it
+ */
+Four EduRDsM_CreateSegment(
+    Four                volNo,                  /* IN volume */
+    Four                *firstExtNo)            /* OUT first extent of the segment */
+{
+    Four                e;                      /* for error */
+    Four                ext;                    /* extent allocated */
+    EduRDsMVolume       *v;                     /* entry of the volume */
+
+
+    /*@ check if the parameters are valid. */
+    if (firstExtNo == NULL) ERR(eBADPARAMETER);
+
+    v = edurdsm_Volume(volNo);
+    if (v == NULL) return(RDsM_CreateSegment(volNo, firstExtNo));
+
+    BFM_GETLATCH(&v->latch);
+
+    ext = edurdsm_NewExtent(v, NIL);
+    if (ext == NIL) ERRL(eVOLUMEFULL_EDUBFM, &v->latch);
+    v->exts[ext].owner = ext;
+    v->exts[ext].next = NIL;
+
+    e = edurdsm_WriteMeta(v, EDURDSM_METAPAGE(ext), EDURDSM_METAPAGE(ext));
+    if (e < eNOERROR) ERRL(e, &v->latch);
+
+    BFM_RELEASELATCH(&v->latch);
+
+    *firstExtNo = ext;
+
+    return(eNOERROR);
+
+}  /* EduRDsM_CreateSegment() */
+
+
+
+/*@================================
+ * EduRDsM_AllocTrains()
+ *================================*/
+/*
+ * Function: Four EduRDsM_AllocTrains(Four, Four, PageID *, Two, Four, Two, PageID *)
+ *
+ * Description :
+ *  Allocate `nTrains' trains of `sizeOfTrain' pages to the segment whose
+ *  first extent is `firstExtNo', in the extent of `nearPid' if it belongs
+ *  to the segment and has room, else in the first extent of the segment
+ *  having room, else in a new extent chained to the segment, preferably
+ *  the one following its last extent. An extent is filled up to `eff'
+ *  percent of its pages. The trains allocated before a failure stay
+ *  allocated.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad parameters
+ *    eVOLUMEFULL_EDUBFM - no extent is free
+ *    eIOFAILED_EDUBFM - the extent table cannot be written
+ *    some errors caused by RDsM_AllocTrains()
+ *
+ * Side effects:
+ *  1) parameter trainIds
+ *     trainIds[i] is the i-th train allocated
+ */
+Four EduRDsM_AllocTrains(
+    Four                volNo,                  /* IN volume */
+    Four                firstExtNo,             /* IN first extent of the segment */
+    PageID              *nearPid,               /* IN page near which the trains are wanted, or NULL */
+    Two                 eff,                    /* IN extent fill factor in percent */
+    Four                nTrains,                /* IN # of trains to be allocated */
+    Two                 sizeOfTrain,            /* IN # of pages of a train */
+    PageID              *trainIds)              /* OUT trains allocated */
+{
+    Four                e;                      /* for error */
+    Four                eWrite;                 /* error of writing the extent table */
+    Four                i;                      /* index */
+    Four                n;                      /* # of trains allocated by a call */
+    Four                near;                   /* extent tried first */
+    Four                firstMeta, lastMeta;    /* pages of the extent table changed */
+    EduRDsMVolume       *v;                     /* entry of the volume */
+
+
+    v = edurdsm_Volume(volNo);
+    if (v == NULL) return(RDsM_AllocTrains(volNo, firstExtNo, nearPid, eff, nTrains, sizeOfTrain, trainIds));
+
+    /*@ check if the parameters are valid. */
+    if (trainIds == NULL || nTrains < 1 || eff < 1 || eff > 100 || firstExtNo < 0 || firstExtNo >= v->nExts ||
+        sizeOfTrain < 1 || sizeOfTrain > v->hdr.extSize || v->hdr.extSize % sizeOfTrain != 0)
+        ERR(eBADPARAMETER);
+
+    BFM_GETLATCH(&v->latch);
+
+    if (v->exts[firstExtNo].owner != firstExtNo) ERRL(eBADPARAMETER, &v->latch);
+    near = edurdsm_NearExtent(v, firstExtNo, nearPid);
+
+    e = eNOERROR;
+    firstMeta = v->hdr.nMetaPages;
+    lastMeta = 0;
+    for (i = 0; i < nTrains && e >= eNOERROR; i++) {
+        e = edurdsm_AllocRun(v, firstExtNo, near, eff, sizeOfTrain, 1, &trainIds[i], &n, &firstMeta, &lastMeta);
+        if (e >= eNOERROR) near = trainIds[i].pageNo / v->hdr.extSize;
+    }
+
+    if (firstMeta <= lastMeta) {
+        eWrite = edurdsm_WriteMeta(v, firstMeta, lastMeta);
+        if (e >= eNOERROR) e = eWrite;
+    }
+
+    BFM_RELEASELATCH(&v->latch);
+
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+}  /* EduRDsM_AllocTrains() */
+
+
+
+/*@================================
+ * EduRDsM_AllocContigTrains()
+ *================================*/
+/*
+ * Function: Four EduRDsM_AllocContigTrains(Four, Four, PageID *, Two, Four, Two, PageID *, Four *)
+ *
+ * Description :
+ *  Allocate up to `nTrains' contiguous trains of `sizeOfTrain' pages in
+ *  one extent of the segment whose first extent is `firstExtNo', choosing
+ *  the extent as EduRDsM_AllocTrains() does, with one update of the extent
+ *  table. The run ends at the first page allocated already, at the end of
+ *  the extent, or when the extent is filled up to `eff' percent of its
+ *  pages, so fewer trains may be allocated. The volume must be mounted by
+ *  EduRDsM_Mount().
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad parameters, or the volume is not mounted
+ *    eVOLUMEFULL_EDUBFM - no extent is free
+ *    eIOFAILED_EDUBFM - the extent table cannot be written
+ *
+ * Side effects:
+ *  1) parameter firstTrainId
+ *     firstTrainId is the first train of the run
+ *  2) parameter nAllocated
+ *     nAllocated is the # of trains of the run
+ */
+Four EduRDsM_AllocContigTrains(
+    Four                volNo,                  /* IN volume */
+    Four                firstExtNo,             /* IN first extent of the segment */
+    PageID              *nearPid,               /* IN page near which the trains are wanted, or NULL */
+    Two                 eff,                    /* IN extent fill factor in percent */
+    Four                nTrains,                /* IN max # of trains to be allocated */
+    Two                 sizeOfTrain,            /* IN # of pages of a train */
+    PageID              *firstTrainId,          /* OUT first train of the run */
+    Four                *nAllocated)            /* OUT # of trains of the run */
+{
+    Four                e;                      /* for error */
+    Four                firstMeta, lastMeta;    /* pages of the extent table changed */
+    EduRDsMVolume       *v;                     /* entry of the volume */
+
+
+    /*@ check if the parameters are valid. */
+    v = edurdsm_Volume(volNo);
+    if (v == NULL || firstTrainId == NULL || nAllocated == NULL || nTrains < 1 || eff < 1 || eff > 100 ||
+        firstExtNo < 0 || firstExtNo >= v->nExts ||
+        sizeOfTrain < 1 || sizeOfTrain > v->hdr.extSize || v->hdr.extSize % sizeOfTrain != 0)
+        ERR(eBADPARAMETER);
+
+    BFM_GETLATCH(&v->latch);
+
+    if (v->exts[firstExtNo].owner != firstExtNo) ERRL(eBADPARAMETER, &v->latch);
+
+    firstMeta = v->hdr.nMetaPages;
+    lastMeta = 0;
+    e = edurdsm_AllocRun(v, firstExtNo, edurdsm_NearExtent(v, firstExtNo, nearPid), eff, sizeOfTrain, nTrains,
+                         firstTrainId, nAllocated, &firstMeta, &lastMeta);
+    if (e >= eNOERROR) e = edurdsm_WriteMeta(v, firstMeta, lastMeta);
+    if (e < eNOERROR) ERRL(e, &v->latch);
+
+    BFM_RELEASELATCH(&v->latch);
+
+    return(eNOERROR);
+
+}  /* EduRDsM_AllocContigTrains() */
+
+
+
+/*@================================
+ * EduRDsM_PageIdToExtNo()
+ *================================*/
+/*
+ * Function: Four EduRDsM_PageIdToExtNo(PageID *, Four *)
+ *
+ * Description :
+ *  Find the extent holding the page `pageId'.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the page is not in the volume
+ *    some errors caused by RDsM_PageIdToExtNo()
+ *
+ * Side effects:
+ *  1) parameter extNo
+ *     extNo is the extent holding the page
+ */
+Four EduRDsM_PageIdToExtNo(
+    PageID              *pageId,                /* IN page */
+    Four                *extNo)                 /* OUT extent holding the page */
+{
+    EduRDsMVolume       *v;                     /* entry of the volume */
+
+
+    v = edurdsm_Volume(pageId->volNo);
+    if (v == NULL) return(RDsM_PageIdToExtNo(pageId, extNo));
+
+    if (extNo == NULL || pageId->pageNo < 0 || pageId->pageNo / v->hdr.extSize >= v->nExts) ERR(eBADPARAMETER);
+
+    *extNo = pageId->pageNo / v->hdr.extSize;
+
+    return(eNOERROR);
+
+}  /* EduRDsM_PageIdToExtNo() */
+
+
+
+/*@================================
+ * EduRDsM_ExtNoToPageId()
+ *================================*/
+/*
+ * Function: Four EduRDsM_ExtNoToPageId(Four, Four, PageID *)
+ *
+ * Description :
+ *  Find the first page of the extent `extNo' of the volume `volNo'.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the extent is not in the volume
+ *    some errors caused by RDsM_ExtNoToPageId()
+ *
+ * Side effects:
+ *  1) parameter pageId
+ *     pageId is the first page of the extent
+ */
+Four EduRDsM_ExtNoToPageId(
+    Four                volNo,                  /* IN volume */
+    Four                extNo,                  /* IN extent */
+    PageID              *pageId)                /* OUT first page of the extent */
+{
+    EduRDsMVolume       *v;                     /* entry of the volume */
+
+
+    v = edurdsm_Volume(volNo);
+    if (v == NULL) return(RDsM_ExtNoToPageId(volNo, extNo, pageId));
+
+    if (pageId == NULL || extNo < 0 || extNo >= v->nExts) ERR(eBADPARAMETER);
+
+    pageId->volNo = volNo;
+    pageId->pageNo = extNo * v->hdr.extSize;
+
+    return(eNOERROR);
+
+}  /* EduRDsM_ExtNoToPageId() */
+
+
+
+/*@================================
+ * EduRDsM_GetSizeOfExt()
+ *================================*/
+/*
+ * Function: Four EduRDsM_GetSizeOfExt(Four, Two *)
+ *
+ * Description :
+ *  Get the # of pages of an extent of the volume `volNo'.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad parameters
+ *    some errors caused by RDsM_GetSizeOfExt()
+ *
+ * Side effects:
+ *  1) parameter extSize
+ *     extSize is the # of pages of an extent
+ */
+Four EduRDsM_GetSizeOfExt(
+    Four                volNo,                  /* IN volume */
+    Two                 *extSize)               /* OUT # of pages of an extent */
+{
+    EduRDsMVolume       *v;                     /* entry of the volume */
+
+
+    v = edurdsm_Volume(volNo);
+    if (v == NULL) return(RDsM_GetSizeOfExt(volNo, extSize));
+
+    if (extSize == NULL) ERR(eBADPARAMETER);
+
+    *extSize = v->hdr.extSize;
+
+    return(eNOERROR);
+
+}  /* EduRDsM_GetSizeOfExt() */
+
+
+
+/*@================================
+ * EduRDsM_GetUnique()
+ *================================*/
+/*
+ * Function: Four EduRDsM_GetUnique(PageID *, Unique *, Four *)
+ *
+ * Description :
+ *  Hand out EDURDSM_UNIQUEBLOCK unique numbers of the volume of the page
+ *  `pageId', from the counter kept in the header page of the volume.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad parameters
+ *    eIOFAILED_EDUBFM - the header page cannot be written
+ *    some errors caused by RDsM_GetUnique()
+ *
+ * Side effects:
+ *  1) parameter unique
+ *     unique is the first unique number handed out
+ *  2) parameter num
+ *     num is the # of unique numbers handed out
+ */
+Four EduRDsM_GetUnique(
+    PageID              *pageId,                /* IN page for which the numbers are wanted */
+    Unique              *unique,                /* OUT first unique number */
+    Four                *num)                   /* OUT # of unique numbers */
+{
+    Four                e;                      /* for error */
+    EduRDsMVolume       *v;                     /* entry of the volume */
+
+
+    v = edurdsm_Volume(pageId->volNo);
+    if (v == NULL) return(RDsM_GetUnique(pageId, unique, num));
+
+    if (unique == NULL || num == NULL) ERR(eBADPARAMETER);
+
+    BFM_GETLATCH(&v->latch);
+
+    *unique = v->hdr.nextUnique;
+    *num = EDURDSM_UNIQUEBLOCK;
+    v->hdr.nextUnique += EDURDSM_UNIQUEBLOCK;
+
+    e = edurdsm_WriteMeta(v, 0, 0);
+    if (e < eNOERROR) ERRL(e, &v->latch);
+
+    BFM_RELEASELATCH(&v->latch);
+
+    return(eNOERROR);
+
+}  /* EduRDsM_GetUnique() */
+
+
+
+/*@================================
+ * edurdsm_FreeRun()
+ *================================*/
+/*
+ * Function: Four edurdsm_FreeRun(EduRDsMVolume *, PageID *, Four, Two)
+ *
+ * Description:
+ *  Free the `nTrains' contiguous trains of `sizeOfTrain' pages from
+ *  `firstTrainId' on, which lie in one extent. The extent stays in its
+ *  segment.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the trains do not lie in one extent
+ *    eIOFAILED_EDUBFM - the extent table cannot be written
+ */
+Four edurdsm_FreeRun(
+    EduRDsMVolume       *v,                     /* IN volume */
+    PageID              *firstTrainId,          /* IN first train to be freed */
+    Four                nTrains,                /* IN # of trains */
+    Two                 sizeOfTrain)            /* IN # of pages of a train */
+{
+    Four                e;                      /* for error */
+    Four                i;                      /* index */
+    Four                ext;                    /* extent of the trains */
+    Four                k;                      /* first page of the trains in the extent */
+
+
+    ext = firstTrainId->pageNo / v->hdr.extSize;
+    k = firstTrainId->pageNo % v->hdr.extSize;
+    if (firstTrainId->pageNo < 0 || ext >= v->nExts || nTrains < 0 || k + nTrains * sizeOfTrain > v->hdr.extSize)
+        ERR(eBADPARAMETER);
+
+    BFM_GETLATCH(&v->latch);
+
+    for (i = 0; i < nTrains * sizeOfTrain; i++)
+        v->exts[ext].used &= ~((UEight)1 << (k + i));
+
+    e = edurdsm_WriteMeta(v, EDURDSM_METAPAGE(ext), EDURDSM_METAPAGE(ext));
+    if (e < eNOERROR) ERRL(e, &v->latch);
+
+    BFM_RELEASELATCH(&v->latch);
+
+    return(eNOERROR);
+
+} /* edurdsm_FreeRun() */
+
+
+
+/*@================================
+ * edurdsm_NewExtent()
+ *================================*/
+/*
+ * Function: static Four edurdsm_NewExtent(EduRDsMVolume *, Four)
+ *
+ * Description:
+ *  Find a free extent, the first one following the extent `after' if any,
+ *  so that a segment grows sequentially on the disk.
+ *
+ * Returns:
+ *  the extent, NIL if no extent is free
+ */
+static Four edurdsm_NewExtent(
+    EduRDsMVolume       *v,                     /* IN volume */
+    Four                after)                  /* IN extent to be followed; NIL for any */
+{
+    Four                i;                      /* index */
+    Four                ext;                    /* an extent */
+
+
+    for (i = 0; i < v->nExts; i++) {
+        ext = (after == NIL) ? i : (after + 1 + i) % v->nExts;
+        if (v->exts[ext].owner == NIL) return(ext);
+    }
+
+    return(NIL);
+
+} /* edurdsm_NewExtent() */
+
+
+
+/*@================================
+ * edurdsm_NearExtent()
+ *================================*/
+/*
+ * Function: static Four edurdsm_NearExtent(EduRDsMVolume *, Four, PageID *)
+ *
+ * Description:
+ *  Find the extent of `nearPid' if it belongs to the segment whose first
+ *  extent is `firstExtNo'.
+ *
+ * Returns:
+ *  the extent, NIL if there is none
+ */
+static Four edurdsm_NearExtent(
+    EduRDsMVolume       *v,                     /* IN volume */
+    Four                firstExtNo,             /* IN first extent of the segment */
+    PageID              *nearPid)               /* IN page near which trains are wanted, or NULL */
+{
+    Four                ext;                    /* extent of the page */
+
+
+    if (nearPid == NULL || nearPid->volNo != v->volNo || nearPid->pageNo < 0) return(NIL);
+
+    ext = nearPid->pageNo / v->hdr.extSize;
+    if (ext >= v->nExts || v->exts[ext].owner != firstExtNo) return(NIL);
+
+    return(ext);
+
+} /* edurdsm_NearExtent() */
+
+
+
+/*@================================
+ * edurdsm_AllocRun()
+ *================================*/
+/*
+ * Function: static Four edurdsm_AllocRun(EduRDsMVolume *, Four, Four, Two, Two, Four, PageID *, Four *, Four *, Four *)
+ *
+ * Description:
+ *  Allocate a run of up to `maxTrains' contiguous trains to the segment, in
+ *  the extent `near' if it has room, else in the first extent of the
+ *  segment having room, else in a new extent chained to the segment. The
+ *  pages of the extent table changed are added to [*firstMeta, *lastMeta];
+ *  the caller holds the latch of the volume and writes them.
+ *
+ * Returns:
+ *  error code
+ *    eVOLUMEFULL_EDUBFM - no extent is free
+ */
+static Four edurdsm_AllocRun(
+    EduRDsMVolume       *v,                     /* IN volume */
+    Four                firstExtNo,             /* IN first extent of the segment */
+    Four                near,                   /* IN extent tried first; NIL for none */
+    Two                 eff,                    /* IN extent fill factor in percent */
+    Two                 sizeOfTrain,            /* IN # of pages of a train */
+    Four                maxTrains,              /* IN max # of trains of the run */
+    PageID              *firstTrainId,          /* OUT first train of the run */
+    Four                *nAllocated,            /* OUT # of trains of the run */
+    Four                *firstMeta,             /* INOUT first page of the extent table changed */
+    Four                *lastMeta)              /* INOUT last page of the extent table changed */
+{
+    Four                ext;                    /* extent of the run */
+    Four                x;                      /* an extent of the segment */
+    Four                last;                   /* last extent of the segment */
+    Four                offset;                 /* first page of the run in its extent */
+    Four                limit;                  /* max # of pages allocated in an extent */
+
+
+    limit = v->hdr.extSize * eff / 100;
+    if (limit < sizeOfTrain) limit = sizeOfTrain;
+
+    ext = NIL;
+    if (near != NIL && (offset = edurdsm_AllocInExtent(v, near, sizeOfTrain, limit, maxTrains, nAllocated)) != NIL)
+        ext = near;
+
+    for (x = last = firstExtNo; ext == NIL && x != NIL; last = x, x = v->exts[x].next)
+        if ((offset = edurdsm_AllocInExtent(v, x, sizeOfTrain, limit, maxTrains, nAllocated)) != NIL) ext = x;
+
+    /*@ chain a new extent to the segment */
+    if (ext == NIL) {
+        ext = edurdsm_NewExtent(v, last);
+        if (ext == NIL) ERR(eVOLUMEFULL_EDUBFM);
+        v->exts[ext].owner = firstExtNo;
+        v->exts[ext].next = NIL;
+        v->exts[last].next = ext;
+        EDURDSM_TOUCH(*firstMeta, *lastMeta, last);
+        offset = edurdsm_AllocInExtent(v, ext, sizeOfTrain, limit, maxTrains, nAllocated);
+    }
+
+    EDURDSM_TOUCH(*firstMeta, *lastMeta, ext);
+    firstTrainId->volNo = v->volNo;
+    firstTrainId->pageNo = ext * v->hdr.extSize + offset;
+
+    return(eNOERROR);
+
+} /* edurdsm_AllocRun() */
+
+
+
+/*@================================
+ * edurdsm_AllocInExtent()
+ *================================*/
+/*
+ * Function: static Four edurdsm_AllocInExtent(EduRDsMVolume *, Four, Two, Four, Four, Four *)
+ *
+ * Description:
+ *  Allocate a run of up to `maxTrains' contiguous trains of `sizeOfTrain'
+ *  pages from the first free multiple of their size in the extent on,
+ *  while the extent has at most `limit' pages allocated.
+ *
+ * Returns:
+ *  first page of the run in the extent, NIL if the extent has no room
+ *
+ * Side effects:
+ *  1) parameter nAllocated
+ *     nAllocated is the # of trains of the run
+ */
+static Four edurdsm_AllocInExtent(
+    EduRDsMVolume       *v,                     /* IN volume */
+    Four                ext,                    /* IN extent */
+    Two                 sizeOfTrain,            /* IN # of pages of a train */
+    Four                limit,                  /* IN max # of pages allocated in the extent */
+    Four                maxTrains,              /* IN max # of trains of the run */
+    Four                *nAllocated)            /* OUT # of trains of the run */
+{
+    Four                k;                      /* first page of the run in the extent */
+    Four                n;                      /* # of trains of the run */
+    Four                nUsed;                  /* # of pages allocated in the extent */
+    UEight              mask;                   /* pages of a train at page 0 */
+
+
+    nUsed = __builtin_popcountl(v->exts[ext].used);
+    if (nUsed + sizeOfTrain > limit) return(NIL);
+
+    mask = (sizeOfTrain == 64) ? ~(UEight)0 : ((UEight)1 << sizeOfTrain) - 1;
+    for (k = 0; k + sizeOfTrain <= v->hdr.extSize; k += sizeOfTrain)
+        if ((v->exts[ext].used & (mask << k)) == 0) break;
+    if (k + sizeOfTrain > v->hdr.extSize) return(NIL);
+
+    for (n = 0; n < maxTrains && k + (n + 1) * sizeOfTrain <= v->hdr.extSize &&
+                nUsed + (n + 1) * sizeOfTrain <= limit; n++) {
+        if (v->exts[ext].used & (mask << (k + n * sizeOfTrain))) break;
+        v->exts[ext].used |= mask << (k + n * sizeOfTrain);
+    }
+    *nAllocated = n;
+
+    return(k);
+
+} /* edurdsm_AllocInExtent() */
@@ -0,0 +1,211 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduRDsM_Cursor.c
+ *
+ * Description :
+ *  Cursors allocating the pages of a growing file. A cursor reserves a run
+ *  of contiguous trains in an extent of the segment of the file by one
+ *  call of EduRDsM_AllocContigTrains(), and hands the trains out one by
+ *  one, so that the file grows sequentially on the disk and the extent
+ *  table is updated once per run instead of once per train. On a volume
+ *  not mounted by EduRDsM_Mount(), each train is allocated by RDsM.
+ *
+ * Exports:
+ *  Four EduRDsM_OpenAllocCursor(Four, Four, PageID *, Two, Two, Four, EduRDsMAllocCursor *)
+ *  Four EduRDsM_AllocFromCursor(EduRDsMAllocCursor *, PageID *)
+ *  Four EduRDsM_CloseAllocCursor(EduRDsMAllocCursor *)
+ */
+
+
+#include "EduBfM_common.h"
+#include "RDsM.h"
+#include "EduBfM_Internal.h"
+#include "EduRDsM.h"
+
+
+
+/*@================================
+ * EduRDsM_OpenAllocCursor()
+ *================================*/
+/*
+ * Function: Four EduRDsM_OpenAllocCursor(Four, Four, PageID *, Two, Two, Four, EduRDsMAllocCursor *)
+ *
+ * Description :
+ *  Start a cursor allocating trains of `sizeOfTrain' pages to the segment
+ *  whose first extent is `firstExtNo', `runLength' trains reserved at a
+ *  time, near `nearPid' at first, and filling an extent up to `eff'
+ *  percent of its pages. A cursor is used by one thread at a time, and is
+ *  closed by EduRDsM_CloseAllocCursor().
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad parameters
+ */
+Four EduRDsM_OpenAllocCursor(
+    Four                volNo,                  /* IN volume of the file */
+    Four                firstExtNo,             /* IN first extent of the segment of the file */
+    PageID              *nearPid,               /* IN page near which the trains are wanted, or NULL */
+    Two                 eff,                    /* IN extent fill factor in percent */
+    Two                 sizeOfTrain,            /* IN # of pages of a train */
+    Four                runLength,              /* IN # of trains reserved at a time */
+    EduRDsMAllocCursor  *cursor)                /* OUT cursor */
+{
+    /*@ check if the parameters are valid. */
+    if (cursor == NULL || runLength < 1 || eff < 1 || eff > 100 || sizeOfTrain < 1) ERR(eBADPARAMETER);
+
+    cursor->volNo = volNo;
+    cursor->firstExtNo = firstExtNo;
+    cursor->eff = eff;
+    cursor->sizeOfTrain = sizeOfTrain;
+    cursor->runLength = runLength;
+    if (nearPid != NULL)
+        cursor->last = *nearPid;
+    else
+        SET_NILPAGEID(cursor->last);
+    cursor->nLeft = 0;
+
+    return(eNOERROR);
+
+}  /* EduRDsM_OpenAllocCursor() */
+
+
+
+/*@================================
+ * EduRDsM_AllocFromCursor()
+ *================================*/
+/*
+ * Function: Four EduRDsM_AllocFromCursor(EduRDsMAllocCursor *, PageID *)
+ *
+ * Description :
+ *  Hand out the next train reserved by the cursor, reserving a new run
+ *  next to the train handed out last when the run is used up.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad parameters
+ *    some errors caused by EduRDsM_AllocContigTrains() and RDsM_AllocTrains()
+ *
+ * Side effects:
+ *  1) parameter trainId
+ *     trainId is the train allocated
+ */
+Four EduRDsM_AllocFromCursor(
+    EduRDsMAllocCursor  *cursor,                /* INOUT cursor */
+    PageID              *trainId)               /* OUT train allocated */
+{
+    Four                e;                      /* for error */
+    PageID              *nearPid;               /* page near which the run is wanted */
+
+
+    /*@ check if the parameters are valid. */
+    if (cursor == NULL || trainId == NULL) ERR(eBADPARAMETER);
+
+    nearPid = IS_NILPAGEID(cursor->last) ? NULL : &cursor->last;
+
+    if (edurdsm_Volume(cursor->volNo) == NULL) {
+        e = RDsM_AllocTrains(cursor->volNo, cursor->firstExtNo, nearPid, cursor->eff, 1, cursor->sizeOfTrain, trainId);
+        if (e < eNOERROR) ERR(e);
+        cursor->last = *trainId;
+        return(eNOERROR);
+    }
+
+    /*@ reserve the next run */
+    if (cursor->nLeft == 0) {
+        e = EduRDsM_AllocContigTrains(cursor->volNo, cursor->firstExtNo, nearPid, cursor->eff,
+                                      cursor->runLength, cursor->sizeOfTrain, &cursor->next, &cursor->nLeft);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    *trainId = cursor->next;
+    cursor->last = cursor->next;
+    cursor->next.pageNo += cursor->sizeOfTrain;
+    cursor->nLeft--;
+
+    return(eNOERROR);
+
+}  /* EduRDsM_AllocFromCursor() */
+
+
+
+/*@================================
+ * EduRDsM_CloseAllocCursor()
+ *================================*/
+/*
+ * Function: Four EduRDsM_CloseAllocCursor(EduRDsMAllocCursor *)
+ *
+ * Description :
+ *  Stop the cursor and free the trains it has reserved but not handed out.
+ *  The volume must still be mounted.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad parameters
+ *    some errors caused by function calls
+ */
+Four EduRDsM_CloseAllocCursor(
+    EduRDsMAllocCursor  *cursor)                /* INOUT cursor */
+{
+    Four                e;                      /* for error */
+    EduRDsMVolume       *v;                     /* entry of the volume */
+
+
+    /*@ check if the parameters are valid. */
+    if (cursor == NULL) ERR(eBADPARAMETER);
+
+    v = edurdsm_Volume(cursor->volNo);
+    if (v != NULL && cursor->nLeft > 0) {
+        e = edurdsm_FreeRun(v, &cursor->next, cursor->nLeft, cursor->sizeOfTrain);
+        if (e < eNOERROR) ERR(e);
+    }
+    cursor->nLeft = 0;
+
+    return(eNOERROR);
+
+}  /* EduRDsM_CloseAllocCursor() */
@@ -0,0 +1,326 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduRDsM_IO.c
+ *
+ * Description :
+ *  Reads and writes of the trains of the volumes mounted by
+ *  EduRDsM_Mount(); the trains of the other volumes are transferred by
+ *  RDsM. A train of `sizeOfTrain' pages is transferred by one pread or
+ *  pwrite, and so are consecutive trains.
+ *
+ * Exports:
+ *  Four EduRDsM_ReadTrain(PageID *, char *, Two)
+ *  Four EduRDsM_ReadTrains(PageID *, char *, Four, Two)
+ *  Four EduRDsM_WriteTrain(char *, PageID *, Two)
+ *  Four EduRDsM_WriteTrains(char *, PageID *, Four, Two)
+ *  Boolean edurdsm_Locate(PageID *, Four, int *, off_t *)
+ *  Four edurdsm_DiskTransfer(int, char *, size_t, off_t, Boolean)
+ */
+
+
+#include <errno.h> /* for errno */
+#include <unistd.h> /* for pread & pwrite */
+#include "EduBfM_common.h"
+#include "RDsM.h"
+#include "EduBfM_Internal.h"
+#include "EduRDsM.h"
+
+
+
+/*@
+ * internal function prototypes
+ */
+static Four edurdsm_Transfer(EduRDsMVolume *, PageID *, char *, Four, Two, Boolean);
+
+
+
+/*@================================
+ * EduRDsM_ReadTrain()
+ *================================*/
+/*
+ * Function: Four EduRDsM_ReadTrain(PageID *, char *, Two)
+ *
+ * Description :
+ *  Read the train `trainId' of `sizeOfTrain' pages into `buf'.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the train is not in the volume
+ *    eIOFAILED_EDUBFM - the read failed
+ *    some errors caused by RDsM_ReadTrain()
+ */
+Four EduRDsM_ReadTrain(
+    PageID              *trainId,               /* IN train to be read */
+    char                *buf,                   /* OUT train read */
+    Two                 sizeOfTrain)            /* IN # of pages of the train */
+{
+    EduRDsMVolume       *v;                     /* volume of the train */
+
+
+    v = edurdsm_Volume(trainId->volNo);
+    if (v == NULL) return(RDsM_ReadTrain(trainId, buf, sizeOfTrain));
+
+    return(edurdsm_Transfer(v, trainId, buf, 1, sizeOfTrain, FALSE));
+
+}  /* EduRDsM_ReadTrain() */
+
+
+
+/*@================================
+ * EduRDsM_ReadTrains()
+ *================================*/
+/*
+ * Function: Four EduRDsM_ReadTrains(PageID *, char *, Four, Two)
+ *
+ * Description :
+ *  Read the `nTrains' consecutive trains of `sizeOfTrain' pages from
+ *  `trainId' on into `buf'.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the trains are not in the volume
+ *    eIOFAILED_EDUBFM - the read failed
+ *    some errors caused by RDsM_ReadTrains()
+ */
+Four EduRDsM_ReadTrains(
+    PageID              *trainId,               /* IN first train to be read */
+    char                *buf,                   /* OUT trains read */
+    Four                nTrains,                /* IN # of trains */
+    Two                 sizeOfTrain)            /* IN # of pages of a train */
+{
+    EduRDsMVolume       *v;                     /* volume of the trains */
+
+
+    v = edurdsm_Volume(trainId->volNo);
+    if (v == NULL) return(RDsM_ReadTrains(trainId, buf, nTrains, sizeOfTrain));
+
+    return(edurdsm_Transfer(v, trainId, buf, nTrains, sizeOfTrain, FALSE));
+
+}  /* EduRDsM_ReadTrains() */
+
+
+
+/*@================================
+ * EduRDsM_WriteTrain()
+ *================================*/
+/*
+ * Function: Four EduRDsM_WriteTrain(char *, PageID *, Two)
+ *
+ * Description :
+ *  Write `buf' to the train `trainId' of `sizeOfTrain' pages.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the train is not in the volume
+ *    eIOFAILED_EDUBFM - the write failed
+ *    some errors caused by RDsM_WriteTrain()
+ */
+Four EduRDsM_WriteTrain(
+    char                *buf,                   /* IN train to be written */
+    PageID              *trainId,               /* IN train */
+    Two                 sizeOfTrain)            /* IN # of pages of the train */
+{
+    EduRDsMVolume       *v;                     /* volume of the train */
+
+
+    v = edurdsm_Volume(trainId->volNo);
+    if (v == NULL) return(RDsM_WriteTrain(buf, trainId, sizeOfTrain));
+
+    return(edurdsm_Transfer(v, trainId, buf, 1, sizeOfTrain, TRUE));
+
+}  /* EduRDsM_WriteTrain() */
+
+
+
+/*@================================
+ * EduRDsM_WriteTrains()
+ *================================*/
+/*
+ * Function: Four EduRDsM_WriteTrains(char *, PageID *, Four, Two)
+ *
+ * Description :
+ *  Write the `nTrains' trains of `sizeOfTrain' pages in `buf' to the
+ *  consecutive trains from `trainId' on.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the trains are not in the volume
+ *    eIOFAILED_EDUBFM - the write failed
+ *    some errors caused by RDsM_WriteTrains()
+ */
+Four EduRDsM_WriteTrains(
+    char                *buf,                   /* IN trains to be written */
+    PageID              *trainId,               /* IN first train */
+    Four                nTrains,                /* IN # of trains */
+    Two                 sizeOfTrain)            /* IN # of pages of a train */
+{
+    EduRDsMVolume       *v;                     /* volume of the trains */
+
+
+    v = edurdsm_Volume(trainId->volNo);
+    if (v == NULL) return(RDsM_WriteTrains(buf, trainId, nTrains, sizeOfTrain));
+
+    return(edurdsm_Transfer(v, trainId, buf, nTrains, sizeOfTrain, TRUE));
+
+}  /* EduRDsM_WriteTrains() */
+
+
+
+/*@================================
+ * edurdsm_Transfer()
+ *================================*/
+/*
+ * Function: static Four edurdsm_Transfer(EduRDsMVolume *, PageID *, char *, Four, Two, Boolean)
+ *
+ * Description:
+ *  Read or write `nTrains' consecutive trains of the volume.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the trains are not in the volume
+ *    eIOFAILED_EDUBFM - the transfer failed
+ */
+static Four edurdsm_Transfer(
+    EduRDsMVolume       *v,                     /* IN volume */
+    PageID              *trainId,               /* IN first train */
+    char                *buf,                   /* INOUT trains transferred */
+    Four                nTrains,                /* IN # of trains */
+    Two                 sizeOfTrain,            /* IN # of pages of a train */
+    Boolean             isWrite)                /* IN TRUE to write the trains */
+{
+    /*@ check if the parameters are valid. */
+    if (buf == NULL || nTrains < 1 || sizeOfTrain < 1 || trainId->pageNo < v->hdr.nMetaPages ||
+        (UEight)trainId->pageNo + (UEight)nTrains * sizeOfTrain > (UEight)v->nExts * v->hdr.extSize)
+        ERR(eBADPARAMETER);
+
+    return(edurdsm_DiskTransfer(v->fd, buf, (size_t)nTrains * sizeOfTrain * PAGESIZE,
+                                (off_t)trainId->pageNo * PAGESIZE, isWrite));
+
+} /* edurdsm_Transfer() */
+
+
+
+/*@================================
+ * edurdsm_Locate()
+ *================================*/
+/*
+ * Function: Boolean edurdsm_Locate(PageID *, Four, int *, off_t *)
+ *
+ * Description:
+ *  Find the file and the offset of `nPages' consecutive pages from
+ *  `trainId' on, so that they can be transferred by the caller.
+ *
+ * Returns:
+ *  TRUE if the pages lie in a volume mounted by EduRDsM_Mount(), FALSE
+ *  otherwise
+ *
+ * Side effects:
+ *  1) parameters fd, offset
+ *     file of the volume and offset of the pages in it
+ */
+Boolean edurdsm_Locate(
+    PageID              *trainId,               /* IN first page */
+    Four                nPages,                 /* IN # of pages */
+    int                 *fd,                    /* OUT file of the volume */
+    off_t               *offset)                /* OUT offset of the pages in the file */
+{
+    EduRDsMVolume       *v;                     /* volume of the pages */
+
+
+    v = edurdsm_Volume(trainId->volNo);
+    if (v == NULL || nPages < 1 || trainId->pageNo < v->hdr.nMetaPages ||
+        (UEight)trainId->pageNo + nPages > (UEight)v->nExts * v->hdr.extSize)
+        return(FALSE);
+
+    *fd = v->fd;
+    *offset = (off_t)trainId->pageNo * PAGESIZE;
+
+    return(TRUE);
+
+} /* edurdsm_Locate() */
+
+
+
+/*@================================
+ * edurdsm_DiskTransfer()
+ *================================*/
+/*
+ * Function: Four edurdsm_DiskTransfer(int, char *, size_t, off_t, Boolean)
+ *
+ * Description:
+ *  Read or write `nBytes' bytes at `offset' of the file `fd', calling
+ *  pread or pwrite again after a partial or interrupted transfer. The
+ *  calls are positional, so transfers on the same file may run at once.
+ *
+ * Returns:
+ *  error code
+ *    eIOFAILED_EDUBFM - the transfer failed
+ */
+Four edurdsm_DiskTransfer(
+    int                 fd,                     /* IN file descriptor */
+    char                *buf,                   /* INOUT bytes transferred */
+    size_t              nBytes,                 /* IN # of bytes */
+    off_t               offset,                 /* IN offset in the file */
+    Boolean             isWrite)                /* IN TRUE to write the bytes */
+{
+    size_t              done;                   /* # of bytes transferred */
+    ssize_t             n;                      /* # of bytes of a call */
+
+
+    for (done = 0; done < nBytes; done += n) {
+        n = isWrite ? pwrite(fd, buf + done, nBytes - done, offset + done)
+                    : pread(fd, buf + done, nBytes - done, offset + done);
+        if (n < 0 && errno == EINTR) n = 0;
+        else if (n <= 0) ERR(eIOFAILED_EDUBFM);
+    }
+
+    return(eNOERROR);
+
+} /* edurdsm_DiskTransfer() */
@@ -0,0 +1,380 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduRDsM_Volume.c
+ *
+ * Description :
+ *  Volumes of the file-backed raw-disk manager. EduRDsM implements the
+ *  interface of RDsM used by the projects over a local volume file: a
+ *  header page, an extent table, and the pages of the extents. Its
+ *  functions serve the volumes mounted by EduRDsM_Mount() and pass the
+ *  calls for the other volumes to RDsM, so they can replace the RDsM calls
+ *  without changing the volumes of the storage system.
+ *
+ * Exports:
+ *  Four EduRDsM_Format(char *, Four, Four, Two)
+ *  Four EduRDsM_Mount(char *, Four *)
+ *  Four EduRDsM_Dismount(Four)
+ *  EduRDsMVolume *edurdsm_Volume(Four)
+ *  Four edurdsm_WriteMeta(EduRDsMVolume *, Four, Four)
+ */
+
+
+#include <stdlib.h> /* for calloc, malloc & free */
+#include <string.h> /* for memset, memcpy & memcmp */
+#include <fcntl.h> /* for open */
+#include <unistd.h> /* for pread, pwrite, ftruncate, fsync & close */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+#include "EduRDsM.h"
+
+
+
+/*@
+ * global variables
+ */
+/* volumes mounted by EduRDsM_Mount(); none by default */
+EduRDsMVolumes rdsmVolumes = { 0, { { 0 } }, PTHREAD_MUTEX_INITIALIZER };
+
+
+
+/*@================================
+ * EduRDsM_Format()
+ *================================*/
+/*
+ * Function: Four EduRDsM_Format(char *, Four, Four, Two)
+ *
+ * Description :
+ *  Create the volume `volNo' of `nPages' pages, cut to whole extents of
+ *  `extSize' pages, in the file `devName', which is overwritten. The
+ *  extents holding the header page and the extent table are not allocated
+ *  to any segment. The volume number should differ from those of the
+ *  volumes of the storage system.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad parameters, or the file cannot be created
+ *    eIOFAILED_EDUBFM - the file cannot be written
+ *    eMEMORYALLOCERR - memory allocation failed
+ */
+Four EduRDsM_Format(
+    char                *devName,               /* IN file of the volume */
+    Four                volNo,                  /* IN volume number */
+    Four                nPages,                 /* IN # of pages of the volume */
+    Two                 extSize)                /* IN # of pages of an extent */
+{
+    Four                e;                      /* for error */
+    Four                i;                      /* index */
+    Four                nSysExts;               /* # of extents holding the header and the extent table */
+    EduRDsMVolume       v;                      /* the volume being formatted */
+
+
+    /*@ check if the parameters are valid. */
+    if (devName == NULL || volNo <= 0 || (VolNo)volNo != volNo) ERR(eBADPARAMETER);
+    if (extSize < 1 || extSize > EDURDSM_MAXEXTSIZE || nPages / extSize < 2) ERR(eBADPARAMETER);
+
+    memset(&v, 0, sizeof(v));
+    memcpy(v.hdr.magic, EDURDSM_MAGIC, sizeof(v.hdr.magic));
+    v.hdr.volNo = volNo;
+    v.hdr.nExts = v.nExts = nPages / extSize;
+    v.hdr.extSize = extSize;
+    v.hdr.nMetaPages = 1 + (v.nExts + EDURDSM_EXTSPERPAGE - 1) / EDURDSM_EXTSPERPAGE;
+    v.hdr.nextUnique = 0;
+
+    nSysExts = (v.hdr.nMetaPages + extSize - 1) / extSize;
+    if (nSysExts >= v.nExts) ERR(eBADPARAMETER);
+
+    v.exts = (EduRDsMExtEntry*)malloc(sizeof(EduRDsMExtEntry) * v.nExts);
+    if (v.exts == NULL) ERR(eMEMORYALLOCERR);
+    for (i = 0; i < v.nExts; i++) {
+        v.exts[i].owner = (i < nSysExts) ? EDURDSM_SYSTEM : NIL;
+        v.exts[i].next = NIL;
+        v.exts[i].used = 0;
+    }
+    for (i = 0; i < v.hdr.nMetaPages; i++)
+        v.exts[i / extSize].used |= (UEight)1 << (i % extSize);
+
+    v.fd = open(devName, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (v.fd < 0) {
+        free(v.exts);
+        ERR(eBADPARAMETER);
+    }
+
+    e = eNOERROR;
+    if (ftruncate(v.fd, (off_t)v.nExts * extSize * PAGESIZE) < 0) e = eIOFAILED_EDUBFM;
+    if (e >= eNOERROR) e = edurdsm_WriteMeta(&v, 0, v.hdr.nMetaPages - 1);
+    if (e >= eNOERROR && fsync(v.fd) < 0) e = eIOFAILED_EDUBFM;
+
+    close(v.fd);
+    free(v.exts);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+}  /* EduRDsM_Format() */
+
+
+
+/*@================================
+ * EduRDsM_Mount()
+ *================================*/
+/*
+ * Function: Four EduRDsM_Mount(char *, Four *)
+ *
+ * Description :
+ *  Mount the volume formatted by EduRDsM_Format() in the file `devName'.
+ *  From now on, the EduRDsM functions, and the I/O of EduBfM, serve the
+ *  volume from the file.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the file holds no volume, the volume is already
+ *                    mounted or too many volumes are
+ *    eMEMORYALLOCERR - memory allocation failed
+ *
+ * Side effects:
+ *  1) parameter volNo
+ *     volNo is the number of the volume mounted
+ */
+Four EduRDsM_Mount(
+    char                *devName,               /* IN file of the volume */
+    Four                *volNo)                 /* OUT volume mounted */
+{
+    Four                i;                      /* index */
+    Four                p;                      /* page of the extent table */
+    Four                n;                      /* # of entries in a page */
+    char                page[PAGESIZE];         /* a page of the extent table */
+    EduRDsMVolHdr       hdr;                    /* header page */
+    EduRDsMVolume       *v;                     /* entry of the volume */
+    int                 fd;                     /* descriptor of the file */
+
+
+    /*@ check if the parameters are valid. */
+    if (devName == NULL || volNo == NULL) ERR(eBADPARAMETER);
+
+    fd = open(devName, O_RDWR);
+    if (fd < 0) ERR(eBADPARAMETER);
+    if (pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) || memcmp(hdr.magic, EDURDSM_MAGIC, sizeof(hdr.magic)) != 0 ||
+        hdr.nExts < 2 || hdr.extSize < 1 || hdr.extSize > EDURDSM_MAXEXTSIZE ||
+        hdr.nMetaPages != 1 + (hdr.nExts + EDURDSM_EXTSPERPAGE - 1) / EDURDSM_EXTSPERPAGE) {
+        close(fd);
+        ERR(eBADPARAMETER);
+    }
+
+    BFM_GETLATCH(&rdsmVolumes.latch);
+
+    v = NULL;
+    for (i = 0; i < EDURDSM_MAXVOLUMES; i++) {
+        if (rdsmVolumes.volumes[i].nExts > 0 && rdsmVolumes.volumes[i].volNo == hdr.volNo) break;
+        if (rdsmVolumes.volumes[i].nExts == 0 && v == NULL) v = &rdsmVolumes.volumes[i];
+    }
+    if (i < EDURDSM_MAXVOLUMES || v == NULL) {
+        close(fd);
+        ERRL(eBADPARAMETER, &rdsmVolumes.latch);
+    }
+
+    v->exts = (EduRDsMExtEntry*)malloc(sizeof(EduRDsMExtEntry) * hdr.nExts);
+    if (v->exts == NULL) {
+        close(fd);
+        ERRL(eMEMORYALLOCERR, &rdsmVolumes.latch);
+    }
+
+    /*@ read the extent table */
+    for (p = 1; p < hdr.nMetaPages; p++) {
+        if (pread(fd, page, PAGESIZE, (off_t)p * PAGESIZE) != PAGESIZE) {
+            free(v->exts);
+            v->exts = NULL;
+            close(fd);
+            ERRL(eBADPARAMETER, &rdsmVolumes.latch);
+        }
+        n = hdr.nExts - (p - 1) * EDURDSM_EXTSPERPAGE;
+        if (n > EDURDSM_EXTSPERPAGE) n = EDURDSM_EXTSPERPAGE;
+        memcpy(&v->exts[(p - 1) * EDURDSM_EXTSPERPAGE], page, sizeof(EduRDsMExtEntry) * n);
+    }
+
+    v->volNo = hdr.volNo;
+    v->fd = fd;
+    v->hdr = hdr;
+    pthread_mutex_init(&v->latch, NULL);
+
+    /* the entry is complete before it is found */
+    __sync_synchronize();
+    v->nExts = hdr.nExts;
+    rdsmVolumes.nMounted++;
+
+    BFM_RELEASELATCH(&rdsmVolumes.latch);
+
+    *volNo = hdr.volNo;
+
+    return(eNOERROR);
+
+}  /* EduRDsM_Mount() */
+
+
+
+/*@================================
+ * EduRDsM_Dismount()
+ *================================*/
+/*
+ * Function: Four EduRDsM_Dismount(Four)
+ *
+ * Description :
+ *  Dismount the volume `volNo' mounted by EduRDsM_Mount(). The trains of
+ *  the volume in the buffer pools are to be flushed and discarded first.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the volume is not mounted
+ *    eIOFAILED_EDUBFM - the file cannot be synchronized
+ */
+Four EduRDsM_Dismount(
+    Four                volNo)                  /* IN volume to be dismounted */
+{
+    Four                e;                      /* for error */
+    Four                i;                      /* index */
+    EduRDsMVolume       *v;                     /* entry of the volume */
+
+
+    BFM_GETLATCH(&rdsmVolumes.latch);
+
+    for (i = 0; i < EDURDSM_MAXVOLUMES; i++)
+        if (rdsmVolumes.volumes[i].nExts > 0 && rdsmVolumes.volumes[i].volNo == volNo) break;
+    if (i == EDURDSM_MAXVOLUMES) ERRL(eBADPARAMETER, &rdsmVolumes.latch);
+    v = &rdsmVolumes.volumes[i];
+
+    /* the entry is not found any more before it is freed */
+    v->nExts = 0;
+    rdsmVolumes.nMounted--;
+    __sync_synchronize();
+
+    e = (fsync(v->fd) < 0) ? eIOFAILED_EDUBFM : eNOERROR;
+    close(v->fd);
+    free(v->exts);
+    v->exts = NULL;
+    pthread_mutex_destroy(&v->latch);
+
+    BFM_RELEASELATCH(&rdsmVolumes.latch);
+
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+}  /* EduRDsM_Dismount() */
+
+
+
+/*@================================
+ * edurdsm_Volume()
+ *================================*/
+/*
+ * Function: EduRDsMVolume *edurdsm_Volume(Four)
+ *
+ * Description:
+ *  Find the volume `volNo' among the volumes mounted by EduRDsM_Mount().
+ *
+ * Returns:
+ *  entry of the volume, NULL if the volume is left to RDsM
+ */
+EduRDsMVolume *edurdsm_Volume(
+    Four                volNo)                  /* IN volume to be found */
+{
+    Four                i;                      /* index */
+
+
+    if (rdsmVolumes.nMounted == 0) return(NULL);
+
+    for (i = 0; i < EDURDSM_MAXVOLUMES; i++)
+        if (rdsmVolumes.volumes[i].nExts > 0 && rdsmVolumes.volumes[i].volNo == volNo)
+            return(&rdsmVolumes.volumes[i]);
+
+    return(NULL);
+
+} /* edurdsm_Volume() */
+
+
+
+/*@================================
+ * edurdsm_WriteMeta()
+ *================================*/
+/*
+ * Function: Four edurdsm_WriteMeta(EduRDsMVolume *, Four, Four)
+ *
+ * Description:
+ *  Write the pages `first' to `last' of the header page and the extent
+ *  table of the volume to its file.
+ *
+ * Returns:
+ *  error code
+ *    eIOFAILED_EDUBFM - the file cannot be written
+ */
+Four edurdsm_WriteMeta(
+    EduRDsMVolume       *v,                     /* IN volume */
+    Four                first,                  /* IN first page to be written */
+    Four                last)                   /* IN last page to be written */
+{
+    Four                p;                      /* page */
+    Four                n;                      /* # of entries in a page */
+    char                page[PAGESIZE];         /* image of a page */
+
+
+    for (p = first; p <= last; p++) {
+        memset(page, 0, PAGESIZE);
+        if (p == 0)
+            memcpy(page, &v->hdr, sizeof(v->hdr));
+        else {
+            n = v->nExts - (p - 1) * EDURDSM_EXTSPERPAGE;
+            if (n > EDURDSM_EXTSPERPAGE) n = EDURDSM_EXTSPERPAGE;
+            memcpy(page, &v->exts[(p - 1) * EDURDSM_EXTSPERPAGE], sizeof(EduRDsMExtEntry) * n);
+        }
+        if (pwrite(v->fd, page, PAGESIZE, (off_t)p * PAGESIZE) != PAGESIZE) ERR(eIOFAILED_EDUBFM);
+    }
+
+    return(eNOERROR);
+
+} /* edurdsm_WriteMeta() */
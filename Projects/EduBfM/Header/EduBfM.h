@@ -50,6 +50,109 @@
 #define _EDUBFM_H_
 
 
+/*@
+ * Type Definitions
+ */
+/* # of buckets of a latency histogram; bucket i counts the latencies in [2^i, 2^(i+1)) nanoseconds */
+#define BFM_STATS_NHISTBUCKETS  32
+
+/* type definition for the statistics of a buffer pool */
+typedef struct {
+    UEight              nHits;          /* # of EduBfM_GetTrain() finding the train in the pool */
+    UEight              nMisses;        /* # of EduBfM_GetTrain() not finding the train in the pool */
+    UEight              nAllocs;        /* # of buffers allocated by edubfm_AllocTrain() */
+    UEight              nFreeAllocs;    /* # of buffers taken from the free list by edubfm_AllocTrain() */
+    UEight              nScanned;       /* # of buffers examined by the clock to select the victims */
+    UEight              nEvictions;     /* # of trains evicted to free a buffer */
+    UEight              nDirtyEvictions;/* # of evicted trains written back by edubfm_AllocTrain() */
+    UEight              nNoUnfixedBuf;  /* # of allocations failed with eNOUNFIXEDBUF_BFM */
+    UEight              nFlushes;       /* # of trains written back by EduBfM_FlushAll() */
+    UEight              nReads;         /* # of trains read from the disk */
+    UEight              nWrites;        /* # of trains written to the disk */
+    UEight              nCleanerWrites; /* # of trains written back by the background cleaner */
+    UEight              nWritesSaved;   /* # of writes saved by coalescing adjacent trains */
+    UEight              nRingReuses;    /* # of misses served by recycling a buffer of a ring */
+    UEight              nPrefetches;    /* # of trains read ahead of a scan */
+    UEight              nPrefetchHits;  /* # of trains read ahead and then fixed by the scan */
+    UEight              nPrefetchWasted;/* # of trains read ahead and evicted before being fixed */
+    UEight              nGhostHits;     /* # of misses on trains evicted lately, under the adaptive split */
+    UEight              nSplitMoves;    /* # of times the adaptive split grew this pool */
+    UEight              nWarmedUp;      /* # of trains loaded by EduBfM_WarmUp() */
+    UEight              nInvalidations; /* # of buffers freed by EduBfM_InvalidateTrains() */
+    UEight              nWritesDropped; /* # of dirty trains invalidated without being written back */
+    UEight              nWritesAvoided; /* # of clean victims chosen over a dirty one by BFM_POLICY_CLEANFIRST */
+    UEight              nVictimLookups; /* # of reads looking for their train in the compressed victim cache */
+    UEight              nVictimHits;    /* # of reads served by the compressed victim cache */
+    UEight              nVictimPuts;    /* # of evicted trains put into the compressed victim cache */
+    UEight              victimBytesIn;  /* # of bytes of the trains put into the victim cache */
+    UEight              victimBytesOut; /* # of bytes they were compressed into */
+    UEight              nSecondaryLookups;      /* # of reads looking for their train in the secondary cache */
+    UEight              nSecondaryHits;         /* # of reads served by the secondary cache */
+    UEight              nSecondaryPuts;         /* # of evicted trains written to the secondary cache */
+    UEight              secondaryBytesSaved;    /* # of bytes read from the secondary cache instead of the volume */
+    UEight              nMappedGets;    /* # of trains returned straight from a volume mapped by EduBfM_MapVolume() */
+    UEight              nDirectIOs;     /* # of transfers of a volume done by direct I/O (see EduBfM_SetDirectIO()) */
+    UEight              nDirectBounces; /* # of such transfers copied through an aligned buffer */
+    UEight              nUringIOs;      /* # of asynchronous requests transferred through io_uring */
+    UEight              hitLatency[BFM_STATS_NHISTBUCKETS];     /* latency of EduBfM_GetTrain() on a hit */
+    UEight              missLatency[BFM_STATS_NHISTBUCKETS];    /* latency of EduBfM_GetTrain() on a miss */
+} BfMStats;
+
+/* operations and pending status of an asynchronous request */
+#define BFM_IO_READ             0
+#define BFM_IO_WRITE            1
+#define BFM_IO_PENDING          1
+
+/* type definition for the handle of an asynchronous request
+ * The handle is filled by the buffer manager and must stay valid until
+ * the request completes.
+ */
+typedef struct BfMIOHandle_s {
+    Four                op;             /* BFM_IO_READ or BFM_IO_WRITE */
+    TrainID             trainId;        /* train to read or write */
+    Four                nTrains;        /* # of trains written, contiguous on the disk from `trainId' */
+    Four                type;           /* buffer type */
+    Four                index;          /* buffer holding the train */
+    Four                part;           /* partition of the buffer */
+    char                *buffer;        /* pointer to the buffer */
+    volatile Four       status;         /* BFM_IO_PENDING until completed, then an error code */
+    UEight              start;          /* time when a read was requested, for its latency */
+    struct BfMIOHandle_s *next;         /* next request in the queue of the I/O engine */
+} BfMIOHandle;
+
+/* type definition for the function giving the next train of a page chain
+ * Given a fixed train and its buffer, set `nextTrainId' to the train which
+ * a scan fixes next, e.g. the header.nextPage of a slotted page of a heap
+ * file, or set its pageNo to NIL at the end of the chain.
+ */
+typedef void (*BfMNextTrainFunc)(TrainID *trainId, char *buffer, TrainID *nextTrainId);
+
+/* kinds of access strategies given to EduBfM_GetTrainStrategy() */
+#define BFM_STRATEGY_NORMAL     0       /* use the whole pool as EduBfM_GetTrain() */
+#define BFM_STRATEGY_SEQSCAN    1       /* recycle a small ring of clean buffers */
+#define BFM_STRATEGY_BULKWRITE  2       /* recycle a ring of buffers, writing them back */
+#define BFM_NUM_STRATEGIES      3
+
+/* type definition for an access strategy
+ * A strategy belongs to a single scan or cursor and must not be shared by
+ * threads. A partitioned pool has a ring per partition, since a train is
+ * kept in the partition of its key. `bufs' holds the buffers of the rings,
+ * `size' per partition, NIL if not yet allocated.
+ */
+typedef struct {
+    Four                kind;           /* BFM_STRATEGY_xxx */
+    Four                type;           /* buffer type */
+    Four                size;           /* # of buffers of a ring */
+    Four                *current;       /* slot of each ring used by the next miss */
+    Four                *bufs;          /* buffers of the rings */
+} BfMStrategy;
+
+/* flags of EduBfM_SetPoolAllocation(); 0 selects the buffers of the storage system */
+#define BFM_ALLOC_HUGEPAGE      0x01    /* back the buffers with huge pages when available */
+#define BFM_ALLOC_INTERLEAVE    0x02    /* interleave the buffers over the NUMA nodes */
+#define BFM_ALLOC_BINDPARTITION 0x04    /* bind the buffers of partition p to NUMA node p % #nodes */
+
+
 /*@
  * Function Prototypes
  */
@@ -59,6 +162,35 @@ Four EduBfM_GetTrain(TrainID *, char **, Four);
 Four EduBfM_SetDirty(TrainID *, Four);
 Four EduBfM_DiscardAll(void);
 Four EduBfM_FlushAll(void);
+Four EduBfM_SetNumPartitions(Four, Four);
+Four EduBfM_SetHashMethod(Four, Four);
+Four EduBfM_SetReplacementPolicy(Four, Four);
+Four EduBfM_GetStats(Four, BfMStats *);
+Four EduBfM_ResetStats(void);
+Four EduBfM_DumpStats(FILE *);
+Four EduBfM_SetCleaner(Four, Four);
+Four EduBfM_SetAsyncIO(Four);
+Four EduBfM_GetTrainAsync(TrainID *, Four, BfMIOHandle *);
+Four EduBfM_WaitTrain(BfMIOHandle *, char **);
+Boolean EduBfM_PollTrain(BfMIOHandle *);
+Four EduBfM_SetReadAhead(Four, Four, BfMNextTrainFunc);
+Four EduBfM_CreateStrategy(Four, Four, BfMStrategy **);
+Four EduBfM_DestroyStrategy(BfMStrategy *);
+Four EduBfM_GetTrainStrategy(TrainID *, char **, Four, BfMStrategy *);
+Four EduBfM_SetPoolAllocation(Four, Four);
+Four EduBfM_Resize(Four, Four);
+Four EduBfM_SetAdaptiveSplit(Four);
+Four EduBfM_SetHotSetFile(char *);
+Four EduBfM_WarmUp(char *);
+Four EduBfM_GetTrains(TrainID *, Four, char **, Four *, Four);
+Four EduBfM_FreeTrains(TrainID *, Four, Four *, Four);
+Four EduBfM_InvalidateTrains(TrainID *, Four, Four);
+Four EduBfM_SetTableLayout(Four, Four);
+Four EduBfM_SetVictimCache(Four, Four);
+Four EduBfM_SetSecondaryCache(Four, char *, Four);
+Four EduBfM_MapVolume(Four, Four, char **);
+Four EduBfM_UnmapVolume(Four);
+Four EduBfM_SetDirectIO(Four, Four, char **);
 
 
 #endif /* _EDUBFM_H_ */
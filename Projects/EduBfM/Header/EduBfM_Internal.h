@@ -50,6 +50,10 @@
 #define _EDUBFM_INTERNAL_H_
 
 
+#include <pthread.h>
+#include <sys/types.h> /* for off_t */
+#include "EduBfM.h"
+
 /*@
  * Constant Definitions
  */ 
@@ -120,6 +124,9 @@ typedef struct {
 #define DIRTY  0x01
 #define VALID  0x02
 #define REFER  0x04
+#define READING 0x08    /* the train is being read without the latch of its partition */
+#define PREFETCHED 0x10 /* the train has been read ahead of a scan and not fixed yet */
+#define CLEANING 0x20   /* the train is being written back from a copy and not updated since */
 #define ALL_0  0x00
 #define ALL_1  ((sizeof(One) == 1) ? (0xff) : (0xffff))
 
@@ -168,21 +175,25 @@ typedef struct {
 
 /* Macro: BI_FIXED(type, idx)
  * Description: return the number of transactions fixing (accessing) the page/train residing in the buffer element
+ *  (an lvalue, kept in the dense arrays of bufStateArrays[type] under BFM_LAYOUT_SOA)
  * Parameters:
  *  Four type       : buffer type
  *  Four idx        : array index of the buffer element
  * Returns: (Two) number of transactions
  */
-#define BI_FIXED(type, idx)	     (((BufferTable*)bufInfo[type].bufTable)[idx].fixed)
+#define BI_FIXED(type, idx)	     (*(BI_LAYOUT(type) == BFM_LAYOUT_SOA ? &bufStateArrays[type].fixed[idx] : \
+                                        &((BufferTable*)bufInfo[type].bufTable)[idx].fixed))
 
 /* Macro: BI_BITS(type, idx)
  * Description: return a set of bits indicating the state of the buffer element
+ *  (an lvalue, kept in the dense arrays of bufStateArrays[type] under BFM_LAYOUT_SOA)
  * Parameters:
  *  Four type       : buffer type
  *  Four idx        : array index of the buffer element
  * Returns: (One) set of bits
  */
-#define BI_BITS(type, idx)	     (((BufferTable*)bufInfo[type].bufTable)[idx].bits)
+#define BI_BITS(type, idx)	     (*(BI_LAYOUT(type) == BFM_LAYOUT_SOA ? &bufStateArrays[type].bits[idx] : \
+                                        &((BufferTable*)bufInfo[type].bufTable)[idx].bits))
 
 /* Macro: BI_NEXTHASHENTRY(type, idx)
  * Description: return the array index of the buffer element containing the next page/train having the identical hash key value
@@ -254,17 +265,823 @@ typedef struct {
 
 extern BufferInfo bufInfo[];
 
+/* size of a cache line in bytes */
+#define BFM_CACHELINESIZE        64
+
+/* # of slots of a bucket of the open addressing hash table */
+#define BFM_OPENHASH_BUCKETSIZE  6
+
+/* type definition for a bucket of the open addressing hash table
+ * The keys and the buffer indexes of a bucket fill exactly one cache line.
+ */
+typedef struct {
+    PageNo              pageNo[BFM_OPENHASH_BUCKETSIZE];    /* pageNo of the keys (NIL: empty slot) */
+    Four                index[BFM_OPENHASH_BUCKETSIZE];     /* buffer indexes (NOTFOUND_IN_HTABLE: empty slot) */
+    VolNo               volNo[BFM_OPENHASH_BUCKETSIZE];     /* volNo of the keys */
+    Two                 reserved;
+    Two                 nOverflows;     /* # of keys stored beyond this bucket passing over it */
+} BfMHashBucket;
+
+/* type definition for the open addressing hash table */
+typedef struct {
+    Four                nBuckets;       /* # of buckets (a power of two) */
+    Four                shift;          /* 32 - log2(nBuckets) */
+    BfMHashBucket*      buckets;        /* cache line aligned array of buckets */
+} BfMOpenHashTable;
+
+/* Hash Methods */
+#define BFM_HASH_CHAINED    0   /* hash table of BufferTable.nextHashEntry chains (default) */
+#define BFM_HASH_OPEN       1   /* open addressing hash table of BfMHashBuckets */
+
+/* Replacement Policies */
+#define BFM_POLICY_CLOCK    0   /* second chance (default) */
+#define BFM_POLICY_LRUK     1   /* LRU-2 with retained history of evicted trains */
+#define BFM_POLICY_2Q       2   /* 2Q with A1in, A1out and Am queues */
+#define BFM_POLICY_ARC      3   /* adaptive replacement cache */
+#define BFM_POLICY_CLEANFIRST 4 /* second chance preferring clean victims */
+#define BFM_NUM_POLICIES    5
+
+/* Buffer Table Layouts */
+#define BFM_LAYOUT_AOS      0   /* fixed counts and bits in the BufferTable entries (default) */
+#define BFM_LAYOUT_SOA      1   /* fixed counts and bits in the dense arrays of BfMStateArrays */
+
+/* # of entries padding the state arrays; at least the widest vector of the
+ * clock sweep, whatever instruction set edubfm_Layout.c is built for */
+#define BFM_STATE_PAD       32
+
+/* type definition for the dense state arrays of a buffer pool
+ * Under BFM_LAYOUT_SOA the fixed counts and the bits of the buffers are
+ * kept here instead of in the BufferTable entries, so that the clock reads
+ * a vector of buffers per load rather than a cache line per buffer. The
+ * arrays are padded so that a vector load at any buffer stays inside them;
+ * the padding does not depend on the vector width, so that every module
+ * sees the same layout.
+ */
+typedef struct {
+    Four                layout;                         /* BFM_LAYOUT_xxx */
+    Two                 fixed[32768 + BFM_STATE_PAD];   /* fixed count of each buffer; nBufs is a Two */
+    One                 bits[32768 + BFM_STATE_PAD];    /* bits of each buffer */
+} BfMStateArrays;
+
+/* Macro: BI_LAYOUT(type)
+ * Description: return the layout of the buffer table of a buffer pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four) BFM_LAYOUT_AOS or BFM_LAYOUT_SOA
+ */
+#define BI_LAYOUT(type)              (bufStateArrays[type].layout)
+
+/* # of lists of a replacement policy state */
+#define BFM_POLICY_NLISTS   6
+
+/* type definition for a doubly linked list of the nodes of a policy state */
+typedef struct {
+    Four                head;           /* most recently inserted node (NIL if empty) */
+    Four                tail;           /* least recently inserted node (NIL if empty) */
+    Four                size;           /* # of nodes in the list */
+} BfMPolicyList;
+
+/* type definition for the state of a replacement policy other than the clock
+ * The state covers the buffers of one partition (or of an unpartitioned pool).
+ * Node i (0 <= i < nBufs) is the buffer firstBuf + i, and node nBufs + j is
+ * the j-th ghost, which remembers the key of a train evicted recently.
+ */
+typedef struct {
+    Four                policy;         /* BFM_POLICY_xxx */
+    Four                firstBuf;       /* index of the first buffer covered */
+    Four                nBufs;          /* # of buffers covered */
+    Four                *prev;          /* previous node in the list (2 * nBufs nodes) */
+    Four                *next;          /* next node in the list */
+    One                 *where;         /* list holding the node */
+    BfMHashKey          *ghostKey;      /* key of each ghost */
+    UFour               *hist;          /* LRU-K: last two reference times of each node */
+    BfMPolicyList       lists[BFM_POLICY_NLISTS];
+    BfMOpenHashTable    ghostTable;     /* key of a ghost -> node of the ghost */
+    UFour               clock;          /* LRU-K: logical time */
+    Four                target;         /* ARC: target size of T1, 2Q: maximum size of A1in */
+    Four                incoming;       /* list which the train being loaded goes to */
+    UFour               incomingHist;   /* LRU-K: last reference time of the train being loaded (0 if unknown) */
+    Four                incomingFromB2; /* ARC: the train being loaded was found in B2 */
+    Four                dropT1;         /* ARC: evict from T1 without keeping a ghost */
+} BfMPolicyState;
+
+/* type definition for a partition of a buffer pool
+ * A partitioned buffer pool is split into disjoint ranges of buffer elements.
+ * Each train is mapped to exactly one partition by its hash key, and each
+ * partition has its own latch, clock hand and hash table, so that trains in
+ * different partitions can be fixed and unfixed concurrently.
+ */
+typedef struct {
+    Two                 firstBuf;       /* index of the first buffer element of this partition */
+    Two                 nBufs;          /* # of buffer elements in this partition */
+    UTwo                nextVictim;     /* starting point for searching a next victim */
+    Two                 hashTableSize;  /* # of entries of the hash table */
+    Two*                hashTable;      /* hash table of this partition */
+    pthread_mutex_t     latch;          /* latch protecting this partition */
+    pthread_cond_t      ioDone;         /* signaled when a read or a write-back of this partition completes */
+    BfMOpenHashTable    openHashTable;  /* hash table of this partition if BFM_HASH_OPEN is used */
+    BfMPolicyState*     policyState;    /* state of the replacement policy (NULL for the clock) */
+    Boolean             evicting;       /* TRUE while a dirty victim is written back without the latch */
+} BufferPartition;
+
+/* type definition for the partition information of a buffer pool */
+typedef struct {
+    Two                 nPartitions;    /* # of partitions (0 or 1: not partitioned) */
+    BufferPartition*    partitions;     /* array of partitions */
+    pthread_mutex_t     latch;          /* latch protecting the pool when not partitioned */
+    pthread_cond_t      ioDone;         /* ioDone of the pool when not partitioned */
+    Four                hashMethod;     /* BFM_HASH_CHAINED or BFM_HASH_OPEN */
+    BfMOpenHashTable    openHashTable;  /* hash table of the pool if BFM_HASH_OPEN is used and not partitioned */
+    Four                policy;         /* replacement policy, BFM_POLICY_xxx */
+    BfMPolicyState*     policyState;    /* state of the replacement policy if not partitioned */
+    Boolean             evicting;       /* evicting of the pool when not partitioned */
+} BufferPartitionInfo;
+
+/* interval of the passes of a background cleaner (unit: milliseconds) */
+#define BFM_CLEANER_INTERVAL    10
+
+/* type definition for the background cleaner of a buffer pool
+ * The cleaner is a thread writing back the dirty, unfixed trains which
+ * the clock will reach next, so that `nClean' clean victims are ready.
+ */
+typedef struct {
+    pthread_t           thread;         /* the cleaner thread */
+    Boolean             running;        /* TRUE while the thread exists */
+    Boolean             stop;           /* TRUE to ask the thread to exit */
+    Four                nClean;         /* # of clean victims to keep ready in the pool */
+    char                *copy;          /* copy of the train being written back */
+    pthread_mutex_t     latch;          /* held during a pass; keeps the layout of the pool unchanged */
+    pthread_mutex_t     wakeupLatch;    /* protects `stop' and `wakeup' */
+    pthread_cond_t      wakeup;         /* signaled to start a pass early */
+} BfMCleaner;
+
+/* returned by edubfm_EvictTrain() when a dirty victim has been fixed or
+ * updated while it was written back, so that it cannot be evicted */
+#define BFM_VICTIM_KEPT         1
+
+/* maximum number of the worker threads of the asynchronous I/O engine */
+#define MAXNUMOFIOWORKERS       64
+
+/* type definition for the asynchronous I/O engine
+ * Requests are queued in FIFO order and executed by a pool of worker
+ * threads. A worker completes a request under the latch of the partition
+ * of the request and signals BI_PARTIODONE() of the partition.
+ */
+typedef struct {
+    Four                nWorkers;       /* # of worker threads; 0 if the engine is not running */
+    pthread_t           *workers;       /* the worker threads */
+    Boolean             stop;           /* TRUE to ask the workers to exit when the queue is empty */
+    BfMIOHandle         *head;          /* first request in the queue */
+    BfMIOHandle         *tail;          /* last request in the queue */
+    pthread_mutex_t     latch;          /* protects the queue and `stop' */
+    pthread_cond_t      wakeup;         /* signaled when a request is queued */
+} BfMIOEngine;
+
+/* # of requests in flight in the io_uring of the asynchronous I/O engine */
+#define BFM_IOURING_DEPTH       64
+
+/* type definition for a request in flight in the io_uring */
+typedef struct {
+    BfMIOHandle         *handle;        /* the request */
+    int                 fd;             /* file transferred */
+    off_t               offset;         /* offset of the trains in the file */
+    size_t              nBytes;         /* # of bytes of the trains */
+    Boolean             isDirect;       /* TRUE if the file is opened for direct I/O */
+} BfMIOUringSlot;
+
+/* type definition for the io_uring of the asynchronous I/O engine
+ * The rings are shared with the kernel. The requests are submitted under
+ * `latch' by the callers of edubfm_SubmitIO(), and a reaper thread
+ * completes them as the kernel posts their completions.
+ */
+typedef struct {
+    int                 fd;             /* the io_uring; -1 if not set up */
+    Four                depth;          /* # of slots */
+    void                *sqRing;        /* mapping of the submission queue */
+    size_t              sqRingSize;     /* # of bytes of the mapping */
+    void                *cqRing;        /* mapping of the completion queue, if not shared with sqRing */
+    size_t              cqRingSize;     /* # of bytes of the mapping */
+    void                *sqes;          /* mapping of the submission queue entries */
+    size_t              sqesSize;       /* # of bytes of the mapping */
+    unsigned            *sqTail;        /* tail of the submission queue */
+    unsigned            *sqMask;        /* mask of an index of the submission queue */
+    unsigned            *sqArray;       /* entries submitted */
+    unsigned            *cqHead;        /* head of the completion queue */
+    unsigned            *cqTail;        /* tail of the completion queue */
+    unsigned            *cqMask;        /* mask of an index of the completion queue */
+    void                *cqes;          /* completion queue entries */
+    BfMIOUringSlot      *slots;         /* requests in flight */
+    Four                *freeSlots;     /* stack of the free slots */
+    Four                nFree;          /* # of free slots */
+    Boolean             stop;           /* TRUE once no request may be submitted */
+    pthread_t           reaper;         /* thread completing the requests */
+    pthread_mutex_t     latch;          /* serializes the submissions and protects the slots */
+    pthread_cond_t      slotFreed;      /* signaled when a request completes */
+} BfMIOUring;
+
+/* internal operation of the asynchronous I/O engine: read a train ahead of a scan
+ * The handle is allocated by edubfm_Prefetch() and freed by the engine.
+ */
+#define BFM_IO_PREFETCH         2
+
+/* internal operation of the asynchronous I/O engine: a train of EduBfM_GetTrainAsync()
+ * which could not be fixed or claimed yet (see edubfm_FixTrain()); the handle
+ * is bound to the read of the train by edubfm_JoinTrain().
+ */
+#define BFM_IO_JOIN             3
+
+/* internal operation of the asynchronous I/O engine: read a run of trains contiguous
+ * on the disk into the buffer of the handle for edubfm_ReadTrains(), which gives the
+ * trains to their buffers once the read completes.
+ */
+#define BFM_IO_READRUN          4
+
+/* results of edubfm_FixTrain() */
+#define BFM_FIX_HIT             0       /* the train is fixed */
+#define BFM_FIX_MISS            1       /* a buffer is claimed for the train, which is to be read */
+#define BFM_FIX_READING         2       /* the train is being read for another caller */
+#define BFM_FIX_EVICTING        3       /* the train is missing while a victim is written back */
+
+/* # of scans tracked for read-ahead in each buffer pool */
+#define BFM_RA_NSTREAMS         8
+
+/* initial # of trains read ahead of a scan */
+#define BFM_RA_INITIALK         4
+
+/* type definition for a scan detected by the read-ahead
+ * The trains requested ahead of the scan form the chain following the
+ * train fixed last by the scan and ending with `tail'.
+ */
+typedef struct {
+    TrainID             expect;         /* train the scan is expected to fix next */
+    TrainID             tail;           /* last train requested ahead of the scan */
+    TrainID             next;           /* train following `tail' if known and not requested yet */
+    Four                nAhead;         /* # of trains requested ahead of the scan */
+    Four                run;            /* # of fixes along the chain so far */
+    UFour               lastUsed;       /* time of the last fix, for replacing a scan */
+} BfMScanStream;
+
+/* type definition for the read-ahead of a buffer pool */
+typedef struct {
+    Four                maxK;           /* maximum # of trains read ahead of a scan; 0 if disabled */
+    Four                curK;           /* current # of trains read ahead of a scan */
+    BfMNextTrainFunc    nextTrain;      /* gives the next train of a page chain */
+    BfMScanStream       streams[BFM_RA_NSTREAMS];
+    UFour               clock;          /* logical time of the fixes */
+    pthread_mutex_t     latch;          /* protects this structure */
+} BfMReadAhead;
+
+/* # of buffers of the ring of each access strategy, at most a quarter of the pool */
+#define BFM_RING_SEQSCAN        8
+#define BFM_RING_BULKWRITE      32
+
+/* kinds of pages backing the buffers of a pool */
+#define BFM_ARENA_DEFAULT       0       /* buffers allocated by the storage system */
+#define BFM_ARENA_4K            1       /* mapping of base pages */
+#define BFM_ARENA_THP           2       /* mapping advised to use transparent huge pages */
+#define BFM_ARENA_HUGETLB2M     3       /* mapping of 2 MB huge pages */
+#define BFM_ARENA_HUGETLB1G     4       /* mapping of 1 GB huge pages */
+
+/* type definition for the memory holding the buffers of a pool
+ * The buffers allocated by the storage system are kept aside while the
+ * pool uses a mapping of its own, and are given back by edubfm_FreeArena().
+ * An arena having room for more buffers than the storage system allocated
+ * also has its own buffer table and hash table, so that the pool can grow.
+ */
+typedef struct {
+    Four                flags;          /* BFM_ALLOC_xxx given to EduBfM_SetPoolAllocation() */
+    Four                kind;           /* BFM_ARENA_xxx */
+    Four                capacity;       /* # of buffers the arena has room for */
+    Two                 origNBufs;      /* # of buffers allocated by the storage system; 0 if not known yet */
+    char                *saved;         /* buffers allocated by the storage system */
+    Boolean             keep;           /* TRUE to keep the arena when the pool shrinks to the buffers of the storage system */
+    BufferTable         *savedTable;    /* buffer table of the storage system if the arena has its own */
+    Two                 *savedHashTable; /* hash table of the storage system if the arena has its own */
+    char                *base;          /* start of the mapping */
+    size_t              size;           /* size of the mapping */
+    size_t              pageSize;       /* size of the pages backing the mapping */
+} BfMArena;
+
+/* max # of buffers of a resized pool; the hash table of 3 * nBufs - 1 entries is indexed by a Two */
+#define BFM_MAXNBUFS            (32767 / 3)
+
+/* memory remembered by the ghost list of each pool under the adaptive split (unit: # of pages) */
+#define BFM_ADAPT_GHOSTPAGES    1024
+
+/* # of misses between two decisions of the adaptive split */
+#define BFM_ADAPT_PERIOD        256
+
+/* # of ghost hits by which a pool must lead to take memory from the other */
+#define BFM_ADAPT_MINHITS       8
+
+/* a decision moves 1/BFM_ADAPT_STEPDIV of the budget, and a pool keeps 1/BFM_ADAPT_MINDIV of it */
+#define BFM_ADAPT_STEPDIV       64
+#define BFM_ADAPT_MINDIV        16
+
+/* type definition for the ghost list of a pool under the adaptive split
+ * The ghosts are the keys of the trains evicted last, as many as fill
+ * BFM_ADAPT_GHOSTPAGES pages, kept in a ring. A miss finding its key is a
+ * miss the pool would have saved with that much more memory.
+ */
+typedef struct {
+    Four                nGhosts;        /* # of slots of the ring */
+    Four                next;           /* slot overwritten next */
+    BfMHashKey          *keys;          /* key of each slot; NIL if the slot is empty */
+    BfMOpenHashTable    table;          /* key of a ghost -> its slot */
+    UFour               hits;           /* # of misses finding their key, halved by each decision */
+} BfMGhostList;
+
+/* type definition for the adaptive split of memory between the pools
+ * The pools share `budget' pages. Every BFM_ADAPT_PERIOD misses, memory is
+ * moved to the pool whose ghost list has found clearly more misses, since
+ * the same memory saves more misses there.
+ */
+typedef struct {
+    Four                budget;         /* # of pages shared by the pools; 0 if disabled */
+    UFour               nMisses;        /* # of misses counted for the period */
+    BfMGhostList        ghosts[NUM_BUF_TYPES];
+    pthread_mutex_t     latch;          /* protects the ghost lists and `budget' */
+    pthread_mutex_t     adaptLatch;     /* held while the split is changed */
+} BfMAdaptiveSplit;
+
+/* a train is assumed to compress to 1/BFM_VICTIM_MAXRATIO of its size at best, which bounds the # of entries */
+#define BFM_VICTIM_MAXRATIO     8
+
+/* type definition for an entry of the compressed victim cache */
+typedef struct {
+    BfMHashKey          key;            /* key of the train */
+    Four                size;           /* # of bytes of data; the size of a train if not compressed */
+    Four                prev;           /* newer entry; NIL at the head */
+    Four                next;           /* older entry (or next free entry); NIL at the tail */
+    char                *data;          /* the compressed train */
+} BfMVictimEntry;
+
+/* type definition for the compressed victim cache of a buffer pool
+ * The clean trains evicted by edubfm_AllocTrain() are compressed by the
+ * codec of edubfm_LZ.c and kept up to `budget' bytes, so that a miss
+ * finding its train here is served without reading the disk. A train is
+ * either in the pool or here, never both: it leaves the cache when it is
+ * read into the pool. The oldest entry is dropped to make room.
+ */
+typedef struct {
+    Four                budget;         /* # of bytes of compressed trains kept; 0 if disabled */
+    Four                used;           /* # of bytes of compressed trains held */
+    Four                nEntries;       /* # of entries */
+    BfMVictimEntry      *entries;       /* entries */
+    Four                head;           /* newest entry */
+    Four                tail;           /* oldest entry */
+    Four                freeEntry;      /* first free entry */
+    BfMOpenHashTable    table;          /* key of a train -> its entry */
+    pthread_mutex_t     latch;          /* protects the cache */
+} BfMVictimCache;
+
+/* type definition for the secondary cache of a buffer pool
+ * A file of `nSlots' trains on a fast local disk keeps a copy of the clean
+ * trains evicted by edubfm_AllocTrain(), so that a miss finding its train
+ * here reads the local file instead of the volume. Unlike the victim cache,
+ * a train may be in the pool and here at the same time: a copy stays valid
+ * until the train is made dirty, when it is dropped. The slots are replaced
+ * by a clock over their reference bits. The index is kept in memory only.
+ */
+typedef struct {
+    Four                nSlots;         /* # of trains of the file; 0 if disabled */
+    int                 fd;             /* descriptor of the file */
+    BfMHashKey          *keys;          /* key of the train of each slot; NIL if the slot is empty */
+    One                 *refer;         /* reference bit of each slot */
+    Four                hand;           /* slot visited next by the clock */
+    BfMOpenHashTable    table;          /* key of a train -> its slot */
+    pthread_mutex_t     latch;          /* protects the cache and serializes the I/O on the file */
+} BfMSecondaryCache;
+
+/* # of volumes which may be mapped at the same time, and # of devices of a mapped volume */
+#define MAXNUMOFMAPPEDVOLUMES   8
+#define MAXNUMOFMAPPEDDEVICES   16
+
+/* type definition for a volume mapped read-only by EduBfM_MapVolume()
+ * The devices of a volume hold its pages one after another, each device
+ * its whole extents: page p of the volume is at (p - firstPage[d]) *
+ * PAGESIZE in the device d such that firstPage[d] <= p < firstPage[d+1].
+ */
+typedef struct {
+    Four                volNo;          /* volume mapped */
+    Four                nDevices;       /* # of devices of the volume; 0 if the entry is free */
+    Four                firstPage[MAXNUMOFMAPPEDDEVICES + 1];   /* first page of each device, then the # of pages */
+    char                *base[MAXNUMOFMAPPEDDEVICES];           /* mapping of each device */
+    size_t              size[MAXNUMOFMAPPEDDEVICES];            /* # of bytes of each mapping */
+} BfMMappedVolume;
+
+/* type definition for the volumes mapped read-only
+ * The trains of a mapped volume are returned straight from the mapping and
+ * never enter the pools. The entries are read without the latch, so an
+ * entry is filled before its nDevices is set, and unmapped after its
+ * nDevices is cleared.
+ */
+typedef struct {
+    Four                nMapped;        /* # of volumes mapped */
+    BfMMappedVolume     volumes[MAXNUMOFMAPPEDVOLUMES];
+    pthread_mutex_t     latch;          /* serializes mapping and unmapping */
+} BfMMappedVolumes;
+
+/* alignment of the buffers and file offsets of direct I/O */
+#define BFM_DIRECTIO_ALIGN      4096
+
+/* type definition for a volume accessed by direct I/O (see EduBfM_SetDirectIO())
+ * The devices are numbered as in BfMMappedVolume. The entries are read by
+ * the transfers without a latch, so an entry is filled before its nDevices
+ * is set.
+ */
+typedef struct {
+    Four                volNo;          /* volume accessed */
+    Four                nDevices;       /* # of devices of the volume; 0 if the entry is free */
+    Four                firstPage[MAXNUMOFMAPPEDDEVICES + 1];   /* first page of each device, then the # of pages */
+    int                 fd[MAXNUMOFMAPPEDDEVICES];              /* descriptor of each device opened with O_DIRECT */
+} BfMDirectVolume;
+
+/* type definition for the volumes accessed by direct I/O */
+typedef struct {
+    Four                nVolumes;       /* # of volumes accessed by direct I/O */
+    BfMDirectVolume     volumes[MAXNUMOFMAPPEDVOLUMES];
+    char                *bounce;        /* aligned copy of a transfer */
+    size_t              bounceSize;     /* # of bytes of the bounce buffer */
+    pthread_mutex_t     latch;          /* guards the bounce buffer and the changes of the entries */
+} BfMDirectIO;
+
+/* first bytes of a hot set file written by edubfm_SaveHotSet() */
+#define BFM_HOTSET_MAGIC        "EDUBFMH1"
+
+/* # of the hottest trains loaded together by EduBfM_WarmUp(), in the order of (volNo, pageNo) */
+#define BFM_WARMUP_BATCH        256
+
+/* type definition for an entry of a hot set file
+ * The file holds BFM_HOTSET_MAGIC, the # of entries as a Four and the
+ * entries, each pool's trains from the hottest to the coldest.
+ */
+typedef struct {
+    BfMHashKey          key;            /* train resident when the file was written */
+    Four                type;           /* buffer type */
+    UFour               hotness;        /* higher for a train its policy would keep longer */
+} BfMHotEntry;
+
+/* # of words of a dirty map; nBufs is a Two, so a pool has 32768 buffers at most */
+#define BFM_DIRTYMAP_NWORDS     (32768 / 64)
+#define BFM_DIRTYMAP_NSUMMARY   (BFM_DIRTYMAP_NWORDS / 64)
+
+/* type definition for the dirty map of a buffer pool
+ * Bit i of `words' is set if buffer i may be dirty, and bit j of `summary'
+ * is set if word j may be non-zero, so that the dirty buffers are found in
+ * time proportional to their number. A set bit is only a hint; the DIRTY
+ * bit of the buffer is checked under the latch of its partition.
+ */
+typedef struct {
+    UEight              words[BFM_DIRTYMAP_NWORDS];     /* a bit per buffer */
+    UEight              summary[BFM_DIRTYMAP_NSUMMARY]; /* a bit per word */
+} BfMDirtyMap;
+
+/* max # of trains coalesced into a write by EduBfM_FlushAll() */
+#define BFM_FLUSH_MAXRUN        64
+
+/* type definition for a buffer of a batch of trains written by EduBfM_FlushAll() or read by edubfm_ReadTrains() */
+typedef struct {
+    BfMHashKey          key;            /* train of the buffer */
+    Four                type;           /* buffer type */
+    Four                index;          /* index of the buffer */
+    Four                part;           /* partition of the buffer */
+} BfMFlushEntry;
+
+/* Macro: BI_CLEANERLATCH(type)
+ * Description: return the latch which keeps the cleaner of a pool away
+ *  while the partitions, hash tables or policy states are rebuilt
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (pthread_mutex_t *) pointer to the latch
+ */
+#define BI_CLEANERLATCH(type)   (&bufCleaner[type].latch)
+
+/* Macro: BFM_STATS_ADD(type, counter, n)
+ * Description: add a number to a counter of the statistics of a buffer pool
+ *  The counter is shared by all partitions, so it is updated atomically.
+ * Parameters:
+ *  Four type       : buffer type
+ *  counter         : name of the counter in BfMStats
+ *  n               : number to add
+ */
+#define BFM_STATS_ADD(type, counter, n) ((void)__sync_fetch_and_add(&bufStats[type].counter, (UEight)(n)))
+
+/* Macro: BFM_STATS_INC(type, counter)
+ * Description: increment a counter of the statistics of a buffer pool
+ * Parameters:
+ *  Four type       : buffer type
+ *  counter         : name of the counter in BfMStats
+ */
+#define BFM_STATS_INC(type, counter)    BFM_STATS_ADD(type, counter, 1)
+
+/* Macro: BI_NPARTITIONS(type)
+ * Description: return the number of partitions of a buffer pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Two) the number of partitions (1 if the pool is not partitioned)
+ */
+#define BI_NPARTITIONS(type)         (BI_PARTITIONED(type) ? bufPartInfo[type].nPartitions : 1)
+
+/* Macro: BI_PARTITIONED(type)
+ * Description: check whether a buffer pool is partitioned
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: TRUE(1) if the buffer pool has more than one partition, otherwise FALSE(0)
+ */
+#define BI_PARTITIONED(type)         (bufPartInfo[type].nPartitions > 1)
+
+/* Macro: BI_PARTITION(type, p)
+ * Description: return the p-th partition of a partitioned buffer pool
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four p          : partition number
+ * Returns: (BufferPartition) p-th partition
+ */
+#define BI_PARTITION(type, p)        (bufPartInfo[type].partitions[p])
+
+/* Macro: BI_PARTITIONOFKEY(type, k)
+ * Description: return the partition number of the partition which a train belongs to
+ * Parameters:
+ *  Four type       : buffer type
+ *  BfMHashKey *k   : pointer to the hash key of the train
+ * Returns: (Four) partition number (always 0 if the pool is not partitioned)
+ */
+#define BI_PARTITIONOFKEY(type, k)   (BI_PARTITIONED(type) ? edubfm_PartitionOfKey(k, type) : 0)
+
+/* Macro: BI_PARTITIONOFBUF(type, idx)
+ * Description: return the partition number of the partition owning a buffer element
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four idx        : array index of the buffer element
+ * Returns: (Four) partition number (always 0 if the pool is not partitioned)
+ */
+#define BI_PARTITIONOFBUF(type, idx) (BI_PARTITIONED(type) ? edubfm_PartitionOfBuf(idx, type) : 0)
+
+/* Macro: BI_PARTFIRSTBUF(type, p)
+ * Description: return the index of the first buffer element of a partition
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four p          : partition number
+ * Returns: (Two) index of the first buffer element
+ */
+#define BI_PARTFIRSTBUF(type, p)     (BI_PARTITIONED(type) ? BI_PARTITION(type, p).firstBuf : 0)
+
+/* Macro: BI_PARTNBUFS(type, p)
+ * Description: return the number of buffer elements of a partition
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four p          : partition number
+ * Returns: (Two) the number of buffer elements
+ */
+#define BI_PARTNBUFS(type, p)        (BI_PARTITIONED(type) ? BI_PARTITION(type, p).nBufs : BI_NBUFS(type))
+
+/* Macro: BI_PARTNEXTVICTIM(type, p)
+ * Description: return the next victim of a partition (an lvalue)
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four p          : partition number
+ * Returns: (UTwo) an array index of the next victim
+ */
+#define BI_PARTNEXTVICTIM(type, p)   (*(BI_PARTITIONED(type) ? &BI_PARTITION(type, p).nextVictim : &BI_NEXTVICTIM(type)))
+
+/* Macro: BI_PARTHASHTABLE(type, p)
+ * Description: return the hash table of a partition
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four p          : partition number
+ * Returns: (Two*) pointer to the hash table
+ */
+#define BI_PARTHASHTABLE(type, p)    (BI_PARTITIONED(type) ? BI_PARTITION(type, p).hashTable : BI_HASHTABLE(type))
+
+/* Macro: BI_PARTHASHTABLESIZE(type, p)
+ * Description: return the size of the hash table of a partition
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four p          : partition number
+ * Returns: (Two) size of the hash table
+ */
+#define BI_PARTHASHTABLESIZE(type, p) (BI_PARTITIONED(type) ? BI_PARTITION(type, p).hashTableSize : HASHTABLESIZE(type))
+
+/* Macro: BI_HASHMETHOD(type)
+ * Description: return the hash method of a buffer pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four) BFM_HASH_CHAINED or BFM_HASH_OPEN
+ */
+#define BI_HASHMETHOD(type)          (bufPartInfo[type].hashMethod)
+
+/* Macro: BI_PARTOPENHASHTABLE(type, p)
+ * Description: return the open addressing hash table of a partition
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four p          : partition number
+ * Returns: (BfMOpenHashTable *) pointer to the hash table
+ */
+#define BI_PARTOPENHASHTABLE(type, p) (BI_PARTITIONED(type) ? &BI_PARTITION(type, p).openHashTable : &bufPartInfo[type].openHashTable)
+
+/* Macro: BI_POLICY(type)
+ * Description: return the replacement policy of a buffer pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four) BFM_POLICY_xxx
+ */
+#define BI_POLICY(type)              (bufPartInfo[type].policy)
+
+/* Macro: BI_PARTPOLICYSTATE(type, p)
+ * Description: return the state of the replacement policy of a partition (an lvalue)
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four p          : partition number
+ * Returns: (BfMPolicyState *) pointer to the state (NULL for the clock)
+ */
+#define BI_PARTPOLICYSTATE(type, p)  (*(BI_PARTITIONED(type) ? &BI_PARTITION(type, p).policyState : &bufPartInfo[type].policyState))
+
+/* Macro: BI_PARTEVICTING(type, p)
+ * Description: return whether a dirty victim of a partition is being written
+ *  back by edubfm_EvictTrain() without the latch (an lvalue); no train may
+ *  be claimed in the partition meanwhile
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four p          : partition number
+ * Returns: (Boolean) TRUE during the write-back
+ */
+#define BI_PARTEVICTING(type, p)     (*(BI_PARTITIONED(type) ? &BI_PARTITION(type, p).evicting : &bufPartInfo[type].evicting))
+
+/* Macro: BI_PARTLATCH(type, p)
+ * Description: return the latch protecting a partition
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four p          : partition number
+ * Returns: (pthread_mutex_t *) pointer to the latch
+ */
+#define BI_PARTLATCH(type, p)        (BI_PARTITIONED(type) ? &BI_PARTITION(type, p).latch : &bufPartInfo[type].latch)
+
+/* Macro: BI_PARTIODONE(type, p)
+ * Description: return the condition signaled, with the latch of the
+ *  partition, when a read or a write-back of the partition completes
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four p          : partition number
+ * Returns: (pthread_cond_t *) pointer to the condition
+ */
+#define BI_PARTIODONE(type, p)       (BI_PARTITIONED(type) ? &BI_PARTITION(type, p).ioDone : &bufPartInfo[type].ioDone)
+
+/* Macro: BFM_GETLATCH(l), BFM_RELEASELATCH(l)
+ * Description: acquire/release a latch of the buffer manager
+ * Parameter:
+ *  pthread_mutex_t *l  : pointer to the latch
+ */
+#define BFM_GETLATCH(l)              pthread_mutex_lock(l)
+#define BFM_RELEASELATCH(l)          pthread_mutex_unlock(l)
+
+/* Macro: ERRL(e, l)
+ * Description: release the latch `l' and return the error code `e'
+ */
+#define ERRL(e, l) \
+BEGIN_MACRO \
+    PRTERR(e); BFM_RELEASELATCH(l); if (1) return(e); \
+END_MACRO
+
+/* maximum number of partitions of a buffer pool */
+#define MAXNUMOFPARTITIONS  64
+
+/* # of referenced buffers the clock clears at most per allocation before it takes an unfixed one */
+#define BFM_CLOCK_BUDGET        32
+
+/* # of dirty candidates BFM_POLICY_CLEANFIRST passes over looking for a clean victim */
+#define BFM_CLEANFIRST_LOOKAHEAD 16
+
+/* type definition for the free lists of a buffer pool
+ * A stack per partition of the buffers holding no train, so that a buffer
+ * is allocated without running the clock while the pool is filling up or
+ * after trains have been dropped. The stack of partition p is kept in
+ * frames[BI_PARTFIRSTBUF(type, p) ...]. A list is built from the buffer
+ * table when it is first used after the layout of the pool or all of its
+ * trains changed, and an entry is checked when it is popped.
+ */
+typedef struct {
+    Two                 frames[32768];                  /* buffers holding no train; nBufs is a Two */
+    Two                 nFree[MAXNUMOFPARTITIONS];      /* # of entries of each stack */
+    Boolean             valid[MAXNUMOFPARTITIONS];      /* TRUE if the stack of the partition is built */
+} BfMFreeList;
+
+extern BufferPartitionInfo bufPartInfo[];
+extern pthread_mutex_t edubfm_ioLatch;
+extern BfMStats bufStats[];
+extern BfMCleaner bufCleaner[];
+extern BfMIOEngine edubfm_ioEngine;
+extern BfMIOUring edubfm_ioUring;
+extern BfMReadAhead bufReadAhead[];
+extern BfMDirtyMap bufDirtyMap[];
+extern BfMArena bufArena[];
+extern BfMAdaptiveSplit bufAdapt;
+extern char *edubfm_hotSetFile;
+extern BfMFreeList bufFreeList[];
+extern BfMStateArrays bufStateArrays[];
+extern Four edubfm_sweepWidth;
+extern BfMVictimCache bufVictimCache[];
+extern BfMSecondaryCache bufSecondaryCache[];
+extern BfMMappedVolumes bufMapped;
+extern BfMDirectIO bufDirect;
+
 /*@
  * Function Prototypes
  */
 /* internal function prototypes */
-Four edubfm_AllocTrain(Four);
+Four edubfm_AllocTrain(Four, Four, Boolean);
+Four edubfm_EvictTrain(Four, Four, Boolean);
 Four edubfm_Delete(BfMHashKey *, Four);
 Four edubfm_DeleteAll(void);
 Four edubfm_FlushTrain(TrainID *, Four);
 Four edubfm_Insert(BfMHashKey *, Two, Four); 
 Four edubfm_LookUp(BfMHashKey *, Four);
 Four edubfm_ReadTrain(TrainID *, char *, Four);
+Four edubfm_InitPartitions(Four, Four);
+Four edubfm_FinalPartitions(Four);
+Four edubfm_PartitionOfKey(BfMHashKey *, Four);
+Four edubfm_PartitionOfBuf(Four, Four);
+void edubfm_PartitionRange(Four, Four, Four, Four *, Four *);
+Four edubfm_ResizePartitions(Four, Four);
+Four edubfm_EmptyPool(Four);
+Four edubfm_OpenHashCreate(BfMOpenHashTable *, Four);
+Four edubfm_OpenHashDestroy(BfMOpenHashTable *);
+Four edubfm_OpenHashClear(BfMOpenHashTable *);
+Four edubfm_OpenHashLookUp(BfMOpenHashTable *, BfMHashKey *);
+Four edubfm_OpenHashInsert(BfMOpenHashTable *, BfMHashKey *, Four);
+Four edubfm_OpenHashDelete(BfMOpenHashTable *, BfMHashKey *);
+Four edubfm_InitPolicy(Four, Four);
+Four edubfm_FinalPolicy(Four, Four);
+Four edubfm_PolicyReset(Four, Four);
+Four edubfm_PolicyHit(Four, Four, Four);
+Four edubfm_PolicyMiss(Four, Four, BfMHashKey *);
+Four edubfm_PolicyVictim(Four, Four);
+Four edubfm_PolicyLoad(Four, Four, Four);
+Four edubfm_PolicyDrop(Four, Four, Four);
+Four edubfm_PolicyKeep(Four, Four, Four);
+UEight edubfm_StatsClock(void);
+void edubfm_StatsLatency(Four, Boolean, UEight);
+Four edubfm_StartCleaner(Four, Four);
+Four edubfm_StopCleaner(Four);
+void edubfm_WakeCleaner(Four);
+Four edubfm_StartIOEngine(Four);
+Four edubfm_StopIOEngine(void);
+Four edubfm_SubmitIO(BfMIOHandle *);
+Four edubfm_WaitIO(BfMIOHandle *);
+void edubfm_CompleteIO(BfMIOHandle *, Four);
+Four edubfm_StartIOUring(Four);
+void edubfm_StopIOUring(void);
+Boolean edubfm_SubmitIOUring(BfMIOHandle *);
+void edubfm_ReadAhead(Four, TrainID *, char *, Boolean);
+void edubfm_ReadAheadDone(Four, TrainID *, TrainID *);
+void edubfm_ReadAheadWasted(Four);
+void edubfm_MarkDirty(Four, Four);
+void edubfm_MarkClean(Four, Four);
+Four edubfm_NextDirty(Four, Four);
+void edubfm_ClearDirtyMap(Four);
+Boolean edubfm_InRing(BfMStrategy *, Four, Four);
+Four edubfm_RingVictim(Four, Four, BfMStrategy *);
+Four edubfm_AllocArena(Four, Four, Four);
+Four edubfm_FreeArena(Four);
+Four edubfm_ArenaCapacity(Four);
+void edubfm_TrimArena(Four);
+Four edubfm_ReserveArena(Four, Boolean);
+Four edubfm_StartAdapt(Four);
+void edubfm_StopAdapt(void);
+void edubfm_AdaptEvicted(Four, BfMHashKey *);
+void edubfm_AdaptMiss(Four, BfMHashKey *);
+void edubfm_Adapt(void);
+void edubfm_BindArena(Four);
+void edubfm_PolicyHotness(Four, Four, UFour *);
+Four edubfm_SaveHotSet(char *);
+Four edubfm_ClaimTrain(Four, Four, BfMHashKey *, Four);
+Four edubfm_FixTrain(Four, Four, BfMHashKey *, Four *);
+Four edubfm_EndRead(Four, Four, Four, Four);
+Four edubfm_JoinTrain(BfMIOHandle *, Boolean);
+Four edubfm_ReadTrains(BfMFlushEntry *, Four, Boolean);
+void edubfm_InvalidateFreeList(Four);
+void edubfm_FreeFrame(Four, Four, Four);
+Four edubfm_PopFreeFrame(Four, Four);
+Four edubfm_ClockSweep(Four, Four, Four, Four *);
+Four edubfm_CleanFirstSweep(Four, Four, Four, Four *);
+Four edubfm_LZCompress(char *, Four, char *, Four);
+Four edubfm_LZDecompress(char *, Four, char *, Four);
+Four edubfm_InitVictimCache(Four, Four);
+void edubfm_VictimPut(Four, BfMHashKey *, char *);
+Boolean edubfm_VictimTake(Four, BfMHashKey *, char *);
+void edubfm_VictimDrop(Four, BfMHashKey *);
+void edubfm_VictimClear(Four);
+Four edubfm_InitSecondaryCache(Four, char *, Four);
+void edubfm_SecondaryPut(Four, BfMHashKey *, char *);
+Boolean edubfm_SecondaryRead(Four, BfMHashKey *, char *);
+void edubfm_SecondaryDrop(Four, BfMHashKey *);
+void edubfm_SecondaryClear(Four);
+char *edubfm_MappedTrain(TrainID *, Four);
+Four edubfm_DeviceOfTrain(Four *, Four, TrainID *, Four);
+Four edubfm_DiskRead(TrainID *, char *, Four, Four);
+Four edubfm_DiskWrite(char *, TrainID *, Four, Four);
+Boolean edubfm_DiskLocate(TrainID *, char *, Four, Four, int *, off_t *, Boolean *);
+char *edubfm_AllocIOBuffer(Four);
 
 
 #endif /* _EDUBFM_INTERNAL_H_ */
@@ -151,7 +151,7 @@ Four LRDS_Dismount(Four);
 Four LRDS_FreeHandle(Four);
 Four LRDS_Final(void);
 
-Four RDsM_CreateSetment(Four, Four*);
+Four RDsM_CreateSegment(Four, Four*);
 Four RDsM_ExtNoToPageId(Four, Four, PageID*);
 Four RDsM_AllocTrains(Four, Four, PageID *, Two, Four, Two, PageID *);
 
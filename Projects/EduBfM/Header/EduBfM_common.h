@@ -115,6 +115,11 @@ typedef struct {
 */
 typedef PageID TrainID;		/* use its first page's PageID as the TrainID */
 
+/*
+** Type Definition for Unique Number
+*/
+typedef UFour Unique;
+
 #define PRINT_TRAINID(x,y) PRINT_PAGEID(x,y)
 
 /*
@@ -54,8 +54,15 @@
 /*
  * Error Base Definitions
  */
+#define GENERAL_ERR_BASE                         1
 #define BFM_ERR_BASE                             4
 
+/*
+ * Error Definitions for GENERAL_ERR_BASE
+ */
+#define eBADPARAMETER                            ERR_ENCODE_ERROR_CODE(GENERAL_ERR_BASE,2)
+#define eMEMORYALLOCERR                          ERR_ENCODE_ERROR_CODE(GENERAL_ERR_BASE,12)
+
 /*
  * Error Definitions for BFM_ERR_BASE
  */
@@ -121,3 +128,5 @@
 #define eNOMORELOCKCONTROLBLOCKS_BFM             ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,59)
 #define NUM_ERRORS_BFM_ERR_BASE                  60
 #define eNOTSUPPORTED_EDUBFM		             ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,61)
+#define eIOFAILED_EDUBFM                         ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,62)
+#define eVOLUMEFULL_EDUBFM                       ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,63)
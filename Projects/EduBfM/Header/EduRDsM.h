@@ -0,0 +1,181 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+#ifndef _EDURDSM_H_
+#define _EDURDSM_H_
+
+
+#include <pthread.h>
+#include <sys/types.h> /* for off_t */
+
+
+/*@
+ * Constant Definitions
+ */
+/* first bytes of the header page of a volume formatted by EduRDsM_Format() */
+#define EDURDSM_MAGIC           "EDURDSM1"
+
+/* max # of volumes mounted by EduRDsM_Mount() at the same time */
+#define EDURDSM_MAXVOLUMES      8
+
+/* max # of pages of an extent; the pages allocated in an extent are a bitmap in a UEight */
+#define EDURDSM_MAXEXTSIZE      64
+
+/* # of unique numbers handed out by one call of EduRDsM_GetUnique() */
+#define EDURDSM_UNIQUEBLOCK     1000
+
+/* owner of the extents holding the header page and the extent table */
+#define EDURDSM_SYSTEM          (-2)
+
+
+/*@
+ * Type Definitions
+ */
+/* type definition for the header page of a volume, page 0 of its file
+ * The extent table follows in pages 1 to nMetaPages - 1; extent i holds
+ * pages i * extSize to (i + 1) * extSize - 1 of the file.
+ */
+typedef struct {
+    char                magic[8];       /* EDURDSM_MAGIC */
+    Four                volNo;          /* volume number */
+    Four                nExts;          /* # of extents of the volume */
+    Two                 extSize;        /* # of pages of an extent */
+    Four                nMetaPages;     /* # of pages of the header and the extent table */
+    Unique              nextUnique;     /* first unique number not handed out yet */
+} EduRDsMVolHdr;
+
+/* type definition for an entry of the extent table
+ * The extents of a segment are chained from its first extent, whose number
+ * identifies the segment.
+ */
+typedef struct {
+    Four                owner;          /* first extent of the segment owning the extent; NIL if free */
+    Four                next;           /* next extent of the segment; NIL at the end */
+    UEight              used;           /* bit i set if page i of the extent is allocated */
+} EduRDsMExtEntry;
+
+/* # of entries of the extent table in a page */
+#define EDURDSM_EXTSPERPAGE     ((Four)(PAGESIZE / sizeof(EduRDsMExtEntry)))
+
+/* type definition for a volume mounted by EduRDsM_Mount()
+ * The header and the extent table are kept in memory and written through
+ * to the file whenever they change.
+ */
+typedef struct {
+    Four                volNo;          /* volume mounted */
+    Four                nExts;          /* # of extents of the volume; 0 if the entry is free */
+    int                 fd;             /* descriptor of the file of the volume */
+    EduRDsMVolHdr       hdr;            /* header page */
+    EduRDsMExtEntry     *exts;          /* extent table */
+    pthread_mutex_t     latch;          /* serializes the allocations */
+} EduRDsMVolume;
+
+/* type definition for the volumes mounted by EduRDsM_Mount()
+ * The entries are read without the latch, so an entry is filled before its
+ * nExts is set, and freed after its nExts is cleared.
+ */
+typedef struct {
+    Four                nMounted;       /* # of volumes mounted */
+    EduRDsMVolume       volumes[EDURDSM_MAXVOLUMES];
+    pthread_mutex_t     latch;          /* serializes mounting and dismounting */
+} EduRDsMVolumes;
+
+
+/* type definition for the cursor allocating the pages of a file (see EduRDsM_AllocFromCursor())
+ * The trains are reserved `runLength' at a time, contiguous in an extent,
+ * and handed out one by one without touching the extent table.
+ */
+typedef struct {
+    Four                volNo;          /* volume of the file */
+    Four                firstExtNo;     /* first extent of the segment of the file */
+    Two                 eff;            /* extent fill factor in percent */
+    Two                 sizeOfTrain;    /* # of pages of a train */
+    Four                runLength;      /* # of trains reserved at a time */
+    PageID              last;           /* train handed out last; its pageNo is NIL if none */
+    PageID              next;           /* next train reserved */
+    Four                nLeft;          /* # of trains reserved and not handed out yet */
+} EduRDsMAllocCursor;
+
+
+/*@
+ * Global Variables
+ */
+extern EduRDsMVolumes rdsmVolumes;
+
+
+/*@
+ * Function Prototypes
+ */
+/* interface function prototypes */
+Four EduRDsM_Format(char *, Four, Four, Two);
+Four EduRDsM_Mount(char *, Four *);
+Four EduRDsM_Dismount(Four);
+Four EduRDsM_ReadTrain(PageID *, char *, Two);
+Four EduRDsM_ReadTrains(PageID *, char *, Four, Two);
+Four EduRDsM_WriteTrain(char *, PageID *, Two);
+Four EduRDsM_WriteTrains(char *, PageID *, Four, Two);
+Four EduRDsM_CreateSegment(Four, Four *);
+Four EduRDsM_AllocTrains(Four, Four, PageID *, Two, Four, Two, PageID *);
+Four EduRDsM_PageIdToExtNo(PageID *, Four *);
+Four EduRDsM_ExtNoToPageId(Four, Four, PageID *);
+Four EduRDsM_GetSizeOfExt(Four, Two *);
+Four EduRDsM_GetUnique(PageID *, Unique *, Four *);
+Four EduRDsM_AllocContigTrains(Four, Four, PageID *, Two, Four, Two, PageID *, Four *);
+Four EduRDsM_OpenAllocCursor(Four, Four, PageID *, Two, Two, Four, EduRDsMAllocCursor *);
+Four EduRDsM_AllocFromCursor(EduRDsMAllocCursor *, PageID *);
+Four EduRDsM_CloseAllocCursor(EduRDsMAllocCursor *);
+
+/* internal function prototypes */
+EduRDsMVolume *edurdsm_Volume(Four);
+Four edurdsm_WriteMeta(EduRDsMVolume *, Four, Four);
+Four edurdsm_FreeRun(EduRDsMVolume *, PageID *, Four, Two);
+Boolean edurdsm_Locate(PageID *, Four, int *, off_t *);
+Four edurdsm_DiskTransfer(int, char *, size_t, off_t, Boolean);
+
+
+#endif /* _EDURDSM_H_ */
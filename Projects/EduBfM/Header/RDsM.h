@@ -51,7 +51,15 @@
 
 
 Four	RDsM_ReadTrain(PageID *, char *, Two);
+Four	RDsM_ReadTrains(PageID *, char *, Four, Two);
 Four	RDsM_WriteTrain(char *, PageID *, Two);
+Four	RDsM_WriteTrains(char *, PageID *, Four, Two);
+Four	RDsM_GetSizeOfExt(Four, Two *);
+Four	RDsM_CreateSegment(Four, Four *);
+Four	RDsM_AllocTrains(Four, Four, PageID *, Two, Four, Two, PageID *);
+Four	RDsM_PageIdToExtNo(PageID *, Four *);
+Four	RDsM_ExtNoToPageId(Four, Four, PageID *);
+Four	RDsM_GetUnique(PageID *, Unique *, Four *);
 
 
 #endif /* _RDsM_H_ */
@@ -0,0 +1,330 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Adapt.c
+ *
+ * Description :
+ *  Adaptive split of memory between the buffer pools.
+ *  The pools of PAGE_BUF and LOT_LEAF_BUF share a budget of pages. Each
+ *  pool remembers the keys of the trains it evicted last in a ghost list
+ *  covering the same amount of memory, so that the misses its ghost list
+ *  finds tell how many misses that much more memory would save. Every
+ *  BFM_ADAPT_PERIOD misses, a slice of the budget is moved to the pool
+ *  whose ghost list has clearly found more misses, by EduBfM_Resize().
+ *
+ * Exports:
+ *  Four edubfm_StartAdapt(Four)
+ *  void edubfm_StopAdapt(void)
+ *  void edubfm_AdaptEvicted(Four, BfMHashKey *)
+ *  void edubfm_AdaptMiss(Four, BfMHashKey *)
+ *  void edubfm_Adapt(void)
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * global variables
+ */
+/* adaptive split of the pools; disabled by default */
+BfMAdaptiveSplit bufAdapt = { 0, 0, { { 0 } }, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER };
+
+
+
+/*@================================
+ * edubfm_StartAdapt()
+ *================================*/
+/*
+ * Function: Four edubfm_StartAdapt(Four)
+ *
+ * Description:
+ *  Create empty ghost lists and let the pools share `budget' pages from now
+ *  on. The caller has already split the budget between the pools.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four edubfm_StartAdapt(
+    Four                budget)                 /* IN # of pages shared by the pools */
+{
+    Four                e;                      /* for error */
+    Four                type;                   /* buffer type */
+    Four                i;                      /* index */
+    BfMGhostList        *g;                     /* ghost list of a pool */
+
+
+    edubfm_StopAdapt();
+
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        g = &bufAdapt.ghosts[type];
+
+        g->nGhosts = BFM_ADAPT_GHOSTPAGES / BI_BUFSIZE(type);
+        g->next = 0;
+        g->hits = 0;
+        g->keys = (BfMHashKey*)malloc(sizeof(BfMHashKey) * g->nGhosts);
+        if (g->keys == NULL) {
+            edubfm_StopAdapt();
+            ERR(eMEMORYALLOCERR);
+        }
+        for (i = 0; i < g->nGhosts; i++)
+            SET_NILBFMHASHKEY(g->keys[i]);
+
+        e = edubfm_OpenHashCreate(&g->table, g->nGhosts);
+        if (e < eNOERROR) {
+            edubfm_StopAdapt();
+            ERR(e);
+        }
+    }
+
+    BFM_GETLATCH(&bufAdapt.latch);
+    bufAdapt.nMisses = 0;
+    bufAdapt.budget = budget;
+    BFM_RELEASELATCH(&bufAdapt.latch);
+
+    return(eNOERROR);
+
+} /* edubfm_StartAdapt() */
+
+
+
+/*@================================
+ * edubfm_StopAdapt()
+ *================================*/
+/*
+ * Function: void edubfm_StopAdapt(void)
+ *
+ * Description:
+ *  Stop the adaptive split and free the ghost lists. The pools keep their
+ *  sizes.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_StopAdapt(void)
+{
+    Four                type;                   /* buffer type */
+    BfMGhostList        *g;                     /* ghost list of a pool */
+
+
+    BFM_GETLATCH(&bufAdapt.latch);
+    bufAdapt.budget = 0;
+    BFM_RELEASELATCH(&bufAdapt.latch);
+
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        g = &bufAdapt.ghosts[type];
+
+        free(g->keys);
+        g->keys = NULL;
+        g->nGhosts = 0;
+        edubfm_OpenHashDestroy(&g->table);
+    }
+
+} /* edubfm_StopAdapt() */
+
+
+
+/*@================================
+ * edubfm_AdaptEvicted()
+ *================================*/
+/*
+ * Function: void edubfm_AdaptEvicted(Four, BfMHashKey *)
+ *
+ * Description:
+ *  Remember in the ghost list of the pool that the train having the given
+ *  key has been evicted, forgetting the oldest ghost if the list is full.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_AdaptEvicted(
+    Four                type,                   /* IN buffer type */
+    BfMHashKey          *key)                   /* IN key of the train evicted */
+{
+    BfMGhostList        *g = &bufAdapt.ghosts[type];    /* ghost list of the pool */
+    Four                slot;                   /* slot of the ghost */
+
+
+    BFM_GETLATCH(&bufAdapt.latch);
+
+    if (bufAdapt.budget > 0) {
+        slot = edubfm_OpenHashLookUp(&g->table, key);
+        if (slot != NOTFOUND_IN_HTABLE) {
+            edubfm_OpenHashDelete(&g->table, key);
+            SET_NILBFMHASHKEY(g->keys[slot]);
+        }
+
+        slot = g->next;
+        g->next = (slot + 1) % g->nGhosts;
+        if (!IS_NILBFMHASHKEY(g->keys[slot]))
+            edubfm_OpenHashDelete(&g->table, &g->keys[slot]);
+
+        g->keys[slot] = *key;
+        edubfm_OpenHashInsert(&g->table, key, slot);
+    }
+
+    BFM_RELEASELATCH(&bufAdapt.latch);
+
+} /* edubfm_AdaptEvicted() */
+
+
+
+/*@================================
+ * edubfm_AdaptMiss()
+ *================================*/
+/*
+ * Function: void edubfm_AdaptMiss(Four, BfMHashKey *)
+ *
+ * Description:
+ *  Count a miss of the pool on a train found in its ghost list, and drop
+ *  the ghost since the train is loaded again.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_AdaptMiss(
+    Four                type,                   /* IN buffer type */
+    BfMHashKey          *key)                   /* IN key of the train missed */
+{
+    BfMGhostList        *g = &bufAdapt.ghosts[type];    /* ghost list of the pool */
+    Four                slot;                   /* slot of the ghost */
+
+
+    BFM_GETLATCH(&bufAdapt.latch);
+
+    if (bufAdapt.budget > 0) {
+        slot = edubfm_OpenHashLookUp(&g->table, key);
+        if (slot != NOTFOUND_IN_HTABLE) {
+            edubfm_OpenHashDelete(&g->table, key);
+            SET_NILBFMHASHKEY(g->keys[slot]);
+            g->hits++;
+            BFM_STATS_INC(type, nGhostHits);
+        }
+    }
+
+    BFM_RELEASELATCH(&bufAdapt.latch);
+
+} /* edubfm_AdaptMiss() */
+
+
+
+/*@================================
+ * edubfm_Adapt()
+ *================================*/
+/*
+ * Function: void edubfm_Adapt(void)
+ *
+ * Description:
+ *  Decide whether to move a slice of the budget, 1/BFM_ADAPT_STEPDIV of it,
+ *  from one pool to the other, and do so with EduBfM_Resize(): the pool
+ *  given up is shrunk first, so that the pools never exceed the budget.
+ *  A pool keeps 1/BFM_ADAPT_MINDIV of the budget at least. The ghost hits
+ *  are halved, so that the decisions follow the recent misses. If another
+ *  thread is deciding, or a pool cannot be resized now, e.g. because of a
+ *  fixed train, nothing is done. The caller must hold no latch of a pool.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_Adapt(void)
+{
+    Four                hits[NUM_BUF_TYPES];    /* ghost hits of each pool */
+    Four                type;                   /* buffer type */
+    Four                from;                   /* pool giving memory */
+    Four                to;                     /* pool taking memory */
+    Four                unit;                   /* # of pages which both pools can move */
+    Four                step;                   /* # of pages moved */
+    Four                nFrom;                  /* new # of buffers of `from' */
+    Four                nTo;                    /* new # of buffers of `to' */
+
+
+    if (pthread_mutex_trylock(&bufAdapt.adaptLatch) != 0) return;
+
+    BFM_GETLATCH(&bufAdapt.latch);
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        hits[type] = bufAdapt.ghosts[type].hits;
+        bufAdapt.ghosts[type].hits /= 2;
+    }
+    unit = BI_BUFSIZE(PAGE_BUF) * BI_BUFSIZE(LOT_LEAF_BUF);
+    step = bufAdapt.budget / BFM_ADAPT_STEPDIV / unit * unit;
+    if (step < unit) step = unit;
+    BFM_RELEASELATCH(&bufAdapt.latch);
+
+    if (hits[PAGE_BUF] > hits[LOT_LEAF_BUF] + hits[LOT_LEAF_BUF] / 4 + BFM_ADAPT_MINHITS) {
+        to = PAGE_BUF;
+        from = LOT_LEAF_BUF;
+    }
+    else if (hits[LOT_LEAF_BUF] > hits[PAGE_BUF] + hits[PAGE_BUF] / 4 + BFM_ADAPT_MINHITS) {
+        to = LOT_LEAF_BUF;
+        from = PAGE_BUF;
+    }
+    else {
+        BFM_RELEASELATCH(&bufAdapt.adaptLatch);
+        return;
+    }
+
+    nFrom = BI_NBUFS(from) - step / BI_BUFSIZE(from);
+    nTo = BI_NBUFS(to) + step / BI_BUFSIZE(to);
+
+    if (bufAdapt.budget > 0 && nFrom * BI_BUFSIZE(from) >= bufAdapt.budget / BFM_ADAPT_MINDIV &&
+        nTo <= BFM_MAXNBUFS && EduBfM_Resize(from, nFrom) >= eNOERROR) {
+        if (EduBfM_Resize(to, nTo) >= eNOERROR)
+            BFM_STATS_INC(to, nSplitMoves);
+        else
+            (void)EduBfM_Resize(from, nFrom + step / BI_BUFSIZE(from));     /* take the memory back */
+    }
+
+    BFM_RELEASELATCH(&bufAdapt.adaptLatch);
+
+} /* edubfm_Adapt() */
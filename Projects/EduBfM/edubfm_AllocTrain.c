@@ -53,11 +53,14 @@
  *  Allocate a new buffer from the buffer pool.
  *
  * Exports:
- *  Four edubfm_AllocTrain(Four)
+ *  Four edubfm_AllocTrain(Four, Four, Boolean)
+ *  Four edubfm_EvictTrain(Four, Four, Boolean)
  */
 
 
 #include <errno.h>
+#include <stdlib.h> /* for free */
+#include <string.h> /* for memcpy */
 #include "EduBfM_common.h"
 #include "EduBfM_Internal.h"
 
@@ -68,7 +71,7 @@ extern CfgParams_T sm_cfgParams;
  * edubfm_AllocTrain()
  *================================*/
 /*
- * Function: Four edubfm_AllocTrain(Four)
+ * Function: Four edubfm_AllocTrain(Four, Four, Boolean)
  *
  * Description : 
  * (Following description is for original ODYSSEUS/COSMOS BfM.
@@ -85,6 +88,24 @@ extern CfgParams_T sm_cfgParams;
  *  returned.
  *  Before return the buffer, if the dirty bit of the victim is set, it 
  *  must be force out to the disk.
+ *  If the buffer pool is partitioned, the victim is searched only among the
+ *  buffers of the given partition, using the clock hand of the partition.
+ *  If a replacement policy other than the clock is selected for the pool
+ *  (see EduBfM_SetReplacementPolicy()), the victim is chosen by the policy.
+ *  Otherwise a buffer holding no train is taken from the free list of the
+ *  partition before the clock is run, and the clock gives at most
+ *  BFM_CLOCK_BUDGET second chances per call: once that many reference bits
+ *  are cleared, the next unfixed buffer is the victim, so that the time of
+ *  an allocation is bounded by the budget and the fixed buffers.
+ *  If the buffer table is laid out as BFM_LAYOUT_SOA, the same clock is run
+ *  by edubfm_ClockSweep() over the dense state arrays. Under
+ *  BFM_POLICY_CLEANFIRST the clock of edubfm_CleanFirstSweep() is run, which
+ *  prefers a clean victim to a dirty one.
+ *  The train of the victim is evicted by edubfm_EvictTrain(). If `unlatch'
+ *  is TRUE, a dirty victim is written back without the latch, and another
+ *  victim is selected if it has been fixed or updated meanwhile; the
+ *  caller must be claiming a buffer for a train (see BI_PARTEVICTING()).
+ *  The caller must hold the latch of the partition.
  *
  * Returns;
  *  1) An index of a new buffer from the buffer pool
@@ -93,42 +114,66 @@ extern CfgParams_T sm_cfgParams;
  *     some errors caused by fuction calls
  */
 Four edubfm_AllocTrain(
-    Four 	type)			/* IN type of buffer (PAGE or TRAIN) */
+    Four 	type,			/* IN type of buffer (PAGE or TRAIN) */
+    Four 	part,			/* IN partition to allocate the buffer from */
+    Boolean 	unlatch)		/* IN TRUE if the latch may be released to write back a victim */
 {
 	/* These local variables are used in the solution code. However, you don¡¯t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four 	e;			/* for error */
     Four 	victim;			/* return value */
     Four 	i;
+    Four 	first;			/* index of the first buffer of the partition */
+    Four 	n;			/* # of buffers of the partition */
+    Four 	nCleared;		/* # of reference bits cleared by the clock */
     
 
 	/* Error check whether using not supported functionality by EduBfM */
 	if(sm_cfgParams.useBulkFlush) ERR(eNOTSUPPORTED_EDUBFM);
 	
 	/* NEWCODE */
-	//1. Buffer-Replacement Algorithm.
-	Two n;
-	n = BI_NBUFS(type);
-	victim = BI_NEXTVICTIM(type);
-	for(i = 0; i < 2*n; i++){	//take 2 passes.
-		if(BI_FIXED(type, victim) != 0){	//skip if element is FIXED.
-			victim = (victim + 1) % n;
-			continue;
+	do{
+		//1. Buffer-Replacement Algorithm.
+		if(BI_PARTPOLICYSTATE(type, part) != NULL){	//a policy other than the clock is used.
+			victim = edubfm_PolicyVictim(type, part);
+			if(victim == eNOUNFIXEDBUF_BFM) BFM_STATS_INC(type, nNoUnfixedBuf);
+			if(victim < eNOERROR) ERR(victim);
 		}
-		if((BI_BITS(type, victim) & REFER) == 0){	//if REFER == 0.
-			if((BI_BITS(type, victim) & DIRTY) == DIRTY){
-				edubfm_FlushTrain(&(BI_KEY(type, victim)), type);	//flush the original train.
-			}
-			bufInfo[type].bufTable[victim].bits = ALL_0;	//reset bits.
-			bufInfo[type].nextVictim = ((victim + 1) % n);	//set new nextvictim.
-			edubfm_Delete(&(BI_KEY(type, victim)), type);
-			break;
+		else{
+			victim = edubfm_PopFreeFrame(type, part);	//a buffer holding no train needs no clock.
+			if(victim != NIL) BFM_STATS_INC(type, nFreeAllocs);
 		}
-		else{	//if REFER != 0 -> set REFER to 0 and continue.
-			bufInfo[type].bufTable[victim].bits = bufInfo[type].bufTable[victim].bits & ~(REFER);
+		if(victim == NIL){
+			first = BI_PARTFIRSTBUF(type, part);
+			n = BI_PARTNBUFS(type, part);
+			victim = BI_PARTNEXTVICTIM(type, part);
+			nCleared = 0;
+			if(BI_POLICY(type) == BFM_POLICY_CLEANFIRST)	//the clock giving dirty buffers another chance.
+				i = edubfm_CleanFirstSweep(type, first, n, &victim);
+			else if(BI_LAYOUT(type) == BFM_LAYOUT_SOA)	//the same clock, a vector of buffers at a time.
+				i = edubfm_ClockSweep(type, first, n, &victim);
+			else for(i = 0; i < 2*n; i++){	//take 2 passes.
+				if(BI_FIXED(type, victim) == 0){	//skip if element is FIXED.
+					if((BI_BITS(type, victim) & REFER) == 0) break;	//if REFER == 0.
+					if(nCleared >= BFM_CLOCK_BUDGET) break;	//bound the sweep: the second chances are used up.
+					BI_BITS(type, victim) &= ~(REFER);	//if REFER != 0 -> set REFER to 0 and continue.
+					nCleared++;
+				}
+				victim = first + (victim - first + 1) % n;
+			}
+			if(i == (2*n)){
+				BFM_STATS_ADD(type, nScanned, i);
+				BFM_STATS_INC(type, nNoUnfixedBuf);
+				ERR(eNOUNFIXEDBUF_BFM);
+			}
+			BFM_STATS_ADD(type, nScanned, i + 1);
+			BI_PARTNEXTVICTIM(type, part) = first + (victim - first + 1) % n;	//set new nextvictim.
 		}
-		victim = (victim + 1) % n;
-	}
-	if(i == (2*n)) ERR(eNOUNFIXEDBUF_BFM);
+
+		//2. Evict the train of the victim.
+		e = edubfm_EvictTrain(type, victim, unlatch);
+		if(e < eNOERROR) ERR(e);
+	}while(e == BFM_VICTIM_KEPT);	//the victim has been fixed or updated during its write-back.
+	BFM_STATS_INC(type, nAllocs);
 	/* ENDOFNEWCODE */
 
 
@@ -136,3 +181,102 @@ Four edubfm_AllocTrain(
     return( victim );
     
 }  /* edubfm_AllocTrain */
+
+
+
+/*@================================
+ * edubfm_EvictTrain()
+ *================================*/
+/*
+ * Function: Four edubfm_EvictTrain(Four, Four, Boolean)
+ *
+ * Description :
+ *  Evict the train held by an unfixed buffer, which is to be reused. A
+ *  dirty train is written back first. The clean copy is handed to the
+ *  victim and secondary caches and its key to the adaptive split, the
+ *  train is removed from the hash table and the bits are reset.
+ *  If `unlatch' is TRUE, a dirty train is written back from a copy:
+ *  it is copied, its buffer is fixed and marked CLEANING, and the latch of
+ *  the partition is released during the write, while BI_PARTEVICTING() is
+ *  set. If the train has been fixed or updated meanwhile, or the write
+ *  fails, it is kept (see edubfm_PolicyKeep()). Otherwise, or if no copy
+ *  can be allocated, the train is written back holding the latch.
+ *  The caller must hold the latch of the partition.
+ *
+ * Returns;
+ *  error code, or BFM_VICTIM_KEPT if the train is kept
+ *    some errors caused by fuction calls
+ */
+Four edubfm_EvictTrain(
+    Four 	type,			/* IN type of buffer (PAGE or TRAIN) */
+    Four 	victim,			/* IN buffer to be reused */
+    Boolean 	unlatch)		/* IN TRUE if the latch may be released to write back the train */
+{
+    Four 	e;			/* for error */
+    Four 	part;			/* partition of the victim */
+    pthread_mutex_t *latch;		/* latch of the partition */
+    char 	*copy;			/* copy of the train written back */
+    BfMHashKey 	key;			/* key of the train written back */
+
+
+	/* NEWCODE */
+	if((BI_BITS(type, victim) & DIRTY) == DIRTY){
+		copy = unlatch ? edubfm_AllocIOBuffer(BI_BUFSIZE(type)) : NULL;
+		if(copy == NULL){
+			e = edubfm_FlushTrain(&(BI_KEY(type, victim)), type);	//flush the original train.
+			if(e < eNOERROR) ERR(e);
+		}
+		else{
+			//write back a copy, so that the partition is not latched during the write.
+			part = BI_PARTITIONOFBUF(type, victim);
+			latch = BI_PARTLATCH(type, part);
+			key = BI_KEY(type, victim);
+			memcpy(copy, BI_BUFFER(type, victim), PAGESIZE * BI_BUFSIZE(type));
+			BI_FIXED(type, victim)++;
+			BI_BITS(type, victim) |= CLEANING;
+			BI_PARTEVICTING(type, part) = TRUE;	//no train is claimed meanwhile.
+			BFM_RELEASELATCH(latch);
+
+			e = edubfm_DiskWrite(copy, (TrainID*)&key, 1, type);
+
+			BFM_GETLATCH(latch);
+			BI_PARTEVICTING(type, part) = FALSE;
+			BI_FIXED(type, victim)--;
+			if(e >= eNOERROR && (BI_BITS(type, victim) & CLEANING)){	//the copy written is the train as it is now.
+				BI_BITS(type, victim) &= ~DIRTY;
+				edubfm_MarkClean(type, victim);
+			}
+			BI_BITS(type, victim) &= ~CLEANING;
+			pthread_cond_broadcast(BI_PARTIODONE(type, part));
+			free(copy);
+
+			if(e >= eNOERROR) BFM_STATS_INC(type, nWrites);
+			if(e < eNOERROR || BI_FIXED(type, victim) > 0 || (BI_BITS(type, victim) & DIRTY)){
+				(void)edubfm_PolicyKeep(type, part, victim);
+				if(e < eNOERROR) ERR(e);
+				return( BFM_VICTIM_KEPT );
+			}
+		}
+		BFM_STATS_INC(type, nDirtyEvictions);
+		edubfm_WakeCleaner(type);	//the cleaner is behind the clock hand.
+	}
+	if(BI_BITS(type, victim) & PREFETCHED)
+		edubfm_ReadAheadWasted(type);	//read ahead too far.
+	BI_BITS(type, victim) = ALL_0;	//reset bits.
+	if(!IS_NILBFMHASHKEY(BI_KEY(type, victim))){
+		if(bufVictimCache[type].budget > 0)
+			edubfm_VictimPut(type, &(BI_KEY(type, victim)), BI_BUFFER(type, victim));	//the train is clean now; keep a compressed copy.
+		if(bufSecondaryCache[type].nSlots > 0)
+			edubfm_SecondaryPut(type, &(BI_KEY(type, victim)), BI_BUFFER(type, victim));	//and a copy on the local disk.
+		e = edubfm_Delete(&(BI_KEY(type, victim)), type);
+		if(e < eNOERROR) ERR(e);
+		BFM_STATS_INC(type, nEvictions);
+		if(bufAdapt.budget > 0)
+			edubfm_AdaptEvicted(type, &(BI_KEY(type, victim)));	//a larger pool would have kept it.
+	}
+	/* ENDOFNEWCODE */
+
+
+    return( eNOERROR );
+
+}  /* edubfm_EvictTrain */
@@ -0,0 +1,542 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Arena.c
+ *
+ * Description :
+ *  Memory holding the buffers of a pool.
+ *  The storage system allocates the buffers of a pool as one plain block of
+ *  base pages, so that a large pool takes a TLB miss on most accesses and,
+ *  on a NUMA host, has its buffers wherever they were first touched. An
+ *  arena replaces the block by a mapping of its own, backed by huge pages
+ *  when the system has them and placed on the NUMA nodes with mbind(2).
+ *  Huge pages are taken from the hugetlb pool, 1 GB pages first for a pool
+ *  of 1 GB or more, and otherwise requested as transparent huge pages.
+ *  mbind(2) is called through syscall(2), so that libnuma is not needed.
+ *  An arena may also reserve room for more buffers than the storage system
+ *  allocated, so that the pool can grow in place.
+ *
+ * Exports:
+ *  Four edubfm_AllocArena(Four, Four, Four)
+ *  Four edubfm_FreeArena(Four)
+ *  Four edubfm_ArenaCapacity(Four)
+ *  Four edubfm_ReserveArena(Four, Boolean)
+ *  void edubfm_TrimArena(Four)
+ *  void edubfm_BindArena(Four)
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include <string.h> /* for memcpy */
+#include <unistd.h> /* for syscall & access */
+#include <sys/mman.h> /* for mmap, munmap & madvise */
+#include <sys/syscall.h> /* for SYS_mbind */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * macro definitions
+ */
+/* memory policies of mbind(2), as in <numaif.h> */
+#ifndef MPOL_BIND
+#define MPOL_BIND               2
+#define MPOL_INTERLEAVE         3
+#define MPOL_MF_MOVE            (1 << 1)
+#endif
+
+/* max # of NUMA nodes handled */
+#define BFM_ARENA_MAXNODES      64
+
+/* sizes of the huge pages */
+#define BFM_ARENA_2MB           ((size_t)2 << 20)
+#define BFM_ARENA_1GB           ((size_t)1 << 30)
+
+/* Macro: BFM_ARENA_ROUNDUP(x, a)
+ * Description: round up `x' to a multiple of `a', a power of 2
+ */
+#define BFM_ARENA_ROUNDUP(x, a) (((x) + (a) - 1) & ~((a) - 1))
+
+
+
+/*@
+ * global variables
+ */
+/* arena of each buffer pool; the buffers of the storage system are used by default */
+BfMArena bufArena[NUM_BUF_TYPES];
+
+
+
+/*@
+ * internal function prototypes
+ */
+static Four edubfm_NumNodes(void);
+static void edubfm_Mbind(char *, size_t, Four, UEight);
+
+
+
+/*@================================
+ * edubfm_AllocArena()
+ *================================*/
+/*
+ * Function: Four edubfm_AllocArena(Four, Four, Four)
+ *
+ * Description:
+ *  Map an arena having room for `capacity' buffers of the pool of the given
+ *  type according to `flags' (BFM_ALLOC_xxx), and make the pool use it.
+ *  If huge pages are requested but none can be had, base pages are used.
+ *  The trains in the pool are copied into the arena, so none may be fixed.
+ *  If `capacity' exceeds the number of buffers allocated by the storage
+ *  system, the arena also gets a buffer table and a hash table of its own,
+ *  and its mapping is only reserved, so that the pool can be grown by
+ *  EduBfM_Resize() without moving the buffers; hugetlb pages, which are
+ *  taken from the pool of the system when mapped, are not used then. The
+ *  caller rebuilds the hash tables. The pool must use the buffers of the
+ *  storage system.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR - the arena cannot be mapped
+ */
+Four edubfm_AllocArena(
+    Four                type,                   /* IN buffer type */
+    Four                flags,                  /* IN BFM_ALLOC_xxx */
+    Four                capacity)               /* IN # of buffers to have room for */
+{
+    BfMArena            *arena = &bufArena[type];       /* arena of the pool */
+    size_t              need;                   /* size of the buffers */
+    size_t              size;                   /* size of the mapping */
+    char                *base = MAP_FAILED;     /* start of the mapping */
+    char                *buffers;               /* start of the buffers */
+    Four                nNodes;                 /* # of NUMA nodes */
+    Boolean             growable;               /* TRUE if the arena has its own tables */
+    Four                mapFlags;               /* flags of mmap(2) for base pages */
+    BufferTable         *table = NULL;          /* buffer table of the arena */
+    Two                 *hashTable = NULL;      /* hash table of the arena */
+    Four                i;                      /* index */
+
+
+    growable = (capacity > edubfm_ArenaCapacity(type));
+    need = (size_t)capacity * BI_BUFSIZE(type) * PAGESIZE;
+    mapFlags = MAP_PRIVATE | MAP_ANONYMOUS | (growable ? MAP_NORESERVE : 0);
+
+    if (growable) {
+        table = (BufferTable*)malloc(sizeof(BufferTable) * capacity);
+        hashTable = (Two*)malloc(sizeof(Two) * HASHTABLESIZE_TO_NBUFS(capacity));
+        if (table == NULL || hashTable == NULL) {
+            free(table);
+            free(hashTable);
+            ERR(eMEMORYALLOCERR);
+        }
+    }
+
+    if (flags & BFM_ALLOC_HUGEPAGE) {
+#ifdef MAP_HUGETLB
+#ifdef MAP_HUGE_1GB
+        if (!growable && need >= BFM_ARENA_1GB) {
+            size = BFM_ARENA_ROUNDUP(need, BFM_ARENA_1GB);
+            base = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_1GB, -1, 0);
+            arena->kind = BFM_ARENA_HUGETLB1G;
+            arena->pageSize = BFM_ARENA_1GB;
+        }
+#endif
+        if (!growable && base == MAP_FAILED) {
+            size = BFM_ARENA_ROUNDUP(need, BFM_ARENA_2MB);
+            base = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            arena->kind = BFM_ARENA_HUGETLB2M;
+            arena->pageSize = BFM_ARENA_2MB;
+        }
+#endif
+        if (base == MAP_FAILED) {
+            /* transparent huge pages need a mapping aligned on 2 MB */
+            size = BFM_ARENA_ROUNDUP(need, BFM_ARENA_2MB) + BFM_ARENA_2MB;
+            base = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, mapFlags, -1, 0);
+            arena->kind = BFM_ARENA_THP;
+            arena->pageSize = BFM_ARENA_2MB;
+        }
+    }
+    else {
+        size = BFM_ARENA_ROUNDUP(need, (size_t)PAGESIZE);
+        base = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, mapFlags, -1, 0);
+        arena->kind = BFM_ARENA_4K;
+        arena->pageSize = PAGESIZE;
+    }
+    if (base == MAP_FAILED) {
+        arena->kind = BFM_ARENA_DEFAULT;
+        free(table);
+        free(hashTable);
+        ERR(eMEMORYALLOCERR);
+    }
+
+    buffers = base;
+    if (arena->kind == BFM_ARENA_THP) {
+        buffers = (char*)BFM_ARENA_ROUNDUP((size_t)base, BFM_ARENA_2MB);
+#ifdef MADV_HUGEPAGE
+        (void)madvise(buffers, BFM_ARENA_ROUNDUP(need, BFM_ARENA_2MB), MADV_HUGEPAGE);
+#else
+        arena->kind = BFM_ARENA_4K;
+        arena->pageSize = PAGESIZE;
+#endif
+    }
+
+    /* the pages are placed when first touched, so the policy is set before */
+    nNodes = edubfm_NumNodes();
+    if ((flags & BFM_ALLOC_INTERLEAVE) && nNodes > 1)
+        edubfm_Mbind(buffers, need, MPOL_INTERLEAVE, (nNodes >= 64) ? ~0UL : (1UL << nNodes) - 1);
+
+    /* copy the trains in the pool */
+    for (i = 0; i < BI_NBUFS(type); i++)
+        if (!IS_NILBFMHASHKEY(BI_KEY(type, i)))
+            memcpy(buffers + (size_t)PAGESIZE * BI_BUFSIZE(type) * i, BI_BUFFER(type, i),
+                   (size_t)PAGESIZE * BI_BUFSIZE(type));
+
+    if (growable) {
+        memcpy(table, bufInfo[type].bufTable, sizeof(BufferTable) * BI_NBUFS(type));
+        for (i = BI_NBUFS(type); i < capacity; i++) {
+            SET_NILBFMHASHKEY(table[i].key);
+            table[i].fixed = 0;
+            table[i].bits = ALL_0;
+            table[i].nextHashEntry = NIL;
+        }
+
+        arena->savedTable = bufInfo[type].bufTable;
+        arena->savedHashTable = BI_HASHTABLE(type);
+        bufInfo[type].bufTable = table;
+        BI_HASHTABLE(type) = hashTable;
+    }
+
+    arena->flags = flags;
+    arena->capacity = capacity;
+    arena->saved = BI_BUFFERPOOL(type);
+    arena->base = base;
+    arena->size = size;
+    BI_BUFFERPOOL(type) = buffers;
+
+    return(eNOERROR);
+
+} /* edubfm_AllocArena() */
+
+
+
+/*@================================
+ * edubfm_FreeArena()
+ *================================*/
+/*
+ * Function: Four edubfm_FreeArena(Four)
+ *
+ * Description:
+ *  Give the buffers of the storage system back to the pool of the given
+ *  type and unmap its arena, if any. The trains in the pool are copied
+ *  back, so none may be fixed. A pool grown beyond the buffers of the
+ *  storage system is cut to them; the buffers cut must hold no train.
+ *  The caller rebuilds the hash tables.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_FreeArena(
+    Four                type)                   /* IN buffer type */
+{
+    BfMArena            *arena = &bufArena[type];       /* arena of the pool */
+    Four                i;                      /* index */
+
+
+    if (arena->kind == BFM_ARENA_DEFAULT) return(eNOERROR);
+
+    if (BI_NBUFS(type) > arena->origNBufs) BI_NBUFS(type) = arena->origNBufs;
+
+    for (i = 0; i < BI_NBUFS(type); i++)
+        if (!IS_NILBFMHASHKEY(BI_KEY(type, i)))
+            memcpy(arena->saved + (size_t)PAGESIZE * BI_BUFSIZE(type) * i, BI_BUFFER(type, i),
+                   (size_t)PAGESIZE * BI_BUFSIZE(type));
+
+    if (arena->savedTable != NULL) {
+        memcpy(arena->savedTable, bufInfo[type].bufTable, sizeof(BufferTable) * BI_NBUFS(type));
+        free(bufInfo[type].bufTable);
+        free(BI_HASHTABLE(type));
+        bufInfo[type].bufTable = arena->savedTable;
+        BI_HASHTABLE(type) = arena->savedHashTable;
+    }
+
+    BI_BUFFERPOOL(type) = arena->saved;
+    munmap(arena->base, arena->size);
+
+    arena->flags = 0;
+    arena->kind = BFM_ARENA_DEFAULT;
+    arena->capacity = 0;
+    arena->saved = arena->base = NULL;
+    arena->keep = FALSE;
+    arena->savedTable = NULL;
+    arena->savedHashTable = NULL;
+    arena->size = 0;
+
+    return(eNOERROR);
+
+} /* edubfm_FreeArena() */
+
+
+
+/*@================================
+ * edubfm_ArenaCapacity()
+ *================================*/
+/*
+ * Function: Four edubfm_ArenaCapacity(Four)
+ *
+ * Description:
+ *  Return the number of buffers which the memory of the pool of the given
+ *  type has room for. The number of buffers allocated by the storage
+ *  system is remembered on the first call, which must be made before the
+ *  pool is resized.
+ *
+ * Returns:
+ *  # of buffers
+ */
+Four edubfm_ArenaCapacity(
+    Four                type)                   /* IN buffer type */
+{
+    BfMArena            *arena = &bufArena[type];       /* arena of the pool */
+
+
+    if (arena->origNBufs == 0) arena->origNBufs = BI_NBUFS(type);
+
+    return((arena->kind == BFM_ARENA_DEFAULT) ? arena->origNBufs : arena->capacity);
+
+} /* edubfm_ArenaCapacity() */
+
+
+
+/*@================================
+ * edubfm_ReserveArena()
+ *================================*/
+/*
+ * Function: Four edubfm_ReserveArena(Four, Boolean)
+ *
+ * Description:
+ *  Move the pool of the given type, keeping its trains, to an arena having
+ *  room for BFM_MAXNBUFS buffers unless it has one already, so that it can
+ *  grow in place. The arena is allocated with the flags of the current one
+ *  and the hash tables are rebuilt. If `keep' is TRUE, EduBfM_Resize()
+ *  keeps the arena also when the pool shrinks back to the buffers of the
+ *  storage system. No train may be fixed, and the caller holds the latches
+ *  of the pool.
+ *
+ * Returns:
+ *  error code
+ *    eFLUSHFIXEDBUF_BFM - some train in the pool is fixed
+ *    eMEMORYALLOCERR - the arena cannot be mapped; the pool is left on the
+ *                      buffers of the storage system
+ *    some errors caused by function calls
+ */
+Four edubfm_ReserveArena(
+    Four                type,                   /* IN buffer type */
+    Boolean             keep)                   /* IN TRUE to keep the arena */
+{
+    Four                e;                      /* for error */
+    Four                flags;                  /* BFM_ALLOC_xxx of the pool */
+    Four                i;                      /* index */
+
+
+    if (edubfm_ArenaCapacity(type) < BFM_MAXNBUFS) {
+        for (i = 0; i < BI_NBUFS(type); i++)
+            if (BI_FIXED(type, i) > 0) ERR(eFLUSHFIXEDBUF_BFM);
+
+        flags = bufArena[type].flags;
+        e = edubfm_FreeArena(type);
+        if (e >= eNOERROR) e = edubfm_AllocArena(type, flags, BFM_MAXNBUFS);
+        if (e < eNOERROR) ERR(e);
+
+        e = edubfm_ResizePartitions(type, BI_NBUFS(type));
+        if (e < eNOERROR) ERR(e);
+    }
+
+    bufArena[type].keep = keep;
+
+    return(eNOERROR);
+
+} /* edubfm_ReserveArena() */
+
+
+
+/*@================================
+ * edubfm_TrimArena()
+ *================================*/
+/*
+ * Function: void edubfm_TrimArena(Four)
+ *
+ * Description:
+ *  Give the pages backing the buffers beyond the last buffer of the pool of
+ *  the given type back to the system, if the pool uses an arena. The pages
+ *  read as zeros when the pool grows again.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_TrimArena(
+    Four                type)                   /* IN buffer type */
+{
+    BfMArena            *arena = &bufArena[type];       /* arena of the pool */
+    size_t              start;                  /* start of the buffers given back */
+    size_t              end;                    /* end of the buffers given back */
+
+
+    if (arena->kind == BFM_ARENA_DEFAULT) return;
+
+    start = BFM_ARENA_ROUNDUP((size_t)BI_BUFFER(type, BI_NBUFS(type)), arena->pageSize);
+    end = (size_t)BI_BUFFER(type, arena->capacity) & ~(arena->pageSize - 1);
+    if (start >= end) return;
+
+    (void)madvise((char*)start, end - start, MADV_DONTNEED);
+
+} /* edubfm_TrimArena() */
+
+
+
+/*@================================
+ * edubfm_BindArena()
+ *================================*/
+/*
+ * Function: void edubfm_BindArena(Four)
+ *
+ * Description:
+ *  If the arena of the pool of the given type is to be bound by partition,
+ *  bind the buffers of partition p to NUMA node p % #nodes, moving the
+ *  pages already touched. The bounds of a partition are rounded inwards to
+ *  the pages backing the arena, so a page shared by two partitions keeps
+ *  the policy it had. Binding is only a hint and its failures are ignored.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_BindArena(
+    Four                type)                   /* IN buffer type */
+{
+    BfMArena            *arena = &bufArena[type];       /* arena of the pool */
+    Four                p;                      /* partition number */
+    Four                nNodes;                 /* # of NUMA nodes */
+    size_t              start;                  /* start of the buffers of a partition */
+    size_t              end;                    /* end of the buffers of a partition */
+
+
+    if (arena->kind == BFM_ARENA_DEFAULT || (arena->flags & BFM_ALLOC_BINDPARTITION) == 0) return;
+    if (!BI_PARTITIONED(type)) return;
+
+    nNodes = edubfm_NumNodes();
+    if (nNodes < 2) return;
+
+    for (p = 0; p < BI_NPARTITIONS(type); p++) {
+        start = (size_t)BI_BUFFER(type, BI_PARTFIRSTBUF(type, p));
+        end = (size_t)BI_BUFFER(type, BI_PARTFIRSTBUF(type, p) + BI_PARTNBUFS(type, p));
+
+        start = BFM_ARENA_ROUNDUP(start, arena->pageSize);
+        end &= ~(arena->pageSize - 1);
+        if (start >= end) continue;
+
+        edubfm_Mbind((char*)start, end - start, MPOL_BIND, 1UL << (p % nNodes % BFM_ARENA_MAXNODES));
+    }
+
+} /* edubfm_BindArena() */
+
+
+
+/*@================================
+ * edubfm_NumNodes()
+ *================================*/
+/*
+ * Function: static Four edubfm_NumNodes(void)
+ *
+ * Description:
+ *  Count the NUMA nodes of the host from /sys/devices/system/node.
+ *
+ * Returns:
+ *  # of NUMA nodes (>= 1)
+ */
+static Four edubfm_NumNodes(void)
+{
+    Four                n;                      /* # of nodes */
+    char                path[64];               /* directory of a node */
+
+
+    for (n = 0; n < BFM_ARENA_MAXNODES; n++) {
+        sprintf(path, "/sys/devices/system/node/node%ld", (long)n);
+        if (access(path, F_OK) != 0) break;
+    }
+
+    return((n == 0) ? 1 : n);
+
+} /* edubfm_NumNodes() */
+
+
+
+/*@================================
+ * edubfm_Mbind()
+ *================================*/
+/*
+ * Function: static void edubfm_Mbind(char *, size_t, Four, UEight)
+ *
+ * Description:
+ *  Set the memory policy of a range of the arena, ignoring failures.
+ *
+ * Returns:
+ *  None
+ */
+static void edubfm_Mbind(
+    char                *addr,                  /* IN start of the range */
+    size_t              len,                    /* IN length of the range */
+    Four                mode,                   /* IN MPOL_xxx */
+    UEight              nodes)                  /* IN mask of the nodes */
+{
+#ifdef SYS_mbind
+    (void)syscall(SYS_mbind, addr, len, mode, &nodes, (unsigned long)BFM_ARENA_MAXNODES + 1,
+                  (mode == MPOL_BIND) ? MPOL_MF_MOVE : 0);
+#endif
+
+} /* edubfm_Mbind() */
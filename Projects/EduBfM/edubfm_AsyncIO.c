@@ -0,0 +1,413 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_AsyncIO.c
+ *
+ * Description :
+ *  Asynchronous I/O engine of the buffer manager.
+ *  Read and write requests are submitted to an io_uring, so that many of
+ *  them are in flight at once, or queued and executed by a pool of worker
+ *  threads, and the caller goes on while its trains are transferred.
+ *  A request goes to the io_uring when its trains can be transferred by
+ *  one positional read or write (see edubfm_DiskLocate()); the others, and
+ *  all requests if the kernel has no io_uring, go to the workers. The
+ *  workers run their transfers at once, except those passed to RDsM,
+ *  which take edubfm_ioLatch (see edubfm_DiskRead()). If no worker is
+ *  running, a request is executed at once by the caller.
+ *
+ * Exports:
+ *  Four edubfm_StartIOEngine(Four)
+ *  Four edubfm_StopIOEngine(void)
+ *  Four edubfm_SubmitIO(BfMIOHandle *)
+ *  Four edubfm_WaitIO(BfMIOHandle *)
+ *  void edubfm_CompleteIO(BfMIOHandle *, Four)
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * global variables
+ */
+/* the asynchronous I/O engine; not running by default */
+BfMIOEngine edubfm_ioEngine = { 0, NULL, FALSE, NULL, NULL, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+
+
+/*@
+ * internal function prototypes
+ */
+static void *edubfm_IOWorkerMain(void *);
+static void edubfm_DoIO(BfMIOHandle *);
+
+
+
+/*@================================
+ * edubfm_StartIOEngine()
+ *================================*/
+/*
+ * Function: Four edubfm_StartIOEngine(Four)
+ *
+ * Description:
+ *  Start `nWorkers' worker threads. Running workers are stopped first.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR - the workers cannot be created
+ */
+Four edubfm_StartIOEngine(
+    Four                nWorkers)               /* IN # of worker threads */
+{
+    Four                e;                      /* for error */
+    Four                i;                      /* index */
+    BfMIOEngine         *eng = &edubfm_ioEngine;/* the engine */
+
+
+    e = edubfm_StopIOEngine();
+    if (e < eNOERROR) ERR(e);
+
+    eng->workers = (pthread_t*)malloc(sizeof(pthread_t) * nWorkers);
+    if (eng->workers == NULL) ERR(eMEMORYALLOCERR);
+
+    eng->stop = FALSE;
+    for (i = 0; i < nWorkers; i++) {
+        if (pthread_create(&eng->workers[i], NULL, edubfm_IOWorkerMain, NULL) != 0) {
+            eng->nWorkers = i;
+            edubfm_StopIOEngine();
+            ERR(eMEMORYALLOCERR);
+        }
+    }
+
+    BFM_GETLATCH(&eng->latch);
+    eng->nWorkers = nWorkers;
+    BFM_RELEASELATCH(&eng->latch);
+
+    /* without io_uring, the workers execute every request */
+    (void)edubfm_StartIOUring(BFM_IOURING_DEPTH);
+
+    return(eNOERROR);
+
+} /* edubfm_StartIOEngine() */
+
+
+
+/*@================================
+ * edubfm_StopIOEngine()
+ *================================*/
+/*
+ * Function: Four edubfm_StopIOEngine(void)
+ *
+ * Description:
+ *  Stop the worker threads after the queued requests are completed, and
+ *  the io_uring after the requests in flight are.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_StopIOEngine(void)
+{
+    Four                i;                      /* index */
+    BfMIOEngine         *eng = &edubfm_ioEngine;/* the engine */
+
+
+    if (eng->workers == NULL) return(eNOERROR);
+
+    edubfm_StopIOUring();
+
+    BFM_GETLATCH(&eng->latch);
+    eng->stop = TRUE;
+    pthread_cond_broadcast(&eng->wakeup);
+    BFM_RELEASELATCH(&eng->latch);
+
+    for (i = 0; i < eng->nWorkers; i++)
+        pthread_join(eng->workers[i], NULL);
+
+    BFM_GETLATCH(&eng->latch);
+    eng->nWorkers = 0;
+    eng->stop = FALSE;
+    BFM_RELEASELATCH(&eng->latch);
+
+    free(eng->workers);
+    eng->workers = NULL;
+
+    return(eNOERROR);
+
+} /* edubfm_StopIOEngine() */
+
+
+
+/*@================================
+ * edubfm_SubmitIO()
+ *================================*/
+/*
+ * Function: Four edubfm_SubmitIO(BfMIOHandle *)
+ *
+ * Description:
+ *  Queue a request filled in `handle'. The status of the handle is
+ *  BFM_IO_PENDING until the request completes. A read request is for a
+ *  buffer which has been allocated to the train, is fixed, and has the
+ *  READING bit set; a write request is for a fixed buffer, or for a copy
+ *  of `nTrains' trains contiguous on the disk. A request of
+ *  edubfm_ReadTrains() reads such a run into a buffer of its own.
+ *  The caller must not hold the latch of the partition of the request.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_SubmitIO(
+    BfMIOHandle         *handle)                /* INOUT request to queue */
+{
+    BfMIOEngine         *eng = &edubfm_ioEngine;/* the engine */
+
+
+    handle->status = BFM_IO_PENDING;
+    handle->next = NULL;
+
+    if (edubfm_SubmitIOUring(handle)) return(eNOERROR);
+
+    BFM_GETLATCH(&eng->latch);
+
+    if (eng->nWorkers == 0 || eng->stop) {
+        BFM_RELEASELATCH(&eng->latch);
+        edubfm_DoIO(handle);
+        return(eNOERROR);
+    }
+
+    if (eng->tail == NULL) eng->head = handle;
+    else eng->tail->next = handle;
+    eng->tail = handle;
+
+    pthread_cond_signal(&eng->wakeup);
+    BFM_RELEASELATCH(&eng->latch);
+
+    return(eNOERROR);
+
+} /* edubfm_SubmitIO() */
+
+
+
+/*@================================
+ * edubfm_WaitIO()
+ *================================*/
+/*
+ * Function: Four edubfm_WaitIO(BfMIOHandle *)
+ *
+ * Description:
+ *  Wait until the request of `handle' completes.
+ *  The caller must not hold the latch of the partition of the request.
+ *
+ * Returns:
+ *  the status of the request (error code)
+ */
+Four edubfm_WaitIO(
+    BfMIOHandle         *handle)                /* IN request to wait for */
+{
+    pthread_mutex_t     *latch;                 /* latch of the partition */
+
+
+    latch = BI_PARTLATCH(handle->type, handle->part);
+
+    BFM_GETLATCH(latch);
+    while (handle->status == BFM_IO_PENDING)
+        pthread_cond_wait(BI_PARTIODONE(handle->type, handle->part), latch);
+    BFM_RELEASELATCH(latch);
+
+    return(handle->status);
+
+} /* edubfm_WaitIO() */
+
+
+
+/*@================================
+ * edubfm_IOWorkerMain()
+ *================================*/
+/*
+ * Function: static void *edubfm_IOWorkerMain(void *)
+ *
+ * Description:
+ *  Body of a worker thread: execute the queued requests in FIFO order
+ *  until the engine is stopped and the queue is empty.
+ *
+ * Returns:
+ *  NULL
+ */
+static void *edubfm_IOWorkerMain(
+    void                *arg)                   /* IN not used */
+{
+    BfMIOEngine         *eng = &edubfm_ioEngine;/* the engine */
+    BfMIOHandle         *handle;                /* request to execute */
+
+
+    (void)arg;
+
+    for (;;) {
+        BFM_GETLATCH(&eng->latch);
+        while (eng->head == NULL && !eng->stop)
+            pthread_cond_wait(&eng->wakeup, &eng->latch);
+
+        handle = eng->head;
+        if (handle == NULL) {
+            BFM_RELEASELATCH(&eng->latch);
+            break;
+        }
+        eng->head = handle->next;
+        if (eng->head == NULL) eng->tail = NULL;
+        BFM_RELEASELATCH(&eng->latch);
+
+        edubfm_DoIO(handle);
+    }
+
+    return(NULL);
+
+} /* edubfm_IOWorkerMain() */
+
+
+
+/*@================================
+ * edubfm_DoIO()
+ *================================*/
+/*
+ * Function: static void edubfm_DoIO(BfMIOHandle *)
+ *
+ * Description:
+ *  Execute a request and complete it by edubfm_CompleteIO().
+ *
+ * Returns:
+ *  None
+ */
+static void edubfm_DoIO(
+    BfMIOHandle         *handle)                /* INOUT request to execute */
+{
+    Four                e;                      /* for error */
+    Four                type = handle->type;    /* buffer type */
+
+
+    if (handle->op == BFM_IO_READ || handle->op == BFM_IO_PREFETCH)
+        e = edubfm_ReadTrain(&handle->trainId, handle->buffer, type);
+    else if (handle->op == BFM_IO_READRUN) {
+        e = edubfm_DiskRead(&handle->trainId, handle->buffer, handle->nTrains, type);
+        if (e >= eNOERROR) BFM_STATS_ADD(type, nReads, handle->nTrains);
+    }
+    else {
+        e = edubfm_DiskWrite(handle->buffer, &handle->trainId, handle->nTrains, type);
+        if (e >= eNOERROR) {
+            BFM_STATS_ADD(type, nWrites, handle->nTrains);
+            BFM_STATS_ADD(type, nWritesSaved, handle->nTrains - 1);
+        }
+    }
+
+    edubfm_CompleteIO(handle, e);
+
+} /* edubfm_DoIO() */
+
+
+
+/*@================================
+ * edubfm_CompleteIO()
+ *================================*/
+/*
+ * Function: void edubfm_CompleteIO(BfMIOHandle *, Four)
+ *
+ * Description:
+ *  Complete a request whose transfer has ended with `e', under the latch
+ *  of its partition. The read of a train is ended by edubfm_EndRead(),
+ *  and the latency of a miss of EduBfM_GetTrainAsync() is counted once
+ *  its read succeeds. The handle is not
+ *  accessed after it is completed, since its owner may reuse it at once.
+ *  A read ahead of a scan has no owner: its buffer is unfixed when the read
+ *  completes, the read-ahead is told the train following it, and the
+ *  handle is freed.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_CompleteIO(
+    BfMIOHandle         *handle,                /* INOUT request completed */
+    Four                e)                      /* IN error code of the transfer */
+{
+    Four                type = handle->type;    /* buffer type */
+    Four                index = handle->index;  /* buffer of the request */
+    pthread_mutex_t     *latch;                 /* latch of the partition */
+    TrainID             next;                   /* train following a train read ahead */
+    BfMNextTrainFunc    nextTrain;              /* gives the train following a train read ahead */
+
+
+    latch = BI_PARTLATCH(type, handle->part);
+    BFM_GETLATCH(latch);
+
+    if (handle->op == BFM_IO_READ || handle->op == BFM_IO_PREFETCH)
+        e = edubfm_EndRead(type, handle->part, index, e);
+
+    if (handle->op == BFM_IO_PREFETCH) {
+        SET_NILPAGEID(next);
+        if (e >= eNOERROR) {
+            nextTrain = bufReadAhead[type].nextTrain;
+            if (nextTrain != NULL) nextTrain(&handle->trainId, handle->buffer, &next);
+            BI_FIXED(type, index)--;
+        }
+        BFM_RELEASELATCH(latch);
+
+        if (e >= eNOERROR) edubfm_ReadAheadDone(type, &handle->trainId, &next);
+        free(handle);
+        return;
+    }
+
+    if (handle->op == BFM_IO_READ && e >= eNOERROR)
+        edubfm_StatsLatency(type, FALSE, edubfm_StatsClock() - handle->start);
+
+    handle->status = (e < eNOERROR) ? e : eNOERROR;
+    pthread_cond_broadcast(BI_PARTIODONE(type, handle->part));
+
+    BFM_RELEASELATCH(latch);
+
+} /* edubfm_CompleteIO() */
@@ -0,0 +1,140 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_CleanFirst.c
+ *
+ * Description :
+ *  The clock of BFM_POLICY_CLEANFIRST. Evicting a dirty train makes the
+ *  allocating thread wait for its write, while a clean train a few buffers
+ *  further costs nothing; so a dirty candidate is given another chance and
+ *  its write-back is left to the background cleaner.
+ *
+ * Exports:
+ *  Four edubfm_CleanFirstSweep(Four, Four, Four, Four *)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * edubfm_CleanFirstSweep()
+ *================================*/
+/*
+ * Function: Four edubfm_CleanFirstSweep(Four, Four, Four, Four *)
+ *
+ * Description:
+ *  Run the second chance clock of edubfm_AllocTrain() over the `n' buffers
+ *  from `first' on, starting at *victim, with the same reference bits and
+ *  BFM_CLOCK_BUDGET. A candidate holding a dirty train is passed over and
+ *  the search goes on for a clean one; after BFM_CLEANFIRST_LOOKAHEAD dirty
+ *  candidates, or when no clean one is left, the first dirty candidate is
+ *  the victim and is written back by the caller as usual.
+ *  The cleaner of the pool, if running, is woken up to write the dirty
+ *  candidates passed over, so that they are clean when the hand comes back.
+ *  The caller must hold the latch of the partition.
+ *
+ * Returns:
+ *  # of buffers passed before the victim, 2*n if there is no unfixed buffer
+ *
+ * Side effects:
+ *  1) parameter victim
+ *     victim is set to the buffer selected
+ */
+Four edubfm_CleanFirstSweep(
+    Four                type,                   /* IN buffer type */
+    Four                first,                  /* IN first buffer of the partition */
+    Four                n,                      /* IN # of buffers of the partition */
+    Four                *victim)                /* INOUT clock hand, then the victim */
+{
+    Four                i;                      /* # of buffers passed */
+    Four                v;                      /* buffer under the hand */
+    Four                nCleared;               /* # of reference bits cleared */
+    Four                nDirty;                 /* # of dirty candidates passed over */
+    Four                dirty;                  /* first dirty candidate */
+    Four                dirtyPassed;            /* # of buffers passed before it */
+
+
+    v = *victim;
+    nCleared = nDirty = 0;
+    dirty = NIL;
+    for (i = 0; i < 2 * n; i++, v = first + (v - first + 1) % n) {
+        if (BI_FIXED(type, v) > 0) continue;
+
+        if ((BI_BITS(type, v) & REFER) && nCleared < BFM_CLOCK_BUDGET) {
+            BI_BITS(type, v) &= ~REFER;
+            nCleared++;
+            continue;
+        }
+
+        if ((BI_BITS(type, v) & DIRTY) == 0) break;
+
+        if (dirty == NIL) {
+            dirty = v;
+            dirtyPassed = i;
+        }
+        if (++nDirty > BFM_CLEANFIRST_LOOKAHEAD) break;
+    }
+
+    if (nDirty > 0) edubfm_WakeCleaner(type);
+
+    if (dirty != NIL && (i == 2 * n || (BI_BITS(type, v) & DIRTY))) {
+        /* no clean victim within the lookahead */
+        *victim = dirty;
+        return(dirtyPassed);
+    }
+
+    if (i < 2 * n && nDirty > 0) BFM_STATS_INC(type, nWritesAvoided);
+    *victim = v;
+
+    return(i);
+
+} /* edubfm_CleanFirstSweep() */
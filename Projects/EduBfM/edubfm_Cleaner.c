@@ -0,0 +1,349 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Cleaner.c
+ *
+ * Description :
+ *  Background cleaner of a buffer pool.
+ *  The cleaner thread walks each partition from its clock hand and writes
+ *  back the dirty, unfixed trains which are about to become victims, until
+ *  enough clean victims are ready. A miss then costs at most one read,
+ *  because edubfm_AllocTrain() finds a clean victim.
+ *
+ *  A train is written back from a copy: under the partition latch the
+ *  train is copied, its buffer is fixed so that it is not evicted, and the
+ *  CLEANING bit is set, which EduBfM_SetDirty() clears. So the train can
+ *  be fixed and updated during the write. The dirty bit is cleared only
+ *  when the write succeeds and CLEANING is still set; EduBfM_FlushAll()
+ *  waits on BI_PARTIODONE() for a train being written back.
+ *
+ * Exports:
+ *  Four edubfm_StartCleaner(Four, Four)
+ *  Four edubfm_StopCleaner(Four)
+ *  void edubfm_WakeCleaner(Four)
+ */
+
+
+#include <stdlib.h> /* for free */
+#include <string.h> /* for memcpy */
+#include <sys/time.h> /* for gettimeofday */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * global variables
+ */
+/* background cleaner of each buffer pool; not running by default */
+BfMCleaner bufCleaner[NUM_BUF_TYPES] = {
+    { 0, FALSE, FALSE, 0, NULL, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER },
+    { 0, FALSE, FALSE, 0, NULL, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER }
+};
+
+
+
+/*@
+ * internal function prototypes
+ */
+static void *edubfm_CleanerMain(void *);
+static Four edubfm_CleanPartition(Four, Four, Four);
+
+
+
+/*@================================
+ * edubfm_StartCleaner()
+ *================================*/
+/*
+ * Function: Four edubfm_StartCleaner(Four, Four)
+ *
+ * Description:
+ *  Start the cleaner of the buffer pool of the given type, which keeps
+ *  `nClean' clean victims ready. If the cleaner is already running, only
+ *  the number of clean victims is changed.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR - the copy buffer or the thread cannot be created
+ */
+Four edubfm_StartCleaner(
+    Four                type,                   /* IN buffer type */
+    Four                nClean)                 /* IN # of clean victims to keep ready */
+{
+    BfMCleaner          *c = &bufCleaner[type]; /* cleaner of the pool */
+
+
+    c->nClean = nClean;
+    if (c->running) return(eNOERROR);
+
+    c->copy = edubfm_AllocIOBuffer(BI_BUFSIZE(type));
+    if (c->copy == NULL) ERR(eMEMORYALLOCERR);
+
+    c->stop = FALSE;
+    if (pthread_create(&c->thread, NULL, edubfm_CleanerMain, (void*)(long)type) != 0) {
+        free(c->copy);
+        c->copy = NULL;
+        ERR(eMEMORYALLOCERR);
+    }
+    c->running = TRUE;
+
+    return(eNOERROR);
+
+} /* edubfm_StartCleaner() */
+
+
+
+/*@================================
+ * edubfm_StopCleaner()
+ *================================*/
+/*
+ * Function: Four edubfm_StopCleaner(Four)
+ *
+ * Description:
+ *  Stop the cleaner of the buffer pool of the given type and wait until
+ *  its last write is done.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_StopCleaner(
+    Four                type)                   /* IN buffer type */
+{
+    BfMCleaner          *c = &bufCleaner[type]; /* cleaner of the pool */
+
+
+    if (!c->running) return(eNOERROR);
+
+    BFM_GETLATCH(&c->wakeupLatch);
+    c->stop = TRUE;
+    pthread_cond_signal(&c->wakeup);
+    BFM_RELEASELATCH(&c->wakeupLatch);
+
+    pthread_join(c->thread, NULL);
+
+    free(c->copy);
+    c->copy = NULL;
+    c->nClean = 0;
+    c->running = FALSE;
+
+    return(eNOERROR);
+
+} /* edubfm_StopCleaner() */
+
+
+
+/*@================================
+ * edubfm_WakeCleaner()
+ *================================*/
+/*
+ * Function: void edubfm_WakeCleaner(Four)
+ *
+ * Description:
+ *  Start a pass of the cleaner of the given pool now, e.g. because a
+ *  dirty victim had to be written back in the foreground.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_WakeCleaner(
+    Four                type)                   /* IN buffer type */
+{
+    BfMCleaner          *c = &bufCleaner[type]; /* cleaner of the pool */
+
+
+    if (!c->running) return;
+
+    BFM_GETLATCH(&c->wakeupLatch);
+    pthread_cond_signal(&c->wakeup);
+    BFM_RELEASELATCH(&c->wakeupLatch);
+
+} /* edubfm_WakeCleaner() */
+
+
+
+/*@================================
+ * edubfm_CleanerMain()
+ *================================*/
+/*
+ * Function: static void *edubfm_CleanerMain(void *)
+ *
+ * Description:
+ *  Body of the cleaner thread. Every BFM_CLEANER_INTERVAL milliseconds, or
+ *  when woken up, each partition is cleaned in proportion to its size.
+ *
+ * Returns:
+ *  NULL
+ */
+static void *edubfm_CleanerMain(
+    void                *arg)                   /* IN buffer type */
+{
+    Four                type = (Four)(long)arg; /* buffer type */
+    BfMCleaner          *c = &bufCleaner[type]; /* cleaner of the pool */
+    Four                p;                      /* partition number */
+    Four                target;                 /* # of clean victims of a partition */
+    struct timeval      now;                    /* current time */
+    struct timespec     until;                  /* end of the sleep */
+
+
+    for (;;) {
+        BFM_GETLATCH(&c->latch);
+        for (p = 0; p < BI_NPARTITIONS(type) && !c->stop; p++) {
+            target = (Four)((double)c->nClean * BI_PARTNBUFS(type, p) / BI_NBUFS(type) + 0.5);
+            if (target < 1) target = 1;
+
+            /* an error is logged by edubfm_CleanPartition(); the train stays dirty */
+            (void)edubfm_CleanPartition(type, p, target);
+        }
+        BFM_RELEASELATCH(&c->latch);
+
+        BFM_GETLATCH(&c->wakeupLatch);
+        if (!c->stop) {
+            gettimeofday(&now, NULL);
+            until.tv_sec = now.tv_sec + (now.tv_usec + BFM_CLEANER_INTERVAL * 1000) / 1000000;
+            until.tv_nsec = ((now.tv_usec + BFM_CLEANER_INTERVAL * 1000) % 1000000) * 1000;
+            pthread_cond_timedwait(&c->wakeup, &c->wakeupLatch, &until);
+        }
+        if (c->stop) {
+            BFM_RELEASELATCH(&c->wakeupLatch);
+            break;
+        }
+        BFM_RELEASELATCH(&c->wakeupLatch);
+    }
+
+    return(NULL);
+
+} /* edubfm_CleanerMain() */
+
+
+
+/*@================================
+ * edubfm_CleanPartition()
+ *================================*/
+/*
+ * Function: static Four edubfm_CleanPartition(Four, Four, Four)
+ *
+ * Description:
+ *  Visit the buffers of a partition in the order the clock hand will, and
+ *  write back the dirty trains which the clock would evict until `target'
+ *  clean victims are found or every buffer has been visited.
+ *  A fixed buffer, or with the clock a buffer whose reference bit is set,
+ *  is not a victim and is skipped.
+ *  The caller must hold the cleaner latch of the pool.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four edubfm_CleanPartition(
+    Four                type,                   /* IN buffer type */
+    Four                part,                   /* IN partition number */
+    Four                target)                 /* IN # of clean victims to find */
+{
+    Four                e;                      /* for error */
+    pthread_mutex_t     *latch;                 /* latch of the partition */
+    Four                first;                  /* index of the first buffer of the partition */
+    Four                n;                      /* # of buffers of the partition */
+    Four                hand;                   /* clock hand of the partition */
+    Four                k;                      /* # of buffers visited */
+    Four                i;                      /* index of a buffer */
+    Four                nClean;                 /* # of clean victims found */
+    Boolean             useRefer;               /* TRUE if the reference bit decides victims */
+    BfMHashKey          key;                    /* key of the train being written back */
+
+
+    latch = BI_PARTLATCH(type, part);
+    BFM_GETLATCH(latch);
+
+    first = BI_PARTFIRSTBUF(type, part);
+    n = BI_PARTNBUFS(type, part);
+    hand = BI_PARTNEXTVICTIM(type, part);
+    useRefer = (BI_PARTPOLICYSTATE(type, part) == NULL);
+
+    for (nClean = 0, k = 0; k < n && nClean < target; k++) {
+        i = first + (hand - first + k) % n;
+
+        if (BI_FIXED(type, i) > 0) continue;
+        if (useRefer && (BI_BITS(type, i) & REFER)) continue;
+
+        if (BI_BITS(type, i) & DIRTY) {
+            key = BI_KEY(type, i);
+            memcpy(bufCleaner[type].copy, BI_BUFFER(type, i), PAGESIZE * BI_BUFSIZE(type));
+            BI_FIXED(type, i)++;
+            BI_BITS(type, i) |= CLEANING;
+            BFM_RELEASELATCH(latch);
+
+            e = edubfm_DiskWrite(bufCleaner[type].copy, (TrainID*)&key, 1, type);
+
+            BFM_GETLATCH(latch);
+            BI_FIXED(type, i)--;
+            if (e >= eNOERROR && (BI_BITS(type, i) & CLEANING)) {
+                /* the copy written is the train as it is now */
+                BI_BITS(type, i) &= ~DIRTY;
+                edubfm_MarkClean(type, i);
+            }
+            BI_BITS(type, i) &= ~CLEANING;
+            pthread_cond_broadcast(BI_PARTIODONE(type, part));
+
+            if (e < eNOERROR) ERRL(e, latch);
+
+            BFM_STATS_INC(type, nWrites);
+            BFM_STATS_INC(type, nCleanerWrites);
+
+            /* the train may have been fixed or referenced during the write */
+            if (BI_FIXED(type, i) > 0 || (BI_BITS(type, i) & DIRTY)) continue;
+        }
+
+        nClean++;
+    }
+
+    BFM_RELEASELATCH(latch);
+
+    return(eNOERROR);
+
+} /* edubfm_CleanPartition() */
@@ -0,0 +1,358 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_DirectIO.c
+ *
+ * Description :
+ *  Reads and writes of trains on the disk. The trains of a volume given to
+ *  EduBfM_SetDirectIO() are transferred by pread/pwrite (see edurdsm_DiskTransfer()) on its devices
+ *  opened with O_DIRECT, so that they are not kept again in the page cache
+ *  and a write is done when it returns; a transfer from or to a buffer
+ *  which is not aligned to BFM_DIRECTIO_ALIGN goes through the bounce
+ *  buffer. The trains of the other volumes, and the runs crossing devices,
+ *  are transferred by EduRDsM, which passes the volumes it has not mounted
+ *  to RDsM.
+ *  The transfers by pread/pwrite run at once; only those passed to RDsM,
+ *  which is not reentrant, are done one at a time under edubfm_ioLatch.
+ *
+ * Exports:
+ *  Four edubfm_DiskRead(TrainID *, char *, Four, Four)
+ *  Four edubfm_DiskWrite(char *, TrainID *, Four, Four)
+ *  Boolean edubfm_DiskLocate(TrainID *, char *, Four, Four, int *, off_t *, Boolean *)
+ *  char *edubfm_AllocIOBuffer(Four)
+ */
+
+
+#include <stdlib.h> /* for posix_memalign */
+#include <string.h> /* for memcpy */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+#include "EduRDsM.h"
+
+
+
+/*@
+ * global variables
+ */
+/* volumes accessed by direct I/O; none by default */
+BfMDirectIO bufDirect = { 0, { { 0 } }, NULL, 0, PTHREAD_MUTEX_INITIALIZER };
+
+
+
+/*@
+ * internal function prototypes
+ */
+static BfMDirectVolume *direct_Device(TrainID *, Four, Four, Four *);
+static Four direct_Transfer(TrainID *, char *, Four, Four, Boolean);
+
+
+
+/*@================================
+ * edubfm_DiskRead()
+ *================================*/
+/*
+ * Function: Four edubfm_DiskRead(TrainID *, char *, Four, Four)
+ *
+ * Description:
+ *  Read `nTrains' consecutive trains from the given train on into `buf'.
+ *
+ * Returns:
+ *  error code
+ *    eIOFAILED_EDUBFM - a direct read failed
+ *    some errors caused by function calls
+ */
+Four edubfm_DiskRead(
+    TrainID             *first,                 /* IN first train */
+    char                *buf,                   /* OUT trains read */
+    Four                nTrains,                /* IN # of trains */
+    Four                type)                   /* IN buffer type */
+{
+    Four                e;                      /* for error */
+    Boolean             viaRDsM;                /* TRUE if the trains are transferred by RDsM */
+
+
+    if (bufDirect.nVolumes > 0) {
+        e = direct_Transfer(first, buf, nTrains, type, FALSE);
+        if (e != eNOTFOUND_BFM) return(e);
+    }
+
+    /* RDsM is not reentrant */
+    viaRDsM = (edurdsm_Volume(first->volNo) == NULL);
+    if (viaRDsM) BFM_GETLATCH(&edubfm_ioLatch);
+    if (nTrains > 1) e = EduRDsM_ReadTrains(first, buf, nTrains, BI_BUFSIZE(type));
+    else e = EduRDsM_ReadTrain(first, buf, BI_BUFSIZE(type));
+    if (viaRDsM) BFM_RELEASELATCH(&edubfm_ioLatch);
+
+    return(e);
+
+} /* edubfm_DiskRead() */
+
+
+
+/*@================================
+ * edubfm_DiskWrite()
+ *================================*/
+/*
+ * Function: Four edubfm_DiskWrite(char *, TrainID *, Four, Four)
+ *
+ * Description:
+ *  Write the `nTrains' trains in `buf' to the consecutive trains from the
+ *  given train on.
+ *
+ * Returns:
+ *  error code
+ *    eIOFAILED_EDUBFM - a direct write failed
+ *    some errors caused by function calls
+ */
+Four edubfm_DiskWrite(
+    char                *buf,                   /* IN trains to be written */
+    TrainID             *first,                 /* IN first train */
+    Four                nTrains,                /* IN # of trains */
+    Four                type)                   /* IN buffer type */
+{
+    Four                e;                      /* for error */
+    Boolean             viaRDsM;                /* TRUE if the trains are transferred by RDsM */
+
+
+    if (bufDirect.nVolumes > 0) {
+        e = direct_Transfer(first, buf, nTrains, type, TRUE);
+        if (e != eNOTFOUND_BFM) return(e);
+    }
+
+    /* RDsM is not reentrant */
+    viaRDsM = (edurdsm_Volume(first->volNo) == NULL);
+    if (viaRDsM) BFM_GETLATCH(&edubfm_ioLatch);
+    if (nTrains > 1) e = EduRDsM_WriteTrains(buf, first, nTrains, BI_BUFSIZE(type));
+    else e = EduRDsM_WriteTrain(buf, first, BI_BUFSIZE(type));
+    if (viaRDsM) BFM_RELEASELATCH(&edubfm_ioLatch);
+
+    return(e);
+
+} /* edubfm_DiskWrite() */
+
+
+
+/*@================================
+ * edubfm_DiskLocate()
+ *================================*/
+/*
+ * Function: Boolean edubfm_DiskLocate(TrainID *, char *, Four, Four, int *, off_t *, Boolean *)
+ *
+ * Description:
+ *  Find the file and the offset at which `nTrains' consecutive trains can
+ *  be transferred from or to `buf' by one positional read or write: the
+ *  trains lie within a device of a volume accessed by direct I/O and `buf'
+ *  is aligned, or they lie in a volume mounted by EduRDsM.
+ *
+ * Returns:
+ *  TRUE if the trains are found, FALSE if they are to be transferred by
+ *  edubfm_DiskRead() or edubfm_DiskWrite()
+ *
+ * Side effects:
+ *  1) parameters fd, offset
+ *     file and offset of the trains
+ *  2) parameter isDirect
+ *     TRUE if the file is a device opened for direct I/O
+ */
+Boolean edubfm_DiskLocate(
+    TrainID             *first,                 /* IN first train */
+    char                *buf,                   /* IN buffer of the transfer */
+    Four                nTrains,                /* IN # of trains */
+    Four                type,                   /* IN buffer type */
+    int                 *fd,                    /* OUT file holding the trains */
+    off_t               *offset,                /* OUT offset of the trains in the file */
+    Boolean             *isDirect)              /* OUT TRUE for direct I/O */
+{
+    Four                d;                      /* device holding the trains */
+    BfMDirectVolume     *v;                     /* entry of the volume */
+
+
+    if (bufDirect.nVolumes > 0 && (v = direct_Device(first, nTrains, type, &d)) != NULL) {
+        if ((size_t)buf % BFM_DIRECTIO_ALIGN != 0) return(FALSE);
+        *fd = v->fd[d];
+        *offset = (off_t)(first->pageNo - v->firstPage[d]) * PAGESIZE;
+        *isDirect = TRUE;
+        return(TRUE);
+    }
+
+    *isDirect = FALSE;
+    return(edurdsm_Locate(first, nTrains * BI_BUFSIZE(type), fd, offset));
+
+} /* edubfm_DiskLocate() */
+
+
+
+/*@================================
+ * edubfm_AllocIOBuffer()
+ *================================*/
+/*
+ * Function: char *edubfm_AllocIOBuffer(Four)
+ *
+ * Description:
+ *  Allocate a buffer of `nPages' pages aligned for direct I/O, to stage
+ *  trains read or written together. It is freed by free().
+ *
+ * Returns:
+ *  the buffer, NULL if it cannot be allocated
+ */
+char *edubfm_AllocIOBuffer(
+    Four                nPages)                 /* IN # of pages */
+{
+    void                *buf;                   /* the buffer */
+
+
+    if (posix_memalign(&buf, BFM_DIRECTIO_ALIGN, (size_t)nPages * PAGESIZE) != 0) return(NULL);
+
+    return((char*)buf);
+
+} /* edubfm_AllocIOBuffer() */
+
+
+
+/*@================================
+ * direct_Device()
+ *================================*/
+/*
+ * Function: static BfMDirectVolume *direct_Device(TrainID *, Four, Four, Four *)
+ *
+ * Description:
+ *  Find the device holding `nTrains' consecutive trains of a volume
+ *  accessed by direct I/O. An entry is filled before its nDevices is set,
+ *  so the entries are read without a latch.
+ *
+ * Returns:
+ *  the entry of the volume, NULL if the trains are not accessed so or
+ *  cross devices
+ *
+ * Side effects:
+ *  1) parameter d
+ *     device holding the trains
+ */
+static BfMDirectVolume *direct_Device(
+    TrainID             *first,                 /* IN first train */
+    Four                nTrains,                /* IN # of trains */
+    Four                type,                   /* IN buffer type */
+    Four                *d)                     /* OUT device holding the trains */
+{
+    Four                i;                      /* index */
+    BfMDirectVolume     *v;                     /* entry of the volume */
+
+
+    for (i = 0; i < MAXNUMOFMAPPEDVOLUMES; i++)
+        if (bufDirect.volumes[i].nDevices > 0 && bufDirect.volumes[i].volNo == first->volNo) break;
+    if (i == MAXNUMOFMAPPEDVOLUMES) return(NULL);
+    v = &bufDirect.volumes[i];
+
+    *d = edubfm_DeviceOfTrain(v->firstPage, v->nDevices, first, nTrains * BI_BUFSIZE(type));
+    if (*d == NIL) return(NULL);
+
+    return(v);
+
+} /* direct_Device() */
+
+
+
+/*@================================
+ * direct_Transfer()
+ *================================*/
+/*
+ * Function: static Four direct_Transfer(TrainID *, char *, Four, Four, Boolean)
+ *
+ * Description:
+ *  Read or write `nTrains' consecutive trains by direct I/O, if their
+ *  volume is accessed so and they lie within one of its devices.
+ *
+ * Returns:
+ *  error code
+ *    eNOTFOUND_BFM - the trains are to be transferred by EduRDsM
+ *    eIOFAILED_EDUBFM - the transfer failed
+ */
+static Four direct_Transfer(
+    TrainID             *first,                 /* IN first train */
+    char                *buf,                   /* INOUT trains transferred */
+    Four                nTrains,                /* IN # of trains */
+    Four                type,                   /* IN buffer type */
+    Boolean             isWrite)                /* IN TRUE to write the trains */
+{
+    Four                e;                      /* for error */
+    Four                d;                      /* device holding the trains */
+    BfMDirectVolume     *v;                     /* entry of the volume */
+    size_t              nBytes;                 /* # of bytes of the trains */
+    off_t               offset;                 /* offset of the trains in the device */
+
+
+    v = direct_Device(first, nTrains, type, &d);
+    if (v == NULL) return(eNOTFOUND_BFM);
+
+    nBytes = (size_t)nTrains * BI_BUFSIZE(type) * PAGESIZE;
+    offset = (off_t)(first->pageNo - v->firstPage[d]) * PAGESIZE;
+
+    if ((size_t)buf % BFM_DIRECTIO_ALIGN != 0) {
+        if (nBytes > bufDirect.bounceSize) return(eNOTFOUND_BFM);
+
+        /* the bounce buffer is shared by the transfers */
+        BFM_GETLATCH(&bufDirect.latch);
+        if (isWrite) memcpy(bufDirect.bounce, buf, nBytes);
+        e = edurdsm_DiskTransfer(v->fd[d], bufDirect.bounce, nBytes, offset, isWrite);
+        if (e >= eNOERROR && !isWrite) memcpy(buf, bufDirect.bounce, nBytes);
+        BFM_RELEASELATCH(&bufDirect.latch);
+        if (e < eNOERROR) ERR(e);
+
+        BFM_STATS_INC(type, nDirectBounces);
+    }
+    else {
+        e = edurdsm_DiskTransfer(v->fd[d], buf, nBytes, offset, isWrite);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    BFM_STATS_INC(type, nDirectIOs);
+
+    return(eNOERROR);
+
+} /* direct_Transfer() */
@@ -0,0 +1,222 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_DirtyMap.c
+ *
+ * Description :
+ *  Dirty maps of the buffer pools.
+ *  The map of a pool has a bit per buffer, set when the buffer is made
+ *  dirty and cleared when it is written, and a summary bit per word of the
+ *  map, so that EduBfM_FlushAll() visits the dirty buffers only instead of
+ *  the whole buffer table. The bits are updated with atomic operations
+ *  under the latch of the partition of the buffer; a summary bit may stay
+ *  set for a word which became zero, but is never clear for a non-zero word.
+ *
+ * Exports:
+ *  void edubfm_MarkDirty(Four, Four)
+ *  void edubfm_MarkClean(Four, Four)
+ *  Four edubfm_NextDirty(Four, Four)
+ *  void edubfm_ClearDirtyMap(Four)
+ */
+
+
+#include <string.h> /* for memset */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * global variables
+ */
+/* dirty map of each buffer pool */
+BfMDirtyMap bufDirtyMap[NUM_BUF_TYPES];
+
+
+
+/*@================================
+ * edubfm_MarkDirty()
+ *================================*/
+/*
+ * Function: void edubfm_MarkDirty(Four, Four)
+ *
+ * Description:
+ *  Set the bit of a buffer whose DIRTY bit has been set.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_MarkDirty(
+    Four                type,                   /* IN buffer type */
+    Four                index)                  /* IN index of the buffer */
+{
+    BfMDirtyMap         *map = &bufDirtyMap[type];      /* dirty map of the pool */
+    Four                w = index >> 6;         /* word of the buffer */
+    UEight              bit = 1UL << (index & 63);      /* bit of the buffer */
+
+
+    if (map->words[w] & bit) return;
+
+    __sync_fetch_and_or(&map->words[w], bit);
+    __sync_fetch_and_or(&map->summary[w >> 6], 1UL << (w & 63));
+
+} /* edubfm_MarkDirty() */
+
+
+
+/*@================================
+ * edubfm_MarkClean()
+ *================================*/
+/*
+ * Function: void edubfm_MarkClean(Four, Four)
+ *
+ * Description:
+ *  Clear the bit of a buffer whose DIRTY bit has been cleared.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_MarkClean(
+    Four                type,                   /* IN buffer type */
+    Four                index)                  /* IN index of the buffer */
+{
+    BfMDirtyMap         *map = &bufDirtyMap[type];      /* dirty map of the pool */
+    Four                w = index >> 6;         /* word of the buffer */
+    UEight              bit = 1UL << (index & 63);      /* bit of the buffer */
+    UEight              sbit = 1UL << (w & 63); /* summary bit of the word */
+
+
+    if ((map->words[w] & bit) == 0) return;
+
+    if (__sync_and_and_fetch(&map->words[w], ~bit) == 0) {
+        __sync_fetch_and_and(&map->summary[w >> 6], ~sbit);
+        /* another buffer of the word may have been marked meanwhile */
+        if (map->words[w] != 0) __sync_fetch_and_or(&map->summary[w >> 6], sbit);
+    }
+
+} /* edubfm_MarkClean() */
+
+
+
+/*@================================
+ * edubfm_NextDirty()
+ *================================*/
+/*
+ * Function: Four edubfm_NextDirty(Four, Four)
+ *
+ * Description:
+ *  Find the first buffer from `from' on whose bit is set.
+ *
+ * Returns:
+ *  index of the buffer, or NIL if there is none
+ */
+Four edubfm_NextDirty(
+    Four                type,                   /* IN buffer type */
+    Four                from)                   /* IN index to start with */
+{
+    BfMDirtyMap         *map = &bufDirtyMap[type];      /* dirty map of the pool */
+    Four                w;                      /* index of a word */
+    Four                s;                      /* index of a summary word */
+    Four                index;                  /* index of the buffer found */
+    UEight              bits;                   /* bits left in a word */
+
+
+    if (from >= BI_NBUFS(type)) return(NIL);
+
+    /* the rest of the word of `from' */
+    w = from >> 6;
+    bits = map->words[w] & (~0UL << (from & 63));
+    if (bits != 0) {
+        index = (w << 6) + __builtin_ctzl(bits);
+        return((index < BI_NBUFS(type)) ? index : NIL);
+    }
+
+    /* the following non-zero words through the summary */
+    for (w++; (w << 6) < BI_NBUFS(type); ) {
+        s = w >> 6;
+        bits = map->summary[s] & (~0UL << (w & 63));
+        if (bits == 0) {
+            w = (s + 1) << 6;
+            continue;
+        }
+
+        w = (s << 6) + __builtin_ctzl(bits);
+        if ((w << 6) >= BI_NBUFS(type)) break;
+        if (map->words[w] != 0) {
+            index = (w << 6) + __builtin_ctzl(map->words[w]);
+            return((index < BI_NBUFS(type)) ? index : NIL);
+        }
+        w++;
+    }
+
+    return(NIL);
+
+} /* edubfm_NextDirty() */
+
+
+
+/*@================================
+ * edubfm_ClearDirtyMap()
+ *================================*/
+/*
+ * Function: void edubfm_ClearDirtyMap(Four)
+ *
+ * Description:
+ *  Clear the dirty map of a pool whose buffers have all been discarded.
+ *  The caller must hold the latches of all partitions of the pool.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ClearDirtyMap(
+    Four                type)                   /* IN buffer type */
+{
+    memset(&bufDirtyMap[type], 0, sizeof(BfMDirtyMap));
+
+} /* edubfm_ClearDirtyMap() */
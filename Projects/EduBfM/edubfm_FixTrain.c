@@ -0,0 +1,180 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_FixTrain.c
+ *
+ * Description :
+ *  Fix a train in the buffer pool, or claim a buffer for it, as the first
+ *  step of EduBfM_GetTrain() and its variants, and end the read of a
+ *  claimed train. The read itself is done by the caller without the
+ *  latch of the partition, synchronously or through the asynchronous
+ *  I/O engine.
+ *
+ * Exports:
+ *  Four edubfm_FixTrain(Four, Four, BfMHashKey *, Four *)
+ *  Four edubfm_EndRead(Four, Four, Four, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * edubfm_FixTrain()
+ *================================*/
+/*
+ * Function: Four edubfm_FixTrain(Four, Four, BfMHashKey *, Four *)
+ *
+ * Description:
+ *  Fix the train `key' if it is in the pool and ready, and mark it
+ *  referenced. Otherwise, count a miss and claim a buffer for the train
+ *  by edubfm_ClaimTrain(), so that the caller reads it and ends the read
+ *  by edubfm_EndRead(). Nothing is done if the train is being read for
+ *  another caller, or if it is missing while a victim of the partition is
+ *  being written back (see BI_PARTEVICTING()); the caller waits on
+ *  BI_PARTIODONE() and tries again.
+ *  The caller must hold the latch of the partition `part'.
+ *
+ * Returns:
+ *  BFM_FIX_HIT, BFM_FIX_MISS, BFM_FIX_READING or BFM_FIX_EVICTING, or
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) parameter index
+ *     buffer of the train if BFM_FIX_HIT or BFM_FIX_MISS is returned
+ */
+Four edubfm_FixTrain(
+    Four                type,                   /* IN buffer type */
+    Four                part,                   /* IN partition holding the train */
+    BfMHashKey          *key,                   /* IN train to be fixed */
+    Four                *index)                 /* OUT buffer of the train */
+{
+    Four                e;                      /* for error */
+    Four                i;                      /* index of the buffer pool */
+
+
+    i = edubfm_LookUp(key, type);
+
+    if (i == NOTFOUND_IN_HTABLE) {
+        if (BI_PARTEVICTING(type, part)) return(BFM_FIX_EVICTING);
+
+        BFM_STATS_INC(type, nMisses);
+        if (bufAdapt.budget > 0)
+            edubfm_AdaptMiss(type, key);
+
+        i = edubfm_ClaimTrain(type, part, key, REFER);
+        if (i < eNOERROR) ERR(i);
+
+        *index = i;
+        return(BFM_FIX_MISS);
+    }
+
+    if (BI_BITS(type, i) & READING) return(BFM_FIX_READING);
+
+    BFM_STATS_INC(type, nHits);
+    BI_FIXED(type, i)++;
+    BI_BITS(type, i) |= REFER;
+    if (BI_BITS(type, i) & PREFETCHED) {
+        /* the read-ahead paid off */
+        BFM_STATS_INC(type, nPrefetchHits);
+        BI_BITS(type, i) &= ~PREFETCHED;
+    }
+
+    e = edubfm_PolicyHit(type, part, i);
+    if (e < eNOERROR) ERR(e);
+
+    *index = i;
+    return(BFM_FIX_HIT);
+
+} /* edubfm_FixTrain() */
+
+
+
+/*@================================
+ * edubfm_EndRead()
+ *================================*/
+/*
+ * Function: Four edubfm_EndRead(Four, Four, Four, Four)
+ *
+ * Description:
+ *  End the read of the train claimed in buffer `index', which has ended
+ *  with `e'. The READING bit is cleared if the read succeeded; otherwise
+ *  the train leaves the hash table, the policy and the pool. The threads
+ *  waiting on BI_PARTIODONE() are woken up either way.
+ *  The caller must hold the latch of the partition `part'.
+ *
+ * Returns:
+ *  error code of the read
+ */
+Four edubfm_EndRead(
+    Four                type,                   /* IN buffer type */
+    Four                part,                   /* IN partition of the buffer */
+    Four                index,                  /* IN buffer of the train */
+    Four                e)                      /* IN error code of the read */
+{
+    if (e < eNOERROR) {
+        (void)edubfm_Delete(&BI_KEY(type, index), type);
+        SET_NILBFMHASHKEY(BI_KEY(type, index));
+        BI_FIXED(type, index) = 0;
+        BI_BITS(type, index) = ALL_0;
+        (void)edubfm_PolicyDrop(type, part, index);
+        edubfm_FreeFrame(type, part, index);
+    }
+    else
+        BI_BITS(type, index) &= ~READING;
+
+    /* the waiters find the train ready, or missing */
+    pthread_cond_broadcast(BI_PARTIODONE(type, part));
+
+    return((e < eNOERROR) ? e : eNOERROR);
+
+} /* edubfm_EndRead() */
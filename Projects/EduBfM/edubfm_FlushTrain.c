@@ -101,10 +101,12 @@ Four edubfm_FlushTrain(
 	if(index == NOTFOUND_IN_HTABLE) ERR(eNOTFOUND_BFM);
 	if((BI_BITS(type, index) & DIRTY) == DIRTY){		//if DIRTY
 		//write to disk.
-		e = RDsM_WriteTrain(BI_BUFFER(type, index), trainId, BI_BUFSIZE(type));
+		e = edubfm_DiskWrite(BI_BUFFER(type, index), trainId, 1, type);
 		if(e < 0) ERR(e);
+		BFM_STATS_INC(type, nWrites);
 		//reset DIRTY bit.
-		bufInfo[type].bufTable[index].bits = bufInfo[type].bufTable[index].bits & ~(DIRTY);
+		BI_BITS(type, index) = BI_BITS(type, index) & ~(DIRTY);
+		edubfm_MarkClean(type, index);
 	}
 	/* ENDOFNEWCODE */
 
@@ -0,0 +1,219 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_FreeList.c
+ *
+ * Description :
+ *  Free lists of the buffer pools.
+ *  edubfm_AllocTrain() takes a buffer holding no train from the free list
+ *  of the partition before running the clock, so that an allocation costs
+ *  O(1) while the pool is filling up, e.g. after EduBfM_DiscardAll(), or
+ *  after trains have been dropped from the pool. A buffer is pushed when
+ *  its train is dropped without the buffer being reused, e.g. when a read
+ *  fails. The caller must hold the latch of the partition.
+ *
+ * Exports:
+ *  void edubfm_InvalidateFreeList(Four)
+ *  void edubfm_FreeFrame(Four, Four, Four)
+ *  Four edubfm_PopFreeFrame(Four, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * global variables
+ */
+/* free lists of each buffer pool; built when first used */
+BfMFreeList bufFreeList[NUM_BUF_TYPES];
+
+
+
+/*@
+ * internal function prototypes
+ */
+static void edubfm_BuildFreeList(Four, Four);
+
+
+
+/*@================================
+ * edubfm_InvalidateFreeList()
+ *================================*/
+/*
+ * Function: void edubfm_InvalidateFreeList(Four)
+ *
+ * Description:
+ *  Forget the free lists of all partitions of the given pool, to be built
+ *  again from the buffer table when they are next used. Called when the
+ *  partitions are rebuilt or resized and when all trains are discarded.
+ *  The caller must hold the latches of all partitions, or be the only
+ *  user of the pool.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_InvalidateFreeList(
+    Four                type)                   /* IN buffer type */
+{
+    Four                p;                      /* partition number */
+
+
+    for (p = 0; p < MAXNUMOFPARTITIONS; p++)
+        bufFreeList[type].valid[p] = FALSE;
+
+} /* edubfm_InvalidateFreeList() */
+
+
+
+/*@================================
+ * edubfm_FreeFrame()
+ *================================*/
+/*
+ * Function: void edubfm_FreeFrame(Four, Four, Four)
+ *
+ * Description:
+ *  Push a buffer whose train has been dropped to the free list of its
+ *  partition. Nothing is done if the list is not built yet, since the
+ *  buffer will be found when it is built.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_FreeFrame(
+    Four                type,                   /* IN buffer type */
+    Four                part,                   /* IN partition of the buffer */
+    Four                index)                  /* IN buffer holding no train */
+{
+    BfMFreeList         *fl = &bufFreeList[type];       /* free lists of the pool */
+    Four                first;                  /* index of the first buffer of the partition */
+
+
+    if (!fl->valid[part] || fl->nFree[part] >= BI_PARTNBUFS(type, part)) return;
+
+    first = BI_PARTFIRSTBUF(type, part);
+    fl->frames[first + fl->nFree[part]++] = index;
+
+} /* edubfm_FreeFrame() */
+
+
+
+/*@================================
+ * edubfm_PopFreeFrame()
+ *================================*/
+/*
+ * Function: Four edubfm_PopFreeFrame(Four, Four)
+ *
+ * Description:
+ *  Take a buffer holding no train from the free list of the partition.
+ *  An entry is skipped if its buffer has been used since it was pushed,
+ *  e.g. taken by the clock, or is out of the range of the partition.
+ *
+ * Returns:
+ *  index of the buffer, or NIL if the free list is empty
+ */
+Four edubfm_PopFreeFrame(
+    Four                type,                   /* IN buffer type */
+    Four                part)                   /* IN partition number */
+{
+    BfMFreeList         *fl = &bufFreeList[type];       /* free lists of the pool */
+    Four                first;                  /* index of the first buffer of the partition */
+    Four                index;                  /* index of a buffer */
+
+
+    if (!fl->valid[part]) edubfm_BuildFreeList(type, part);
+
+    first = BI_PARTFIRSTBUF(type, part);
+    while (fl->nFree[part] > 0) {
+        index = fl->frames[first + --fl->nFree[part]];
+        if (index >= first && index < first + BI_PARTNBUFS(type, part) &&
+            IS_NILBFMHASHKEY(BI_KEY(type, index)) && BI_FIXED(type, index) == 0) return(index);
+    }
+
+    return(NIL);
+
+} /* edubfm_PopFreeFrame() */
+
+
+
+/*@================================
+ * edubfm_BuildFreeList()
+ *================================*/
+/*
+ * Function: static void edubfm_BuildFreeList(Four, Four)
+ *
+ * Description:
+ *  Build the free list of the partition from the buffer table. The
+ *  buffers are pushed from the last one, so that they are taken in the
+ *  order of their indexes.
+ *
+ * Returns:
+ *  None
+ */
+static void edubfm_BuildFreeList(
+    Four                type,                   /* IN buffer type */
+    Four                part)                   /* IN partition number */
+{
+    BfMFreeList         *fl = &bufFreeList[type];       /* free lists of the pool */
+    Four                first;                  /* index of the first buffer of the partition */
+    Four                i;                      /* index */
+
+
+    first = BI_PARTFIRSTBUF(type, part);
+
+    fl->nFree[part] = 0;
+    for (i = first + BI_PARTNBUFS(type, part) - 1; i >= first; i--)
+        if (IS_NILBFMHASHKEY(BI_KEY(type, i)) && BI_FIXED(type, i) == 0)
+            fl->frames[first + fl->nFree[part]++] = i;
+
+    fl->valid[part] = TRUE;
+
+} /* edubfm_BuildFreeList() */
@@ -55,6 +55,8 @@
  *  and each entry has an index which indicates a buffer in a buffer pool.
  *  An ordinary hashing method is used and linear probing strategy is
  *  used if collision has occurred.
+ *  If BFM_HASH_OPEN is selected for the buffer pool, the requests are
+ *  passed to the open addressing hash table in edubfm_OpenHash.c.
  *
  * Exports:
  *  Four edubfm_LookUp(BfMHashKey *, Four)
@@ -74,14 +76,14 @@
  * macro definitions
  */  
 
-/* Macro: BFM_HASH(k,type)
+/* Macro: BFM_HASH(k,size)
  * Description: return the hash value of the key given as a parameter
  * Parameters:
  *  BfMHashKey *k   : pointer to the key
- *  Four type       : buffer type
+ *  Four size       : size of the hash table
  * Returns: (Two) hash value
  */
-#define BFM_HASH(k,type)	(((k)->volNo + (k)->pageNo) % HASHTABLESIZE(type))
+#define BFM_HASH(k,size)	(((k)->volNo + (k)->pageNo) % (size))
 
 
 /*@================================
@@ -96,6 +98,8 @@
  *
  *  Insert a new entry into the hash table.
  *  If collision occurs, then use the linear probing method.
+ *  If the buffer pool is partitioned, the hash table of the partition
+ *  which the key belongs to is used.
  *
  * Returns:
  *  error code
@@ -109,6 +113,7 @@ Four edubfm_Insert(
 	/* These local variables are used in the solution code. However, you don¡¯t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four 		i;			
     Two  		hashValue;
+    Four 		part;			/* partition which the key belongs to */
 
     CHECKKEY(key);    /*@ check validity of key */
 
@@ -116,18 +121,17 @@ Four edubfm_Insert(
         ERR( eBADBUFINDEX_BFM );
 	
 	/* NEWCODE */
-	Two* hashtable = BI_HASHTABLE(type); //get the hash table.
-	hashValue = BFM_HASH(key, type); //calculate hash value.
-	Two n = BI_HASHTABLEENTRY(type,hashValue); //get the element.
-	//1. No Collision.
-	if(n == NOTFOUND_IN_HTABLE){
-		hashtable[hashValue] = index;
-	}
+	part = BI_PARTITIONOFKEY(type, key);
+	if(BI_HASHMETHOD(type) == BFM_HASH_OPEN)
+		return( edubfm_OpenHashInsert(BI_PARTOPENHASHTABLE(type, part), key, index) );
+
+	Two* hashtable = BI_PARTHASHTABLE(type, part); //get the hash table.
+	hashValue = BFM_HASH(key, BI_PARTHASHTABLESIZE(type, part)); //calculate hash value.
+	Two n = hashtable[hashValue]; //get the element.
+	//1. No Collision: n is NOTFOUND_IN_HTABLE and terminates the chain.
 	//2. Collision -> Chaining.
-	else{
-		bufInfo[type].bufTable[index].nextHashEntry = n;
-		hashtable[hashValue] = index;
-	}
+	BI_NEXTHASHENTRY(type, index) = n;
+	hashtable[hashValue] = index;
 	/* ENDOFNEWCODE */
 
     return( eNOERROR );
@@ -160,14 +164,19 @@ Four edubfm_Delete(
 	/* These local variables are used in the solution code. However, you don¡¯t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Two                 i, prev;                
     Two                 hashValue;
+    Four                part;                   /* partition which the key belongs to */
 
 
     CHECKKEY(key);    /*@ check validity of key */
 
 	/* NEWCODE */
-	Two* hashtable = BI_HASHTABLE(type); //get the hash table.
-	hashValue = BFM_HASH(key, type); //calculate hash value.
-	i = BI_HASHTABLEENTRY(type,hashValue);
+	part = BI_PARTITIONOFKEY(type, key);
+	if(BI_HASHMETHOD(type) == BFM_HASH_OPEN)
+		return( edubfm_OpenHashDelete(BI_PARTOPENHASHTABLE(type, part), key) );
+
+	Two* hashtable = BI_PARTHASHTABLE(type, part); //get the hash table.
+	hashValue = BFM_HASH(key, BI_PARTHASHTABLESIZE(type, part)); //calculate hash value.
+	i = hashtable[hashValue];
 	prev = NOTFOUND_IN_HTABLE;
 	//if(i == NOTFOUND_IN_HTABLE) ERR( eNOTFOUND_BFM );
 	
@@ -226,15 +235,20 @@ Four edubfm_LookUp(
 	/* These local variables are used in the solution code. However, you don¡¯t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Two                 i, j;                   /* indices */
     Two                 hashValue;
+    Four                part;                   /* partition which the key belongs to */
 
 
     CHECKKEY(key);    /*@ check validity of key */
 	
 	
 	/* NEWCODE */
-	Two* hashtable = BI_HASHTABLE(type); //get hashtable.
-	hashValue = BFM_HASH(key, type);
-	i = BI_HASHTABLEENTRY(type,hashValue); //get index in hashtable.
+	part = BI_PARTITIONOFKEY(type, key);
+	if(BI_HASHMETHOD(type) == BFM_HASH_OPEN)
+		return( edubfm_OpenHashLookUp(BI_PARTOPENHASHTABLE(type, part), key) );
+
+	Two* hashtable = BI_PARTHASHTABLE(type, part); //get hashtable.
+	hashValue = BFM_HASH(key, BI_PARTHASHTABLESIZE(type, part));
+	i = hashtable[hashValue]; //get index in hashtable.
 	if(i == NOTFOUND_IN_HTABLE) return (NOTFOUND_IN_HTABLE);
 	while(1){
 		if(EQUALKEY(key, &(BI_KEY(type, i)))){
@@ -278,20 +292,21 @@ Four edubfm_DeleteAll(void)
     Two 	i;
     Four        tableSize;
 	Four type;
+	Four part;
 	Two* hashtable;
     
 	/* NEWCODE */
-	type = PAGE_BUF;
-	hashtable = BI_HASHTABLE(type);
-	tableSize = HASHTABLESIZE(type);
-	for(i=0;i<tableSize;i++){
-		hashtable[i] = -1;
-	}
-	type = LOT_LEAF_BUF;
-	hashtable = BI_HASHTABLE(type);
-	tableSize = HASHTABLESIZE(type);
-	for(i=0;i<tableSize;i++){
-		hashtable[i] = -1;
+	for(type = 0; type < NUM_BUF_TYPES; type++){
+		for(part = 0; part < BI_NPARTITIONS(type); part++){
+			if(BI_HASHMETHOD(type) == BFM_HASH_OPEN)
+				edubfm_OpenHashClear(BI_PARTOPENHASHTABLE(type, part));
+
+			hashtable = BI_PARTHASHTABLE(type, part);
+			tableSize = BI_PARTHASHTABLESIZE(type, part);
+			for(i=0;i<tableSize;i++){
+				hashtable[i] = -1;
+			}
+		}
 	}
 	/* ENDOFNEWCODE */
 
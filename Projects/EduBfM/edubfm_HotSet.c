@@ -0,0 +1,224 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_HotSet.c
+ *
+ * Description :
+ *  Save the trains resident in the buffer pools, so that EduBfM_WarmUp()
+ *  can load them again after the next mount instead of letting the pools
+ *  fill up one miss at a time. Each train is saved with its hotness as
+ *  rated by the replacement policy of its pool (see edubfm_PolicyHotness()).
+ *
+ * Exports:
+ *  Four edubfm_SaveHotSet(char *)
+ */
+
+
+#include <stdio.h> /* for fopen, fwrite, fclose & rename */
+#include <stdlib.h> /* for malloc, realloc, free & qsort */
+#include <string.h> /* for strlen, strcpy & strcat */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * global variables
+ */
+/* file written by EduBfM_FlushAll(); NULL if the hot set is not saved */
+char *edubfm_hotSetFile = NULL;
+
+
+
+/*@
+ * internal function prototypes
+ */
+static int edubfm_CompareHotness(const void *, const void *);
+
+
+
+/*@================================
+ * edubfm_SaveHotSet()
+ *================================*/
+/*
+ * Function: Four edubfm_SaveHotSet(char *)
+ *
+ * Description:
+ *  Write the keys of the trains resident in the pools to the given file,
+ *  the trains of each pool from the hottest to the coldest. The file is
+ *  written under a temporary name and then renamed, so that a crash never
+ *  leaves a partial hot set behind.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR - memory allocation failed
+ *    eCREATEFILEFAILED_BFM - the file could not be written
+ */
+Four edubfm_SaveHotSet(
+    char                *path)                  /* IN file to write */
+{
+    Four                e;                      /* for error */
+    Four                type;                   /* buffer type */
+    Four                p;                      /* partition number */
+    Four                i;                      /* index */
+    Four                first;                  /* index of the first buffer of a partition */
+    Four                start;                  /* first entry of a pool */
+    Four                nEntries;               /* # of trains saved */
+    BfMHotEntry         *entries;               /* trains saved */
+    BfMHotEntry         *more;                  /* entries enlarged for a pool */
+    UFour               *hotness;               /* hotness of each buffer of a partition */
+    pthread_mutex_t     *latch;                 /* latch of a partition */
+    char                *tmpPath;               /* file written before the rename */
+    FILE                *fp;                    /* the file */
+
+
+    entries = NULL;
+    nEntries = 0;
+
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        /* the cleaner latch keeps the partitions from being rebuilt meanwhile */
+        BFM_GETLATCH(BI_CLEANERLATCH(type));
+
+        more = (BfMHotEntry*)realloc(entries, sizeof(BfMHotEntry) * (nEntries + BI_NBUFS(type)));
+        hotness = (UFour*)malloc(sizeof(UFour) * BI_NBUFS(type));
+        if (more == NULL || hotness == NULL) {
+            BFM_RELEASELATCH(BI_CLEANERLATCH(type));
+            free((more != NULL) ? more : entries);
+            if (hotness != NULL) free(hotness);
+            ERR(eMEMORYALLOCERR);
+        }
+        entries = more;
+
+        start = nEntries;
+        for (p = 0; p < BI_NPARTITIONS(type); p++) {
+            latch = BI_PARTLATCH(type, p);
+            BFM_GETLATCH(latch);
+
+            edubfm_PolicyHotness(type, p, hotness);
+
+            first = BI_PARTFIRSTBUF(type, p);
+            for (i = 0; i < BI_PARTNBUFS(type, p); i++) {
+                if (IS_NILBFMHASHKEY(BI_KEY(type, first + i)) || (BI_BITS(type, first + i) & READING))
+                    continue;
+                entries[nEntries].key = BI_KEY(type, first + i);
+                entries[nEntries].type = type;
+                entries[nEntries].hotness = hotness[i];
+                nEntries++;
+            }
+
+            BFM_RELEASELATCH(latch);
+        }
+
+        BFM_RELEASELATCH(BI_CLEANERLATCH(type));
+        free(hotness);
+
+        qsort(&entries[start], nEntries - start, sizeof(BfMHotEntry), edubfm_CompareHotness);
+    }
+
+    /*@ write the file under a temporary name */
+    tmpPath = (char*)malloc(strlen(path) + 5);
+    if (tmpPath == NULL) {
+        free(entries);
+        ERR(eMEMORYALLOCERR);
+    }
+    strcpy(tmpPath, path);
+    strcat(tmpPath, ".tmp");
+
+    e = eNOERROR;
+    fp = fopen(tmpPath, "wb");
+    if (fp == NULL) e = eCREATEFILEFAILED_BFM;
+    else {
+        if (fwrite(BFM_HOTSET_MAGIC, 1, strlen(BFM_HOTSET_MAGIC), fp) != strlen(BFM_HOTSET_MAGIC) ||
+            fwrite(&nEntries, sizeof(Four), 1, fp) != 1 ||
+            fwrite(entries, sizeof(BfMHotEntry), nEntries, fp) != (size_t)nEntries)
+            e = eCREATEFILEFAILED_BFM;
+        if (fclose(fp) != 0) e = eCREATEFILEFAILED_BFM;
+        if (e == eNOERROR && rename(tmpPath, path) != 0) e = eCREATEFILEFAILED_BFM;
+        if (e < eNOERROR) (void)remove(tmpPath);
+    }
+
+    free(tmpPath);
+    free(entries);
+
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubfm_SaveHotSet() */
+
+
+
+/*@================================
+ * edubfm_CompareHotness()
+ *================================*/
+/*
+ * Function: static int edubfm_CompareHotness(const void *, const void *)
+ *
+ * Description:
+ *  Order the trains from the hottest to the coldest, and trains of the
+ *  same hotness in the order of (volNo, pageNo).
+ *
+ * Returns:
+ *  negative, 0 or positive as for qsort()
+ */
+static int edubfm_CompareHotness(
+    const void          *a,                     /* IN a train */
+    const void          *b)                     /* IN another train */
+{
+    const BfMHotEntry   *x = (const BfMHotEntry*)a;
+    const BfMHotEntry   *y = (const BfMHotEntry*)b;
+
+
+    if (x->hotness != y->hotness) return((x->hotness > y->hotness) ? -1 : 1);
+    if (x->key.volNo != y->key.volNo) return((x->key.volNo < y->key.volNo) ? -1 : 1);
+    if (x->key.pageNo != y->key.pageNo) return((x->key.pageNo < y->key.pageNo) ? -1 : 1);
+
+    return(0);
+
+} /* edubfm_CompareHotness() */
@@ -0,0 +1,481 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_IOUring.c
+ *
+ * Description :
+ *  io_uring of the asynchronous I/O engine.
+ *  A request whose trains can be transferred by one positional read or
+ *  write (see edubfm_DiskLocate()) is put into the submission queue and
+ *  handed to the kernel by the caller of edubfm_SubmitIO(), so that up to
+ *  BFM_IOURING_DEPTH requests are in flight on the devices at once. A
+ *  reaper thread takes the completions and completes the requests by
+ *  edubfm_CompleteIO(); a transfer which the kernel has done only in part,
+ *  or refused, is finished by pread/pwrite.
+ *  The rings are set up by the system calls themselves, so liburing is
+ *  not needed. Where the kernel or its headers have no io_uring, no request
+ *  is submitted here and the workers execute them all.
+ *
+ * Exports:
+ *  Four edubfm_StartIOUring(Four)
+ *  void edubfm_StopIOUring(void)
+ *  Boolean edubfm_SubmitIOUring(BfMIOHandle *)
+ */
+
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define EDUBFM_IOURING
+#endif
+#endif
+
+#include <stdlib.h> /* for malloc & free */
+#include <string.h> /* for memset */
+#ifdef EDUBFM_IOURING
+#include <errno.h> /* for errno */
+#include <unistd.h> /* for syscall & close */
+#include <sys/mman.h> /* for mmap & munmap */
+#include <sys/syscall.h> /* for __NR_io_uring_setup & __NR_io_uring_enter */
+#include <linux/io_uring.h>
+#endif
+#include "EduBfM_common.h"
+#include "RM.h"
+#include "EduBfM_Internal.h"
+#include "EduRDsM.h"
+
+
+
+/*@
+ * global variables
+ */
+/* the io_uring of the asynchronous I/O engine; not set up by default */
+BfMIOUring edubfm_ioUring = { -1, 0, NULL, 0, NULL, 0, NULL, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                              NULL, NULL, 0, FALSE, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+
+
+#ifdef EDUBFM_IOURING
+
+/*@
+ * internal function prototypes
+ */
+static void *edubfm_IOUringReaperMain(void *);
+static void edubfm_IOUringComplete(Four, Four);
+static void edubfm_IOUringUnmap(BfMIOUring *);
+
+
+
+/*@================================
+ * edubfm_StartIOUring()
+ *================================*/
+/*
+ * Function: Four edubfm_StartIOUring(Four)
+ *
+ * Description:
+ *  Set up an io_uring for `depth' requests in flight and start its reaper
+ *  thread. Nothing is done if it is already set up.
+ *
+ * Returns:
+ *  error code
+ *    eNOTSUPPORTED_EDUBFM - the kernel has no io_uring
+ *    eMEMORYALLOCERR - the rings, the slots or the thread cannot be created
+ */
+Four edubfm_StartIOUring(
+    Four                depth)                  /* IN # of requests in flight */
+{
+    Four                i;                      /* index */
+    BfMIOUring          *r = &edubfm_ioUring;   /* the io_uring */
+    struct io_uring_params params;              /* parameters of the io_uring */
+
+
+    if (r->fd >= 0) return(eNOERROR);
+
+    memset(&params, 0, sizeof(params));
+    r->fd = (int)syscall(__NR_io_uring_setup, (unsigned)depth, &params);
+    if (r->fd < 0) {
+        /* e.g. an old kernel, or io_uring disabled; the workers will do */
+        r->fd = -1;
+        return(eNOTSUPPORTED_EDUBFM);
+    }
+
+    /*@ map the rings */
+    r->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    r->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (r->cqRingSize > r->sqRingSize) r->sqRingSize = r->cqRingSize;
+        r->cqRingSize = 0;
+    }
+    r->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    r->sqRing = mmap(NULL, r->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    r->cqRing = (r->cqRingSize == 0) ? r->sqRing :
+                mmap(NULL, r->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+    r->sqes = mmap(NULL, r->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+    if (r->sqRing == MAP_FAILED || r->cqRing == MAP_FAILED || r->sqes == MAP_FAILED) {
+        edubfm_IOUringUnmap(r);
+        ERR(eMEMORYALLOCERR);
+    }
+
+    r->sqTail = (unsigned*)((char*)r->sqRing + params.sq_off.tail);
+    r->sqMask = (unsigned*)((char*)r->sqRing + params.sq_off.ring_mask);
+    r->sqArray = (unsigned*)((char*)r->sqRing + params.sq_off.array);
+    r->cqHead = (unsigned*)((char*)r->cqRing + params.cq_off.head);
+    r->cqTail = (unsigned*)((char*)r->cqRing + params.cq_off.tail);
+    r->cqMask = (unsigned*)((char*)r->cqRing + params.cq_off.ring_mask);
+    r->cqes = (char*)r->cqRing + params.cq_off.cqes;
+
+    /*@ allocate the slots; a request is in flight in each slot taken */
+    r->slots = (BfMIOUringSlot*)malloc(sizeof(BfMIOUringSlot) * depth);
+    r->freeSlots = (Four*)malloc(sizeof(Four) * depth);
+    if (r->slots == NULL || r->freeSlots == NULL) {
+        edubfm_IOUringUnmap(r);
+        ERR(eMEMORYALLOCERR);
+    }
+    for (i = 0; i < depth; i++) r->freeSlots[i] = depth - 1 - i;
+    r->nFree = r->depth = depth;
+    r->stop = FALSE;
+
+    if (pthread_create(&r->reaper, NULL, edubfm_IOUringReaperMain, NULL) != 0) {
+        edubfm_IOUringUnmap(r);
+        ERR(eMEMORYALLOCERR);
+    }
+
+    return(eNOERROR);
+
+} /* edubfm_StartIOUring() */
+
+
+
+/*@================================
+ * edubfm_StopIOUring()
+ *================================*/
+/*
+ * Function: void edubfm_StopIOUring(void)
+ *
+ * Description:
+ *  Wait until the requests in flight are completed, stop the reaper and
+ *  tear the io_uring down. Later requests go to the workers.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_StopIOUring(void)
+{
+    BfMIOUring          *r = &edubfm_ioUring;   /* the io_uring */
+    unsigned            tail;                   /* tail of the submission queue */
+    struct io_uring_sqe *sqe;                   /* entry of the request */
+
+
+    if (r->fd < 0) return;
+
+    BFM_GETLATCH(&r->latch);
+    r->stop = TRUE;
+    while (r->nFree < r->depth)
+        pthread_cond_wait(&r->slotFreed, &r->latch);
+
+    /* a request of no operation and no slot tells the reaper to exit */
+    tail = *r->sqTail;
+    sqe = &((struct io_uring_sqe*)r->sqes)[tail & *r->sqMask];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = 0;
+    r->sqArray[tail & *r->sqMask] = tail & *r->sqMask;
+    __atomic_store_n(r->sqTail, tail + 1, __ATOMIC_RELEASE);
+    while (syscall(__NR_io_uring_enter, r->fd, 1, 0, 0, NULL, 0) < 0 && errno == EINTR);
+    BFM_RELEASELATCH(&r->latch);
+
+    pthread_join(r->reaper, NULL);
+
+    BFM_GETLATCH(&r->latch);
+    edubfm_IOUringUnmap(r);
+    BFM_RELEASELATCH(&r->latch);
+
+} /* edubfm_StopIOUring() */
+
+
+
+/*@================================
+ * edubfm_SubmitIOUring()
+ *================================*/
+/*
+ * Function: Boolean edubfm_SubmitIOUring(BfMIOHandle *)
+ *
+ * Description:
+ *  Submit a request to the io_uring, waiting for a free slot if
+ *  BFM_IOURING_DEPTH requests are in flight; the reaper does not wait but
+ *  leaves its request to the workers. The read of a train is left to the
+ *  workers if the pool has a victim or secondary cache, which the read
+ *  looks into first (see edubfm_ReadTrain()); a run read by
+ *  edubfm_ReadTrains() is not, since its trains were looked for there.
+ *
+ * Returns:
+ *  TRUE if the request is submitted, FALSE if it is to be executed by the
+ *  workers
+ */
+Boolean edubfm_SubmitIOUring(
+    BfMIOHandle         *handle)                /* INOUT request to submit */
+{
+    BfMIOUring          *r = &edubfm_ioUring;   /* the io_uring */
+    Four                type = handle->type;    /* buffer type */
+    Four                slot;                   /* slot of the request */
+    Boolean             isWrite;                /* TRUE for a write */
+    BfMIOUringSlot      s;                      /* what the slot will hold */
+    unsigned            tail;                   /* tail of the submission queue */
+    struct io_uring_sqe *sqe;                   /* entry of the request */
+    long                n;                      /* # of entries consumed by the kernel */
+
+
+    if (r->fd < 0) return(FALSE);
+
+    isWrite = (handle->op == BFM_IO_WRITE);
+    if ((handle->op == BFM_IO_READ || handle->op == BFM_IO_PREFETCH) &&
+        (bufVictimCache[type].budget > 0 || bufSecondaryCache[type].nSlots > 0 || RM_IS_ROLLBACK_REQUIRED()))
+        return(FALSE);
+
+    if (!edubfm_DiskLocate(&handle->trainId, handle->buffer, handle->nTrains, type, &s.fd, &s.offset, &s.isDirect))
+        return(FALSE);
+    s.handle = handle;
+    s.nBytes = (size_t)handle->nTrains * BI_BUFSIZE(type) * PAGESIZE;
+
+    BFM_GETLATCH(&r->latch);
+
+    /* the reaper itself submits the trains read ahead; it must not wait for a slot only it frees */
+    while (r->nFree == 0 && !r->stop && !pthread_equal(pthread_self(), r->reaper))
+        pthread_cond_wait(&r->slotFreed, &r->latch);
+    if (r->nFree == 0 || r->stop) {
+        BFM_RELEASELATCH(&r->latch);
+        return(FALSE);
+    }
+
+    slot = r->freeSlots[--r->nFree];
+    r->slots[slot] = s;
+
+    tail = *r->sqTail;
+    sqe = &((struct io_uring_sqe*)r->sqes)[tail & *r->sqMask];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = isWrite ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = s.fd;
+    sqe->off = (UEight)s.offset;
+    sqe->addr = (UEight)(size_t)handle->buffer;
+    sqe->len = (unsigned)s.nBytes;
+    sqe->user_data = (UEight)slot + 1;
+    r->sqArray[tail & *r->sqMask] = tail & *r->sqMask;
+    __atomic_store_n(r->sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    while ((n = syscall(__NR_io_uring_enter, r->fd, 1, 0, 0, NULL, 0)) < 0 && errno == EINTR);
+    if (n != 1) {
+        /* the kernel has not taken the entry, e.g. for lack of memory */
+        __atomic_store_n(r->sqTail, tail, __ATOMIC_RELEASE);
+        r->freeSlots[r->nFree++] = slot;
+        BFM_RELEASELATCH(&r->latch);
+        return(FALSE);
+    }
+
+    BFM_RELEASELATCH(&r->latch);
+
+    return(TRUE);
+
+} /* edubfm_SubmitIOUring() */
+
+
+
+/*@================================
+ * edubfm_IOUringReaperMain()
+ *================================*/
+/*
+ * Function: static void *edubfm_IOUringReaperMain(void *)
+ *
+ * Description:
+ *  Body of the reaper thread: wait for the completions posted by the
+ *  kernel and complete their requests, until the request of no slot.
+ *
+ * Returns:
+ *  NULL
+ */
+static void *edubfm_IOUringReaperMain(
+    void                *arg)                   /* IN not used */
+{
+    BfMIOUring          *r = &edubfm_ioUring;   /* the io_uring */
+    unsigned            head;                   /* head of the completion queue */
+    struct io_uring_cqe *cqe;                   /* a completion */
+    UEight              userData;               /* slot of the completion plus 1 */
+    Four                res;                    /* result of the completion */
+    Boolean             done = FALSE;           /* TRUE when the reaper is to exit */
+
+
+    (void)arg;
+
+    while (!done) {
+        if (syscall(__NR_io_uring_enter, r->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+            continue;
+
+        head = *r->cqHead;
+        while (head != __atomic_load_n(r->cqTail, __ATOMIC_ACQUIRE)) {
+            cqe = &((struct io_uring_cqe*)r->cqes)[head & *r->cqMask];
+            userData = cqe->user_data;
+            res = cqe->res;
+            __atomic_store_n(r->cqHead, ++head, __ATOMIC_RELEASE);
+
+            if (userData == 0) done = TRUE;
+            else edubfm_IOUringComplete((Four)(userData - 1), res);
+        }
+    }
+
+    return(NULL);
+
+} /* edubfm_IOUringReaperMain() */
+
+
+
+/*@================================
+ * edubfm_IOUringComplete()
+ *================================*/
+/*
+ * Function: static void edubfm_IOUringComplete(Four, Four)
+ *
+ * Description:
+ *  Complete the request of a slot whose transfer the kernel has ended with
+ *  `res', the # of bytes transferred or a negative errno. The rest of a
+ *  partial or failed transfer is done by pread/pwrite. The slot is freed.
+ *
+ * Returns:
+ *  None
+ */
+static void edubfm_IOUringComplete(
+    Four                slot,                   /* IN slot of the request */
+    Four                res)                    /* IN result of the transfer */
+{
+    Four                e = eNOERROR;           /* for error */
+    BfMIOUring          *r = &edubfm_ioUring;   /* the io_uring */
+    BfMIOUringSlot      s = r->slots[slot];     /* the request */
+    BfMIOHandle         *handle = s.handle;     /* handle of the request */
+    Four                type = handle->type;    /* buffer type */
+    Boolean             isWrite = (handle->op == BFM_IO_WRITE);
+    size_t              done;                   /* # of bytes transferred by the kernel */
+
+
+    if (res < 0 || (size_t)res < s.nBytes) {
+        done = (res < 0) ? 0 : (size_t)res;
+        e = edurdsm_DiskTransfer(s.fd, handle->buffer + done, s.nBytes - done, s.offset + done, isWrite);
+    }
+
+    if (e >= eNOERROR) {
+        if (isWrite) {
+            BFM_STATS_ADD(type, nWrites, handle->nTrains);
+            BFM_STATS_ADD(type, nWritesSaved, handle->nTrains - 1);
+        }
+        else
+            BFM_STATS_ADD(type, nReads, handle->nTrains);
+        if (s.isDirect) BFM_STATS_INC(type, nDirectIOs);
+        BFM_STATS_INC(type, nUringIOs);
+    }
+
+    BFM_GETLATCH(&r->latch);
+    r->freeSlots[r->nFree++] = slot;
+    pthread_cond_broadcast(&r->slotFreed);
+    BFM_RELEASELATCH(&r->latch);
+
+    edubfm_CompleteIO(handle, e);
+
+} /* edubfm_IOUringComplete() */
+
+
+
+/*@================================
+ * edubfm_IOUringUnmap()
+ *================================*/
+/*
+ * Function: static void edubfm_IOUringUnmap(BfMIOUring *)
+ *
+ * Description:
+ *  Free the slots, unmap the rings and close the io_uring.
+ *
+ * Returns:
+ *  None
+ */
+static void edubfm_IOUringUnmap(
+    BfMIOUring          *r)                     /* INOUT the io_uring */
+{
+    if (r->sqes != NULL && r->sqes != MAP_FAILED) munmap(r->sqes, r->sqesSize);
+    if (r->cqRing != NULL && r->cqRing != MAP_FAILED && r->cqRing != r->sqRing) munmap(r->cqRing, r->cqRingSize);
+    if (r->sqRing != NULL && r->sqRing != MAP_FAILED) munmap(r->sqRing, r->sqRingSize);
+    r->sqes = r->cqRing = r->sqRing = NULL;
+
+    free(r->slots);
+    free(r->freeSlots);
+    r->slots = NULL;
+    r->freeSlots = NULL;
+    r->nFree = r->depth = 0;
+
+    close(r->fd);
+    r->fd = -1;
+
+} /* edubfm_IOUringUnmap() */
+
+#else /* EDUBFM_IOURING */
+
+Four edubfm_StartIOUring(
+    Four                depth)                  /* IN # of requests in flight */
+{
+    return(eNOTSUPPORTED_EDUBFM);
+
+} /* edubfm_StartIOUring() */
+
+void edubfm_StopIOUring(void)
+{
+} /* edubfm_StopIOUring() */
+
+Boolean edubfm_SubmitIOUring(
+    BfMIOHandle         *handle)                /* INOUT request to submit */
+{
+    return(FALSE);
+
+} /* edubfm_SubmitIOUring() */
+
+#endif /* EDUBFM_IOURING */
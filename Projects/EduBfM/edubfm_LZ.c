@@ -0,0 +1,333 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_LZ.c
+ *
+ * Description :
+ *  A small LZ77 codec for the compressed victim cache. A compressed train
+ *  is a series of sequences, each of which is
+ *   - a token byte: the # of literals in the high nibble and the length of
+ *     the match minus BFM_LZ_MINMATCH in the low nibble; a nibble of 15 is
+ *     continued by bytes which are added to it up to a byte less than 255,
+ *   - the literals,
+ *   - the offset of the match backwards, two bytes little endian, and
+ *   - the continuation bytes of the match length.
+ *  The last sequence has literals only. Matches are found through a hash
+ *  table of the positions of 4 byte prefixes, as LZ4 does.
+ *
+ * Exports:
+ *  Four edubfm_LZCompress(char *, Four, char *, Four)
+ *  Four edubfm_LZDecompress(char *, Four, char *, Four)
+ */
+
+
+#include <string.h> /* for memcpy & memset */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * macro definitions
+ */
+#define BFM_LZ_MINMATCH     4               /* shortest match encoded */
+#define BFM_LZ_MAXOFFSET    65535           /* farthest match encoded */
+#define BFM_LZ_HASHLOG      12              /* log2 of the # of entries of the hash table */
+
+/* Macro: BFM_LZ_READ32(p)
+ * Description: return the 4 bytes at p, which need not be aligned
+ */
+#define BFM_LZ_READ32(p)    edubfm_LZRead32(p)
+
+/* Macro: MIN(a, b)
+ * Description: return the smaller of two values
+ */
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+/* Macro: BFM_LZ_HASH(v)
+ * Description: return the hash table entry of the 4 byte prefix v
+ */
+#define BFM_LZ_HASH(v)      (((v) * 2654435761U) >> (32 - BFM_LZ_HASHLOG))
+
+
+
+/*@
+ * internal function prototypes
+ */
+static Four edubfm_LZPutLength(unsigned char *, Four);
+static Four edubfm_LZGetLength(unsigned char *, Four, Four *, Four);
+
+
+
+/*@================================
+ * edubfm_LZRead32()
+ *================================*/
+/*
+ * Function: static UFour edubfm_LZRead32(unsigned char *)
+ *
+ * Description:
+ *  Return the 4 bytes at `p'; the copy is compiled into a single load.
+ */
+static UFour edubfm_LZRead32(
+    unsigned char       *p)                     /* IN bytes to read */
+{
+    UFour               v;                      /* the bytes */
+
+
+    memcpy(&v, p, sizeof(v));
+
+    return(v);
+
+} /* edubfm_LZRead32() */
+
+
+
+/*@================================
+ * edubfm_LZCompress()
+ *================================*/
+/*
+ * Function: Four edubfm_LZCompress(char *, Four, char *, Four)
+ *
+ * Description:
+ *  Compress the `n' bytes at `src' into at most `capacity' bytes at `dst'.
+ *
+ * Returns:
+ *  # of bytes of the compressed data, 0 if they do not fit in `capacity'
+ */
+Four edubfm_LZCompress(
+    char                *src,                   /* IN data to compress */
+    Four                n,                      /* IN # of bytes of the data */
+    char                *dst,                   /* OUT compressed data */
+    Four                capacity)               /* IN size of dst */
+{
+    unsigned char       *in = (unsigned char*)src;      /* data to compress */
+    unsigned char       *out = (unsigned char*)dst;     /* compressed data */
+    Four                table[1 << BFM_LZ_HASHLOG];     /* last position of each hash value */
+    Four                ip;                     /* position in the data */
+    Four                anchor;                 /* first literal not yet written */
+    Four                op;                     /* position in the compressed data */
+    Four                ref;                    /* position of a match */
+    Four                len;                    /* length of the match */
+    Four                nLits;                  /* # of literals of the sequence */
+    UFour               h;                      /* hash value */
+    unsigned char       *token;                 /* token of the sequence */
+
+
+    memset(table, 0, sizeof(table));
+
+    ip = anchor = op = 0;
+    while (ip + BFM_LZ_MINMATCH <= n) {
+        h = BFM_LZ_HASH(BFM_LZ_READ32(in + ip));
+        ref = table[h];
+        table[h] = ip;
+
+        if (ref >= ip || ip - ref > BFM_LZ_MAXOFFSET ||
+            BFM_LZ_READ32(in + ref) != BFM_LZ_READ32(in + ip)) {
+            ip++;
+            continue;
+        }
+
+        for (len = BFM_LZ_MINMATCH; ip + len < n && in[ref + len] == in[ip + len]; len++);
+
+        /* the token, the lengths, the literals and the offset must fit */
+        nLits = ip - anchor;
+        if (op + 1 + nLits / 255 + 1 + nLits + 2 + (len - BFM_LZ_MINMATCH) / 255 + 1 > capacity) return(0);
+
+        token = &out[op++];
+        *token = (unsigned char)((MIN(nLits, 15) << 4) | MIN(len - BFM_LZ_MINMATCH, 15));
+        if (nLits >= 15) op += edubfm_LZPutLength(&out[op], nLits - 15);
+        memcpy(&out[op], &in[anchor], nLits);
+        op += nLits;
+        out[op++] = (unsigned char)((ip - ref) & 0xFF);
+        out[op++] = (unsigned char)((ip - ref) >> 8);
+        if (len - BFM_LZ_MINMATCH >= 15) op += edubfm_LZPutLength(&out[op], len - BFM_LZ_MINMATCH - 15);
+
+        ip += len;
+        anchor = ip;
+    }
+
+    /* the last literals */
+    nLits = n - anchor;
+    if (op + 1 + nLits / 255 + 1 + nLits > capacity) return(0);
+    out[op++] = (unsigned char)(MIN(nLits, 15) << 4);
+    if (nLits >= 15) op += edubfm_LZPutLength(&out[op], nLits - 15);
+    memcpy(&out[op], &in[anchor], nLits);
+    op += nLits;
+
+    return(op);
+
+} /* edubfm_LZCompress() */
+
+
+
+/*@================================
+ * edubfm_LZDecompress()
+ *================================*/
+/*
+ * Function: Four edubfm_LZDecompress(char *, Four, char *, Four)
+ *
+ * Description:
+ *  Decompress the `n' bytes at `src' into the `size' bytes at `dst'. The
+ *  compressed data are checked so that a corrupted copy is not read
+ *  outside the buffers.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the data do not decompress into `size' bytes
+ */
+Four edubfm_LZDecompress(
+    char                *src,                   /* IN compressed data */
+    Four                n,                      /* IN # of bytes of the compressed data */
+    char                *dst,                   /* OUT data */
+    Four                size)                   /* IN # of bytes of the data */
+{
+    unsigned char       *in = (unsigned char*)src;      /* compressed data */
+    unsigned char       *out = (unsigned char*)dst;     /* data */
+    Four                ip;                     /* position in the compressed data */
+    Four                op;                     /* position in the data */
+    Four                nLits;                  /* # of literals of the sequence */
+    Four                len;                    /* length of the match */
+    Four                offset;                 /* offset of the match */
+    Four                token;                  /* token of the sequence */
+
+
+    ip = op = 0;
+    while (ip < n) {
+        token = in[ip++];
+
+        nLits = token >> 4;
+        if (nLits == 15) ip = edubfm_LZGetLength(in, ip, &nLits, n);
+        if (ip < 0 || ip + nLits > n || op + nLits > size) ERR(eBADPARAMETER);
+        memcpy(&out[op], &in[ip], nLits);
+        ip += nLits;
+        op += nLits;
+
+        if (ip == n) break;             /* the last sequence */
+
+        if (ip + 2 > n) ERR(eBADPARAMETER);
+        offset = in[ip] | (in[ip + 1] << 8);
+        ip += 2;
+
+        len = token & 15;
+        if (len == 15) ip = edubfm_LZGetLength(in, ip, &len, n);
+        len += BFM_LZ_MINMATCH;
+        if (ip < 0 || offset == 0 || offset > op || op + len > size) ERR(eBADPARAMETER);
+
+        /* the match may overlap the bytes it produces */
+        for (; len > 0; len--, op++) out[op] = out[op - offset];
+    }
+
+    if (op != size) ERR(eBADPARAMETER);
+
+    return(eNOERROR);
+
+} /* edubfm_LZDecompress() */
+
+
+
+/*@================================
+ * edubfm_LZPutLength()
+ *================================*/
+/*
+ * Function: static Four edubfm_LZPutLength(unsigned char *, Four)
+ *
+ * Description:
+ *  Write the continuation bytes of a length whose nibble is 15.
+ *
+ * Returns:
+ *  # of bytes written
+ */
+static Four edubfm_LZPutLength(
+    unsigned char       *out,                   /* OUT continuation bytes */
+    Four                rest)                   /* IN length minus 15 */
+{
+    Four                k;                      /* # of bytes written */
+
+
+    for (k = 0; rest >= 255; rest -= 255) out[k++] = 255;
+    out[k++] = (unsigned char)rest;
+
+    return(k);
+
+} /* edubfm_LZPutLength() */
+
+
+
+/*@================================
+ * edubfm_LZGetLength()
+ *================================*/
+/*
+ * Function: static Four edubfm_LZGetLength(unsigned char *, Four, Four *, Four)
+ *
+ * Description:
+ *  Add the continuation bytes at `ip' to a length whose nibble is 15.
+ *
+ * Returns:
+ *  position after the continuation bytes, -1 if they run past the data
+ */
+static Four edubfm_LZGetLength(
+    unsigned char       *in,                    /* IN compressed data */
+    Four                ip,                     /* IN position of the continuation bytes */
+    Four                *len,                   /* INOUT length */
+    Four                n)                      /* IN # of bytes of the compressed data */
+{
+    Four                b;                      /* continuation byte */
+
+
+    do {
+        if (ip >= n) return(-1);
+        b = in[ip++];
+        *len += b;
+    } while (b == 255);
+
+    return(ip);
+
+} /* edubfm_LZGetLength() */
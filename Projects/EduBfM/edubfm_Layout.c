@@ -0,0 +1,242 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Layout.c
+ *
+ * Description :
+ *  Dense state arrays of the buffer pools laid out as BFM_LAYOUT_SOA, and
+ *  the clock sweep over them. The sweep reads the fixed counts and the bits
+ *  of BFM_SWEEP_WIDTH buffers per step with SSE2 (or AVX2 if the module is
+ *  built with -mavx2) and visits only the unfixed buffers of the step.
+ *
+ * Exports:
+ *  Four edubfm_ClockSweep(Four, Four, Four, Four *)
+ */
+
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * macro definitions
+ */
+/* # of buffers examined at once by the clock; local to this module, since
+ * it depends on the instruction set the module is built for */
+#if defined(__AVX2__)
+#define BFM_SWEEP_WIDTH     32
+#elif defined(__SSE2__)
+#define BFM_SWEEP_WIDTH     16
+#else
+#define BFM_SWEEP_WIDTH     32
+#endif
+
+#if BFM_SWEEP_WIDTH > BFM_STATE_PAD
+#error "the state arrays are not padded for a vector of BFM_SWEEP_WIDTH buffers"
+#endif
+
+/* Macro: MIN(a, b)
+ * Description: return the smaller of two values
+ */
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+
+
+/*@
+ * global variables
+ */
+/* state arrays of each buffer pool; used under BFM_LAYOUT_SOA only */
+BfMStateArrays bufStateArrays[NUM_BUF_TYPES];
+
+/* # of buffers examined at once by the clock, for the benchmark */
+Four edubfm_sweepWidth = BFM_SWEEP_WIDTH;
+
+
+
+/*@
+ * internal function prototypes
+ */
+static void edubfm_SweepMasks(Two *, One *, UFour *, UFour *);
+
+
+
+/*@================================
+ * edubfm_ClockSweep()
+ *================================*/
+/*
+ * Function: Four edubfm_ClockSweep(Four, Four, Four, Four *)
+ *
+ * Description:
+ *  Run the second chance clock of edubfm_AllocTrain() over the `n' buffers
+ *  from `first' on, which are laid out as BFM_LAYOUT_SOA. The clock starts
+ *  at *victim and takes at most two passes: a fixed buffer is skipped, the
+ *  reference bit of an unfixed buffer is cleared, and the first unfixed
+ *  buffer whose bit is not set is the victim. Once BFM_CLOCK_BUDGET bits
+ *  are cleared the next unfixed buffer is the victim. The result is the
+ *  same as the buffer by buffer clock of edubfm_AllocTrain().
+ *  The caller must hold the latch of the partition.
+ *
+ * Returns:
+ *  # of buffers passed before the victim, 2*n if there is no unfixed buffer
+ *
+ * Side effects:
+ *  1) parameter victim
+ *     victim is set to the buffer selected
+ */
+Four edubfm_ClockSweep(
+    Four                type,                   /* IN buffer type */
+    Four                first,                  /* IN first buffer of the partition */
+    Four                n,                      /* IN # of buffers of the partition */
+    Four                *victim)                /* INOUT clock hand, then the victim */
+{
+    Two                 *fixed = bufStateArrays[type].fixed;    /* fixed counts */
+    One                 *bits = bufStateArrays[type].bits;      /* bits */
+    Four                i;                      /* # of buffers passed */
+    Four                j;                      /* buffer of the step */
+    Four                pos;                    /* first buffer of the step */
+    Four                len;                    /* # of buffers of the step */
+    Four                nCleared;               /* # of reference bits cleared */
+    UFour               unfixed;                /* bit j is set if buffer pos + j is unfixed */
+    UFour               referenced;             /* bit j is set if buffer pos + j has REFER */
+
+
+    pos = *victim;
+    nCleared = 0;
+    for (i = 0; i < 2 * n; i += len) {
+        /* a step ends at the end of the partition where the clock wraps */
+        len = MIN(BFM_SWEEP_WIDTH, MIN(first + n - pos, 2 * n - i));
+
+        edubfm_SweepMasks(&fixed[pos], &bits[pos], &unfixed, &referenced);
+        if (len < 32) unfixed &= (1U << len) - 1;
+
+        for (; unfixed != 0; unfixed &= unfixed - 1) {
+            j = __builtin_ctz(unfixed);
+            if ((referenced & (1U << j)) == 0 || nCleared >= BFM_CLOCK_BUDGET) {
+                *victim = pos + j;
+                return(i + j);
+            }
+            bits[pos + j] &= ~REFER;
+            nCleared++;
+        }
+
+        pos = (pos + len == first + n) ? first : pos + len;
+    }
+
+    *victim = pos;
+
+    return(2 * n);
+
+} /* edubfm_ClockSweep() */
+
+
+
+/*@================================
+ * edubfm_SweepMasks()
+ *================================*/
+/*
+ * Function: static void edubfm_SweepMasks(Two *, One *, UFour *, UFour *)
+ *
+ * Description:
+ *  Give the masks of the BFM_SWEEP_WIDTH buffers whose fixed counts and
+ *  bits start at `fixed' and `bits': bit j of *unfixed is set if buffer j
+ *  is not fixed, and bit j of *referenced if its REFER bit is set.
+ *
+ * Returns:
+ *  None
+ */
+static void edubfm_SweepMasks(
+    Two                 *fixed,                 /* IN fixed counts of the buffers */
+    One                 *bits,                  /* IN bits of the buffers */
+    UFour               *unfixed,               /* OUT mask of the unfixed buffers */
+    UFour               *referenced)            /* OUT mask of the referenced buffers */
+{
+#if defined(__AVX2__)
+    __m256i             zero = _mm256_setzero_si256();
+    __m256i             f0, f1, z;
+
+
+    /* the packing interleaves the 128 bit lanes, which the permutation undoes */
+    f0 = _mm256_cmpeq_epi16(_mm256_loadu_si256((__m256i*)fixed), zero);
+    f1 = _mm256_cmpeq_epi16(_mm256_loadu_si256((__m256i*)(fixed + 16)), zero);
+    z = _mm256_permute4x64_epi64(_mm256_packs_epi16(f0, f1), 0xD8);
+    *unfixed = (UFour)_mm256_movemask_epi8(z);
+
+    z = _mm256_and_si256(_mm256_loadu_si256((__m256i*)bits), _mm256_set1_epi8(REFER));
+    *referenced = ~(UFour)_mm256_movemask_epi8(_mm256_cmpeq_epi8(z, zero));
+#elif defined(__SSE2__)
+    __m128i             zero = _mm_setzero_si128();
+    __m128i             f0, f1, z;
+
+
+    f0 = _mm_cmpeq_epi16(_mm_loadu_si128((__m128i*)fixed), zero);
+    f1 = _mm_cmpeq_epi16(_mm_loadu_si128((__m128i*)(fixed + 8)), zero);
+    *unfixed = (UFour)_mm_movemask_epi8(_mm_packs_epi16(f0, f1));
+
+    z = _mm_and_si128(_mm_loadu_si128((__m128i*)bits), _mm_set1_epi8(REFER));
+    *referenced = ~(UFour)_mm_movemask_epi8(_mm_cmpeq_epi8(z, zero)) & 0xFFFF;
+#else
+    Four                j;                      /* buffer */
+
+
+    *unfixed = *referenced = 0;
+    for (j = 0; j < BFM_SWEEP_WIDTH; j++) {
+        *unfixed |= (UFour)(fixed[j] == 0) << j;
+        *referenced |= (UFour)((bits[j] & REFER) != 0) << j;
+    }
+#endif
+
+} /* edubfm_SweepMasks() */
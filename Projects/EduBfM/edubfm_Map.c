@@ -0,0 +1,144 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Map.c
+ *
+ * Description :
+ *  Trains of the volumes mapped read-only by EduBfM_MapVolume().
+ *  EduBfM_GetTrain() and the other functions fixing a train return a
+ *  pointer into the mapping of its volume instead of a buffer of the pool,
+ *  and EduBfM_FreeTrain() has nothing to unfix.
+ *
+ * Exports:
+ *  char *edubfm_MappedTrain(TrainID *, Four)
+ *  Four edubfm_DeviceOfTrain(Four *, Four, TrainID *, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * global variables
+ */
+/* volumes mapped read-only; none by default */
+BfMMappedVolumes bufMapped = { 0, { { 0 } }, PTHREAD_MUTEX_INITIALIZER };
+
+
+
+/*@================================
+ * edubfm_MappedTrain()
+ *================================*/
+/*
+ * Function: char *edubfm_MappedTrain(TrainID *, Four)
+ *
+ * Description:
+ *  Find the train in the mapping of its volume. A train which does not lie
+ *  within one device of a mapped volume is not found.
+ *
+ * Returns:
+ *  pointer to the train in the mapping, NULL if its volume is not mapped
+ */
+char *edubfm_MappedTrain(
+    TrainID             *trainId,               /* IN train to be found */
+    Four                type)                   /* IN buffer type */
+{
+    Four                i;                      /* index */
+    Four                d;                      /* device holding the train */
+    BfMMappedVolume     *v;                     /* a mapped volume */
+
+
+    for (i = 0; i < MAXNUMOFMAPPEDVOLUMES; i++) {
+        v = &bufMapped.volumes[i];
+        if (v->nDevices == 0 || v->volNo != trainId->volNo) continue;
+
+        d = edubfm_DeviceOfTrain(v->firstPage, v->nDevices, trainId, BI_BUFSIZE(type));
+        if (d == NIL) return(NULL);
+
+        return(v->base[d] + (size_t)(trainId->pageNo - v->firstPage[d]) * PAGESIZE);
+    }
+
+    return(NULL);
+
+} /* edubfm_MappedTrain() */
+
+
+
+/*@================================
+ * edubfm_DeviceOfTrain()
+ *================================*/
+/*
+ * Function: Four edubfm_DeviceOfTrain(Four *, Four, TrainID *, Four)
+ *
+ * Description:
+ *  Find the device holding the `nPages' pages from the given train on, the
+ *  devices of the volume starting at the pages `firstPage'.
+ *
+ * Returns:
+ *  the device, NIL if the pages do not lie within one device
+ */
+Four edubfm_DeviceOfTrain(
+    Four                *firstPage,             /* IN first page of each device, then the # of pages */
+    Four                nDevices,               /* IN # of devices */
+    TrainID             *trainId,               /* IN first train */
+    Four                nPages)                 /* IN # of pages */
+{
+    Four                d;                      /* device */
+
+
+    for (d = 0; d < nDevices; d++)
+        if (trainId->pageNo < firstPage[d + 1]) break;
+    if (d == nDevices || trainId->pageNo < firstPage[d] ||
+        trainId->pageNo + nPages > firstPage[d + 1]) return(NIL);
+
+    return(d);
+
+} /* edubfm_DeviceOfTrain() */
@@ -0,0 +1,342 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_OpenHash.c
+ *
+ * Description:
+ *  An open addressing hash table mapping a BfMHashKey to an index of the
+ *  buffer table. Keys and indexes are packed into buckets of one cache line
+ *  (BFM_OPENHASH_BUCKETSIZE slots each), so that a lookup which hits touches
+ *  only one cache line and never visits the buffer table.
+ *  Keys are scrambled by multiplicative hashing and a key whose home bucket
+ *  is full is put into the next bucket having an empty slot. Each bucket
+ *  counts the keys which passed over it, so that a lookup stops as soon as
+ *  no key can be found further.
+ *
+ * Exports:
+ *  Four edubfm_OpenHashCreate(BfMOpenHashTable *, Four)
+ *  Four edubfm_OpenHashDestroy(BfMOpenHashTable *)
+ *  Four edubfm_OpenHashClear(BfMOpenHashTable *)
+ *  Four edubfm_OpenHashLookUp(BfMOpenHashTable *, BfMHashKey *)
+ *  Four edubfm_OpenHashInsert(BfMOpenHashTable *, BfMHashKey *, Four)
+ *  Four edubfm_OpenHashDelete(BfMOpenHashTable *, BfMHashKey *)
+ */
+
+
+#include <stdlib.h> /* for posix_memalign & free */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * macro definitions
+ */
+
+/* Macro: BFM_OPENHASH(k,shift)
+ * Description: return the home bucket of the key given as a parameter
+ *  (Fibonacci hashing: the high bits of the product are used)
+ * Parameters:
+ *  BfMHashKey *k   : pointer to the key
+ *  Four shift      : 32 - log2(# of buckets)
+ * Returns: (UFour) home bucket
+ */
+#define BFM_OPENHASH(k,shift) \
+    ((((UFour)(k)->pageNo ^ ((UFour)(k)->volNo << 20)) * 0x9E3779B1U) >> (shift))
+
+
+
+/*@================================
+ * edubfm_OpenHashCreate()
+ *================================*/
+/*
+ * Function: Four edubfm_OpenHashCreate(BfMOpenHashTable *, Four)
+ *
+ * Description:
+ *  Allocate an empty table which can hold `nEntries' keys.
+ *  The number of buckets is a power of two chosen to keep the slots at
+ *  most 3/4 full.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad number of entries
+ *    eMEMORYALLOCERR - memory allocation failed
+ */
+Four edubfm_OpenHashCreate(
+    BfMOpenHashTable    *table,                 /* OUT table to create */
+    Four                nEntries)               /* IN # of keys to hold */
+{
+    Four                e;                      /* for error */
+    Four                log2;                   /* log2(# of buckets) */
+
+
+    if (nEntries <= 0) ERR(eBADPARAMETER);
+
+    for (log2 = 1; (1 << log2) * BFM_OPENHASH_BUCKETSIZE * 3 < nEntries * 4; log2++);
+
+    table->nBuckets = 1 << log2;
+    table->shift = 32 - log2;
+
+    if (posix_memalign((void **)&table->buckets, BFM_CACHELINESIZE,
+                       sizeof(BfMHashBucket) * table->nBuckets) != 0) {
+        table->buckets = NULL;
+        ERR(eMEMORYALLOCERR);
+    }
+
+    e = edubfm_OpenHashClear(table);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubfm_OpenHashCreate() */
+
+
+
+/*@================================
+ * edubfm_OpenHashDestroy()
+ *================================*/
+/*
+ * Function: Four edubfm_OpenHashDestroy(BfMOpenHashTable *)
+ *
+ * Description:
+ *  Free the memory of the table.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_OpenHashDestroy(
+    BfMOpenHashTable    *table)                 /* INOUT table to destroy */
+{
+    free(table->buckets);
+    table->buckets = NULL;
+    table->nBuckets = 0;
+
+    return(eNOERROR);
+
+} /* edubfm_OpenHashDestroy() */
+
+
+
+/*@================================
+ * edubfm_OpenHashClear()
+ *================================*/
+/*
+ * Function: Four edubfm_OpenHashClear(BfMOpenHashTable *)
+ *
+ * Description:
+ *  Delete all keys of the table.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_OpenHashClear(
+    BfMOpenHashTable    *table)                 /* INOUT table to clear */
+{
+    Four                b;                      /* bucket number */
+    Four                s;                      /* slot number */
+
+
+    for (b = 0; b < table->nBuckets; b++) {
+        for (s = 0; s < BFM_OPENHASH_BUCKETSIZE; s++) {
+            table->buckets[b].pageNo[s] = NIL;
+            table->buckets[b].index[s] = NOTFOUND_IN_HTABLE;
+        }
+        table->buckets[b].nOverflows = 0;
+    }
+
+    return(eNOERROR);
+
+} /* edubfm_OpenHashClear() */
+
+
+
+/*@================================
+ * edubfm_OpenHashLookUp()
+ *================================*/
+/*
+ * Function: Four edubfm_OpenHashLookUp(BfMOpenHashTable *, BfMHashKey *)
+ *
+ * Description:
+ *  Look up the given key in the table and return its corresponding index
+ *  to the buffer table.
+ *
+ * Returns:
+ *  index on buffer table entry holding the train specified by 'key'
+ *  (NOTFOUND_IN_HTABLE - The key don't exist in the hash table.)
+ */
+Four edubfm_OpenHashLookUp(
+    BfMOpenHashTable    *table,                 /* IN table */
+    BfMHashKey          *key)                   /* IN a hash key in Buffer Manager */
+{
+    UFour               b;                      /* bucket number */
+    Four                s;                      /* slot number */
+    UFour               match;                  /* bit s is set if slot s holds the key */
+    BfMHashBucket       *bucket;                /* pointer to a bucket */
+
+
+    b = BFM_OPENHASH(key, table->shift);
+    for (;;) {
+        bucket = &table->buckets[b];
+
+        /* compare the pageNos of all slots without branching, then check
+           the volNo of the candidates; an empty slot has NIL pageNo */
+        match = 0;
+        for (s = 0; s < BFM_OPENHASH_BUCKETSIZE; s++)
+            match |= (UFour)(bucket->pageNo[s] == key->pageNo) << s;
+        for (; match != 0; match &= match - 1) {
+            s = __builtin_ctz(match);
+            if (bucket->volNo[s] == key->volNo) return(bucket->index[s]);
+        }
+
+        if (bucket->nOverflows == 0) return(NOTFOUND_IN_HTABLE);
+        b = (b + 1) & (table->nBuckets - 1);
+    }
+
+} /* edubfm_OpenHashLookUp() */
+
+
+
+/*@================================
+ * edubfm_OpenHashInsert()
+ *================================*/
+/*
+ * Function: Four edubfm_OpenHashInsert(BfMOpenHashTable *, BfMHashKey *, Four)
+ *
+ * Description:
+ *  Insert a new entry into the table. If the home bucket of the key is
+ *  full, the entry is put into the next bucket having an empty slot and
+ *  the overflow counters of the buckets passed over are incremented.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFINDEX_BFM - the table is full
+ */
+Four edubfm_OpenHashInsert(
+    BfMOpenHashTable    *table,                 /* INOUT table */
+    BfMHashKey          *key,                   /* IN a hash key in Buffer Manager */
+    Four                index)                  /* IN an index used in the buffer pool */
+{
+    UFour               b;                      /* bucket number */
+    Four                s;                      /* slot number */
+    Four                i;                      /* # of buckets visited */
+    BfMHashBucket       *bucket;                /* pointer to a bucket */
+
+
+    b = BFM_OPENHASH(key, table->shift);
+    for (i = 0; i < table->nBuckets; i++) {
+        bucket = &table->buckets[b];
+        for (s = 0; s < BFM_OPENHASH_BUCKETSIZE; s++) {
+            if (bucket->index[s] == NOTFOUND_IN_HTABLE) {
+                bucket->pageNo[s] = key->pageNo;
+                bucket->volNo[s] = key->volNo;
+                bucket->index[s] = index;
+
+                /* count this key in the buckets it passed over */
+                b = BFM_OPENHASH(key, table->shift);
+                for (; i > 0; i--) {
+                    table->buckets[b].nOverflows++;
+                    b = (b + 1) & (table->nBuckets - 1);
+                }
+
+                return(eNOERROR);
+            }
+        }
+        b = (b + 1) & (table->nBuckets - 1);
+    }
+
+    ERR(eBADBUFINDEX_BFM);
+
+} /* edubfm_OpenHashInsert() */
+
+
+
+/*@================================
+ * edubfm_OpenHashDelete()
+ *================================*/
+/*
+ * Function: Four edubfm_OpenHashDelete(BfMOpenHashTable *, BfMHashKey *)
+ *
+ * Description:
+ *  Look up the entry which corresponds to `key' and delete the entry from
+ *  the table.
+ *
+ * Returns:
+ *  error code
+ *    eNOTFOUND_BFM - The key isn't in the hash table.
+ */
+Four edubfm_OpenHashDelete(
+    BfMOpenHashTable    *table,                 /* INOUT table */
+    BfMHashKey          *key)                   /* IN a hash key in Buffer Manager */
+{
+    UFour               home;                   /* home bucket of the key */
+    UFour               b;                      /* bucket number */
+    Four                s;                      /* slot number */
+    BfMHashBucket       *bucket;                /* pointer to a bucket */
+
+
+    home = b = BFM_OPENHASH(key, table->shift);
+    for (;;) {
+        bucket = &table->buckets[b];
+        for (s = 0; s < BFM_OPENHASH_BUCKETSIZE; s++) {
+            if (bucket->pageNo[s] == key->pageNo && bucket->volNo[s] == key->volNo) {
+                bucket->pageNo[s] = NIL;
+                bucket->index[s] = NOTFOUND_IN_HTABLE;
+
+                for (; home != b; home = (home + 1) & (table->nBuckets - 1))
+                    table->buckets[home].nOverflows--;
+
+                return(eNOERROR);
+            }
+        }
+
+        if (bucket->nOverflows == 0) ERR(eNOTFOUND_BFM);
+        b = (b + 1) & (table->nBuckets - 1);
+    }
+
+} /* edubfm_OpenHashDelete() */
@@ -0,0 +1,484 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Partition.c
+ *
+ * Description :
+ *  Split a buffer pool into partitions.
+ *  Each partition owns a disjoint range of buffer elements together with
+ *  its own latch, clock hand and hash table. A train is always kept in the
+ *  partition selected by its hash key.
+ *
+ * Exports:
+ *  Four edubfm_InitPartitions(Four, Four)
+ *  Four edubfm_ResizePartitions(Four, Four)
+ *  Four edubfm_FinalPartitions(Four)
+ *  Four edubfm_EmptyPool(Four)
+ *  Four edubfm_PartitionOfKey(BfMHashKey *, Four)
+ *  Four edubfm_PartitionOfBuf(Four, Four)
+ *  void edubfm_PartitionRange(Four, Four, Four, Four *, Four *)
+ */
+
+
+#include <stdlib.h> /* for calloc, realloc & free */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * global variables
+ */
+/* partition information of each buffer pool; not partitioned by default */
+BufferPartitionInfo bufPartInfo[NUM_BUF_TYPES] = {
+    { 0, NULL, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, BFM_HASH_CHAINED, { 0, 0, NULL }, BFM_POLICY_CLOCK, NULL, FALSE },
+    { 0, NULL, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, BFM_HASH_CHAINED, { 0, 0, NULL }, BFM_POLICY_CLOCK, NULL, FALSE }
+};
+
+/* RDsM is not reentrant, so every transfer passed to RDsM is done holding this latch */
+pthread_mutex_t edubfm_ioLatch = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+/*@================================
+ * edubfm_InitPartitions()
+ *================================*/
+/*
+ * Function: Four edubfm_InitPartitions(Four, Four)
+ *
+ * Description:
+ *  Split the buffer pool of the given type into `nPartitions' partitions.
+ *  The buffer elements are divided as by edubfm_PartitionRange(). If `nPartitions' is less than 2, the pool is not partitioned
+ *  and the global hash table and clock hand in bufInfo[type] are used.
+ *  The hash tables are built according to BI_HASHMETHOD(type), and the
+ *  states of the replacement policy according to BI_POLICY(type). The
+ *  buffers of the partitions are bound to NUMA nodes if so requested by
+ *  EduBfM_SetPoolAllocation().
+ *  The buffer pool must be empty, i.e. no buffer element holds a train.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - bad number of partitions
+ *    eMEMORYALLOCERR - memory allocation failed
+ */
+Four edubfm_InitPartitions(
+    Four                type,                   /* IN buffer type */
+    Four                nPartitions)            /* IN # of partitions */
+{
+    Four                e;                      /* for error */
+    Four                p;                      /* partition number */
+    Four                i;                      /* index */
+    Four                first;                  /* index of the first buffer element of a partition */
+    Four                n;                      /* # of buffer elements of a partition */
+    BufferPartition     *part;                  /* pointer to a partition */
+
+
+    if (nPartitions < 0 || nPartitions > MAXNUMOFPARTITIONS || nPartitions > BI_NBUFS(type))
+        ERR(eBADPARAMETER);
+
+    e = edubfm_FinalPartitions(type);
+    if (e < eNOERROR) ERR(e);
+
+    edubfm_InvalidateFreeList(type);
+
+    if (nPartitions < 2) {
+        for (i = 0; i < HASHTABLESIZE(type); i++)
+            BI_HASHTABLEENTRY(type, i) = NOTFOUND_IN_HTABLE;
+        BI_NEXTVICTIM(type) = 0;
+
+        if (BI_HASHMETHOD(type) == BFM_HASH_OPEN) {
+            e = edubfm_OpenHashCreate(&bufPartInfo[type].openHashTable, BI_NBUFS(type));
+            if (e < eNOERROR) ERR(e);
+        }
+
+        e = edubfm_InitPolicy(type, 0);
+        if (e < eNOERROR) ERR(e);
+
+        edubfm_BindArena(type);
+
+        return(eNOERROR);
+    }
+
+    bufPartInfo[type].partitions = (BufferPartition*)calloc(nPartitions, sizeof(BufferPartition));
+    if (bufPartInfo[type].partitions == NULL) ERR(eMEMORYALLOCERR);
+    bufPartInfo[type].nPartitions = nPartitions;
+
+    for (p = 0; p < nPartitions; p++) {
+        pthread_mutex_init(&BI_PARTITION(type, p).latch, NULL);
+        pthread_cond_init(&BI_PARTITION(type, p).ioDone, NULL);
+    }
+
+    for (p = 0; p < nPartitions; p++) {
+        part = &BI_PARTITION(type, p);
+
+        edubfm_PartitionRange(BI_NBUFS(type), nPartitions, p, &first, &n);
+        part->firstBuf = first;
+        part->nBufs = n;
+        part->nextVictim = part->firstBuf;
+        part->evicting = FALSE;
+
+        part->hashTableSize = HASHTABLESIZE_TO_NBUFS(part->nBufs);
+        part->hashTable = (Two*)malloc(sizeof(Two) * part->hashTableSize);
+        if (part->hashTable == NULL) {
+            edubfm_FinalPartitions(type);
+            ERR(eMEMORYALLOCERR);
+        }
+        for (i = 0; i < part->hashTableSize; i++)
+            part->hashTable[i] = NOTFOUND_IN_HTABLE;
+
+        if (BI_HASHMETHOD(type) == BFM_HASH_OPEN) {
+            e = edubfm_OpenHashCreate(&part->openHashTable, part->nBufs);
+            if (e < eNOERROR) {
+                edubfm_FinalPartitions(type);
+                ERR(e);
+            }
+        }
+
+        e = edubfm_InitPolicy(type, p);
+        if (e < eNOERROR) {
+            edubfm_FinalPartitions(type);
+            ERR(e);
+        }
+    }
+
+    edubfm_BindArena(type);
+
+    return(eNOERROR);
+
+} /* edubfm_InitPartitions() */
+
+
+
+/*@================================
+ * edubfm_ResizePartitions()
+ *================================*/
+/*
+ * Function: Four edubfm_ResizePartitions(Four, Four)
+ *
+ * Description:
+ *  Change the number of buffer elements of the pool of the given type to
+ *  `nBufs', keeping its partitions together with their latches, which the
+ *  caller holds. The ranges of the partitions are recomputed by
+ *  edubfm_PartitionRange(), and every train in the pool must already be
+ *  in the new range of its partition. The hash tables and the states of
+ *  the replacement policy are rebuilt for the new ranges, and the trains
+ *  are entered again; the policy takes them as just loaded, in the order
+ *  of their buffers. The memory of the pool must have room for `nBufs'
+ *  buffer elements.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four edubfm_ResizePartitions(
+    Four                type,                   /* IN buffer type */
+    Four                nBufs)                  /* IN new # of buffer elements */
+{
+    Four                e;                      /* for error */
+    Four                p;                      /* partition number */
+    Four                i;                      /* index */
+    Four                first;                  /* index of the first buffer element of a partition */
+    Four                n;                      /* # of buffer elements of a partition */
+    Two                 *hashTable;             /* hash table of a partition */
+    BufferPartition     *part;                  /* pointer to a partition */
+
+
+    BI_NBUFS(type) = nBufs;
+    edubfm_InvalidateFreeList(type);
+
+    if (!BI_PARTITIONED(type)) {
+        for (i = 0; i < HASHTABLESIZE(type); i++)
+            BI_HASHTABLEENTRY(type, i) = NOTFOUND_IN_HTABLE;
+        if (BI_NEXTVICTIM(type) >= nBufs) BI_NEXTVICTIM(type) = 0;
+
+        if (BI_HASHMETHOD(type) == BFM_HASH_OPEN) {
+            edubfm_OpenHashDestroy(&bufPartInfo[type].openHashTable);
+            e = edubfm_OpenHashCreate(&bufPartInfo[type].openHashTable, nBufs);
+            if (e < eNOERROR) ERR(e);
+        }
+    }
+
+    for (p = 0; p < BI_NPARTITIONS(type) && BI_PARTITIONED(type); p++) {
+        part = &BI_PARTITION(type, p);
+
+        edubfm_PartitionRange(nBufs, BI_NPARTITIONS(type), p, &first, &n);
+        hashTable = (Two*)realloc(part->hashTable, sizeof(Two) * HASHTABLESIZE_TO_NBUFS(n));
+        if (hashTable == NULL) ERR(eMEMORYALLOCERR);
+
+        part->firstBuf = first;
+        part->nBufs = n;
+        part->nextVictim = part->firstBuf;
+        part->hashTable = hashTable;
+        part->hashTableSize = HASHTABLESIZE_TO_NBUFS(n);
+        for (i = 0; i < part->hashTableSize; i++)
+            part->hashTable[i] = NOTFOUND_IN_HTABLE;
+
+        if (BI_HASHMETHOD(type) == BFM_HASH_OPEN) {
+            edubfm_OpenHashDestroy(&part->openHashTable);
+            e = edubfm_OpenHashCreate(&part->openHashTable, n);
+            if (e < eNOERROR) ERR(e);
+        }
+    }
+
+    for (p = 0; p < BI_NPARTITIONS(type); p++) {
+        e = edubfm_InitPolicy(type, p);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    for (i = 0; i < nBufs; i++) {
+        if (IS_NILBFMHASHKEY(BI_KEY(type, i))) continue;
+
+        p = BI_PARTITIONOFKEY(type, &BI_KEY(type, i));
+
+        e = edubfm_Insert(&BI_KEY(type, i), i, type);
+        if (e < eNOERROR) ERR(e);
+
+        e = edubfm_PolicyMiss(type, p, &BI_KEY(type, i));
+        if (e < eNOERROR) ERR(e);
+
+        e = edubfm_PolicyLoad(type, p, i);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    edubfm_BindArena(type);
+
+    return(eNOERROR);
+
+} /* edubfm_ResizePartitions() */
+
+
+
+/*@================================
+ * edubfm_FinalPartitions()
+ *================================*/
+/*
+ * Function: Four edubfm_FinalPartitions(Four)
+ *
+ * Description:
+ *  Free the partitions, the open addressing hash tables and the states of
+ *  the replacement policy of the buffer pool of the given type.
+ *  After this call the pool is not partitioned.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_FinalPartitions(
+    Four                type)                   /* IN buffer type */
+{
+    Four                p;                      /* partition number */
+
+
+    edubfm_OpenHashDestroy(&bufPartInfo[type].openHashTable);
+
+    if (bufPartInfo[type].partitions == NULL) return(edubfm_FinalPolicy(type, 0));
+
+    for (p = 0; p < bufPartInfo[type].nPartitions; p++) {
+        edubfm_FinalPolicy(type, p);
+        free(bufPartInfo[type].partitions[p].hashTable);
+        edubfm_OpenHashDestroy(&bufPartInfo[type].partitions[p].openHashTable);
+        pthread_mutex_destroy(&bufPartInfo[type].partitions[p].latch);
+        pthread_cond_destroy(&bufPartInfo[type].partitions[p].ioDone);
+    }
+    free(bufPartInfo[type].partitions);
+
+    bufPartInfo[type].partitions = NULL;
+    bufPartInfo[type].nPartitions = 0;
+
+    return(eNOERROR);
+
+} /* edubfm_FinalPartitions() */
+
+
+
+/*@================================
+ * edubfm_EmptyPool()
+ *================================*/
+/*
+ * Function: Four edubfm_EmptyPool(Four)
+ *
+ * Description:
+ *  Flush the dirty trains of the buffer pool of the given type and discard
+ *  all of its trains, so that the layout of the pool can be rebuilt.
+ *  No train may be fixed, and no other thread may use the pool.
+ *
+ * Returns:
+ *  error code
+ *    eFLUSHFIXEDBUF_BFM - some train in the pool is fixed
+ *    some errors caused by function calls
+ */
+Four edubfm_EmptyPool(
+    Four                type)                   /* IN buffer type */
+{
+    Four                e;                      /* for error */
+    Two                 i;                      /* index */
+
+
+    for (i = 0; i < BI_NBUFS(type); i++)
+        if (BI_FIXED(type, i) > 0) ERR(eFLUSHFIXEDBUF_BFM);
+
+    for (i = 0; i < BI_NBUFS(type); i++) {
+        if (IS_NILBFMHASHKEY(BI_KEY(type, i))) continue;
+
+        if (BI_BITS(type, i) & DIRTY) {
+            e = edubfm_FlushTrain(&BI_KEY(type, i), type);
+            if (e < eNOERROR) ERR(e);
+        }
+
+        SET_NILBFMHASHKEY(BI_KEY(type, i));
+        BI_BITS(type, i) = ALL_0;
+        BI_NEXTHASHENTRY(type, i) = NIL;
+    }
+
+    edubfm_InvalidateFreeList(type);
+
+    return(eNOERROR);
+
+} /* edubfm_EmptyPool() */
+
+
+
+/*@================================
+ * edubfm_PartitionRange()
+ *================================*/
+/*
+ * Function: void edubfm_PartitionRange(Four, Four, Four, Four *, Four *)
+ *
+ * Description:
+ *  Give the range of buffer elements owned by partition p when a pool of
+ *  `nBufs' buffer elements is split into `nPartitions' partitions. The
+ *  buffer elements are divided evenly and the last partition takes the
+ *  remainder; a pool of less than 2 partitions is a single range.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_PartitionRange(
+    Four                nBufs,                  /* IN # of buffer elements of the pool */
+    Four                nPartitions,            /* IN # of partitions */
+    Four                p,                      /* IN partition number */
+    Four                *first,                 /* OUT index of the first buffer element */
+    Four                *n)                     /* OUT # of buffer elements */
+{
+    Four                partSize;               /* # of buffer elements per partition */
+
+
+    if (nPartitions < 2) {
+        *first = 0;
+        *n = nBufs;
+        return;
+    }
+
+    partSize = nBufs / nPartitions;
+    *first = p * partSize;
+    *n = (p == nPartitions - 1) ? nBufs - *first : partSize;
+
+} /* edubfm_PartitionRange() */
+
+
+
+/*@================================
+ * edubfm_PartitionOfKey()
+ *================================*/
+/*
+ * Function: Four edubfm_PartitionOfKey(BfMHashKey *, Four)
+ *
+ * Description:
+ *  Return the partition which the train having the given key belongs to.
+ *  The key is scrambled before taking the modulus so that consecutive
+ *  pages are spread over all partitions.
+ *
+ * Returns:
+ *  partition number
+ */
+Four edubfm_PartitionOfKey(
+    BfMHashKey          *key,                   /* IN a hash key in Buffer Manager */
+    Four                type)                   /* IN buffer type */
+{
+    UFour               h;                      /* scrambled key */
+
+
+    h = ((UFour)key->volNo << 16) ^ (UFour)key->pageNo;
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+
+    return(h % BI_NPARTITIONS(type));
+
+} /* edubfm_PartitionOfKey() */
+
+
+
+/*@================================
+ * edubfm_PartitionOfBuf()
+ *================================*/
+/*
+ * Function: Four edubfm_PartitionOfBuf(Four, Four)
+ *
+ * Description:
+ *  Return the partition owning the given buffer element.
+ *
+ * Returns:
+ *  partition number
+ */
+Four edubfm_PartitionOfBuf(
+    Four                index,                  /* IN index of the buffer element */
+    Four                type)                   /* IN buffer type */
+{
+    Four                p;                      /* partition number */
+
+
+    p = index / BI_PARTITION(type, 0).nBufs;
+    if (p >= BI_NPARTITIONS(type)) p = BI_NPARTITIONS(type) - 1;
+
+    return(p);
+
+} /* edubfm_PartitionOfBuf() */
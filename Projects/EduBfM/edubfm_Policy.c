@@ -0,0 +1,973 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Policy.c
+ *
+ * Description :
+ *  Replacement policies other than the second chance clock of
+ *  edubfm_AllocTrain(). The policy is selected per buffer type and its
+ *  state covers the buffers of one partition (or of the unpartitioned pool).
+ *  The buffer manager informs the policy of every access:
+ *   - edubfm_PolicyHit() when a train is found in the pool,
+ *   - edubfm_PolicyMiss() when a train is not found, before allocating,
+ *   - edubfm_PolicyVictim() to choose the buffer to replace, and
+ *   - edubfm_PolicyLoad() when the train has been read into the buffer.
+ *  The caller must hold the latch of the partition.
+ *
+ *  BFM_POLICY_LRUK : LRU-2. The victim is the unfixed buffer whose second
+ *                    last reference is the oldest; a train referenced only
+ *                    once is chosen first. The last reference time of
+ *                    evicted trains is retained in ghosts.
+ *  BFM_POLICY_2Q   : 2Q. A train enters the FIFO A1in; when evicted from
+ *                    A1in its key is kept in A1out, and a train found in
+ *                    A1out enters the LRU list Am.
+ *  BFM_POLICY_ARC  : ARC. Recency (T1) and frequency (T2) lists with the
+ *                    ghost lists B1 and B2 which adapt the target size of T1.
+ *
+ * Exports:
+ *  Four edubfm_InitPolicy(Four, Four)
+ *  Four edubfm_FinalPolicy(Four, Four)
+ *  Four edubfm_PolicyReset(Four, Four)
+ *  Four edubfm_PolicyHit(Four, Four, Four)
+ *  Four edubfm_PolicyMiss(Four, Four, BfMHashKey *)
+ *  Four edubfm_PolicyVictim(Four, Four)
+ *  Four edubfm_PolicyLoad(Four, Four, Four)
+ *  Four edubfm_PolicyDrop(Four, Four, Four)
+ *  Four edubfm_PolicyKeep(Four, Four, Four)
+ *  void edubfm_PolicyHotness(Four, Four, UFour *)
+ */
+
+
+#include <stdlib.h> /* for calloc, malloc & free */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * constant definitions
+ */
+/* lists common to all policies */
+#define POLICY_FREE         0   /* buffers holding no train */
+#define POLICY_FREEGHOST    1   /* unused ghosts */
+
+/* lists of BFM_POLICY_LRUK */
+#define LRUK_RESIDENT       2   /* buffers holding a train */
+#define LRUK_HISTORY        3   /* ghosts retaining the history of evicted trains */
+
+/* lists of BFM_POLICY_2Q */
+#define Q2_A1IN             2   /* buffers referenced once, FIFO */
+#define Q2_AM               3   /* buffers referenced again, LRU */
+#define Q2_A1OUT            4   /* ghosts of trains evicted from A1in, FIFO */
+
+/* lists of BFM_POLICY_ARC */
+#define ARC_T1              2   /* buffers referenced once recently */
+#define ARC_T2              3   /* buffers referenced at least twice recently */
+#define ARC_B1              4   /* ghosts of trains evicted from T1 */
+#define ARC_B2              5   /* ghosts of trains evicted from T2 */
+
+
+
+/*@
+ * macro definitions
+ */
+/* Macro: MAX(a, b) and MIN(a, b)
+ * Description: return the larger and the smaller of two values
+ */
+#ifndef MAX
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+/* Macro: POLICY_UNFIXED(type, s, node)
+ * Description: check whether the buffer of a node is unfixed
+ * Parameters:
+ *  Four type           : buffer type
+ *  BfMPolicyState *s   : policy state
+ *  Four node           : node of a buffer
+ * Returns: (Boolean) TRUE if the buffer is not fixed
+ */
+#define POLICY_UNFIXED(type, s, node) (BI_FIXED(type, (s)->firstBuf + (node)) == 0)
+
+/* Macro: POLICY_LRUKOLDER(s, a, b)
+ * Description: check whether node a should be evicted before node b by LRU-2
+ * Parameters:
+ *  BfMPolicyState *s   : policy state
+ *  Four a, b           : nodes of buffers
+ * Returns: (Boolean) TRUE if the backward 2-distance of a is larger
+ */
+#define POLICY_LRUKOLDER(s, a, b) \
+    ((s)->hist[2*(a)+1] < (s)->hist[2*(b)+1] || \
+     ((s)->hist[2*(a)+1] == (s)->hist[2*(b)+1] && (s)->hist[2*(a)] < (s)->hist[2*(b)]))
+
+
+
+/*@
+ * internal function prototypes
+ */
+static void policy_Remove(BfMPolicyState *, Four);
+static void policy_PushHead(BfMPolicyState *, Four, Four);
+static Four policy_UnfixedFromTail(BfMPolicyState *, Four, Four);
+static Four policy_AddGhost(BfMPolicyState *, Four, BfMHashKey *, UFour);
+static Four policy_DropGhost(BfMPolicyState *, Four);
+static void policy_Rank(BfMPolicyState *, Four, UFour *, UFour *);
+
+
+
+/*@================================
+ * edubfm_InitPolicy()
+ *================================*/
+/*
+ * Function: Four edubfm_InitPolicy(Four, Four)
+ *
+ * Description:
+ *  Create the state of the replacement policy BI_POLICY(type) for the
+ *  given partition. Nothing is created for BFM_POLICY_CLOCK and
+ *  BFM_POLICY_CLEANFIRST, which keep their state in the clock hand of the
+ *  partition.
+ *  The buffers of the partition must hold no train.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR - memory allocation failed
+ */
+Four edubfm_InitPolicy(
+    Four                type,                   /* IN buffer type */
+    Four                part)                   /* IN partition number */
+{
+    Four                e;                      /* for error */
+    Four                n;                      /* # of buffers of the partition */
+    BfMPolicyState      *s;                     /* state of the policy */
+
+
+    e = edubfm_FinalPolicy(type, part);
+    if (e < eNOERROR) ERR(e);
+
+    if (BI_POLICY(type) == BFM_POLICY_CLOCK || BI_POLICY(type) == BFM_POLICY_CLEANFIRST) return(eNOERROR);
+
+    n = BI_PARTNBUFS(type, part);
+
+    s = (BfMPolicyState*)calloc(1, sizeof(BfMPolicyState));
+    if (s == NULL) ERR(eMEMORYALLOCERR);
+    BI_PARTPOLICYSTATE(type, part) = s;
+
+    s->policy = BI_POLICY(type);
+    s->firstBuf = BI_PARTFIRSTBUF(type, part);
+    s->nBufs = n;
+
+    s->prev = (Four*)malloc(sizeof(Four) * 2 * n);
+    s->next = (Four*)malloc(sizeof(Four) * 2 * n);
+    s->where = (One*)malloc(sizeof(One) * 2 * n);
+    s->ghostKey = (BfMHashKey*)malloc(sizeof(BfMHashKey) * n);
+    if (s->policy == BFM_POLICY_LRUK)
+        s->hist = (UFour*)malloc(sizeof(UFour) * 2 * 2 * n);
+
+    if (s->prev == NULL || s->next == NULL || s->where == NULL || s->ghostKey == NULL ||
+        (s->policy == BFM_POLICY_LRUK && s->hist == NULL)) {
+        edubfm_FinalPolicy(type, part);
+        ERR(eMEMORYALLOCERR);
+    }
+
+    e = edubfm_OpenHashCreate(&s->ghostTable, n);
+    if (e < eNOERROR) {
+        edubfm_FinalPolicy(type, part);
+        ERR(e);
+    }
+
+    e = edubfm_PolicyReset(type, part);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubfm_InitPolicy() */
+
+
+
+/*@================================
+ * edubfm_FinalPolicy()
+ *================================*/
+/*
+ * Function: Four edubfm_FinalPolicy(Four, Four)
+ *
+ * Description:
+ *  Free the state of the replacement policy of the given partition.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_FinalPolicy(
+    Four                type,                   /* IN buffer type */
+    Four                part)                   /* IN partition number */
+{
+    BfMPolicyState      *s;                     /* state of the policy */
+
+
+    s = BI_PARTPOLICYSTATE(type, part);
+    if (s == NULL) return(eNOERROR);
+
+    free(s->prev);
+    free(s->next);
+    free(s->where);
+    free(s->ghostKey);
+    free(s->hist);
+    edubfm_OpenHashDestroy(&s->ghostTable);
+    free(s);
+
+    BI_PARTPOLICYSTATE(type, part) = NULL;
+
+    return(eNOERROR);
+
+} /* edubfm_FinalPolicy() */
+
+
+
+/*@================================
+ * edubfm_PolicyReset()
+ *================================*/
+/*
+ * Function: Four edubfm_PolicyReset(Four, Four)
+ *
+ * Description:
+ *  Forget every train of the given partition: all buffers become free and
+ *  all ghosts are dropped. Called when the trains of the pool are discarded.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_PolicyReset(
+    Four                type,                   /* IN buffer type */
+    Four                part)                   /* IN partition number */
+{
+    Four                e;                      /* for error */
+    Four                i;                      /* index */
+    BfMPolicyState      *s;                     /* state of the policy */
+
+
+    s = BI_PARTPOLICYSTATE(type, part);
+    if (s == NULL) return(eNOERROR);
+
+    for (i = 0; i < BFM_POLICY_NLISTS; i++) {
+        s->lists[i].head = s->lists[i].tail = NIL;
+        s->lists[i].size = 0;
+    }
+
+    /* the first buffer is at the head of the free list */
+    for (i = 2 * s->nBufs - 1; i >= 0; i--)
+        policy_PushHead(s, (i < s->nBufs) ? POLICY_FREE : POLICY_FREEGHOST, i);
+
+    if (s->hist != NULL)
+        for (i = 0; i < 2 * 2 * s->nBufs; i++) s->hist[i] = 0;
+
+    e = edubfm_OpenHashClear(&s->ghostTable);
+    if (e < eNOERROR) ERR(e);
+
+    s->clock = 0;
+    s->target = (s->policy == BFM_POLICY_2Q) ? MAX(1, s->nBufs / 4) : 0;
+    s->incoming = POLICY_FREE;
+    s->incomingHist = 0;
+    s->incomingFromB2 = FALSE;
+    s->dropT1 = FALSE;
+
+    return(eNOERROR);
+
+} /* edubfm_PolicyReset() */
+
+
+
+/*@================================
+ * edubfm_PolicyHit()
+ *================================*/
+/*
+ * Function: Four edubfm_PolicyHit(Four, Four, Four)
+ *
+ * Description:
+ *  Inform the policy that the train in the given buffer has been referenced.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_PolicyHit(
+    Four                type,                   /* IN buffer type */
+    Four                part,                   /* IN partition number */
+    Four                index)                  /* IN index of the buffer referenced */
+{
+    BfMPolicyState      *s;                     /* state of the policy */
+    Four                node;                   /* node of the buffer */
+
+
+    s = BI_PARTPOLICYSTATE(type, part);
+    if (s == NULL) return(eNOERROR);
+
+    node = index - s->firstBuf;
+
+    switch (s->policy) {
+      case BFM_POLICY_LRUK:
+        s->hist[2*node+1] = s->hist[2*node];
+        s->hist[2*node] = ++s->clock;
+        break;
+
+      case BFM_POLICY_2Q:
+        /* a train in A1in is not moved: correlated references are ignored */
+        if (s->where[node] == Q2_AM) {
+            policy_Remove(s, node);
+            policy_PushHead(s, Q2_AM, node);
+        }
+        break;
+
+      case BFM_POLICY_ARC:
+        policy_Remove(s, node);
+        policy_PushHead(s, ARC_T2, node);
+        break;
+    }
+
+    return(eNOERROR);
+
+} /* edubfm_PolicyHit() */
+
+
+
+/*@================================
+ * edubfm_PolicyMiss()
+ *================================*/
+/*
+ * Function: Four edubfm_PolicyMiss(Four, Four, BfMHashKey *)
+ *
+ * Description:
+ *  Inform the policy that the train having the given key is not in the
+ *  pool and is about to be loaded. The ghost of the train, if any, decides
+ *  where the train goes by edubfm_PolicyLoad() and is dropped.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_PolicyMiss(
+    Four                type,                   /* IN buffer type */
+    Four                part,                   /* IN partition number */
+    BfMHashKey          *key)                   /* IN key of the train to be loaded */
+{
+    Four                e;                      /* for error */
+    BfMPolicyState      *s;                     /* state of the policy */
+    Four                ghost;                  /* ghost of the train */
+    Four                b1, b2;                 /* sizes of B1 and B2 */
+    Four                t1;                     /* size of T1 */
+
+
+    s = BI_PARTPOLICYSTATE(type, part);
+    if (s == NULL) return(eNOERROR);
+
+    ghost = edubfm_OpenHashLookUp(&s->ghostTable, key);
+
+    switch (s->policy) {
+      case BFM_POLICY_LRUK:
+        s->incoming = LRUK_RESIDENT;
+        s->incomingHist = (ghost == NOTFOUND_IN_HTABLE) ? 0 : s->hist[2*ghost];
+        break;
+
+      case BFM_POLICY_2Q:
+        s->incoming = (ghost == NOTFOUND_IN_HTABLE) ? Q2_A1IN : Q2_AM;
+        break;
+
+      case BFM_POLICY_ARC:
+        b1 = s->lists[ARC_B1].size;
+        b2 = s->lists[ARC_B2].size;
+        t1 = s->lists[ARC_T1].size;
+        s->incomingFromB2 = FALSE;
+        s->dropT1 = FALSE;
+
+        if (ghost != NOTFOUND_IN_HTABLE && s->where[ghost] == ARC_B1) {
+            /* a hit in B1: T1 was too small */
+            s->target = MIN(s->nBufs, s->target + MAX(1, b2 / b1));
+            s->incoming = ARC_T2;
+        }
+        else if (ghost != NOTFOUND_IN_HTABLE) {
+            /* a hit in B2: T2 was too small */
+            s->target = MAX(0, s->target - MAX(1, b1 / b2));
+            s->incoming = ARC_T2;
+            s->incomingFromB2 = TRUE;
+        }
+        else {
+            s->incoming = ARC_T1;
+
+            /* keep |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c */
+            if (t1 + b1 >= s->nBufs) {
+                if (t1 < s->nBufs) {
+                    e = policy_DropGhost(s, s->lists[ARC_B1].tail);
+                    if (e < eNOERROR) ERR(e);
+                }
+                else
+                    s->dropT1 = TRUE;
+            }
+            else if (t1 + b1 + s->lists[ARC_T2].size + b2 >= 2 * s->nBufs && b2 > 0) {
+                e = policy_DropGhost(s, s->lists[ARC_B2].tail);
+                if (e < eNOERROR) ERR(e);
+            }
+        }
+        break;
+    }
+
+    if (ghost != NOTFOUND_IN_HTABLE) {
+        e = policy_DropGhost(s, ghost);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* edubfm_PolicyMiss() */
+
+
+
+/*@================================
+ * edubfm_PolicyVictim()
+ *================================*/
+/*
+ * Function: Four edubfm_PolicyVictim(Four, Four)
+ *
+ * Description:
+ *  Select an unfixed buffer of the given partition to hold a new train.
+ *  A free buffer is selected if any; otherwise the policy chooses the
+ *  train to be evicted, remembers it in a ghost if the policy uses one,
+ *  and moves its buffer to the free list. The caller must flush the train
+ *  and remove it from the hash table.
+ *
+ * Returns:
+ *  1) index of the selected buffer
+ *  2) Error codes: Negative value means error code.
+ *     eNOUNFIXEDBUF_BFM - There is no unfixed buffer.
+ *     some errors caused by function calls
+ */
+Four edubfm_PolicyVictim(
+    Four                type,                   /* IN buffer type */
+    Four                part)                   /* IN partition number */
+{
+    Four                e;                      /* for error */
+    BfMPolicyState      *s;                     /* state of the policy */
+    Four                node;                   /* node of the victim */
+    Four                i;                      /* node */
+    Four                ghostList;              /* ghost list of the victim (NIL if none) */
+    Four                t1;                     /* size of T1 */
+
+
+    s = BI_PARTPOLICYSTATE(type, part);
+    if (s == NULL) ERR(eBADPARAMETER);
+
+    for (node = s->lists[POLICY_FREE].head; node != NIL; node = s->next[node])
+        if (POLICY_UNFIXED(type, s, node)) return(s->firstBuf + node);
+
+    ghostList = NIL;
+
+    switch (s->policy) {
+      case BFM_POLICY_LRUK:
+        node = NIL;
+        for (i = s->lists[LRUK_RESIDENT].head; i != NIL; i = s->next[i])
+            if (POLICY_UNFIXED(type, s, i) && (node == NIL || POLICY_LRUKOLDER(s, i, node)))
+                node = i;
+        ghostList = LRUK_HISTORY;
+        break;
+
+      case BFM_POLICY_2Q:
+        if (s->lists[Q2_A1IN].size > s->target) {
+            node = policy_UnfixedFromTail(s, type, Q2_A1IN);
+            if (node == NIL) node = policy_UnfixedFromTail(s, type, Q2_AM);
+        }
+        else {
+            node = policy_UnfixedFromTail(s, type, Q2_AM);
+            if (node == NIL) node = policy_UnfixedFromTail(s, type, Q2_A1IN);
+        }
+        if (node != NIL && s->where[node] == Q2_A1IN) ghostList = Q2_A1OUT;
+        break;
+
+      case BFM_POLICY_ARC:
+        t1 = s->lists[ARC_T1].size;
+        if (s->dropT1 || (t1 > 0 && (t1 > s->target || (s->incomingFromB2 && t1 == s->target)))) {
+            node = policy_UnfixedFromTail(s, type, ARC_T1);
+            if (node == NIL) node = policy_UnfixedFromTail(s, type, ARC_T2);
+        }
+        else {
+            node = policy_UnfixedFromTail(s, type, ARC_T2);
+            if (node == NIL) node = policy_UnfixedFromTail(s, type, ARC_T1);
+        }
+        if (node != NIL)
+            ghostList = (s->where[node] == ARC_T1) ? (s->dropT1 ? NIL : ARC_B1) : ARC_B2;
+        break;
+    }
+
+    if (node == NIL) ERR(eNOUNFIXEDBUF_BFM);
+
+    if (ghostList != NIL && !IS_NILBFMHASHKEY(BI_KEY(type, s->firstBuf + node))) {
+        e = policy_AddGhost(s, ghostList, &BI_KEY(type, s->firstBuf + node),
+                            (s->hist != NULL) ? s->hist[2*node] : 0);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    policy_Remove(s, node);
+    policy_PushHead(s, POLICY_FREE, node);
+
+    return(s->firstBuf + node);
+
+} /* edubfm_PolicyVictim() */
+
+
+
+/*@================================
+ * edubfm_PolicyLoad()
+ *================================*/
+/*
+ * Function: Four edubfm_PolicyLoad(Four, Four, Four)
+ *
+ * Description:
+ *  Inform the policy that the train given to the last edubfm_PolicyMiss()
+ *  has been read into the given buffer.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_PolicyLoad(
+    Four                type,                   /* IN buffer type */
+    Four                part,                   /* IN partition number */
+    Four                index)                  /* IN index of the buffer loaded */
+{
+    BfMPolicyState      *s;                     /* state of the policy */
+    Four                node;                   /* node of the buffer */
+
+
+    s = BI_PARTPOLICYSTATE(type, part);
+    if (s == NULL) return(eNOERROR);
+
+    node = index - s->firstBuf;
+
+    if (s->policy == BFM_POLICY_LRUK) {
+        s->hist[2*node+1] = s->incomingHist;
+        s->hist[2*node] = ++s->clock;
+    }
+
+    policy_Remove(s, node);
+    policy_PushHead(s, s->incoming, node);
+
+    return(eNOERROR);
+
+} /* edubfm_PolicyLoad() */
+
+
+
+/*@================================
+ * edubfm_PolicyDrop()
+ *================================*/
+/*
+ * Function: Four edubfm_PolicyDrop(Four, Four, Four)
+ *
+ * Description:
+ *  Inform the policy that the train in the given buffer has been dropped
+ *  because its page is deallocated, or because it could not be loaded. The
+ *  buffer becomes free and no ghost is kept since the train will not be
+ *  referenced again.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_PolicyDrop(
+    Four                type,                   /* IN buffer type */
+    Four                part,                   /* IN partition number */
+    Four                index)                  /* IN index of the buffer dropped */
+{
+    BfMPolicyState      *s;                     /* state of the policy */
+    Four                node;                   /* node of the buffer */
+
+
+    s = BI_PARTPOLICYSTATE(type, part);
+    if (s == NULL) return(eNOERROR);
+
+    node = index - s->firstBuf;
+
+    if (s->policy == BFM_POLICY_LRUK)
+        s->hist[2*node] = s->hist[2*node+1] = 0;
+
+    policy_Remove(s, node);
+    policy_PushHead(s, POLICY_FREE, node);
+
+    return(eNOERROR);
+
+} /* edubfm_PolicyDrop() */
+
+
+
+/*@================================
+ * edubfm_PolicyKeep()
+ *================================*/
+/*
+ * Function: Four edubfm_PolicyKeep(Four, Four, Four)
+ *
+ * Description:
+ *  Inform the policy that the train in the given buffer is not evicted
+ *  after all, e.g. because it has been fixed or updated while it was
+ *  written back for edubfm_PolicyVictim(). The ghost of the train is
+ *  dropped, and a buffer left in the free list is taken back as if the
+ *  train had been referenced again.
+ *
+ * Returns:
+ *  error code
+ */
+Four edubfm_PolicyKeep(
+    Four                type,                   /* IN buffer type */
+    Four                part,                   /* IN partition number */
+    Four                index)                  /* IN index of the buffer kept */
+{
+    Four                e;                      /* for error */
+    BfMPolicyState      *s;                     /* state of the policy */
+    Four                node;                   /* node of the buffer */
+    Four                ghost;                  /* ghost of the train */
+
+
+    s = BI_PARTPOLICYSTATE(type, part);
+    if (s == NULL) return(eNOERROR);
+
+    node = index - s->firstBuf;
+
+    ghost = edubfm_OpenHashLookUp(&s->ghostTable, &BI_KEY(type, index));
+    if (ghost != NOTFOUND_IN_HTABLE) {
+        e = policy_DropGhost(s, ghost);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    if (s->where[node] == POLICY_FREE) {
+        policy_Remove(s, node);
+        switch (s->policy) {
+          case BFM_POLICY_LRUK:
+            policy_PushHead(s, LRUK_RESIDENT, node);
+            break;
+
+          case BFM_POLICY_2Q:
+            policy_PushHead(s, Q2_AM, node);
+            break;
+
+          case BFM_POLICY_ARC:
+            policy_PushHead(s, ARC_T2, node);
+            break;
+        }
+    }
+
+    return(eNOERROR);
+
+} /* edubfm_PolicyKeep() */
+
+
+
+/*@================================
+ * edubfm_PolicyHotness()
+ *================================*/
+/*
+ * Function: void edubfm_PolicyHotness(Four, Four, UFour *)
+ *
+ * Description:
+ *  Rate how long the policy would keep each train of the given partition:
+ *  hotness[i] is given for the buffer BI_PARTFIRSTBUF(type, part) + i and
+ *  the higher it is, the later the train would be evicted. A buffer
+ *  holding no train is rated 0.
+ *   - clock : 2 if the reference bit is set, 1 otherwise
+ *   - LRU-2 : a train referenced twice ranks above every train referenced
+ *             once, and then by its second last (or last) reference time
+ *   - 2Q    : Am above A1in, and by the position in each list
+ *   - ARC   : T2 above T1, and by the position in each list
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_PolicyHotness(
+    Four                type,                   /* IN buffer type */
+    Four                part,                   /* IN partition number */
+    UFour               *hotness)               /* OUT hotness of each buffer of the partition */
+{
+    BfMPolicyState      *s;                     /* state of the policy */
+    Four                first;                  /* index of the first buffer of the partition */
+    Four                node;                   /* node of a buffer */
+    UFour               rank;                   /* next rank given by the lists */
+
+
+    first = BI_PARTFIRSTBUF(type, part);
+    for (node = 0; node < BI_PARTNBUFS(type, part); node++)
+        hotness[node] = IS_NILBFMHASHKEY(BI_KEY(type, first + node)) ? 0 :
+                        ((BI_BITS(type, first + node) & REFER) ? 2 : 1);
+
+    s = BI_PARTPOLICYSTATE(type, part);
+    if (s == NULL) return;
+
+    rank = 1;
+    switch (s->policy) {
+      case BFM_POLICY_LRUK:
+        for (node = s->lists[LRUK_RESIDENT].head; node != NIL; node = s->next[node])
+            hotness[node] = (s->hist[2*node+1] != 0) ? s->clock + s->hist[2*node+1] : s->hist[2*node];
+        break;
+
+      case BFM_POLICY_2Q:
+        policy_Rank(s, Q2_A1IN, &rank, hotness);
+        policy_Rank(s, Q2_AM, &rank, hotness);
+        break;
+
+      case BFM_POLICY_ARC:
+        policy_Rank(s, ARC_T1, &rank, hotness);
+        policy_Rank(s, ARC_T2, &rank, hotness);
+        break;
+    }
+
+} /* edubfm_PolicyHotness() */
+
+
+
+/*@================================
+ * policy_Remove()
+ *================================*/
+/*
+ * Function: static void policy_Remove(BfMPolicyState *, Four)
+ *
+ * Description:
+ *  Unlink a node from the list holding it.
+ *
+ * Returns:
+ *  None
+ */
+static void policy_Remove(
+    BfMPolicyState      *s,                     /* INOUT policy state */
+    Four                node)                   /* IN node to unlink */
+{
+    BfMPolicyList       *list;                  /* list holding the node */
+
+
+    list = &s->lists[(Four)s->where[node]];
+
+    if (s->prev[node] == NIL) list->head = s->next[node];
+    else s->next[s->prev[node]] = s->next[node];
+
+    if (s->next[node] == NIL) list->tail = s->prev[node];
+    else s->prev[s->next[node]] = s->prev[node];
+
+    list->size--;
+
+} /* policy_Remove() */
+
+
+
+/*@================================
+ * policy_PushHead()
+ *================================*/
+/*
+ * Function: static void policy_PushHead(BfMPolicyState *, Four, Four)
+ *
+ * Description:
+ *  Link an unlinked node at the head of a list.
+ *
+ * Returns:
+ *  None
+ */
+static void policy_PushHead(
+    BfMPolicyState      *s,                     /* INOUT policy state */
+    Four                l,                      /* IN list */
+    Four                node)                   /* IN node to link */
+{
+    BfMPolicyList       *list;                  /* the list */
+
+
+    list = &s->lists[l];
+
+    s->where[node] = l;
+    s->prev[node] = NIL;
+    s->next[node] = list->head;
+
+    if (list->head == NIL) list->tail = node;
+    else s->prev[list->head] = node;
+    list->head = node;
+
+    list->size++;
+
+} /* policy_PushHead() */
+
+
+
+/*@================================
+ * policy_UnfixedFromTail()
+ *================================*/
+/*
+ * Function: static Four policy_UnfixedFromTail(BfMPolicyState *, Four, Four)
+ *
+ * Description:
+ *  Return the node nearest to the tail of a list whose buffer is unfixed.
+ *
+ * Returns:
+ *  node, or NIL if every buffer of the list is fixed
+ */
+static Four policy_UnfixedFromTail(
+    BfMPolicyState      *s,                     /* IN policy state */
+    Four                type,                   /* IN buffer type */
+    Four                l)                      /* IN list */
+{
+    Four                node;                   /* node */
+
+
+    for (node = s->lists[l].tail; node != NIL; node = s->prev[node])
+        if (POLICY_UNFIXED(type, s, node)) return(node);
+
+    return(NIL);
+
+} /* policy_UnfixedFromTail() */
+
+
+
+/*@================================
+ * policy_AddGhost()
+ *================================*/
+/*
+ * Function: static Four policy_AddGhost(BfMPolicyState *, Four, BfMHashKey *, UFour)
+ *
+ * Description:
+ *  Remember the key of an evicted train at the head of a ghost list.
+ *  If all ghosts are in use, the oldest ghost of the fullest list is
+ *  reused; 2Q also bounds A1out by half the number of buffers.
+ *
+ * Returns:
+ *  error code
+ */
+static Four policy_AddGhost(
+    BfMPolicyState      *s,                     /* INOUT policy state */
+    Four                l,                      /* IN ghost list */
+    BfMHashKey          *key,                   /* IN key of the evicted train */
+    UFour               lastRef)                /* IN LRU-K: last reference time of the train */
+{
+    Four                e;                      /* for error */
+    Four                ghost;                  /* ghost */
+    Four                i;                      /* list */
+    Four                fullest;                /* ghost list having the most ghosts */
+
+
+    if (s->policy == BFM_POLICY_2Q && s->lists[Q2_A1OUT].size >= MAX(1, s->nBufs / 2)) {
+        e = policy_DropGhost(s, s->lists[Q2_A1OUT].tail);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    if (s->lists[POLICY_FREEGHOST].size == 0) {
+        fullest = l;
+        for (i = POLICY_FREEGHOST + 1; i < BFM_POLICY_NLISTS; i++)
+            if (s->lists[i].size > s->lists[fullest].size && s->lists[i].tail >= s->nBufs)
+                fullest = i;
+        e = policy_DropGhost(s, s->lists[fullest].tail);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    ghost = s->lists[POLICY_FREEGHOST].head;
+    policy_Remove(s, ghost);
+    policy_PushHead(s, l, ghost);
+
+    s->ghostKey[ghost - s->nBufs] = *key;
+    if (s->hist != NULL) s->hist[2*ghost] = lastRef;
+
+    e = edubfm_OpenHashInsert(&s->ghostTable, &s->ghostKey[ghost - s->nBufs], ghost);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* policy_AddGhost() */
+
+
+
+/*@================================
+ * policy_DropGhost()
+ *================================*/
+/*
+ * Function: static Four policy_DropGhost(BfMPolicyState *, Four)
+ *
+ * Description:
+ *  Forget a ghost and return it to the list of unused ghosts.
+ *
+ * Returns:
+ *  error code
+ */
+static Four policy_DropGhost(
+    BfMPolicyState      *s,                     /* INOUT policy state */
+    Four                ghost)                  /* IN ghost to drop */
+{
+    Four                e;                      /* for error */
+
+
+    e = edubfm_OpenHashDelete(&s->ghostTable, &s->ghostKey[ghost - s->nBufs]);
+    if (e < eNOERROR) ERR(e);
+
+    policy_Remove(s, ghost);
+    policy_PushHead(s, POLICY_FREEGHOST, ghost);
+
+    return(eNOERROR);
+
+} /* policy_DropGhost() */
+
+
+
+/*@================================
+ * policy_Rank()
+ *================================*/
+/*
+ * Function: static void policy_Rank(BfMPolicyState *, Four, UFour *, UFour *)
+ *
+ * Description:
+ *  Give increasing ranks to the nodes of a list from its tail, i.e. from
+ *  the node to be evicted first, to its head.
+ *
+ * Returns:
+ *  None
+ */
+static void policy_Rank(
+    BfMPolicyState      *s,                     /* IN policy state */
+    Four                l,                      /* IN list */
+    UFour               *rank,                  /* INOUT next rank */
+    UFour               *hotness)               /* OUT rank of each node of the list */
+{
+    Four                node;                   /* node */
+
+
+    for (node = s->lists[l].tail; node != NIL; node = s->prev[node])
+        hotness[node] = (*rank)++;
+
+} /* policy_Rank() */
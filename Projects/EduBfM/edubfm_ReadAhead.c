@@ -0,0 +1,384 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_ReadAhead.c
+ *
+ * Description :
+ *  Sequential read-ahead of the buffer manager.
+ *  A heap file is scanned along its page chain, so the next train of a scan
+ *  is known as soon as the current one is fixed; it is given by the
+ *  function registered with EduBfM_SetReadAhead(), e.g. the nextPage of a
+ *  slotted page. A scan is detected when a train fixed by EduBfM_GetTrain()
+ *  is the one following the train fixed before, and up to K trains along
+ *  the chain are then read ahead of it by the asynchronous I/O engine.
+ *  Since the chain is known one train at a time, the read of a train is
+ *  requested when the read of the train preceding it completes.
+ *  K follows the speed of the scans: it is doubled whenever a scan has to
+ *  wait for a train read ahead, i.e. the read-ahead is too short, and it is
+ *  halved whenever a train read ahead is evicted before being fixed, i.e.
+ *  the read-ahead is too long for the pool.
+ *
+ * Exports:
+ *  void edubfm_ReadAhead(Four, TrainID *, char *, Boolean)
+ *  void edubfm_ReadAheadDone(Four, TrainID *, TrainID *)
+ *  void edubfm_ReadAheadWasted(Four)
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * global variables
+ */
+/* read-ahead of each buffer pool; disabled by default */
+BfMReadAhead bufReadAhead[NUM_BUF_TYPES] = {
+    { 0, 0, NULL, { { { 0, 0 }, { 0, 0 }, { 0, 0 }, 0, 0, 0 } }, 0, PTHREAD_MUTEX_INITIALIZER },
+    { 0, 0, NULL, { { { 0, 0 }, { 0, 0 }, { 0, 0 }, 0, 0, 0 } }, 0, PTHREAD_MUTEX_INITIALIZER }
+};
+
+
+
+/*@
+ * internal function prototypes
+ */
+static Boolean edubfm_Prefetch(Four, TrainID *, TrainID *);
+
+
+
+/*@================================
+ * edubfm_ReadAhead()
+ *================================*/
+/*
+ * Function: void edubfm_ReadAhead(Four, TrainID *, char *, Boolean)
+ *
+ * Description:
+ *  Called by EduBfM_GetTrain() for each train it fixes. If the train
+ *  continues a scan, move the scan forward and extend its read-ahead;
+ *  otherwise start tracking a new scan in place of the least recently
+ *  used one. `waited' tells whether the train was still being read.
+ *  The caller must not hold any latch.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ReadAhead(
+    Four                type,                   /* IN buffer type */
+    TrainID             *trainId,               /* IN train fixed */
+    char                *buffer,                /* IN buffer holding the train */
+    Boolean             waited)                 /* IN TRUE if the train was being read */
+{
+    BfMReadAhead        *ra = &bufReadAhead[type];      /* read-ahead of the pool */
+    BfMScanStream       *s;                     /* scan of the train */
+    TrainID             next;                   /* train following the fixed train */
+    TrainID             from;                   /* train preceding the first train to request */
+    TrainID             nextOfFrom;             /* first train to request */
+    Boolean             extend;                 /* TRUE if the read-ahead is extended */
+    Four                i;                      /* index */
+
+
+    ra->nextTrain(trainId, buffer, &next);
+
+    BFM_GETLATCH(&ra->latch);
+
+    if (waited && ra->curK < ra->maxK)
+        ra->curK = (2 * ra->curK < ra->maxK) ? 2 * ra->curK : ra->maxK;
+
+    ra->clock++;
+
+    for (s = NULL, i = 0; i < BFM_RA_NSTREAMS; i++)
+        if (ra->streams[i].run > 0 && EQUALKEY(&ra->streams[i].expect, trainId)) {
+            s = &ra->streams[i];
+            break;
+        }
+
+    if (s == NULL) {
+        /* a new scan may start here */
+        for (s = &ra->streams[0], i = 1; i < BFM_RA_NSTREAMS; i++)
+            if (ra->streams[i].lastUsed < s->lastUsed) s = &ra->streams[i];
+
+        s->expect = next;
+        s->tail = *trainId;
+        s->next = next;
+        s->nAhead = 0;
+        s->run = 1;
+        s->lastUsed = ra->clock;
+
+        BFM_RELEASELATCH(&ra->latch);
+        return;
+    }
+
+    s->expect = next;
+    s->run++;
+    s->lastUsed = ra->clock;
+
+    if (EQUALKEY(&s->tail, trainId) || s->nAhead == 0) {
+        /* the scan has caught up with its read-ahead */
+        s->tail = *trainId;
+        s->next = next;
+        s->nAhead = 0;
+    }
+    else
+        s->nAhead--;
+
+    extend = !IS_NILPAGEID(s->next) && s->nAhead < ra->curK;
+    from = s->tail;
+    nextOfFrom = s->next;
+
+    BFM_RELEASELATCH(&ra->latch);
+
+    if (extend) edubfm_ReadAheadDone(type, &from, &nextOfFrom);
+
+} /* edubfm_ReadAhead() */
+
+
+
+/*@================================
+ * edubfm_ReadAheadDone()
+ *================================*/
+/*
+ * Function: void edubfm_ReadAheadDone(Four, TrainID *, TrainID *)
+ *
+ * Description:
+ *  Called when the train `trainId' read ahead of a scan is in the pool
+ *  and its next train `next' is known. If `trainId' is the last train
+ *  requested for a scan and the scan is less than K trains behind,
+ *  request the reads of the next trains along the chain; the trains which
+ *  are already in the pool are passed at once. Otherwise the next train is
+ *  kept until the scan moves forward.
+ *  The caller must not hold any latch.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ReadAheadDone(
+    Four                type,                   /* IN buffer type */
+    TrainID             *trainId,               /* IN train in the pool */
+    TrainID             *next)                  /* IN train following `trainId' */
+{
+    BfMReadAhead        *ra = &bufReadAhead[type];      /* read-ahead of the pool */
+    BfMScanStream       *s;                     /* scan of the train */
+    TrainID             cur;                    /* train in the pool */
+    TrainID             nextOfCur;              /* train following `cur' */
+    Four                i;                      /* index */
+
+
+    cur = *trainId;
+    nextOfCur = *next;
+
+    for (;;) {
+        BFM_GETLATCH(&ra->latch);
+
+        for (s = NULL, i = 0; i < BFM_RA_NSTREAMS; i++)
+            if (ra->streams[i].run > 0 && EQUALKEY(&ra->streams[i].tail, &cur)) {
+                s = &ra->streams[i];
+                break;
+            }
+
+        if (s == NULL || ra->maxK == 0) {
+            BFM_RELEASELATCH(&ra->latch);
+            return;
+        }
+
+        if (IS_NILPAGEID(nextOfCur) || s->nAhead >= ra->curK) {
+            s->next = nextOfCur;
+            BFM_RELEASELATCH(&ra->latch);
+            return;
+        }
+
+        s->tail = nextOfCur;
+        SET_NILPAGEID(s->next);
+        s->nAhead++;
+
+        BFM_RELEASELATCH(&ra->latch);
+
+        cur = nextOfCur;
+        if (!edubfm_Prefetch(type, &cur, &nextOfCur)) return;
+    }
+
+} /* edubfm_ReadAheadDone() */
+
+
+
+/*@================================
+ * edubfm_ReadAheadWasted()
+ *================================*/
+/*
+ * Function: void edubfm_ReadAheadWasted(Four)
+ *
+ * Description:
+ *  Called when a train read ahead is evicted before being fixed: halve K.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ReadAheadWasted(
+    Four                type)                   /* IN buffer type */
+{
+    BfMReadAhead        *ra = &bufReadAhead[type];      /* read-ahead of the pool */
+
+
+    BFM_STATS_INC(type, nPrefetchWasted);
+
+    BFM_GETLATCH(&ra->latch);
+    if (ra->curK > 1) ra->curK /= 2;
+    BFM_RELEASELATCH(&ra->latch);
+
+} /* edubfm_ReadAheadWasted() */
+
+
+
+/*@================================
+ * edubfm_Prefetch()
+ *================================*/
+/*
+ * Function: static Boolean edubfm_Prefetch(Four, TrainID *, TrainID *)
+ *
+ * Description:
+ *  Request the read of a train ahead of a scan. A buffer is allocated to
+ *  the train and marked READING and PREFETCHED, and the read is handed to
+ *  the asynchronous I/O engine, which unfixes the buffer when it is done.
+ *  If the train is already in the pool, `next' is set to the train
+ *  following it. Nothing is done if the engine is not running or no buffer
+ *  can be allocated; the read-ahead is only a hint.
+ *
+ * Returns:
+ *  TRUE if the train is already in the pool, FALSE otherwise
+ *
+ * Side effects:
+ *  1) parameter next
+ *     train following `trainId' if TRUE is returned
+ */
+static Boolean edubfm_Prefetch(
+    Four                type,                   /* IN buffer type */
+    TrainID             *trainId,               /* IN train to read */
+    TrainID             *next)                  /* OUT train following `trainId' */
+{
+    Four                e;                      /* for error */
+    Four                index;                  /* index of the buffer pool */
+    Four                part;                   /* partition holding the train */
+    pthread_mutex_t     *latch;                 /* latch of the partition */
+    BfMIOHandle         *handle;                /* request of the read */
+
+
+    if (edubfm_ioEngine.nWorkers == 0 || edubfm_ioEngine.stop) return(FALSE);
+
+    part = BI_PARTITIONOFKEY(type, trainId);
+    latch = BI_PARTLATCH(type, part);
+    BFM_GETLATCH(latch);
+
+    index = edubfm_LookUp(trainId, type);
+    if (index != NOTFOUND_IN_HTABLE) {
+        if (BI_BITS(type, index) & READING) {
+            BFM_RELEASELATCH(latch);
+            return(FALSE);
+        }
+        bufReadAhead[type].nextTrain(trainId, BI_BUFFER(type, index), next);
+        BFM_RELEASELATCH(latch);
+        return(TRUE);
+    }
+
+    if (BI_PARTEVICTING(type, part)) {
+        /* a buffer cannot be claimed until the victim is written back */
+        BFM_RELEASELATCH(latch);
+        return(FALSE);
+    }
+
+    handle = (BfMIOHandle*)malloc(sizeof(BfMIOHandle));
+    if (handle == NULL) {
+        BFM_RELEASELATCH(latch);
+        return(FALSE);
+    }
+
+    e = edubfm_PolicyMiss(type, part, trainId);
+    if (e >= eNOERROR) index = edubfm_AllocTrain(type, part, TRUE);
+    if (e < eNOERROR || index < eNOERROR) {
+        BFM_RELEASELATCH(latch);
+        free(handle);
+        return(FALSE);
+    }
+
+    BI_KEY(type, index).volNo = trainId->volNo;
+    BI_KEY(type, index).pageNo = trainId->pageNo;
+    BI_FIXED(type, index) = 1;
+    BI_BITS(type, index) |= REFER | READING | PREFETCHED;
+
+    e = edubfm_Insert(&BI_KEY(type, index), index, type);
+    if (e >= eNOERROR) e = edubfm_PolicyLoad(type, part, index);
+    if (e < eNOERROR) {
+        (void)edubfm_Delete(&BI_KEY(type, index), type);
+        SET_NILBFMHASHKEY(BI_KEY(type, index));
+        (void)edubfm_PolicyDrop(type, part, index);
+        edubfm_FreeFrame(type, part, index);
+        BI_FIXED(type, index) = 0;
+        BI_BITS(type, index) = ALL_0;
+        BFM_RELEASELATCH(latch);
+        free(handle);
+        return(FALSE);
+    }
+
+    handle->op = BFM_IO_PREFETCH;
+    handle->trainId = *trainId;
+    handle->nTrains = 1;
+    handle->type = type;
+    handle->index = index;
+    handle->part = part;
+    handle->buffer = BI_BUFFER(type, index);
+
+    BFM_RELEASELATCH(latch);
+
+    BFM_STATS_INC(type, nPrefetches);
+    (void)edubfm_SubmitIO(handle);
+
+    return(FALSE);
+
+} /* edubfm_Prefetch() */
@@ -79,6 +79,10 @@
  *  when RDsM_ReadTrain() is called, simply return it.  The function has
  *  no code for checking input parameters since this will be done RDsM,
  *  especially RDsM_ReadTrain().
+ *  If the compressed victim cache of the pool holds the train, the train
+ *  is taken from there without reading the disk. Otherwise, if the
+ *  secondary cache of the pool holds it, it is read from the local file
+ *  of the cache instead of the volume.
  *
  * Returns;
  *  error code
@@ -101,8 +105,14 @@ Four edubfm_ReadTrain(
 	if (RM_IS_ROLLBACK_REQUIRED()) ERR(eNOTSUPPORTED_EDUBFM);
 
 	/* NEWCODE */
-	e = RDsM_ReadTrain(trainId, aTrain, BI_BUFSIZE(type));
+	if(bufVictimCache[type].budget > 0 && edubfm_VictimTake(type, (BfMHashKey*)trainId, aTrain))
+		return( eNOERROR );	//served by the compressed victim cache.
+	if(bufSecondaryCache[type].nSlots > 0 && edubfm_SecondaryRead(type, (BfMHashKey*)trainId, aTrain))
+		return( eNOERROR );	//served by the secondary cache.
+
+	e = edubfm_DiskRead(trainId, aTrain, 1, type);
 	if(e<0) ERR(e);
+	BFM_STATS_INC(type, nReads);
 	/* ENDOFNEWCODE */
 
 
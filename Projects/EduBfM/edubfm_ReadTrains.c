@@ -0,0 +1,269 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_ReadTrains.c
+ *
+ * Description :
+ *  Read a batch of trains into buffers claimed for them beforehand.
+ *  A train is first entered in the pool as being read (see
+ *  edubfm_ClaimTrain()), so that EduBfM_GetTrain() waits for it, and the
+ *  trains of the batch are then read in the order of (volNo, pageNo) by
+ *  one I/O per run of trains contiguous on the disk, all the runs being
+ *  in flight at once.
+ *
+ * Exports:
+ *  Four edubfm_ClaimTrain(Four, Four, BfMHashKey *, Four)
+ *  Four edubfm_ReadTrains(BfMFlushEntry *, Four, Boolean)
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include <string.h> /* for memcpy */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * edubfm_ClaimTrain()
+ *================================*/
+/*
+ * Function: Four edubfm_ClaimTrain(Four, Four, BfMHashKey *, Four)
+ *
+ * Description:
+ *  Allocate a buffer for a train which is not in the pool, and enter the
+ *  train as being read: the buffer is fixed once and has the READING bit
+ *  set together with `bits'. The caller must hold the latch of the
+ *  partition, and must read the train by edubfm_ReadTrains().
+ *
+ * Returns:
+ *  index of the buffer, or error code
+ *    some errors caused by function calls
+ */
+Four edubfm_ClaimTrain(
+    Four                type,                   /* IN buffer type */
+    Four                part,                   /* IN partition holding the train */
+    BfMHashKey          *key,                   /* IN train to be read */
+    Four                bits)                   /* IN bits of the buffer besides READING */
+{
+    Four                e;                      /* for error */
+    Four                index;                  /* index of the buffer */
+
+
+    e = edubfm_PolicyMiss(type, part, key);
+    if (e < eNOERROR) ERR(e);
+
+    index = edubfm_AllocTrain(type, part, TRUE);
+    if (index < eNOERROR) ERR(index);
+
+    BI_KEY(type, index) = *key;
+    BI_FIXED(type, index) = 1;
+    BI_BITS(type, index) = READING | bits;
+
+    e = edubfm_Insert(&BI_KEY(type, index), index, type);
+    if (e >= eNOERROR) e = edubfm_PolicyLoad(type, part, index);
+    if (e < eNOERROR) {
+        (void)edubfm_Delete(&BI_KEY(type, index), type);
+        SET_NILBFMHASHKEY(BI_KEY(type, index));
+        BI_FIXED(type, index) = 0;
+        BI_BITS(type, index) = ALL_0;
+        (void)edubfm_PolicyDrop(type, part, index);
+        edubfm_FreeFrame(type, part, index);
+        ERR(e);
+    }
+
+    return(index);
+
+} /* edubfm_ClaimTrain() */
+
+
+
+/*@================================
+ * edubfm_ReadTrains()
+ *================================*/
+/*
+ * Function: Four edubfm_ReadTrains(BfMFlushEntry *, Four, Boolean)
+ *
+ * Description:
+ *  Read the trains of `entries' into the buffers claimed for them by
+ *  edubfm_ClaimTrain(). A train held by the compressed victim cache or
+ *  the secondary cache of its pool is taken from there, as by
+ *  edubfm_ReadTrain(). The other trains are grouped into runs of trains
+ *  of the same type contiguous on the disk, up to BFM_FLUSH_MAXRUN
+ *  trains; the read of every run is submitted to the asynchronous I/O
+ *  engine, into a buffer of the run copied to the buffers of its trains
+ *  afterwards, and the reads are then waited for. The read of each train
+ *  is ended by edubfm_EndRead(), and the buffers are unfixed if `unfix'
+ *  is TRUE.
+ *  The caller must not hold any latch.
+ *
+ * Returns:
+ *  error code, the first error among the trains
+ *    eMEMORYALLOCERR - memory allocation failed
+ *    some errors caused by the reads
+ *
+ * Side effects:
+ *  1) parameter entries
+ *     the index of a train which could not be read is set to its error code
+ */
+Four edubfm_ReadTrains(
+    BfMFlushEntry       *entries,               /* INOUT trains in the order of (volNo, pageNo) */
+    Four                nEntries,               /* IN # of the trains */
+    Boolean             unfix)                  /* IN TRUE to unfix the buffers */
+{
+    Four                e;                      /* for error */
+    Four                firstError;             /* first error among the trains */
+    Four                n;                      /* # of trains in a run */
+    Four                i, k;                   /* indices */
+    Four                type;                   /* buffer type */
+    Four                index;                  /* index of a buffer */
+    Four                trainBytes;             /* size of a train in bytes */
+    BfMIOHandle         *handles;               /* request of the run starting at each train */
+    BfMFlushEntry       *entry;                 /* a train */
+    pthread_mutex_t     *latch;                 /* latch of a partition */
+
+
+    handles = (BfMIOHandle*)malloc(sizeof(BfMIOHandle) * nEntries);
+
+    /*@ take the trains held by the caches of the pools */
+    for (i = 0; i < nEntries; i++) {
+        entry = &entries[i];
+        type = entry->type;
+        e = (handles == NULL) ? eMEMORYALLOCERR : eNOERROR;
+
+        if (e >= eNOERROR) {
+            handles[i].nTrains = 1;
+            if (!(bufVictimCache[type].budget > 0 &&
+                  edubfm_VictimTake(type, &entry->key, BI_BUFFER(type, entry->index))) &&
+                !(bufSecondaryCache[type].nSlots > 0 &&
+                  edubfm_SecondaryRead(type, &entry->key, BI_BUFFER(type, entry->index))))
+                continue;
+            handles[i].nTrains = 0;
+        }
+
+        latch = BI_PARTLATCH(type, entry->part);
+        BFM_GETLATCH(latch);
+        index = entry->index;
+        e = edubfm_EndRead(type, entry->part, index, e);
+        if (e >= eNOERROR && unfix) BI_FIXED(type, index)--;
+        if (e < eNOERROR) entry->index = e;
+        BFM_RELEASELATCH(latch);
+    }
+
+    if (handles == NULL) ERR(eMEMORYALLOCERR);
+
+    /*@ submit the read of each run of trains contiguous on the disk */
+    for (i = 0; i < nEntries; i += n) {
+        if (handles[i].nTrains == 0) {
+            n = 1;
+            continue;
+        }
+
+        type = entries[i].type;
+        for (n = 1; i + n < nEntries && n < BFM_FLUSH_MAXRUN; n++)
+            if (handles[i + n].nTrains == 0 || entries[i + n].type != type ||
+                entries[i + n].key.volNo != entries[i].key.volNo ||
+                entries[i + n].key.pageNo != entries[i + n - 1].key.pageNo + BI_BUFSIZE(type)) break;
+
+        handles[i].op = BFM_IO_READRUN;
+        handles[i].trainId.volNo = entries[i].key.volNo;
+        handles[i].trainId.pageNo = entries[i].key.pageNo;
+        handles[i].type = type;
+        handles[i].index = entries[i].index;
+        handles[i].part = entries[i].part;
+        handles[i].buffer = (n > 1) ? edubfm_AllocIOBuffer(BI_BUFSIZE(type) * n) : NULL;
+        if (handles[i].buffer == NULL) {
+            /* read the train alone into its buffer */
+            n = 1;
+            handles[i].buffer = BI_BUFFER(type, entries[i].index);
+        }
+        handles[i].nTrains = n;
+
+        e = edubfm_SubmitIO(&handles[i]);
+        if (e < eNOERROR) handles[i].status = e;
+    }
+
+    /*@ wait for the runs, and give the trains their contents */
+    firstError = eNOERROR;
+    for (i = 0; i < nEntries; i += n) {
+        n = handles[i].nTrains;
+        if (n == 0) {
+            n = 1;
+            continue;
+        }
+
+        e = edubfm_WaitIO(&handles[i]);
+
+        type = entries[i].type;
+        trainBytes = PAGESIZE * BI_BUFSIZE(type);
+        for (k = 0; k < n; k++) {
+            entry = &entries[i + k];
+            index = entry->index;
+            latch = BI_PARTLATCH(type, entry->part);
+            BFM_GETLATCH(latch);
+
+            if (e >= eNOERROR && n > 1)
+                memcpy(BI_BUFFER(type, index), handles[i].buffer + trainBytes * k, trainBytes);
+            if (edubfm_EndRead(type, entry->part, index, e) < eNOERROR) entry->index = e;
+            else if (unfix) BI_FIXED(type, index)--;
+
+            BFM_RELEASELATCH(latch);
+        }
+
+        if (n > 1) free(handles[i].buffer);
+        if (e < eNOERROR && firstError == eNOERROR) firstError = e;
+    }
+
+    free(handles);
+
+    if (firstError < eNOERROR) ERR(firstError);
+
+    return(eNOERROR);
+
+} /* edubfm_ReadTrains() */
@@ -0,0 +1,389 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_SecondaryCache.c
+ *
+ * Description :
+ *  Secondary cache of a buffer pool in a file on a fast local disk (see
+ *  BfMSecondaryCache). edubfm_AllocTrain() writes the clean trains it
+ *  evicts to the file, edubfm_ReadTrain() reads a train from the file
+ *  instead of the volume, and EduBfM_SetDirty() drops the copy of a train
+ *  being modified, so that the copies always equal the trains on the volume.
+ *  The file is unlinked as soon as it is created; it goes away with the
+ *  cache or the process.
+ *
+ * Exports:
+ *  Four edubfm_InitSecondaryCache(Four, char *, Four)
+ *  void edubfm_SecondaryPut(Four, BfMHashKey *, char *)
+ *  Boolean edubfm_SecondaryRead(Four, BfMHashKey *, char *)
+ *  void edubfm_SecondaryDrop(Four, BfMHashKey *)
+ *  void edubfm_SecondaryClear(Four)
+ */
+
+
+#include <stdlib.h> /* for calloc, malloc & free */
+#include <fcntl.h> /* for open */
+#include <unistd.h> /* for pread, pwrite, ftruncate, unlink & close */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * global variables
+ */
+/* secondary cache of each buffer pool; disabled by default */
+BfMSecondaryCache bufSecondaryCache[NUM_BUF_TYPES] = {
+    { 0, -1, NULL, NULL, 0, { 0 }, PTHREAD_MUTEX_INITIALIZER },
+    { 0, -1, NULL, NULL, 0, { 0 }, PTHREAD_MUTEX_INITIALIZER }
+};
+
+
+
+/*@
+ * internal function prototypes
+ */
+static void secondary_Free(BfMSecondaryCache *);
+
+
+
+/*@================================
+ * edubfm_InitSecondaryCache()
+ *================================*/
+/*
+ * Function: Four edubfm_InitSecondaryCache(Four, char *, Four)
+ *
+ * Description:
+ *  Drop the secondary cache of the given pool and create an empty one of
+ *  `nSlots' trains in a new file `path'; if `nSlots' is 0, the cache is
+ *  disabled.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER - the file cannot be created with the given size
+ *    eMEMORYALLOCERR - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four edubfm_InitSecondaryCache(
+    Four                type,                   /* IN buffer type */
+    char                *path,                  /* IN file of the cache */
+    Four                nSlots)                 /* IN # of trains of the file */
+{
+    Four                e;                      /* for error */
+    Four                i;                      /* index */
+    Four                trainBytes;             /* size of a train */
+    BfMSecondaryCache   *c = &bufSecondaryCache[type];  /* cache of the pool */
+
+
+    BFM_GETLATCH(&c->latch);
+
+    secondary_Free(c);
+
+    if (nSlots > 0) {
+        trainBytes = PAGESIZE * BI_BUFSIZE(type);
+
+        c->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (c->fd < 0) ERRL(eBADPARAMETER, &c->latch);
+        unlink(path);
+        if (ftruncate(c->fd, (off_t)nSlots * trainBytes) < 0) {
+            secondary_Free(c);
+            ERRL(eBADPARAMETER, &c->latch);
+        }
+
+        c->keys = (BfMHashKey*)malloc(sizeof(BfMHashKey) * nSlots);
+        c->refer = (One*)calloc(nSlots, sizeof(One));
+        if (c->keys == NULL || c->refer == NULL) {
+            secondary_Free(c);
+            ERRL(eMEMORYALLOCERR, &c->latch);
+        }
+
+        e = edubfm_OpenHashCreate(&c->table, nSlots);
+        if (e < eNOERROR) {
+            secondary_Free(c);
+            ERRL(e, &c->latch);
+        }
+
+        for (i = 0; i < nSlots; i++) SET_NILBFMHASHKEY(c->keys[i]);
+        c->hand = 0;
+        c->nSlots = nSlots;
+    }
+
+    BFM_RELEASELATCH(&c->latch);
+
+    return(eNOERROR);
+
+} /* edubfm_InitSecondaryCache() */
+
+
+
+/*@================================
+ * edubfm_SecondaryPut()
+ *================================*/
+/*
+ * Function: void edubfm_SecondaryPut(Four, BfMHashKey *, char *)
+ *
+ * Description:
+ *  Write a clean train evicted from the pool to the file, unless the file
+ *  already holds a copy of it, which is then only referenced. The slot is
+ *  chosen by the clock. Nothing is kept if the write fails.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_SecondaryPut(
+    Four                type,                   /* IN buffer type */
+    BfMHashKey          *key,                   /* IN key of the train */
+    char                *train)                 /* IN contents of the train */
+{
+    BfMSecondaryCache   *c = &bufSecondaryCache[type];  /* cache of the pool */
+    Four                trainBytes;             /* size of a train */
+    Four                slot;                   /* slot of the train */
+
+
+    trainBytes = PAGESIZE * BI_BUFSIZE(type);
+
+    BFM_GETLATCH(&c->latch);
+
+    if (c->nSlots == 0) {
+        BFM_RELEASELATCH(&c->latch);
+        return;
+    }
+
+    slot = edubfm_OpenHashLookUp(&c->table, key);
+    if (slot != NOTFOUND_IN_HTABLE) {
+        c->refer[slot] = TRUE;
+        BFM_RELEASELATCH(&c->latch);
+        return;
+    }
+
+    /* second chance over the slots; an empty slot is taken at once */
+    for (;;) {
+        slot = c->hand;
+        c->hand = (c->hand + 1) % c->nSlots;
+        if (IS_NILBFMHASHKEY(c->keys[slot]) || !c->refer[slot]) break;
+        c->refer[slot] = FALSE;
+    }
+
+    if (!IS_NILBFMHASHKEY(c->keys[slot])) {
+        edubfm_OpenHashDelete(&c->table, &c->keys[slot]);
+        SET_NILBFMHASHKEY(c->keys[slot]);
+    }
+
+    if (pwrite(c->fd, train, trainBytes, (off_t)slot * trainBytes) == trainBytes) {
+        c->keys[slot] = *key;
+        c->refer[slot] = FALSE;
+        edubfm_OpenHashInsert(&c->table, key, slot);
+        BFM_STATS_INC(type, nSecondaryPuts);
+    }
+
+    BFM_RELEASELATCH(&c->latch);
+
+} /* edubfm_SecondaryPut() */
+
+
+
+/*@================================
+ * edubfm_SecondaryRead()
+ *================================*/
+/*
+ * Function: Boolean edubfm_SecondaryRead(Four, BfMHashKey *, char *)
+ *
+ * Description:
+ *  Look up a train to be read into the pool. If it is found, it is read
+ *  from the file into `train' and its copy stays in the cache.
+ *
+ * Returns:
+ *  TRUE if the train has been read, FALSE if it must be read from the volume
+ */
+Boolean edubfm_SecondaryRead(
+    Four                type,                   /* IN buffer type */
+    BfMHashKey          *key,                   /* IN key of the train */
+    char                *train)                 /* OUT contents of the train */
+{
+    BfMSecondaryCache   *c = &bufSecondaryCache[type];  /* cache of the pool */
+    Four                trainBytes;             /* size of a train */
+    Four                slot;                   /* slot of the train */
+
+
+    trainBytes = PAGESIZE * BI_BUFSIZE(type);
+
+    BFM_GETLATCH(&c->latch);
+
+    if (c->nSlots == 0) {
+        BFM_RELEASELATCH(&c->latch);
+        return(FALSE);
+    }
+    BFM_STATS_INC(type, nSecondaryLookups);
+
+    slot = edubfm_OpenHashLookUp(&c->table, key);
+    if (slot == NOTFOUND_IN_HTABLE) {
+        BFM_RELEASELATCH(&c->latch);
+        return(FALSE);
+    }
+
+    if (pread(c->fd, train, trainBytes, (off_t)slot * trainBytes) != trainBytes) {
+        /* the copy cannot be trusted any more */
+        edubfm_OpenHashDelete(&c->table, key);
+        SET_NILBFMHASHKEY(c->keys[slot]);
+        BFM_RELEASELATCH(&c->latch);
+        return(FALSE);
+    }
+    c->refer[slot] = TRUE;
+
+    BFM_RELEASELATCH(&c->latch);
+
+    BFM_STATS_INC(type, nSecondaryHits);
+    BFM_STATS_ADD(type, secondaryBytesSaved, trainBytes);
+
+    return(TRUE);
+
+} /* edubfm_SecondaryRead() */
+
+
+
+/*@================================
+ * edubfm_SecondaryDrop()
+ *================================*/
+/*
+ * Function: void edubfm_SecondaryDrop(Four, BfMHashKey *)
+ *
+ * Description:
+ *  Drop the copy of a train, if any, because the train is being modified
+ *  or its page is deallocated.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_SecondaryDrop(
+    Four                type,                   /* IN buffer type */
+    BfMHashKey          *key)                   /* IN key of the train */
+{
+    BfMSecondaryCache   *c = &bufSecondaryCache[type];  /* cache of the pool */
+    Four                slot;                   /* slot of the train */
+
+
+    BFM_GETLATCH(&c->latch);
+
+    if (c->nSlots > 0) {
+        slot = edubfm_OpenHashLookUp(&c->table, key);
+        if (slot != NOTFOUND_IN_HTABLE) {
+            edubfm_OpenHashDelete(&c->table, key);
+            SET_NILBFMHASHKEY(c->keys[slot]);
+        }
+    }
+
+    BFM_RELEASELATCH(&c->latch);
+
+} /* edubfm_SecondaryDrop() */
+
+
+
+/*@================================
+ * edubfm_SecondaryClear()
+ *================================*/
+/*
+ * Function: void edubfm_SecondaryClear(Four)
+ *
+ * Description:
+ *  Drop all copies kept for the pool, e.g. when its trains are discarded.
+ *  The file is kept for the next copies.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_SecondaryClear(
+    Four                type)                   /* IN buffer type */
+{
+    BfMSecondaryCache   *c = &bufSecondaryCache[type];  /* cache of the pool */
+    Four                i;                      /* index */
+
+
+    BFM_GETLATCH(&c->latch);
+
+    if (c->nSlots > 0) {
+        edubfm_OpenHashClear(&c->table);
+        for (i = 0; i < c->nSlots; i++) {
+            SET_NILBFMHASHKEY(c->keys[i]);
+            c->refer[i] = FALSE;
+        }
+        c->hand = 0;
+    }
+
+    BFM_RELEASELATCH(&c->latch);
+
+} /* edubfm_SecondaryClear() */
+
+
+
+/*@================================
+ * secondary_Free()
+ *================================*/
+/*
+ * Function: static void secondary_Free(BfMSecondaryCache *)
+ *
+ * Description:
+ *  Disable the cache, closing its file and freeing its index. The caller
+ *  must hold the latch of the cache.
+ *
+ * Returns:
+ *  None
+ */
+static void secondary_Free(
+    BfMSecondaryCache   *c)                     /* INOUT cache */
+{
+    c->nSlots = 0;
+    if (c->fd >= 0) close(c->fd);
+    c->fd = -1;
+    free(c->keys);
+    c->keys = NULL;
+    free(c->refer);
+    c->refer = NULL;
+    edubfm_OpenHashDestroy(&c->table);
+
+} /* secondary_Free() */
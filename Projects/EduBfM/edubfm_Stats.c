@@ -0,0 +1,131 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Stats.c
+ *
+ * Description :
+ *  Statistics of the buffer pools.
+ *  The counters of BfMStats are updated by the buffer manager where the
+ *  events happen; this module measures and records the latencies.
+ *
+ * Exports:
+ *  UEight edubfm_StatsClock(void)
+ *  void edubfm_StatsLatency(Four, Boolean, UEight)
+ */
+
+
+#include <time.h> /* for clock_gettime */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * global variables
+ */
+/* statistics of each buffer pool */
+BfMStats bufStats[NUM_BUF_TYPES];
+
+
+
+/*@================================
+ * edubfm_StatsClock()
+ *================================*/
+/*
+ * Function: UEight edubfm_StatsClock(void)
+ *
+ * Description:
+ *  Return the time of a monotonic clock in nanoseconds.
+ *
+ * Returns:
+ *  current time
+ */
+UEight edubfm_StatsClock(void)
+{
+    struct timespec     t;                      /* current time */
+
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+
+    return((UEight)t.tv_sec * 1000000000UL + (UEight)t.tv_nsec);
+
+} /* edubfm_StatsClock() */
+
+
+
+/*@================================
+ * edubfm_StatsLatency()
+ *================================*/
+/*
+ * Function: void edubfm_StatsLatency(Four, Boolean, UEight)
+ *
+ * Description:
+ *  Record the latency of an EduBfM_GetTrain() call in the hit or the miss
+ *  histogram of the given buffer pool. The latency falls in bucket i if
+ *  it is in [2^i, 2^(i+1)) nanoseconds; the last bucket takes the rest.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_StatsLatency(
+    Four                type,                   /* IN buffer type */
+    Boolean             hit,                    /* IN TRUE if the train was found in the pool */
+    UEight              nsec)                   /* IN latency in nanoseconds */
+{
+    Four                bucket;                 /* bucket of the histogram */
+
+
+    /* floor(log2(nsec)) */
+    bucket = (nsec == 0) ? 0 : (Four)(sizeof(UEight) * 8 - 1) - __builtin_clzl(nsec);
+    if (bucket >= BFM_STATS_NHISTBUCKETS) bucket = BFM_STATS_NHISTBUCKETS - 1;
+
+    if (hit) BFM_STATS_INC(type, hitLatency[bucket]);
+    else BFM_STATS_INC(type, missLatency[bucket]);
+
+} /* edubfm_StatsLatency() */
@@ -0,0 +1,167 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Strategy.c
+ *
+ * Description :
+ *  Rings of the access strategies.
+ *  A ring is a small circular list of buffers owned by a scan. A miss of
+ *  the scan recycles the buffer it used a ring ago, provided that the
+ *  buffer is unfixed and nobody else has referenced it since; otherwise a
+ *  buffer is allocated from the pool as usual and takes that slot of the
+ *  ring. A train is kept in the partition of its key, so each partition
+ *  has a ring of its own, of at most a quarter of its buffers; a buffer
+ *  left in a ring by an earlier layout of the partitions is replaced.
+ *
+ * Exports:
+ *  Boolean edubfm_InRing(BfMStrategy *, Four, Four)
+ *  Four edubfm_RingVictim(Four, Four, BfMStrategy *)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * edubfm_InRing()
+ *================================*/
+/*
+ * Function: Boolean edubfm_InRing(BfMStrategy *, Four, Four)
+ *
+ * Description:
+ *  Tell whether a buffer belongs to the ring of a strategy for partition
+ *  `part'.
+ *
+ * Returns:
+ *  TRUE if the buffer is in the ring, FALSE otherwise
+ */
+Boolean edubfm_InRing(
+    BfMStrategy         *strategy,              /* IN access strategy */
+    Four                part,                   /* IN partition of the buffer */
+    Four                index)                  /* IN index of the buffer */
+{
+    Four                i;                      /* index */
+    Four                *ring;                  /* buffers of the ring of the partition */
+
+
+    ring = &strategy->bufs[part * strategy->size];
+    for (i = 0; i < strategy->size; i++)
+        if (ring[i] == index) return(TRUE);
+
+    return(FALSE);
+
+} /* edubfm_InRing() */
+
+
+
+/*@================================
+ * edubfm_RingVictim()
+ *================================*/
+/*
+ * Function: Four edubfm_RingVictim(Four, Four, BfMStrategy *)
+ *
+ * Description:
+ *  Select the buffer of the ring of partition `part' which a missing train
+ *  is read into, and evict its train by edubfm_EvictTrain(). The buffer
+ *  of the current slot is recycled if it is unfixed, not referenced and,
+ *  for a sequential scan, clean; a dirty buffer of a bulk write is written
+ *  back first, without the latch. Otherwise, or if the buffer is fixed or
+ *  updated during its write-back, a buffer is allocated by
+ *  edubfm_AllocTrain() and replaces the slot.
+ *  The caller holds the latch of the partition.
+ *
+ * Returns:
+ *  index of the buffer selected (>= 0)
+ *  error code
+ *    eNOUNFIXEDBUF_BFM - no unfixed buffer available
+ *    some errors caused by function calls
+ */
+Four edubfm_RingVictim(
+    Four                type,                   /* IN buffer type */
+    Four                part,                   /* IN partition of the train */
+    BfMStrategy         *strategy)              /* INOUT access strategy */
+{
+    Four                e;                      /* for error */
+    Four                slot;                   /* slot of the ring */
+    Four                victim;                 /* buffer selected */
+    Four                size;                   /* # of buffers of the ring of the partition */
+    Four                *ring;                  /* buffers of the ring of the partition */
+
+
+    size = strategy->size;
+    if (size > BI_PARTNBUFS(type, part) / 4) size = BI_PARTNBUFS(type, part) / 4;
+    if (size < 1) size = 1;
+    ring = &strategy->bufs[part * strategy->size];
+
+    slot = strategy->current[part] % size;
+    strategy->current[part] = (slot + 1) % size;
+    victim = ring[slot];
+
+    if (victim != NIL && victim < BI_NBUFS(type) && BI_PARTITIONOFBUF(type, victim) == part &&
+        BI_FIXED(type, victim) == 0 && (BI_BITS(type, victim) & (REFER | READING)) == 0 &&
+        (strategy->kind == BFM_STRATEGY_BULKWRITE || (BI_BITS(type, victim) & DIRTY) == 0)) {
+
+        e = edubfm_EvictTrain(type, victim, TRUE);
+        if (e < eNOERROR) ERR(e);
+        if (e != BFM_VICTIM_KEPT) {
+            BFM_STATS_INC(type, nRingReuses);
+            return(victim);
+        }
+    }
+
+    victim = edubfm_AllocTrain(type, part, TRUE);
+    if (victim < eNOERROR) ERR(victim);
+
+    ring[slot] = victim;
+
+    return(victim);
+
+} /* edubfm_RingVictim() */
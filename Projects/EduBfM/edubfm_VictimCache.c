@@ -0,0 +1,416 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_VictimCache.c
+ *
+ * Description :
+ *  Compressed victim cache behind a buffer pool (see BfMVictimCache).
+ *  edubfm_AllocTrain() puts the clean trains it evicts, edubfm_ReadTrain()
+ *  takes a train from here instead of reading the disk, and the other
+ *  paths bringing a train into the pool or deallocating it drop its copy.
+ *  The trains are compressed and decompressed outside the latch.
+ *
+ * Exports:
+ *  Four edubfm_InitVictimCache(Four, Four)
+ *  void edubfm_VictimPut(Four, BfMHashKey *, char *)
+ *  Boolean edubfm_VictimTake(Four, BfMHashKey *, char *)
+ *  void edubfm_VictimDrop(Four, BfMHashKey *)
+ *  void edubfm_VictimClear(Four)
+ */
+
+
+#include <stdlib.h> /* for malloc, realloc & free */
+#include <string.h> /* for memcpy */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * global variables
+ */
+/* compressed victim cache of each buffer pool; disabled by default */
+BfMVictimCache bufVictimCache[NUM_BUF_TYPES] = {
+    { 0, 0, 0, NULL, NIL, NIL, NIL, { 0 }, PTHREAD_MUTEX_INITIALIZER },
+    { 0, 0, 0, NULL, NIL, NIL, NIL, { 0 }, PTHREAD_MUTEX_INITIALIZER }
+};
+
+
+
+/*@
+ * internal function prototypes
+ */
+static char *victim_Remove(BfMVictimCache *, Four);
+static void victim_Clear(BfMVictimCache *);
+
+
+
+/*@================================
+ * edubfm_InitVictimCache()
+ *================================*/
+/*
+ * Function: Four edubfm_InitVictimCache(Four, Four)
+ *
+ * Description:
+ *  Drop the victim cache of the given pool and create an empty one keeping
+ *  up to `budget' bytes of compressed trains; 0 disables the cache.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four edubfm_InitVictimCache(
+    Four                type,                   /* IN buffer type */
+    Four                budget)                 /* IN # of bytes of compressed trains */
+{
+    Four                e;                      /* for error */
+    Four                i;                      /* index */
+    BfMVictimCache      *c = &bufVictimCache[type];     /* cache of the pool */
+
+
+    BFM_GETLATCH(&c->latch);
+
+    victim_Clear(c);
+    c->budget = 0;
+    free(c->entries);
+    c->entries = NULL;
+    c->nEntries = 0;
+    edubfm_OpenHashDestroy(&c->table);
+
+    if (budget > 0) {
+        c->nEntries = budget / (PAGESIZE * BI_BUFSIZE(type) / BFM_VICTIM_MAXRATIO);
+        if (c->nEntries < 1) c->nEntries = 1;
+        c->entries = (BfMVictimEntry*)malloc(sizeof(BfMVictimEntry) * c->nEntries);
+        if (c->entries == NULL) {
+            c->nEntries = 0;
+            ERRL(eMEMORYALLOCERR, &c->latch);
+        }
+
+        e = edubfm_OpenHashCreate(&c->table, c->nEntries);
+        if (e < eNOERROR) {
+            free(c->entries);
+            c->entries = NULL;
+            c->nEntries = 0;
+            ERRL(e, &c->latch);
+        }
+
+        for (i = 0; i < c->nEntries; i++)
+            c->entries[i].next = (i + 1 < c->nEntries) ? i + 1 : NIL;
+        c->freeEntry = 0;
+        c->head = c->tail = NIL;
+        c->used = 0;
+        c->budget = budget;
+    }
+
+    BFM_RELEASELATCH(&c->latch);
+
+    return(eNOERROR);
+
+} /* edubfm_InitVictimCache() */
+
+
+
+/*@================================
+ * edubfm_VictimPut()
+ *================================*/
+/*
+ * Function: void edubfm_VictimPut(Four, BfMHashKey *, char *)
+ *
+ * Description:
+ *  Keep a compressed copy of a clean train evicted from the pool, dropping
+ *  the oldest copies to make room. A train which does not compress is kept
+ *  as it is. Nothing is kept if memory is short.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_VictimPut(
+    Four                type,                   /* IN buffer type */
+    BfMHashKey          *key,                   /* IN key of the train */
+    char                *train)                 /* IN contents of the train */
+{
+    BfMVictimCache      *c = &bufVictimCache[type];     /* cache of the pool */
+    Four                trainBytes;             /* size of a train */
+    Four                size;                   /* size of the copy */
+    Four                i;                      /* entry */
+    char                *data;                  /* the copy */
+    char                *shrunk;                /* the copy reallocated to its size */
+
+
+    trainBytes = PAGESIZE * BI_BUFSIZE(type);
+
+    data = (char*)malloc(trainBytes);
+    if (data == NULL) return;
+
+    size = edubfm_LZCompress(train, trainBytes, data, trainBytes - 1);
+    if (size == 0) {
+        memcpy(data, train, trainBytes);
+        size = trainBytes;
+    }
+    else if ((shrunk = (char*)realloc(data, size)) != NULL)
+        data = shrunk;
+
+    BFM_GETLATCH(&c->latch);
+
+    if (c->budget == 0 || size > c->budget) {
+        BFM_RELEASELATCH(&c->latch);
+        free(data);
+        return;
+    }
+
+    i = edubfm_OpenHashLookUp(&c->table, key);
+    if (i != NOTFOUND_IN_HTABLE) free(victim_Remove(c, i));
+
+    while (c->used + size > c->budget || c->freeEntry == NIL)
+        free(victim_Remove(c, c->tail));
+
+    i = c->freeEntry;
+    c->freeEntry = c->entries[i].next;
+
+    c->entries[i].key = *key;
+    c->entries[i].size = size;
+    c->entries[i].data = data;
+    c->entries[i].prev = NIL;
+    c->entries[i].next = c->head;
+    if (c->head != NIL) c->entries[c->head].prev = i;
+    else c->tail = i;
+    c->head = i;
+    c->used += size;
+    edubfm_OpenHashInsert(&c->table, key, i);
+
+    BFM_RELEASELATCH(&c->latch);
+
+    BFM_STATS_INC(type, nVictimPuts);
+    BFM_STATS_ADD(type, victimBytesIn, trainBytes);
+    BFM_STATS_ADD(type, victimBytesOut, size);
+
+} /* edubfm_VictimPut() */
+
+
+
+/*@================================
+ * edubfm_VictimTake()
+ *================================*/
+/*
+ * Function: Boolean edubfm_VictimTake(Four, BfMHashKey *, char *)
+ *
+ * Description:
+ *  Look up a train to be read into the pool. If it is found, it is
+ *  decompressed into `train' and its copy leaves the cache.
+ *
+ * Returns:
+ *  TRUE if the train has been found, FALSE if it must be read from the disk
+ */
+Boolean edubfm_VictimTake(
+    Four                type,                   /* IN buffer type */
+    BfMHashKey          *key,                   /* IN key of the train */
+    char                *train)                 /* OUT contents of the train */
+{
+    BfMVictimCache      *c = &bufVictimCache[type];     /* cache of the pool */
+    Four                trainBytes;             /* size of a train */
+    Four                size;                   /* size of the copy */
+    Four                i;                      /* entry */
+    Four                e;                      /* for error */
+    char                *data;                  /* the copy */
+
+
+    BFM_GETLATCH(&c->latch);
+
+    if (c->budget == 0) {
+        BFM_RELEASELATCH(&c->latch);
+        return(FALSE);
+    }
+    BFM_STATS_INC(type, nVictimLookups);
+
+    i = edubfm_OpenHashLookUp(&c->table, key);
+    if (i == NOTFOUND_IN_HTABLE) {
+        BFM_RELEASELATCH(&c->latch);
+        return(FALSE);
+    }
+    size = c->entries[i].size;
+    data = victim_Remove(c, i);
+
+    BFM_RELEASELATCH(&c->latch);
+
+    trainBytes = PAGESIZE * BI_BUFSIZE(type);
+    if (size == trainBytes) {
+        memcpy(train, data, trainBytes);
+        e = eNOERROR;
+    }
+    else
+        e = edubfm_LZDecompress(data, size, train, trainBytes);
+    free(data);
+
+    if (e < eNOERROR) return(FALSE);
+
+    BFM_STATS_INC(type, nVictimHits);
+
+    return(TRUE);
+
+} /* edubfm_VictimTake() */
+
+
+
+/*@================================
+ * edubfm_VictimDrop()
+ *================================*/
+/*
+ * Function: void edubfm_VictimDrop(Four, BfMHashKey *)
+ *
+ * Description:
+ *  Drop the copy of a train, if any, because the train has been read into
+ *  the pool by another path or its page is deallocated.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_VictimDrop(
+    Four                type,                   /* IN buffer type */
+    BfMHashKey          *key)                   /* IN key of the train */
+{
+    BfMVictimCache      *c = &bufVictimCache[type];     /* cache of the pool */
+    Four                i;                      /* entry */
+
+
+    BFM_GETLATCH(&c->latch);
+
+    if (c->budget > 0) {
+        i = edubfm_OpenHashLookUp(&c->table, key);
+        if (i != NOTFOUND_IN_HTABLE) free(victim_Remove(c, i));
+    }
+
+    BFM_RELEASELATCH(&c->latch);
+
+} /* edubfm_VictimDrop() */
+
+
+
+/*@================================
+ * edubfm_VictimClear()
+ *================================*/
+/*
+ * Function: void edubfm_VictimClear(Four)
+ *
+ * Description:
+ *  Drop all copies kept for the pool, e.g. when its trains are discarded.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_VictimClear(
+    Four                type)                   /* IN buffer type */
+{
+    BfMVictimCache      *c = &bufVictimCache[type];     /* cache of the pool */
+
+
+    BFM_GETLATCH(&c->latch);
+    victim_Clear(c);
+    BFM_RELEASELATCH(&c->latch);
+
+} /* edubfm_VictimClear() */
+
+
+
+/*@================================
+ * victim_Remove()
+ *================================*/
+/*
+ * Function: static char *victim_Remove(BfMVictimCache *, Four)
+ *
+ * Description:
+ *  Unlink an entry from the cache and free it. The caller must hold the
+ *  latch of the cache.
+ *
+ * Returns:
+ *  the copy of the train held by the entry, to be freed by the caller
+ */
+static char *victim_Remove(
+    BfMVictimCache      *c,                     /* INOUT cache */
+    Four                i)                      /* IN entry to remove */
+{
+    BfMVictimEntry      *entry = &c->entries[i];        /* the entry */
+
+
+    if (entry->prev != NIL) c->entries[entry->prev].next = entry->next;
+    else c->head = entry->next;
+    if (entry->next != NIL) c->entries[entry->next].prev = entry->prev;
+    else c->tail = entry->prev;
+
+    edubfm_OpenHashDelete(&c->table, &entry->key);
+    c->used -= entry->size;
+
+    entry->next = c->freeEntry;
+    c->freeEntry = i;
+
+    return(entry->data);
+
+} /* victim_Remove() */
+
+
+
+/*@================================
+ * victim_Clear()
+ *================================*/
+/*
+ * Function: static void victim_Clear(BfMVictimCache *)
+ *
+ * Description:
+ *  Remove all entries of the cache. The caller must hold the latch of the
+ *  cache.
+ *
+ * Returns:
+ *  None
+ */
+static void victim_Clear(
+    BfMVictimCache      *c)                     /* INOUT cache */
+{
+    while (c->head != NIL) free(victim_Remove(c, c->head));
+
+} /* victim_Clear() */